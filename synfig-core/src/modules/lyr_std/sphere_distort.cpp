@@ -49,6 +49,9 @@
 
 #include <synfig/curve_helper.h>
 
+#include <synfig/rendering/common/task/taskdistort.h>
+#include <synfig/rendering/software/task/taskdistortsw.h>
+
 #endif
 
 /* === U S I N G =========================================================== */
@@ -349,229 +352,93 @@ Layer_SphereDistort::get_sub_renddesc_vfunc(const RendDesc &renddesc) const
 	return desc;
 }
 
-#if 1
-bool
-Layer_SphereDistort::accelerated_render(Context context,Surface *surface,int quality, const RendDesc &renddesc, ProgressCallback *cb)const
+
+class TaskSphereDistort
+	: public rendering::TaskDistort,
+	  public rendering::TaskInterfaceSplit
 {
-	RENDER_TRANSFORMED_IF_NEED(__FILE__, __LINE__)
+public:
+	typedef etl::handle<TaskSphereDistort> Handle;
+	static Token token;
+	Token::Handle get_token() const override { return token.handle(); }
 
-	/*	Things to consider:
-		1) Block expansion for distortion (ouch... quality level??)
-		2) Bounding box clipping
-		3) Super sampling for better visual quality (based on the quality level?)
-		4) Interpolation type for sampling (based on quality level?)
+	Point center;
+	Real radius;
+	Real percent;
+	int type;
+	bool clip;
 
-		//things to defer until after
-		super sampling, non-linear interpolation
-	*/
+	TaskSphereDistort(): radius(1.0), percent(1.0), type(TYPE_NORMAL), clip(false) { }
 
-	//bounding box reject
-	Vector center=param_center.get(Vector());
-	double radius=param_radius.get(double());
-	double percent=param_amount.get(double());
-	int type=param_type.get(int());
-	bool clip=param_clip.get(bool());
+	Rect
+	compute_required_source_rect(const Rect& source_rect, const Matrix& /*inv_matrix*/) const override
 	{
-		Rect	sphr;
-
-		sphr.set_point(center[0]-radius,center[1]-radius);
-		sphr.expand(center[0]+radius,center[1]+radius);
-
-		//get the bounding box of the transform
-		Rect	windr;
-
-		//and the bounding box of the rendering
-		windr.set_point(renddesc.get_tl()[0],renddesc.get_tl()[1]);
-		windr.expand(renddesc.get_br()[0],renddesc.get_br()[1]);
-
-		//test bounding boxes for collision
-		if( (type == TYPE_NORMAL && !rect_intersect(sphr,windr)) ||
-			(type == TYPE_DISTH && (sphr.minx >= windr.maxx || windr.minx >= sphr.maxx)) ||
-			(type == TYPE_DISTV && (sphr.miny >= windr.maxy || windr.miny >= sphr.maxy)) )
+		// distorted points never leave the sphere (or the bar),
+		// and the points outside of it are taken as is
+		const Rect sphr(center[0]-radius, center[1]-radius, center[0]+radius, center[1]+radius);
+		switch(type)
 		{
-			//warning("Spherize: Bounding box reject");
-			if (clip)
-			{
-				surface->set_wh(renddesc.get_w(), renddesc.get_h());
-				surface->clear();
-				return true;
-			}
-			else
-				return context.accelerated_render(surface,quality,renddesc,cb);
+		case TYPE_NORMAL:
+			if (rect_intersect(sphr, source_rect))
+				return source_rect | sphr;
+			break;
+		case TYPE_DISTH:
+			if (sphr.minx < source_rect.maxx && source_rect.minx < sphr.maxx)
+				return source_rect | Rect(sphr.minx, source_rect.miny, sphr.maxx, source_rect.maxy);
+			break;
+		case TYPE_DISTV:
+			if (sphr.miny < source_rect.maxy && source_rect.miny < sphr.maxy)
+				return source_rect | Rect(source_rect.minx, sphr.miny, source_rect.maxx, sphr.maxy);
+			break;
+		default:
+			break;
 		}
-
-		//warning("Spherize: Bounding box accept");
+		return source_rect;
 	}
+};
 
-	//Ok, so we overlap some... now expand the window for rendering
-	RendDesc r = renddesc;
-	Surface background;
-	Real pw = renddesc.get_pw(),ph = renddesc.get_ph();
-
-	int nl=0,nt=0,nr=0,nb=0, nw=0,nh=0;
-	Point tl = renddesc.get_tl(), br = renddesc.get_br();
-
-	{
-		//must enlarge window by pixel coordinates so go!
-
-		//need to figure out closest and farthest point and distort THOSE
-
-		Point origin[4] = {tl,tl,br,br};
-		Vector v[4] = {Vector(0,br[1]-tl[1]),
-					   Vector(br[0]-tl[0],0),
-					   Vector(0,tl[1]-br[1]),
-					   Vector(tl[0]-br[0],0)};
-
-		Point close(0,0);
-		Real t = 0;
-		Rect	expandr(tl,br);
-
-		//expandr.set_point(tl[0],tl[1]);
-		//expandr.expand(br[0],br[1]);
-
-		//warning("Spherize: Loop through lines and stuff");
-		for(int i=0; i<4; ++i)
-		{
-			//warning("Spherize: 	%d", i);
-			Vector p_o = center-origin[i];
-
-			//project onto left line
-			t = (p_o*v[i])/v[i].mag_squared();
-
-			//clamp
-			if (t < 0) t = 0;
-			if (t > 1) t = 1;
-
-			close = origin[i] + v[i]*t;
-
-			//now get transforms and expand the rectangle to accommodate
-			Point p = sphtrans(close,center,radius,percent,type);
-			expandr.expand(p[0],p[1]);
-			p = sphtrans(origin[i],center,radius,percent,type);
-			expandr.expand(p[0],p[1]);
-			p = sphtrans(origin[i]+v[i],center,radius,percent,type);
-			expandr.expand(p[0],p[1]);
-		}
-
-		/*warning("Spherize: Bounding box (%f,%f)-(%f,%f)",
-							expandr.minx,expandr.miny,expandr.maxx,expandr.maxy);*/
-
-		//now that we have the bounding rectangle of ALL the pixels (should be...)
-		//order it so that it's in the same orientation as the tl,br pair
-
-		//warning("Spherize: Organize like tl,br");
-		Point ntl(0,0),nbr(0,0);
-
-		//sort x
-		if(tl[0] < br[0])
-		{
-			ntl[0] = expandr.minx;
-			nbr[0] = expandr.maxx;
-		}
-		else
-		{
-			ntl[0] = expandr.maxx;
-			nbr[0] = expandr.minx;
-		}
-
-		//sort y
-		if(tl[1] < br[1])
-		{
-			ntl[1] = expandr.miny;
-			nbr[1] = expandr.maxy;
-		}
-		else
-		{
-			ntl[1] = expandr.maxy;
-			nbr[1] = expandr.miny;
-		}
-
-		//now expand the window as needed
-		Vector temp = ntl-tl;
-
-		//pixel offset
-		nl = (int)(temp[0]/pw)-1;
-		nt = (int)(temp[1]/ph)-1;
-
-		temp = nbr - br;
-		nr = (int)(temp[0]/pw)+1;
-		nb = (int)(temp[1]/ph)+1;
-
-		nw = renddesc.get_w() + nr - nl;
-		nh = renddesc.get_h() + nb - nt;
-
-		//warning("Spherize: Setting subwindow (%d,%d) (%d,%d) (%d,%d)",nl,nt,nr,nb,nw,nh);
-		r.set_subwindow(nl,nt,nw,nh);
+class TaskSphereDistortSW
+	: public TaskSphereDistort, public rendering::TaskDistortSW
+{
+public:
+	typedef etl::handle<TaskSphereDistortSW> Handle;
+	static Token token;
+	Token::Handle get_token() const override { return token.handle(); }
 
-		/*r = renddesc;
-		nw = r.get_w(), nh = r.get_h();
-		nl = 0, nt = 0;*/
-	}
+	Point
+	point_vfunc(const Point &point) const override
+		{ return sphtrans(point, center, radius, percent, type); }
 
-	//warning("Spherize: render background");
-	if(!context.accelerated_render(&background,quality,r,cb))
+	bool
+	point_clip_vfunc(const Point &point, Point &source_point) const override
 	{
-		warning("SphereDistort: Layer below failed");
-		return false;
+		bool clipped;
+		source_point = sphtrans(point, center, radius, percent, type, clipped);
+		return !(clip && clipped);
 	}
 
-	//now distort and check to make sure we aren't overshooting our bounds here
-	int w = renddesc.get_w(), h = renddesc.get_h();
-	surface->set_wh(w,h);
-
-	Point sample = tl, sub = tl, trans(0,0);
-	float xs = 0,ys = 0;
-	int y=0,x=0;
-	Real invpw = 1/pw, invph = 1/ph;
-	Surface::pen	p = surface->begin();
-
-	Point rtl = r.get_tl();
-
-	//warning("Spherize: About to transform");
+	bool run(Task::RunParams& /*params*/) const override
+		{ return run_task(*this); }
+};
 
-	for(y = 0; y < h; ++y, sample[1] += ph, p.inc_y())
-	{
-		sub = sample;
-		for(x = 0; x < w; ++x, sub[0] += pw, p.inc_x())
-		{
-			bool clipped;
-			trans=sphtrans(sub,center,radius,percent,type,clipped);
-			if(clip && clipped)
-			{
-				p.put_value(Color::alpha());
-				continue;
-			}
-
-			xs = (trans[0]-rtl[0])*invpw;
-			ys = (trans[1]-rtl[1])*invph;
-
-			if(!(xs >= 0 && xs < nw && ys >= 0 && ys < nh))
-			{
-				//warning("Spherize: we failed to account for %f,%f",xs,ys);
-				p.put_value(context.get_color(trans));//Color::alpha());
-				continue;
-			}
-
-			//sample at that pixel location based on the quality
-			if(quality <= 4)	// cubic
-				p.put_value(background.cubic_sample(xs,ys));
-			else if(quality <= 5) // cosine
-				p.put_value(background.cosine_sample(xs,ys));
-			else if(quality <= 6) // linear
-				p.put_value(background.linear_sample(xs,ys));
-			else				// nearest
-				p.put_value(background[round_to_int(ys)][round_to_int(xs)]);
-		}
-		p.dec_x(w);
-	}
+rendering::Task::Token TaskSphereDistort::token(
+	DescAbstract<TaskSphereDistort>("SphereDistort") );
+rendering::Task::Token TaskSphereDistortSW::token(
+	DescReal<TaskSphereDistortSW, TaskSphereDistort>("SphereDistortSW") );
 
-	return true;
+rendering::Task::Handle
+Layer_SphereDistort::build_rendering_task_vfunc(Context context) const
+{
+	TaskSphereDistort::Handle task_distort(new TaskSphereDistort());
+	task_distort->center = param_center.get(Vector());
+	task_distort->radius = param_radius.get(double());
+	task_distort->percent = param_amount.get(double());
+	task_distort->type = param_type.get(int());
+	task_distort->clip = param_clip.get(bool());
+	task_distort->sub_task() = context.build_rendering_task();
+	return task_distort;
 }
 
-
-
-#endif
-
 class lyr_std::Spherize_Trans : public Transform
 {
 	etl::handle<const Layer_SphereDistort> layer;
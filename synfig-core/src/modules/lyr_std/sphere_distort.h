@@ -82,7 +82,6 @@ public:
 
 	virtual Color get_color(Context context, const Point &pos)const;
 
-	virtual bool accelerated_render(Context context,Surface *surface,int quality, const RendDesc &renddesc, ProgressCallback *cb)const;
 	Layer::Handle hit_check(Context context, const Point &point)const;
 
 	virtual Rect get_bounding_rect()const;
@@ -92,6 +91,7 @@ public:
 
 protected:
 	virtual RendDesc get_sub_renddesc_vfunc(const RendDesc &renddesc) const;
+	virtual rendering::Task::Handle build_rendering_task_vfunc(Context context) const;
 }; // END of class Layer_SphereDistort
 
 }; // END of namespace lyr_std
@@ -42,6 +42,8 @@
 #include <synfig/renddesc.h>
 #include <synfig/value.h>
 #include <synfig/transform.h>
+#include <synfig/rendering/common/task/taskdistort.h>
+#include <synfig/rendering/software/task/taskdistortsw.h>
 #include "twirl.h"
 
 #endif
@@ -62,6 +64,101 @@ SYNFIG_LAYER_SET_VERSION(Twirl,"0.1");
 
 /* === P R O C E D U R E S ================================================= */
 
+static Point
+twirl_point(const Point &pos, const Point &center, Real radius, const Angle &rotations,
+            bool distort_inside, bool distort_outside, bool reverse)
+{
+	Point centered(pos-center);
+	Real mag(centered.mag());
+
+	Angle a;
+
+	if((distort_inside || mag>radius) && (distort_outside || mag<radius))
+		a=rotations*((centered.mag()-radius)/radius);
+	else
+		return pos;
+
+	if(reverse)	a=-a;
+
+	const Real sin(Angle::sin(a).get());
+	const Real cos(Angle::cos(a).get());
+
+	Point twirled;
+	twirled[0]=cos*centered[0]-sin*centered[1];
+	twirled[1]=sin*centered[0]+cos*centered[1];
+
+	return twirled+center;
+}
+
+class TaskTwirl
+	: public rendering::TaskDistort,
+	  public rendering::TaskInterfaceSplit
+{
+public:
+	typedef etl::handle<TaskTwirl> Handle;
+	static Token token;
+	Token::Handle get_token() const override { return token.handle(); }
+
+	Point center;
+	Real radius;
+	Angle rotations;
+	bool distort_inside;
+	bool distort_outside;
+
+	TaskTwirl(): radius(1.0), distort_inside(true), distort_outside(false) { }
+
+	Point distort(const Point &pos) const
+		{ return twirl_point(pos, center, radius, rotations, distort_inside, distort_outside, false); }
+
+	Rect
+	compute_required_source_rect(const Rect& source_rect, const Matrix& /*inv_matrix*/) const override
+	{
+		// twirl keeps the distance to the center, so every distorted point
+		// comes from the circle which touches the farthest corner
+		Real min_mag = 0.0, max_mag = 0.0;
+		const Point corners[] = {
+			Point(source_rect.minx, source_rect.miny), Point(source_rect.maxx, source_rect.miny),
+			Point(source_rect.minx, source_rect.maxy), Point(source_rect.maxx, source_rect.maxy) };
+		for(const Point &corner : corners)
+			max_mag = std::max(max_mag, (corner - center).mag());
+		if (!source_rect.is_inside(center)) {
+			const Point nearest(
+				std::max(source_rect.minx, std::min(source_rect.maxx, center[0])),
+				std::max(source_rect.miny, std::min(source_rect.maxy, center[1])) );
+			min_mag = (nearest - center).mag();
+		}
+
+		if (!distort_outside && min_mag >= radius)
+			return source_rect;
+		if (!distort_inside && max_mag <= radius)
+			return source_rect;
+
+		const Real r = distort_outside ? max_mag : std::min(max_mag, radius);
+		return source_rect | Rect(center - Vector(r, r), center + Vector(r, r));
+	}
+};
+
+class TaskTwirlSW
+	: public TaskTwirl, public rendering::TaskDistortSW
+{
+public:
+	typedef etl::handle<TaskTwirlSW> Handle;
+	static Token token;
+	Token::Handle get_token() const override { return token.handle(); }
+
+	Point
+	point_vfunc(const Point &point) const override
+		{ return distort(point); }
+
+	bool run(Task::RunParams& /*params*/) const override
+		{ return run_task(*this); }
+};
+
+rendering::Task::Token TaskTwirl::token(
+	DescAbstract<TaskTwirl>("Twirl") );
+rendering::Task::Token TaskTwirlSW::token(
+	DescReal<TaskTwirlSW, TaskTwirl>("TwirlSW") );
+
 /* === M E T H O D S ======================================================= */
 
 /* === E N T R Y P O I N T ================================================= */
@@ -145,32 +242,14 @@ Twirl::get_param_vocab()const
 Point
 Twirl::distort(const Point &pos,bool reverse)const
 {
-	Point center=param_center.get(Point());
-	Real radius=param_radius.get(Real());
-	Angle rotations=param_rotations.get(Angle());
-	bool distort_inside=param_distort_inside.get(bool());
-	bool distort_outside=param_distort_outside.get(bool());
-	
-	Point centered(pos-center);
-	Real mag(centered.mag());
-
-	Angle a;
-
-	if((distort_inside || mag>radius) && (distort_outside || mag<radius))
-		a=rotations*((centered.mag()-radius)/radius);
-	else
-		return pos;
-
-	if(reverse)	a=-a;
-
-	const Real sin(Angle::sin(a).get());
-	const Real cos(Angle::cos(a).get());
-
-	Point twirled;
-	twirled[0]=cos*centered[0]-sin*centered[1];
-	twirled[1]=sin*centered[0]+cos*centered[1];
-
-	return twirled+center;
+	return twirl_point(
+		pos,
+		param_center.get(Point()),
+		param_radius.get(Real()),
+		param_rotations.get(Angle()),
+		param_distort_inside.get(bool()),
+		param_distort_outside.get(bool()),
+		reverse );
 }
 
 Layer::Handle
@@ -279,5 +358,17 @@ Twirl::get_sub_renddesc_vfunc(const RendDesc &renddesc) const
 }
 
 rendering::Task::Handle
-Twirl::build_rendering_task_vfunc(Context context) const
-	{ return Layer::build_rendering_task_vfunc(context); }
+Twirl::build_composite_fork_task_vfunc(ContextParams /* context_params */, rendering::Task::Handle sub_task) const
+{
+	if (!sub_task)
+		return sub_task;
+
+	TaskTwirl::Handle task_twirl(new TaskTwirl());
+	task_twirl->center = param_center.get(Point());
+	task_twirl->radius = param_radius.get(Real());
+	task_twirl->rotations = param_rotations.get(Angle());
+	task_twirl->distort_inside = param_distort_inside.get(bool());
+	task_twirl->distort_outside = param_distort_outside.get(bool());
+	task_twirl->sub_task() = sub_task->clone_recursive();
+	return task_twirl;
+}
@@ -47,13 +47,22 @@
 #if HAVE_FCNTL_H
  #include <fcntl.h>
 #endif
-#include <iostream>
+#include <algorithm>
+#include <vector>
+
+#include <synfig/misc.h>
 #endif
 
 /* === M A C R O S ========================================================= */
 
 using namespace synfig;
 
+#define DEFAULT_FPS			24.f
+//! Pictures decoded ahead of the one requested
+#define READ_AHEAD_FRAMES	4
+//! Longest jump forward (in seconds) done by reading on instead of restarting ffmpeg
+#define MAX_FORWARD_SKIP	2.0
+
 /* === G L O B A L S ======================================================= */
 
 SYNFIG_IMPORTER_INIT(ffmpeg_mptr);
@@ -70,56 +79,96 @@ bool ffmpeg_mptr::is_animated()
 }
 
 bool
-ffmpeg_mptr::seek_to(const Time& time)
+ffmpeg_mptr::start_stream(int frame)
 {
-	//if(frame<cur_frame || !file)
-	//{
-		pipe = nullptr;
-		
-		// FIXME: 24 fps is hardcoded now, but in fact we have to get it from canvas
-		//float position = (frame+1)/24; // ffmpeg didn't work with 0 frame
-		//float position = 1000/24; // ffmpeg didn't work with 0 frame
-		const std::string position = time.get_string(Time::FORMAT_NORMAL);
-
-		OS::RunArgs args;
-		args.push_back({"-ss", position});
-		args.push_back("-i");
-		args.push_back(filesystem::Path(identifier.filename));
-		args.push_back({"-vframes", "1"});
-		args.push_back("-an");
-		args.push_back({"-f", "image2pipe"});
-		args.push_back({"-vcodec", "ppm"});
-		args.push_back("-");
+	stop_stream();
+
+	const std::string position = Time(frame/fps).get_string(Time::FORMAT_NORMAL);
+
+	// -r makes ffmpeg output exactly one picture per canvas frame,
+	// so the n-th picture of the stream is frame + n
+	OS::RunArgs args;
+	args.push_back({"-ss", position});
+	args.push_back("-i");
+	args.push_back(filesystem::Path(identifier.filename));
+	args.push_back({"-r", strprintf("%f", fps)});
+	args.push_back("-an");
+	args.push_back({"-f", "image2pipe"});
+	args.push_back({"-vcodec", "ppm"});
+	args.push_back("-");
 
 #ifdef _WIN32
-		synfig::filesystem::Path binary_path = synfig::OS::get_binary_path();
-		if (!binary_path.empty())
-			binary_path = binary_path.parent_path();
-		binary_path /= filesystem::Path("ffmpeg.exe");
+	synfig::filesystem::Path binary_path = synfig::OS::get_binary_path();
+	if (!binary_path.empty())
+		binary_path = binary_path.parent_path();
+	binary_path /= filesystem::Path("ffmpeg.exe");
 #else
-		synfig::filesystem::Path binary_path("ffmpeg");
+	synfig::filesystem::Path binary_path("ffmpeg");
 #endif
-		pipe = OS::run_async(binary_path, args, OS::RUN_MODE_READ);
+	pipe = OS::run_async(binary_path, args, OS::RUN_MODE_READ);
 
-		if(!pipe)
+	if(!pipe)
+	{
+		synfig::error(_("Unable to open pipe to ffmpeg"));
+		return false;
+	}
+
+	next_frame = frame;
+	stop_decoder = false;
+	stream_ended = false;
+	decoder = std::thread(&ffmpeg_mptr::decoder_loop, this, frame);
+	return true;
+}
+
+void
+ffmpeg_mptr::stop_stream()
+{
+	if (decoder.joinable()) {
 		{
-			synfig::error(_("Unable to open pipe to ffmpeg"));
-			return false;
+			std::lock_guard<std::mutex> lock(queue_mutex);
+			stop_decoder = true;
 		}
-		cur_frame=-1;
-	//}
-
-	//while(cur_frame<frame-1)
-	//{
-	//	cerr<<"Seeking to..."<<frame<<'('<<cur_frame<<')'<<endl;
-	//	if(!grab_frame())
-	//		return false;
-	//}
-	return true;
+		queue_cond.notify_all();
+		// the decoder finishes the picture it reads, ffmpeg keeps writing until then
+		decoder.join();
+	}
+	pipe = nullptr;
+	queue.clear();
+}
+
+void
+ffmpeg_mptr::decoder_loop(int frame)
+{
+	for(int index = frame; ; ++index)
+	{
+		{
+			std::unique_lock<std::mutex> lock(queue_mutex);
+			queue_cond.wait(lock, [this] { return stop_decoder || queue.size() < READ_AHEAD_FRAMES; });
+			if (stop_decoder)
+				return;
+		}
+
+		DecodedFrame decoded;
+		decoded.index = index;
+		decoded.surface = std::make_shared<Surface>();
+		const bool success = grab_frame(*decoded.surface);
+
+		{
+			std::lock_guard<std::mutex> lock(queue_mutex);
+			if (success)
+				queue.push_back(decoded);
+			else
+				stream_ended = true;
+		}
+		queue_cond.notify_all();
+
+		if (!success)
+			return;
+	}
 }
 
 bool
-ffmpeg_mptr::grab_frame(void)
+ffmpeg_mptr::grab_frame(Surface &surface)
 {
 	if(!pipe)
 	{
@@ -143,32 +192,33 @@ ffmpeg_mptr::grab_frame(void)
 	}
 
 	pipe->getc();
-	pipe->scanf("%d %d\n",&w,&h);
+	if (pipe->scanf("%d %d\n",&w,&h) != 2 || w <= 0 || h <= 0)
+		return false;
 	pipe->scanf("%f",&divisor);
 	pipe->getc();
 
 	if(pipe->eof())
 		return false;
 
-	frame.set_wh(w, h);
+	surface.set_wh(w, h);
+	std::vector<unsigned char> row(3*w);
 	const ColorReal k = 1/255.0;
-	for(int y = 0; y < frame.get_h(); ++y)
-		for(int x = 0; x < frame.get_w(); ++x)
-		{
-			if(pipe->eof())
-				return false;
-			ColorReal r = k*(unsigned char)pipe->getc();
-			ColorReal g = k*(unsigned char)pipe->getc();
-			ColorReal b = k*(unsigned char)pipe->getc();
-			frame[y][x] = Color(r, g, b);
-		}
-	cur_frame++;
+	for(int y = 0; y < h; ++y)
+	{
+		if (pipe->read(&row.front(), 1, row.size()) != row.size())
+			return false;
+		const unsigned char *p = &row.front();
+		for(Color *c = surface[y], *end = c + w; c < end; ++c, p += 3)
+			*c = Color(k*p[0], k*p[1], k*p[2]);
+	}
 	return true;
 }
 
 ffmpeg_mptr::ffmpeg_mptr(const synfig::FileSystem::Identifier& identifier)
 	: synfig::Importer(identifier),
-	  pipe(nullptr), cur_frame(-1), fps(23.98)
+	  pipe(nullptr), fps(DEFAULT_FPS),
+	  next_frame(0), last_frame(-1),
+	  stop_decoder(false), stream_ended(false)
 {
 #ifdef HAVE_TERMIOS_H
 	tcgetattr (0, &oldtty);
@@ -177,21 +227,56 @@ ffmpeg_mptr::ffmpeg_mptr(const synfig::FileSystem::Identifier& identifier)
 
 ffmpeg_mptr::~ffmpeg_mptr()
 {
-	pipe = nullptr;
+	stop_stream();
 #ifdef HAVE_TERMIOS_H
 	tcsetattr(0,TCSANOW,&oldtty);
 #endif
 }
 
 bool
-ffmpeg_mptr::get_frame(synfig::Surface &surface, const synfig::RendDesc &/*renddesc*/, Time time, synfig::ProgressCallback *)
+ffmpeg_mptr::get_frame(synfig::Surface &surface, const synfig::RendDesc &renddesc, Time time, synfig::ProgressCallback *)
 {
-	synfig::warning("time: %f", (float)time);
-	if(!seek_to(time))
-		return false;
-	if(!grab_frame())
-		return false;
+	std::lock_guard<std::mutex> lock(get_frame_mutex);
 
-	surface=frame;
-	return true;
+	const float rate = renddesc.get_frame_rate() > 0 ? renddesc.get_frame_rate() : DEFAULT_FPS;
+	if (rate != fps) {
+		stop_stream();
+		fps = rate;
+		last_frame = -1;
+		last_surface = nullptr;
+	}
+
+	const int frame = std::max(0, round_to_int((double)time*fps));
+	if (frame == last_frame && last_surface) {
+		surface = *last_surface;
+		return true;
+	}
+
+	// sequential playback reads on, anything else restarts ffmpeg at the new position
+	const bool forward = frame >= next_frame && frame - next_frame <= round_to_int(MAX_FORWARD_SKIP*fps);
+	if (!decoder.joinable() || !forward)
+		if (!start_stream(frame))
+			return false;
+
+	while(true)
+	{
+		DecodedFrame decoded;
+		{
+			std::unique_lock<std::mutex> queue_lock(queue_mutex);
+			queue_cond.wait(queue_lock, [this] { return !queue.empty() || stream_ended; });
+			if (queue.empty())
+				return false; // past the end of the video
+			decoded = queue.front();
+			queue.pop_front();
+		}
+		queue_cond.notify_all();
+
+		next_frame = decoded.index + 1;
+		if (decoded.index == frame) {
+			last_frame = frame;
+			last_surface = decoded.surface;
+			surface = *decoded.surface;
+			return true;
+		}
+	}
 }
@@ -30,6 +30,12 @@
 
 /* === H E A D E R S ======================================================= */
 
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 #include <synfig/importer.h>
 #include <synfig/os.h>
 #include <synfig/surface.h>
@@ -44,20 +50,51 @@
 
 /* === C L A S S E S & S T R U C T S ======================================= */
 
+/*!	\class ffmpeg_mptr
+**	\brief Imports video frames through a pipe from an ffmpeg process
+**
+**	One ffmpeg process decodes the video starting at the requested time,
+**	resampled to the frame rate of the canvas, and a read-ahead thread
+**	parses the next frames while the current one is rendered.
+**	The process is restarted only when seeking backwards or far forward.
+*/
 class ffmpeg_mptr : public synfig::Importer
 {
 	SYNFIG_IMPORTER_MODULE_EXT
 private:
+	struct DecodedFrame
+	{
+		int index;
+		std::shared_ptr<synfig::Surface> surface;
+	};
+
 	synfig::OS::RunPipe::Handle pipe;
-	int cur_frame;
-	synfig::Surface frame;
 	float fps;
 #ifdef HAVE_TERMIOS_H
 	struct termios oldtty;
 #endif
 
-	bool seek_to(const synfig::Time& time);
-	bool grab_frame(void);
+	//! Serializes get_frame() calls
+	std::mutex get_frame_mutex;
+
+	//! Index of the next frame get_frame() takes from the queue
+	int next_frame;
+	//! Last returned frame, for repeated requests of the same time
+	int last_frame;
+	std::shared_ptr<synfig::Surface> last_surface;
+
+	std::thread decoder;
+	std::mutex queue_mutex;
+	std::condition_variable queue_cond;
+	//! Decoded frames which are not taken yet, filled by the decoder thread
+	std::deque<DecodedFrame> queue;
+	bool stop_decoder;
+	bool stream_ended;
+
+	bool start_stream(int frame);
+	void stop_stream();
+	void decoder_loop(int frame);
+	bool grab_frame(synfig::Surface &surface);
 
 public:
 	ffmpeg_mptr(const synfig::FileSystem::Identifier &identifier);
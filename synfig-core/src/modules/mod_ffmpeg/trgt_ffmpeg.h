@@ -60,6 +60,10 @@ private:
 
 	bool does_video_codec_support_alpha_channel(const synfig::String& video_codec) const;
 
+protected:
+	//! Frames are converted and written into the pipe while the next ones render
+	bool supports_async_write() const override { return true; }
+
 public:
 
 	ffmpeg_trgt(const synfig::filesystem::Path& filename,
@@ -40,15 +40,21 @@
 #include "halftone.h"
 
 /* === M A C R O S ========================================================= */
+#define HALFTONE2_PARAM_ID(x)                                                 \
+	([]() -> const synfig::ParamID& {                                         \
+		static const synfig::ParamID id(                                      \
+			synfig::ParamID::from_member_name(#x, "halftone.param_"));        \
+		return id; }())
+
 #define HALFTONE2_IMPORT_VALUE(x)                                             \
-	if (#x=="halftone.param_"+param && x.get_type()==value.get_type())        \
+	if (HALFTONE2_PARAM_ID(x).is_name(param) && x.get_type()==value.get_type()) \
 		{                                                                     \
 			x=value;                                                          \
 			return true;                                                      \
 		}                                                                     \
 
 #define HALFTONE2_EXPORT_VALUE(x)                                             \
-	if (#x=="halftone.param_"+param)                                          \
+	if (HALFTONE2_PARAM_ID(x).is_name(param))                                 \
 		{                                                                     \
 			return x;                                                         \
 		}                                                                     \
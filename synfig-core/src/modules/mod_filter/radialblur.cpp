@@ -45,6 +45,8 @@
 #include <synfig/surface.h>
 #include <synfig/value.h>
 #include <synfig/transform.h>
+#include <synfig/rendering/common/task/taskdistort.h>
+#include <synfig/rendering/software/task/tasksw.h>
 
 #endif
 
@@ -60,6 +62,142 @@ SYNFIG_LAYER_SET_VERSION(RadialBlur,"0.1");
 
 /* === P R O C E D U R E S ================================================= */
 
+class TaskRadialBlur
+	: public rendering::TaskDistort,
+	  public rendering::TaskInterfaceSplit
+{
+public:
+	typedef etl::handle<TaskRadialBlur> Handle;
+	static Token token;
+	Token::Handle get_token() const override { return token.handle(); }
+
+	Vector origin;
+	Real size;
+	bool fade_out;
+
+	TaskRadialBlur(): size(0.2), fade_out(false) { }
+
+	//! How far towards the origin of the blur the pixel at \a point wanders
+	Point get_end(const Point &point) const
+		{ return (point-origin)*(1.0f-size) + origin; }
+
+	Rect
+	compute_required_source_rect(const Rect& source_rect, const Matrix& /*inv_matrix*/) const override
+	{
+		// the scaled copy of the rect contains ends of all the rays
+		Rect rect(source_rect);
+		rect.expand(get_end(source_rect.get_min()));
+		rect.expand(get_end(source_rect.get_max()));
+		return rect;
+	}
+};
+
+class TaskRadialBlurSW
+	: public TaskRadialBlur, public rendering::TaskSW
+{
+public:
+	typedef etl::handle<TaskRadialBlurSW> Handle;
+	static Token token;
+	Token::Handle get_token() const override { return token.handle(); }
+
+	bool run(Task::RunParams& /*params*/) const override
+	{
+		if (!sub_task() || !is_valid())
+			return true;
+
+		LockWrite la(this);
+		if (!la)
+			return false;
+		LockRead lb(sub_task());
+		if (!lb)
+			return false;
+
+		const Surface &src = lb->get_surface();
+		const Vector upp = get_units_per_pixel();
+		const Vector ppub = sub_task()->get_pixels_per_unit();
+		const Point src_tl = required_source_rect.get_min();
+		const int tw = target_rect.get_width();
+
+		Surface::pen pen(la->get_surface().get_pen(target_rect.minx, target_rect.miny));
+		Surface::value_prep_type cooker;
+
+		Point pos(source_rect.minx, source_rect.miny);
+		for(int y = target_rect.miny; y < target_rect.maxy; ++y, pos[1] += upp[1], pen.inc_y(), pen.dec_x(tw))
+		{
+			pos[0] = source_rect.minx;
+			for(int x = target_rect.minx; x < target_rect.maxx; ++x, pos[0] += upp[0], pen.inc_x())
+			{
+				const Point end_pos = get_end(pos);
+				int x0(round_to_int((pos[0] - src_tl[0])*ppub[0])),
+					y0(round_to_int((pos[1] - src_tl[1])*ppub[1])),
+					x1(round_to_int((end_pos[0] - src_tl[0])*ppub[0])),
+					y1(round_to_int((end_pos[1] - src_tl[1])*ppub[1]));
+
+				// walk along the ray with Bresenham's algorithm
+				Color pool(Color::alpha());
+				int poolsize(0);
+
+				int steep = 1;
+				int w(src.get_w()), h(src.get_h());
+				int dx = std::abs(x1 - x0);
+				int sx = ((x1 - x0) > 0) ? 1 : -1;
+				int dy = std::abs(y1 - y0);
+				int sy = ((y1 - y0) > 0) ? 1 : -1;
+				if (dy > dx)
+				{
+					steep = 0;
+					std::swap(x0, y0);
+					std::swap(dx, dy);
+					std::swap(sx, sy);
+					std::swap(w, h);
+				}
+				const int bx(steep ? x0 : y0), by(steep ? y0 : x0);
+
+				int e = (dy << 1) - dx;
+				for (int i = 0; i < dx; i++)
+				{
+					if (y0 >= 0 && x0 >= 0 && y0 < h && x0 < w)
+					{
+						const Color &c = steep ? src[y0][x0] : src[x0][y0];
+						const int weight = fade_out ? i - dx : 1;
+						pool += cooker.cook(c)*weight;
+						poolsize += weight;
+					}
+					while (e >= 0)
+					{
+						y0 += sy;
+						e -= (dx << 1);
+					}
+					x0 += sx;
+					e += (dy << 1);
+				}
+
+				if (poolsize)
+				{
+					pool /= poolsize;
+					pen.put_value(cooker.uncook(pool));
+				}
+				else
+				if (bx >= 0 && by >= 0 && bx < src.get_w() && by < src.get_h())
+				{
+					pen.put_value(src[by][bx]);
+				}
+				else
+				{
+					pen.put_value(Color::alpha());
+				}
+			}
+		}
+
+		return true;
+	}
+};
+
+rendering::Task::Token TaskRadialBlur::token(
+	DescAbstract<TaskRadialBlur>("RadialBlur") );
+rendering::Task::Token TaskRadialBlurSW::token(
+	DescReal<TaskRadialBlurSW, TaskRadialBlur>("RadialBlurSW") );
+
 /* === M E T H O D S ======================================================= */
 
 /* === E N T R Y P O I N T ================================================= */
@@ -133,211 +271,16 @@ RadialBlur::get_color(Context context, const Point &p)const
 	return context.get_color(p);
 }
 
-bool
-RadialBlur::accelerated_render(Context context,Surface *surface,int quality, const RendDesc &renddesc, ProgressCallback *cb)const
+rendering::Task::Handle
+RadialBlur::build_composite_fork_task_vfunc(ContextParams /* context_params */, rendering::Task::Handle sub_task) const
 {
-	RENDER_TRANSFORMED_IF_NEED(__FILE__, __LINE__)
-
-	Vector origin=param_origin.get(Vector());
-	Real size=param_size.get(Real());
-	bool fade_out=param_fade_out.get(bool());
-	
-	// don't do anything at quality 10
-	if (quality == 10)
-		return context.accelerated_render(surface,quality,renddesc,cb);
-
-	if(cb && !cb->amount_complete(0,10000))
-		return false;
-
-	Surface tmp_surface;
-	const Point tl(renddesc.get_tl()), br(renddesc.get_br());
-	const int w(renddesc.get_w()), h(renddesc.get_h());
-	const Real pw(renddesc.get_pw()),ph(renddesc.get_ph());
-
-	Rect rect(tl, br);
-	Point pos;
-
-	// find how far towards the origin of the blur we are going to
-	// wander for each of the 4 corners of our tile, expanding the
-	// render description for each of them if necessary
-	int x, y;
-	for(y=0,pos[1]=tl[1];y<h;y+=(h-1),pos[1]+=ph*(h-1))
-		for(x=0,pos[0]=tl[0];x<w;x+=(w-1),pos[0]+=pw*(w-1))
-			rect.expand((pos-origin)*(1.0f-size) + origin);
-
-	Vector stl = rect.get_min();
-	Vector sbr = rect.get_max();
-	if (br[0] < tl[0]) std::swap(stl[0], sbr[0]);
-	if (br[1] < tl[1]) std::swap(stl[1], sbr[1]);
-
-	// round out to the nearest pixel
-	Point tmp_surface_tl = Point(tl[0] - pw*(int((tl[0]-stl[0])/pw+1-1e-6)),
-								 tl[1] - ph*(int((tl[1]-stl[1])/ph+1-1e-6)));
-	Point tmp_surface_br = Point(br[0] + pw*(int((sbr[0]-br[0])/pw+2-1e-6)),
-								 br[1] + ph*(int((sbr[1]-br[1])/ph+2-1e-6)));
-
-	// round to nearest integer width and height (should be very
-	// nearly whole numbers already, but don't want to round 5.99999
-	// down to 5)
-	int tmp_surface_width = int((tmp_surface_br[0]-tmp_surface_tl[0])/pw + 0.5);
-	int tmp_surface_height = int((tmp_surface_br[1]-tmp_surface_tl[1])/ph + 0.5);
-
-	RendDesc desc(renddesc);
-	desc.clear_flags();
-	desc.set_wh(tmp_surface_width,tmp_surface_height);
-	desc.set_tl(tmp_surface_tl);
-	desc.set_br(tmp_surface_br);
-
-	// render the layers beneath us
-	if(!context.accelerated_render(&tmp_surface,quality,desc,cb))
-		return false;
-
-	// copy the part of the layers beneath us that corresponds to this tile
-	surface->set_wh(w, h);
-	Surface::pen pen(surface->get_pen(0, 0));
-	tmp_surface.blit_to(pen,
-						int((tl[0] - tmp_surface_tl[0])/pw + 0.5),
-						int((tl[1] - tmp_surface_tl[1])/ph + 0.5),
-						w, h);
-
-	Surface::alpha_pen apen(surface->begin());
-
-	apen.set_alpha(get_amount());
-	apen.set_blend_method(get_blend_method());
-
-/*
-	int steps(5);
-
-	if(quality>=9)steps=20;
-	else if(quality>=5)steps=30;
-	else if(quality>=4)steps=60;
-	else if(quality>=3)steps=100;
-	else steps=120;
-*/
-
-	Surface::value_prep_type cooker;
-
-	// loop through the pixels
-	for(y=0,pos[1]=tl[1];y<h;y++,apen.inc_y(),apen.dec_x(x),pos[1]+=ph)
-		for(x=0,pos[0]=tl[0];x<w;x++,apen.inc_x(),pos[0]+=pw)
-		{
-			Point
-				begin(pos-tmp_surface_tl),
-				end((pos-origin)*(1.0f-size) + origin-tmp_surface_tl);
-			begin[0]/=pw;begin[1]/=ph;
-			end[0]/=pw;end[1]/=ph;
-
-			Color pool(Color::alpha());
-			int poolsize(0);
-
-			int x0(round_to_int(begin[0])),
-				y0(round_to_int(begin[1])),
-				x1(round_to_int(end[0])),
-				y1(round_to_int(end[1]));
-
-			int i;
-			int steep = 1;
-			int sx, sy;  /* step positive or negative (1 or -1) */
-			int dx, dy;  /* delta (difference in X and Y between points) */
-			int e;
-			int w(tmp_surface_width), h(tmp_surface_height);
-
-			dx = std::abs(x1 - x0);
-			sx = ((x1 - x0) > 0) ? 1 : -1;
-			dy = std::abs(y1 - y0);
-			sy = ((y1 - y0) > 0) ? 1 : -1;
-			if (dy > dx)
-			{
-				steep = 0;
-				std::swap(x0, y0);
-				std::swap(dx, dy);
-				std::swap(sx, sy);
-				std::swap(w,h);
-			}
-			e = (dy << 1) - dx;
-			for (i = 0; i < dx; i++)
-			{
-				if(y0>=0 && x0>=0 && y0<h && x0<w)
-				{
-					if(fade_out)
-					{
-						if (steep)
-							pool+=cooker.cook(tmp_surface[y0][x0])*(i-dx);
-						else
-							pool+=cooker.cook(tmp_surface[x0][y0])*(i-dx);
-						poolsize+=(i-dx);
-					}
-					else
-					{
-						if (steep)
-							pool+=cooker.cook(tmp_surface[y0][x0]);
-						else
-							pool+=cooker.cook(tmp_surface[x0][y0]);
-						poolsize+=1;
-					}
-				} else
-					printf("%s:%d unexpected %d >= %d or %d >= %d?\n", __FILE__, __LINE__, x0, w, y0, h);
-
-				while (e >= 0)
-				{
-					y0 += sy;
-					e -= (dx << 1);
-				}
-				x0 += sx;
-				e += (dy << 1);
-			}
-			if(poolsize)
-			{
-				pool/=poolsize;
-				apen.put_value(cooker.uncook(pool));
-			}
-/*
-			Point begin,end;
-			begin=pos;
-			end=(pos-origin)*(1.0f-size)+origin;
-
-			Color pool(Color::alpha());
-			float f,poolsize(0);
-			int i;
-			int steps(steps*size);
-			for(f=0,i=0;i<steps;i++,f+=1.0f/(steps-1))
-			{
-				Point loc((end-begin)*f+begin-tl);
-				loc[0]/=pw;loc[1]/=ph;
-
-				if(fade_out)
-					pool+=tmp_surface.linear_sample(loc[0],loc[1])*(i-steps),poolsize+=(i-steps);
-				else
-					pool+=tmp_surface.linear_sample(loc[0],loc[1]),poolsize+=1;
-			}
-			pool/=poolsize;
-			apen.put_value(pool);
-*/
-		}
-
-
-	if(cb && !cb->amount_complete(10000,10000)) return false;
-
-// #define DRAW_TILE_OUTLINES
-#ifdef DRAW_TILE_OUTLINES
-	// draw red lines to show tiles
-	{
-		int x, y;
-		if (w != 0 && h != 0) {
-			Surface::alpha_pen apen(surface->begin());
-			apen.set_alpha(get_amount());
-			apen.set_blend_method(get_blend_method());
-			apen.set_value(Color(1, 0, 0, .1));
-			for (x = 0; x < w; x++) { apen.put_value(); apen.inc_x(); } apen.dec_x(w);
-			for (y = 0; y < h; y++) { apen.put_value(); apen.inc_y(); } apen.dec_y(h);
-		}
-	}
-#endif // DRAW_TILE_OUTLINES
-
-	return true;
+	if (!sub_task)
+		return sub_task;
+
+	TaskRadialBlur::Handle task_radial_blur(new TaskRadialBlur());
+	task_radial_blur->origin = param_origin.get(Vector());
+	task_radial_blur->size = param_size.get(Real());
+	task_radial_blur->fade_out = param_fade_out.get(bool());
+	task_radial_blur->sub_task() = sub_task->clone_recursive();
+	return task_radial_blur;
 }
-
-
-rendering::Task::Handle
-RadialBlur::build_rendering_task_vfunc(Context context) const
-	{ return Layer::build_rendering_task_vfunc(context); }
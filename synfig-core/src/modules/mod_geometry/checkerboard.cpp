@@ -136,6 +136,18 @@ public:
 		return (this->*selected_get_color_method)(p);
 	}
 
+	void get_color_span(Color* colors, int count, const Vector& p, const Vector& dp) const override
+	{
+		// choose the method once per span, so the calls below can be inlined
+		if (antialias) {
+			for (int i = 0; i < count; ++i)
+				colors[i] = get_color_antialias(p + dp*i);
+		} else {
+			for (int i = 0; i < count; ++i)
+				colors[i] = get_color_simple(p + dp*i);
+		}
+	}
+
 	void pre_run(const Matrix3& world_to_raster, const Matrix3& /*raster_to_world*/) const override
 	{
 		kx = world_to_raster.axis_x().mag()*0.5;
@@ -101,6 +101,14 @@ public:
 		return params.gradient.average(dist - supersample, dist + supersample);
 		//return params.gradient.color(dist);
 	}
+
+	void get_color_span(Color* colors, int count, const Vector& p, const Vector& dp) const override
+	{
+		// dist is linear along the span
+		const Real dist((p - params.p1)*params.diff);
+		const Real step(dp*params.diff);
+		params.gradient.average(colors, count, supersample, [&](int i) -> Real { return dist + step*i; });
+	}
 };
 
 SYNFIG_EXPORT rendering::Task::Token TaskLinearGradient::token(
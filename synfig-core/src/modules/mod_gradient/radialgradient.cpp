@@ -108,6 +108,12 @@ public:
 		return compiled_gradient.average(dist - supersample, dist + supersample);
 		//return params.gradient.color(dist);
 	}
+
+	void get_color_span(Color* colors, int count, const Vector& p, const Vector& dp) const override
+	{
+		const Vector offset(p - center);
+		compiled_gradient.average(colors, count, supersample, [&](int i) -> Real { return (offset + dp*i).mag()/radius; });
+	}
 };
 
 SYNFIG_EXPORT rendering::Task::Token TaskRadialGradient::token(
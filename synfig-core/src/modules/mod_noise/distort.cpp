@@ -44,6 +44,8 @@
 #include <synfig/paramdesc.h>
 #include <synfig/renddesc.h>
 #include <synfig/value.h>
+#include <synfig/rendering/common/task/taskdistort.h>
+#include <synfig/rendering/software/task/taskdistortsw.h>
 #include <ctime>
 
 #endif
@@ -62,64 +64,35 @@ SYNFIG_LAYER_SET_VERSION(NoiseDistort,"0.0");
 
 /* === P R O C E D U R E S ================================================= */
 
-/* === M E T H O D S ======================================================= */
-
-NoiseDistort::NoiseDistort():
-	Layer_CompositeFork(1.0,Color::BLEND_STRAIGHT),
-	param_displacement(ValueBase(Vector(0.25,0.25))),
-	param_size(ValueBase(Vector(1,1))),
-	param_random(ValueBase(int(time(nullptr)))),
-	param_smooth(ValueBase(int(RandomNoise::SMOOTH_COSINE))),
-	param_detail(ValueBase(int(4))),
-	param_speed(ValueBase(Real(0))),
-	param_turbulent(bool(false))
-{
-	SET_INTERPOLATION_DEFAULTS();
-	SET_STATIC_DEFAULTS();
-}
-
-inline Point
-NoiseDistort::point_func(const Point &point)const
+Point
+NoiseDistort::Distortion::distort(const Point &point) const
 {
-	Vector displacement=param_displacement.get(Vector());
-	Vector size=param_size.get(Vector());
-	RandomNoise random;
-	random.set_seed(param_random.get(int()));
-	int smooth_=param_smooth.get(int());
-	int detail=param_detail.get(int());
-	Real speed=param_speed.get(Real());
-	bool turbulent=param_turbulent.get(bool());
-	
 	float x(point[0]/size[0]*(1<<detail));
 	float y(point[1]/size[1]*(1<<detail));
-	
+
 	int i;
-	Time time = speed*get_time_mark();
-	int temp_smooth(smooth_);
-	int smooth((!speed && temp_smooth == (int)(RandomNoise::SMOOTH_SPLINE)) ? (int)(RandomNoise::SMOOTH_FAST_SPLINE) : temp_smooth);
-	
 	Vector vect(0,0);
 	for(i=0;i<detail;i++)
 	{
-		vect[0]=random(RandomNoise::SmoothType(smooth),0+(detail-i)*5,x,y,time)+vect[0]*0.5;
-		vect[1]=random(RandomNoise::SmoothType(smooth),1+(detail-i)*5,x,y,time)+vect[1]*0.5;
-		
+		vect[0]=random(smooth,0+(detail-i)*5,x,y,time)+vect[0]*0.5;
+		vect[1]=random(smooth,1+(detail-i)*5,x,y,time)+vect[1]*0.5;
+
 		if (vect[0] < -1) vect[0] = -1;
 		if (vect[0] >  1) vect[0] =  1;
-		
+
 		if (vect[1] < -1) vect[1] = -1;
 		if (vect[1] >  1) vect[1] =  1;
-		
+
 		if(turbulent)
 		{
 			vect[0]=std::fabs(vect[0]);
 			vect[1]=std::fabs(vect[1]);
 		}
-		
+
 		x/=2.0f;
 		y/=2.0f;
 	}
-	
+
 	if(!turbulent)
 	{
 		vect[0]=vect[0]/2.0f+0.5f;
@@ -127,10 +100,94 @@ NoiseDistort::point_func(const Point &point)const
 	}
 	vect[0]=(vect[0]-0.5f)*displacement[0];
 	vect[1]=(vect[1]-0.5f)*displacement[1];
-	
+
 	return point+vect;
 }
 
+class TaskNoiseDistort
+	: public rendering::TaskDistort,
+	  public rendering::TaskInterfaceSplit
+{
+public:
+	typedef etl::handle<TaskNoiseDistort> Handle;
+	static Token token;
+	Token::Handle get_token() const override { return token.handle(); }
+
+	NoiseDistort::Distortion distortion;
+
+	Rect
+	compute_required_source_rect(const Rect& source_rect, const Matrix& /*inv_matrix*/) const override
+	{
+		// the offset never exceeds a half of displacement along each axis
+		Rect rect(source_rect);
+		rect.expand_x(0.5*std::fabs(distortion.displacement[0]));
+		rect.expand_y(0.5*std::fabs(distortion.displacement[1]));
+		return rect;
+	}
+};
+
+class TaskNoiseDistortSW
+	: public TaskNoiseDistort, public rendering::TaskDistortSW
+{
+public:
+	typedef etl::handle<TaskNoiseDistortSW> Handle;
+	static Token token;
+	Token::Handle get_token() const override { return token.handle(); }
+
+	Point
+	point_vfunc(const Point &point) const override
+		{ return distortion.distort(point); }
+
+	bool run(Task::RunParams& /*params*/) const override
+		{ return run_task(*this); }
+};
+
+rendering::Task::Token TaskNoiseDistort::token(
+	DescAbstract<TaskNoiseDistort>("NoiseDistort") );
+rendering::Task::Token TaskNoiseDistortSW::token(
+	DescReal<TaskNoiseDistortSW, TaskNoiseDistort>("NoiseDistortSW") );
+
+/* === M E T H O D S ======================================================= */
+
+NoiseDistort::NoiseDistort():
+	Layer_CompositeFork(1.0,Color::BLEND_STRAIGHT),
+	param_displacement(ValueBase(Vector(0.25,0.25))),
+	param_size(ValueBase(Vector(1,1))),
+	param_random(ValueBase(int(time(nullptr)))),
+	param_smooth(ValueBase(int(RandomNoise::SMOOTH_COSINE))),
+	param_detail(ValueBase(int(4))),
+	param_speed(ValueBase(Real(0))),
+	param_turbulent(bool(false))
+{
+	SET_INTERPOLATION_DEFAULTS();
+	SET_STATIC_DEFAULTS();
+}
+
+NoiseDistort::Distortion
+NoiseDistort::get_distortion() const
+{
+	Distortion distortion;
+	distortion.displacement=param_displacement.get(Vector());
+	distortion.size=param_size.get(Vector());
+	distortion.random.set_seed(param_random.get(int()));
+	distortion.detail=param_detail.get(int());
+	distortion.turbulent=param_turbulent.get(bool());
+
+	Real speed=param_speed.get(Real());
+	int smooth=param_smooth.get(int());
+	if (!speed && smooth == (int)(RandomNoise::SMOOTH_SPLINE))
+		smooth = (int)(RandomNoise::SMOOTH_FAST_SPLINE);
+	distortion.smooth=RandomNoise::SmoothType(smooth);
+	distortion.time=Time(speed*get_time_mark());
+	return distortion;
+}
+
+inline Point
+NoiseDistort::point_func(const Point &point)const
+{
+	return get_distortion().distort(point);
+}
+
 inline Color
 NoiseDistort::color_func(const Point &point, Context context)const
 {
@@ -336,5 +393,13 @@ NoiseDistort::accelerated_render(Context context,Surface *surface,int quality, c
 */
 
 rendering::Task::Handle
-NoiseDistort::build_rendering_task_vfunc(Context context) const
-	{ return Layer::build_rendering_task_vfunc(context); }
+NoiseDistort::build_composite_fork_task_vfunc(ContextParams /* context_params */, rendering::Task::Handle sub_task) const
+{
+	if (!sub_task)
+		return sub_task;
+
+	TaskNoiseDistort::Handle task_distort(new TaskNoiseDistort());
+	task_distort->distortion = get_distortion();
+	task_distort->sub_task() = sub_task->clone_recursive();
+	return task_distort;
+}
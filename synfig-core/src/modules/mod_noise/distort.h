@@ -69,6 +69,24 @@ private:
 	synfig::Point point_func(const synfig::Point &point)const;
 
 public:
+	//! Parameters of the distortion at the current time, shared with the rendering task
+	struct Distortion
+	{
+		synfig::Vector displacement;
+		synfig::Vector size;
+		RandomNoise random;
+		RandomNoise::SmoothType smooth;
+		int detail;
+		float time;
+		bool turbulent;
+
+		Distortion(): smooth(RandomNoise::SMOOTH_COSINE), detail(4), time(0.f), turbulent(false) { }
+
+		synfig::Point distort(const synfig::Point &point) const;
+	};
+
+	Distortion get_distortion() const;
+
 	NoiseDistort();
 
 	virtual bool set_param(const synfig::String &param, const synfig::ValueBase &value);
@@ -83,7 +101,7 @@ public:
 
 protected:
 	virtual synfig::RendDesc get_sub_renddesc_vfunc(const synfig::RendDesc &renddesc) const;
-	virtual synfig::rendering::Task::Handle build_rendering_task_vfunc(synfig::Context context) const;
+	virtual synfig::rendering::Task::Handle build_composite_fork_task_vfunc(synfig::ContextParams context_params, synfig::rendering::Task::Handle sub_task) const;
 }; // EOF of class NoiseDistort
 
 /* === E N D =============================================================== */
@@ -103,6 +103,36 @@ public:
 	}
 
 	Color get_color(const Vector& point) const override
+	{
+		const float ftime(speed * time_mark);
+		return calc_color(point, get_smooth_type(), ftime);
+	}
+
+	void get_color_span(Color* colors, int count, const Vector& p, const Vector& dp) const override
+	{
+		// these do not depend on the position
+		const RandomNoise::SmoothType smooth_type = get_smooth_type();
+		const float ftime(speed * time_mark);
+		for (int i = 0; i < count; ++i)
+			colors[i] = calc_color(p + dp*i, smooth_type, ftime);
+	}
+
+	bool run(RunParams&) const override {
+		return run_task();
+	}
+
+protected:
+	mutable float pixel_size = 0.0f;
+
+private:
+	RandomNoise::SmoothType get_smooth_type() const
+	{
+		return (!speed && smooth == RandomNoise::SMOOTH_SPLINE)
+		     ? RandomNoise::SMOOTH_FAST_SPLINE
+		     : smooth;
+	}
+
+	Color calc_color(const Vector& point, RandomNoise::SmoothType smooth_type, float ftime) const
 	{
 		float x(point[0] / size[0] * (1 << detail));
 		float y(point[1] / size[1] * (1 << detail));
@@ -113,12 +143,6 @@ public:
 			y2 = (point[1] + pixel_size) / size[1] * (1 << detail);
 		}
 
-		const RandomNoise::SmoothType smooth_type((!speed && smooth == RandomNoise::SMOOTH_SPLINE)
-													? RandomNoise::SMOOTH_FAST_SPLINE
-													: smooth);
-
-		const float ftime(speed * time_mark);
-
 		float amount = 0.0f;
 		float amount2 = 0.0f;
 		float amount3 = 0.0f;
@@ -186,13 +210,6 @@ public:
 
 		return color;
 	}
-
-	bool run(RunParams&) const override {
-		return run_task();
-	}
-
-protected:
-	mutable float pixel_size = 0.0f;
 };
 
 SYNFIG_EXPORT rendering::Task::Token TaskNoise::token(
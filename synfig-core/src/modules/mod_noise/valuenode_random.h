@@ -77,6 +77,9 @@ protected:
 
 	virtual Vocab get_children_vocab_vfunc() const override;
 
+	//! The noise is animated over time
+	virtual bool get_constant_interval_vfunc(Time, Time&, Time&) const override { return false; }
+
 private:
 	void randomize_seed();
 }; // END of class ValueNode_Random
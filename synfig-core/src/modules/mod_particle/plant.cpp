@@ -42,6 +42,7 @@
 #include <synfig/general.h>
 
 #include <synfig/context.h>
+#include <synfig/rendering/software/task/tasksw.h>
 
 #include "random.h"
 
@@ -59,6 +60,66 @@ SYNFIG_LAYER_SET_VERSION(Plant,"0.3");
 
 /* === P R O C E D U R E S ================================================= */
 
+/* === C L A S S E S ======================================================= */
+
+class TaskPlant
+	: public rendering::Task,
+	  public rendering::TaskInterfaceSplit
+{
+public:
+	typedef etl::handle<TaskPlant> Handle;
+	static Token token;
+	Token::Handle get_token() const override { return token.handle(); }
+
+	//! shared with the layer, sync() replaces the list instead of changing it
+	std::shared_ptr<const Plant::ParticleList> particles;
+	Rect bounds;
+	Point origin;
+	Real size;
+	bool reverse;
+	bool size_as_alpha;
+
+	TaskPlant(): bounds(Rect::zero()), size(0.015), reverse(true), size_as_alpha(false) { }
+
+	Rect calc_bounds() const override
+		{ return particles && !particles->empty() ? bounds : Rect::zero(); }
+};
+
+class TaskPlantSW
+	: public TaskPlant, public rendering::TaskSW
+{
+public:
+	typedef etl::handle<TaskPlantSW> Handle;
+	static Token token;
+	Token::Handle get_token() const override { return token.handle(); }
+
+	bool run(Task::RunParams& /*params*/) const override
+	{
+		if (!is_valid() || !particles)
+			return true;
+
+		LockWrite la(this);
+		if (!la)
+			return false;
+
+		Surface dest_surface;
+		dest_surface.set_wh(target_rect.get_width(), target_rect.get_height());
+		dest_surface.clear();
+
+		// Here is where drawing occurs
+		Plant::draw_particles(&dest_surface, *particles, source_rect, origin, size, reverse, size_as_alpha);
+
+		Surface::pen pen(la->get_surface().get_pen(target_rect.minx, target_rect.miny));
+		dest_surface.blit_to(pen);
+		return true;
+	}
+};
+
+rendering::Task::Token TaskPlant::token(
+	DescAbstract<TaskPlant>("Plant") );
+rendering::Task::Token TaskPlantSW::token(
+	DescReal<TaskPlantSW, TaskPlant>("PlantSW") );
+
 /* === M E T H O D S ======================================================= */
 
 
@@ -83,6 +144,7 @@ Plant::Plant():
 	bline_loop(true),
 	bounding_rect(Rect::zero()),
 	mass(0.5),
+	particle_list(new ParticleList()),
 	needs_sync_(true),
 	version(get_register_version())
 {
@@ -137,9 +199,9 @@ Plant::branch(int n,int depth,float t, float stunt_growth, synfig::Point positio
 		position[0]+=vel[0]*step;
 		position[1]+=vel[1]*step;
 
-		particle_list.push_back(Particle(position, gradient(t)));
-		if (particle_list.size() % 1000000 == 0)
-			synfig::info("constructed %d million particles...", particle_list.size()/1000000);
+		particle_list->push_back(Particle(position, gradient(t)));
+		if (particle_list->size() % 1000000 == 0)
+			synfig::info("constructed %d million particles...", particle_list->size()/1000000);
 
 		bounding_rect.expand(position);
 	}
@@ -217,7 +279,7 @@ Plant::sync()const
 	std::lock_guard<std::mutex> lock(mutex);
 	if (!needs_sync_) return;
 	time_t start_time; time(&start_time);
-	particle_list.clear();
+	particle_list.reset(new ParticleList());
 
 	bounding_rect=Rect::zero();
 
@@ -261,9 +323,9 @@ Plant::sync()const
 		{
 			Point point(curve(f));
 
-			particle_list.push_back(Particle(point, gradient(0)));
-			if (particle_list.size() % 1000000 == 0)
-				synfig::info("constructed %d million particles...", particle_list.size()/1000000);
+			particle_list->push_back(Particle(point, gradient(0)));
+			if (particle_list->size() % 1000000 == 0)
+				synfig::info("constructed %d million particles...", particle_list->size()/1000000);
 
 			bounding_rect.expand(point);
 
@@ -298,7 +360,7 @@ Plant::sync()const
 	time_t end_time; time(&end_time);
 	if (end_time-start_time > 4)
 		synfig::info("Plant::sync() constructed %d particles in %d seconds\n",
-					 particle_list.size(), int(end_time-start_time));
+					 particle_list->size(), int(end_time-start_time));
 	needs_sync_=false;
 }
 
@@ -510,62 +572,54 @@ Plant::reset_version()
 	version = get_register_version();
 }
 
-bool
-Plant::accelerated_render(Context context,Surface *surface,int quality, const RendDesc &renddesc, ProgressCallback *cb)const
+rendering::Task::Handle
+Plant::build_composite_task_vfunc(ContextParams /* context_params */) const
 {
-	RENDER_TRANSFORMED_IF_NEED(__FILE__, __LINE__)
-
-	bool ret(context.accelerated_render(surface,quality,renddesc,cb));
-	if(is_disabled() || !ret)
-		return ret;
-
 	if(needs_sync_==true)
 		sync();
 
-	Surface dest_surface;
-	dest_surface.set_wh(surface->get_w(),surface->get_h());
-	dest_surface.clear();
-
-	// Here is where drawing occurs 
-	draw_particles(&dest_surface, renddesc);
-
-	Surface::alpha_pen pen(surface->get_pen(0,0),get_amount(),get_blend_method());
-	dest_surface.blit_to(pen);
-
-	return true;
+	TaskPlant::Handle task(new TaskPlant());
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		task->particles = particle_list;
+		task->bounds = bounding_rect;
+	}
+	task->origin = param_origin.get(Vector());
+	task->size = param_size.get(Real());
+	task->reverse = param_reverse.get(bool());
+	task->size_as_alpha = param_size_as_alpha.get(bool());
+	task->bounds += task->origin;
+	task->bounds.expand(std::fabs(task->size));
+	return task;
 }
 
-
-
-
 void
-Plant::draw_particles(Surface *dest_surface, const RendDesc &renddesc)const
+Plant::draw_particles(
+	Surface *dest_surface,
+	const ParticleList &particle_list,
+	const Rect &rect,
+	const Point &origin,
+	Real size,
+	bool reverse,
+	bool size_as_alpha )
 {
-	Point origin=param_origin.get(Vector());
-	Real size=param_size.get(Real());
-	bool reverse=param_reverse.get(bool());
-	bool size_as_alpha=param_size_as_alpha.get(bool());
-	
-	const Point	tl(renddesc.get_tl()-origin);
-	const Point br(renddesc.get_br()-origin);
-	
-	const int	w(renddesc.get_w());
-	const int	h(renddesc.get_h());
+	const Point	tl(rect.get_min()-origin);
+	const Point br(rect.get_max()-origin);
 	
 	const int	surface_width(dest_surface->get_w());
 	const int	surface_height(dest_surface->get_h());
 	
 	// Width and Height of a pixel
-	const Real pw = (br[0] - tl[0]) / w;
-	const Real ph = (br[1] - tl[1]) / h;
+	const Real pw = (br[0] - tl[0]) / surface_width;
+	const Real ph = (br[1] - tl[1]) / surface_height;
 	
 	if (std::isinf(pw) || std::isinf(ph))
 		return;
 	
 	if (particle_list.begin() != particle_list.end())
 	{
-		std::vector<Particle>::iterator iter;
-		Particle *particle;
+		ParticleList::const_iterator iter;
+		const Particle *particle;
 		
 		float radius(size*sqrt(1.0f/(std::fabs(pw)*std::fabs(ph))));
 		
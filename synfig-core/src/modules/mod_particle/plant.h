@@ -32,6 +32,7 @@
 /* === H E A D E R S ======================================================= */
 
 #include <list>
+#include <memory>
 #include <vector>
 #include <synfig/layers/layer_composite.h>
 #include <synfig/blinepoint.h>
@@ -91,6 +92,7 @@ private:
 
 	bool bline_loop;
 
+public:
 	struct Particle
 	{
 		Point point;
@@ -100,7 +102,10 @@ private:
 			point(point),color(color) { }
 	};
 
-	mutable std::vector<Particle> particle_list;
+	typedef std::vector<Particle> ParticleList;
+
+private:
+	mutable std::shared_ptr<ParticleList> particle_list;
 	mutable Rect	bounding_rect;
 	Real mass;
 
@@ -110,7 +115,6 @@ private:
 	void branch(int n, int depth,float t, float stunt_growth, Point position,Vector velocity)const;
 	void sync()const;
 	String version;
-	void draw_particles(Surface *surface, const RendDesc &renddesc)const;
 
 public:
 
@@ -127,9 +131,21 @@ public:
 
 	virtual Vocab get_param_vocab()const;
 
-	virtual bool accelerated_render(Context context,Surface *surface,int quality, const RendDesc &renddesc, ProgressCallback *cb)const;
 	using Layer::get_bounding_rect;
 	virtual Rect get_bounding_rect(Context context)const;
+
+	//! Draws particles visible in \a rect over the whole \a dest_surface
+	static void draw_particles(
+		Surface *dest_surface,
+		const ParticleList &particle_list,
+		const Rect &rect,
+		const Point &origin,
+		Real size,
+		bool reverse,
+		bool size_as_alpha );
+
+protected:
+	virtual rendering::Task::Handle build_composite_task_vfunc(ContextParams context_params)const;
 };
 
 /* === E N D =============================================================== */
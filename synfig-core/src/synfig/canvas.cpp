@@ -488,7 +488,20 @@ Canvas::set_time(Time t)const
 		const_cast<Canvas&>(*this).cur_time_=t;
 
 		is_dirty_=false;
+
+		// report how many dynamic parameters were evaluated for the frame
+		const bool log_statistics = is_root() && DEBUG_GETENV("SYNFIG_DEBUG_SET_TIME");
+		Layer::SetTimeStatistics before;
+		if (log_statistics)
+			before = Layer::get_set_time_statistics();
+
 		get_independent_context().set_time(t);
+
+		if (log_statistics) {
+			Layer::SetTimeStatistics after = Layer::get_set_time_statistics();
+			synfig::info("Canvas::set_time(%s): %lld parameters evaluated, %lld skipped",
+				t.get_string().c_str(), after.evaluated - before.evaluated, after.skipped - before.skipped);
+		}
 	}
 	is_dirty_=false;
 }
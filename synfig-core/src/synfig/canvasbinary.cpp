@@ -0,0 +1,334 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file canvasbinary.cpp
+**	\brief CanvasBinary Implementation
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <cassert>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include <libxml++/libxml++.h>
+
+#include "canvasbinary.h"
+
+#include "general.h"
+
+#endif
+
+using namespace synfig;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+const char CanvasBinary::magic[8] = { 'S', 'I', 'F', 'B', '\r', '\n', 0x1a, '\n' };
+
+/* === P R O C E D U R E S ================================================= */
+
+namespace {
+
+inline uint32_t
+read_uint32(const char *p)
+{
+	const unsigned char *b = reinterpret_cast<const unsigned char*>(p);
+	return (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+}
+
+inline void
+append_uint32(std::vector<char> &buffer, uint32_t x)
+{
+	buffer.push_back((char)(x & 0xff));
+	buffer.push_back((char)((x >> 8) & 0xff));
+	buffer.push_back((char)((x >> 16) & 0xff));
+	buffer.push_back((char)((x >> 24) & 0xff));
+}
+
+//! Collects the strings, nodes and attributes of the document
+class Encoder
+{
+public:
+	std::unordered_map<String, uint32_t> string_indices;
+	std::vector<const String*> strings;
+	std::vector<CanvasBinary::Node> nodes;
+	std::vector<CanvasBinary::Attribute> attributes;
+
+	uint32_t add_string(const String &s)
+	{
+		std::pair<std::unordered_map<String, uint32_t>::iterator, bool> i =
+			string_indices.insert(std::make_pair(s, (uint32_t)strings.size()));
+		if (i.second)
+			strings.push_back(&i.first->first);
+		return i.first->second;
+	}
+
+	void add_element(xmlpp::Element *element)
+	{
+		const size_t index = nodes.size();
+		nodes.push_back(CanvasBinary::Node());
+		nodes[index].kind = CanvasBinary::NODE_ELEMENT;
+		nodes[index].name = add_string(element->get_name());
+		nodes[index].first_attribute = (uint32_t)attributes.size();
+
+		const xmlpp::Element::AttributeList list = element->get_attributes();
+		for(xmlpp::Element::AttributeList::const_iterator i = list.begin(); i != list.end(); ++i) {
+			CanvasBinary::Attribute attribute;
+			attribute.name = add_string((*i)->get_name());
+			attribute.value = add_string((*i)->get_value());
+			attributes.push_back(attribute);
+		}
+		nodes[index].attribute_count = (uint32_t)attributes.size() - nodes[index].first_attribute;
+
+		const xmlpp::Node::NodeList children = element->get_children();
+		for(xmlpp::Node::NodeList::const_iterator i = children.begin(); i != children.end(); ++i) {
+			if (xmlpp::Element *child = dynamic_cast<xmlpp::Element*>(*i)) {
+				add_element(child);
+			} else
+			if (xmlpp::TextNode *text = dynamic_cast<xmlpp::TextNode*>(*i)) {
+				CanvasBinary::Node node = CanvasBinary::Node();
+				node.kind = CanvasBinary::NODE_TEXT;
+				node.name = add_string(text->get_content());
+				node.end = (uint32_t)nodes.size() + 1;
+				nodes.push_back(node);
+			}
+			// comments and other nodes are not written by save_canvas
+		}
+		nodes[index].end = (uint32_t)nodes.size();
+	}
+};
+
+}
+
+/* === M E T H O D S ======================================================= */
+
+bool
+CanvasBinary::check_magic(const char *data, size_t size)
+	{ return size >= sizeof(magic) && !memcmp(data, magic, sizeof(magic)); }
+
+bool
+CanvasBinary::write(xmlpp::Element *root, std::ostream &stream)
+{
+	Encoder encoder;
+	encoder.add_element(root);
+
+	uint32_t string_data_size = 0;
+	for(std::vector<const String*>::const_iterator i = encoder.strings.begin(); i != encoder.strings.end(); ++i)
+		string_data_size += (uint32_t)(*i)->size() + 1;
+
+	const uint32_t strings_offset = (uint32_t)header_size;
+	const uint32_t nodes_offset = strings_offset + 4*((uint32_t)encoder.strings.size() + 1);
+	const uint32_t attributes_offset = nodes_offset + (uint32_t)(node_size*encoder.nodes.size());
+	const uint32_t string_data_offset = attributes_offset + (uint32_t)(attribute_size*encoder.attributes.size());
+
+	std::vector<char> buffer;
+	buffer.reserve(string_data_offset + string_data_size);
+	buffer.insert(buffer.end(), magic, magic + sizeof(magic));
+	append_uint32(buffer, version);
+	append_uint32(buffer, (uint32_t)encoder.strings.size());
+	append_uint32(buffer, (uint32_t)encoder.nodes.size());
+	append_uint32(buffer, (uint32_t)encoder.attributes.size());
+	append_uint32(buffer, strings_offset);
+	append_uint32(buffer, nodes_offset);
+	append_uint32(buffer, attributes_offset);
+	append_uint32(buffer, string_data_offset);
+	assert(buffer.size() == header_size);
+
+	uint32_t offset = 0;
+	for(std::vector<const String*>::const_iterator i = encoder.strings.begin(); i != encoder.strings.end(); ++i) {
+		append_uint32(buffer, offset);
+		offset += (uint32_t)(*i)->size() + 1;
+	}
+	append_uint32(buffer, offset);
+
+	for(std::vector<Node>::const_iterator i = encoder.nodes.begin(); i != encoder.nodes.end(); ++i) {
+		append_uint32(buffer, i->kind);
+		append_uint32(buffer, i->name);
+		append_uint32(buffer, i->end);
+		append_uint32(buffer, i->first_attribute);
+		append_uint32(buffer, i->attribute_count);
+	}
+
+	for(std::vector<Attribute>::const_iterator i = encoder.attributes.begin(); i != encoder.attributes.end(); ++i) {
+		append_uint32(buffer, i->name);
+		append_uint32(buffer, i->value);
+	}
+
+	for(std::vector<const String*>::const_iterator i = encoder.strings.begin(); i != encoder.strings.end(); ++i)
+		buffer.insert(buffer.end(), (*i)->c_str(), (*i)->c_str() + (*i)->size() + 1);
+
+	stream.write(&buffer.front(), buffer.size());
+	return (bool)stream;
+}
+
+
+CanvasBinary::Reader::Reader():
+	data(), size(), header() { }
+
+bool
+CanvasBinary::Reader::fail(const String &message)
+{
+	error = message;
+	data = nullptr;
+	size = 0;
+	return false;
+}
+
+bool
+CanvasBinary::Reader::open(const char *data, size_t size)
+{
+	this->data = data;
+	this->size = size;
+	error.clear();
+
+	if (size < header_size || !check_magic(data, size))
+		return fail("not a binary canvas file");
+	memcpy(header.magic, data, sizeof(header.magic));
+	header.version            = read_uint32(data + 8);
+	header.string_count       = read_uint32(data + 12);
+	header.node_count         = read_uint32(data + 16);
+	header.attribute_count    = read_uint32(data + 20);
+	header.strings_offset     = read_uint32(data + 24);
+	header.nodes_offset       = read_uint32(data + 28);
+	header.attributes_offset  = read_uint32(data + 32);
+	header.string_data_offset = read_uint32(data + 36);
+
+	if (header.version != version)
+		return fail(strprintf("unsupported version %u", header.version));
+
+	// tables must be aligned and fit into the file
+	const uint64_t tables[][3] = {
+		{ header.strings_offset, (uint64_t)header.string_count + 1, 4 },
+		{ header.nodes_offset, header.node_count, node_size },
+		{ header.attributes_offset, header.attribute_count, attribute_size } };
+	for(size_t i = 0; i < sizeof(tables)/sizeof(tables[0]); ++i)
+		if (tables[i][0] % 4 || tables[i][0] < header_size || tables[i][0] + tables[i][1]*tables[i][2] > size)
+			return fail("table is out of file");
+	if (header.string_data_offset > size)
+		return fail("string data is out of file");
+
+	const size_t string_data_size = size - header.string_data_offset;
+	const char *string_data = data + header.string_data_offset;
+	uint32_t begin = read_uint32(data + header.strings_offset);
+	for(uint32_t i = 0; i < header.string_count; ++i) {
+		const uint32_t end = read_uint32(data + header.strings_offset + 4*(i + 1));
+		if (end <= begin || end > string_data_size || string_data[end - 1])
+			return fail(strprintf("invalid string %u", i));
+		begin = end;
+	}
+
+	if (!header.node_count)
+		return fail("no root element");
+	// ends of the open elements, every subtree must be inside its parent
+	std::vector<uint32_t> ends(1, header.node_count);
+	for(uint32_t i = 0; i < header.node_count; ++i) {
+		const Node node = get_node(i);
+		while(ends.back() <= i)
+			ends.pop_back();
+		// build() recurses into every element
+		if (ends.size() > max_depth)
+			return fail(strprintf("node %u is nested too deep", i));
+		if ( node.name >= header.string_count
+		  || node.end <= i
+		  || node.end > ends.back()
+		  || (uint64_t)node.first_attribute + node.attribute_count > header.attribute_count )
+			return fail(strprintf("invalid node %u", i));
+		if (node.kind == NODE_TEXT) {
+			if (node.end != i + 1 || node.attribute_count || !i)
+				return fail(strprintf("invalid text node %u", i));
+		} else
+		if (node.kind != NODE_ELEMENT) {
+			return fail(strprintf("unknown kind of node %u", i));
+		}
+		ends.push_back(node.end);
+	}
+	if (get_node(0).end != header.node_count)
+		return fail("data after the root element");
+
+	for(uint32_t i = 0; i < header.attribute_count; ++i) {
+		const Attribute attribute = get_attribute(i);
+		if (attribute.name >= header.string_count || attribute.value >= header.string_count)
+			return fail(strprintf("invalid attribute %u", i));
+	}
+
+	return true;
+}
+
+CanvasBinary::Node
+CanvasBinary::Reader::get_node(size_t index) const
+{
+	const char *p = data + header.nodes_offset + node_size*index;
+	Node node;
+	node.kind            = read_uint32(p);
+	node.name            = read_uint32(p + 4);
+	node.end             = read_uint32(p + 8);
+	node.first_attribute = read_uint32(p + 12);
+	node.attribute_count = read_uint32(p + 16);
+	return node;
+}
+
+CanvasBinary::Attribute
+CanvasBinary::Reader::get_attribute(size_t index) const
+{
+	const char *p = data + header.attributes_offset + attribute_size*index;
+	Attribute attribute;
+	attribute.name  = read_uint32(p);
+	attribute.value = read_uint32(p + 4);
+	return attribute;
+}
+
+const char*
+CanvasBinary::Reader::get_string(size_t index) const
+	{ return data + header.string_data_offset + read_uint32(data + header.strings_offset + 4*index); }
+
+void
+CanvasBinary::Reader::copy_attributes(size_t index, xmlpp::Element *element) const
+{
+	const Node node = get_node(index);
+	for(uint32_t i = node.first_attribute; i < node.first_attribute + node.attribute_count; ++i) {
+		const Attribute attribute = get_attribute(i);
+		element->set_attribute(get_string(attribute.name), get_string(attribute.value));
+	}
+}
+
+xmlpp::Node*
+CanvasBinary::Reader::build(size_t index, xmlpp::Element *parent) const
+{
+	const Node node = get_node(index);
+	if (node.kind == NODE_TEXT)
+		return parent->add_child_text(get_string(node.name));
+
+	xmlpp::Element *element = parent->add_child(get_string(node.name));
+	copy_attributes(index, element);
+	for(size_t i = index + 1; i < node.end; i = get_node(i).end)
+		build(i, element);
+	return element;
+}
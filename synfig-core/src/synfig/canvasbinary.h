@@ -0,0 +1,165 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file canvasbinary.h
+**	\brief CanvasBinary Header
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_CANVASBINARY_H
+#define __SYNFIG_CANVASBINARY_H
+
+/* === H E A D E R S ======================================================= */
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+#include "string.h"
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace xmlpp { class Node; class Element; };
+
+namespace synfig {
+
+/*!	\class CanvasBinary
+**	\brief Binary form of the canvas document (.sifb)
+**
+**	The file is the element tree of .sif serialized without the XML syntax.
+**	It is rebuilt into xmlpp elements and loaded by the same CanvasParser
+**	code, so it converts to XML and back without losses. Values are kept
+**	as strings, there are no typed arrays of waypoints or vertices, and
+**	the parse_* functions still convert every attribute from text, so it
+**	is not meant to make loading faster than .sif.
+**	It has a table of unique strings and flat arrays of nodes and
+**	attributes. Nodes go in document order and refer to their name,
+**	attributes and the end of their subtree by index.
+**
+**	All numbers are 32-bit little-endian at 4-byte aligned offsets from the
+**	start of the file, so the reader works on the data in place. The loader
+**	reads the file into memory through FileSystem, it is not mapped:
+**
+**	  Header
+**	  uint32 string offsets [string_count + 1], relative to string data
+**	  Node [node_count], node 0 is the root <canvas>
+**	  Attribute [attribute_count]
+**	  string data, NUL-terminated UTF-8
+*/
+class CanvasBinary
+{
+public:
+	static const char magic[8];
+	static const uint32_t version = 1;
+
+	enum NodeKind
+	{
+		NODE_ELEMENT = 0,
+		NODE_TEXT = 1
+	};
+
+	struct Header
+	{
+		char magic[8];
+		uint32_t version;
+		uint32_t string_count;
+		uint32_t node_count;
+		uint32_t attribute_count;
+		uint32_t strings_offset;
+		uint32_t nodes_offset;
+		uint32_t attributes_offset;
+		uint32_t string_data_offset;
+	};
+
+	struct Node
+	{
+		uint32_t kind;
+		//! name of element or content of text
+		uint32_t name;
+		//! index of the node following the subtree
+		uint32_t end;
+		uint32_t first_attribute;
+		uint32_t attribute_count;
+	};
+
+	struct Attribute
+	{
+		uint32_t name;
+		uint32_t value;
+	};
+
+	static const size_t header_size = 40;
+	static const size_t node_size = 20;
+	static const size_t attribute_size = 8;
+
+	//! Deepest nesting of elements accepted by Reader, the same as libxml2 allows by default
+	static const size_t max_depth = 256;
+
+	//! Returns true if \a data starts like a binary canvas file
+	static bool check_magic(const char *data, size_t size);
+
+	//! Writes the element tree of \a root, returns false on stream error
+	static bool write(xmlpp::Element *root, std::ostream &stream);
+
+	//! Access to the binary canvas in memory
+	class Reader
+	{
+	private:
+		const char *data;
+		size_t size;
+		Header header;
+		String error;
+
+		bool fail(const String &message);
+
+	public:
+		Reader();
+
+		//! Checks the header, all offsets and indices and the depth of the tree,
+		//! so the accessors and build() don't have to.
+		//! \a data is not copied and must live while the reader is used
+		bool open(const char *data, size_t size);
+		const String& get_error() const
+			{ return error; }
+
+		const Header& get_header() const
+			{ return header; }
+		Node get_node(size_t index) const;
+		Attribute get_attribute(size_t index) const;
+		const char* get_string(size_t index) const;
+
+		//! Sets the attributes of element \a index to \a element
+		void copy_attributes(size_t index, xmlpp::Element *element) const;
+		//! Appends the subtree of node \a index to \a parent, returns the new node
+		xmlpp::Node* build(size_t index, xmlpp::Element *parent) const;
+	};
+}; // END of class CanvasBinary
+
+}; // END of namespace synfig
+
+/* === E N D =============================================================== */
+
+#endif
@@ -233,7 +233,7 @@ CanvasFileNaming::make_filesystem_container(const String &filename, FileContaine
 		FileSystemGroup::Handle group(new FileSystemGroup());
 		group->register_system("images", FileSystemNative::instance(), prefix + "images");
 		group->register_system("animations", FileSystemNative::instance(), prefix + "animations");
-		group->register_system(ext == "sif" ? "project.sif" : container_canvas_filename, FileSystemNative::instance(), filename);
+		group->register_system(ext == "sif" || ext == "sifb" ? "project." + ext : container_canvas_filename, FileSystemNative::instance(), filename);
 		return group;
 	}
 
@@ -264,13 +264,16 @@ CanvasFileNaming::project_file(const FileSystem::Handle &canvas_filesystem)
 		return container_canvas_full_filename();
 	if (canvas_filesystem->is_file(container_prefix + "project.sif"))
 		return container_prefix + "project.sif";
+	if (canvas_filesystem->is_file(container_prefix + "project.sifb"))
+		return container_prefix + "project.sifb";
 	return String();
 }
 
 String
 CanvasFileNaming::project_file(const String &filename) {
-	return filename_extension_lower(filename) == "sif"
-		 ? container_prefix + "project.sif"
+	const String ext = filename_extension_lower(filename);
+	return ext == "sif" || ext == "sifb"
+		 ? container_prefix + "project." + ext
 		 : container_canvas_full_filename();
 }
 
@@ -0,0 +1,224 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file colorblendrow.cpp
+**	\brief Row-wise color blending
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <cassert>
+#include <cmath>
+
+#include "colorblendrow.h"
+#include "colorblendrowkernels.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#endif
+
+#endif
+
+/* === U S I N G =========================================================== */
+
+using namespace synfig;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+static_assert(sizeof(Color) == 4*sizeof(float), "row blending expects Color to be four packed floats");
+
+const Color synfig::color_blend_row_transparent = Color::alpha();
+
+/* === P R O C E D U R E S ================================================= */
+
+namespace {
+
+template<blendfunc Func>
+void
+blend_row_scalar(Color *dest, const Color *src, int count, ColorReal amount)
+{
+	// same as Color::blend()
+	if (std::fabs(amount) <= COLOR_EPSILON) return;
+	for(Color *end = dest + count; dest < end; ++dest, ++src) {
+		Color a = *src;
+		*dest = Func(a, *dest, amount);
+	}
+}
+
+bool
+cpu_has_avx2()
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) return false;
+	__cpuid(info, 1);
+	const int osxsave_and_avx = (1 << 27) | (1 << 28);
+	if ((info[2] & osxsave_and_avx) != osxsave_and_avx) return false;
+	// OS saves xmm and ymm registers on context switch
+	if ((_xgetbv(0) & 6) != 6) return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	return false;
+#endif
+}
+
+} // END of anonymous namespace
+
+/* === M E T H O D S ======================================================= */
+
+bool
+ColorBlendRow::is_supported(Instructions instructions)
+{
+	switch(instructions) {
+	case INSTRUCTIONS_SCALAR:
+		return true;
+	case INSTRUCTIONS_SSE2:
+#ifdef SYNFIG_COLOR_BLEND_ROW_SSE2
+		return true;
+#else
+		return false;
+#endif
+	case INSTRUCTIONS_AVX2: {
+		static const bool supported = cpu_has_avx2()
+		                           && color_blend_row_avx2_func(Color::BLEND_COMPOSITE);
+		return supported;
+	}
+	default:
+		break;
+	}
+	return false;
+}
+
+ColorBlendRow::Instructions
+ColorBlendRow::get_best_instructions()
+{
+	static const Instructions best =
+		is_supported(INSTRUCTIONS_AVX2) ? INSTRUCTIONS_AVX2
+	  : is_supported(INSTRUCTIONS_SSE2) ? INSTRUCTIONS_SSE2
+	  : INSTRUCTIONS_SCALAR;
+	return best;
+}
+
+const char*
+ColorBlendRow::get_instructions_name(Instructions instructions)
+{
+	switch(instructions) {
+	case INSTRUCTIONS_SCALAR: return "scalar";
+	case INSTRUCTIONS_SSE2:   return "SSE2";
+	case INSTRUCTIONS_AVX2:   return "AVX2";
+	default: break;
+	}
+	return "unknown";
+}
+
+bool
+ColorBlendRow::is_vectorized(Color::BlendMethod method)
+{
+	switch(method) {
+	case Color::BLEND_COMPOSITE:
+	case Color::BLEND_STRAIGHT:
+	case Color::BLEND_ONTO:
+	case Color::BLEND_BEHIND:
+	case Color::BLEND_ADD:
+	case Color::BLEND_MULTIPLY:
+	case Color::BLEND_SCREEN:
+	case Color::BLEND_ALPHA:
+		return true;
+	default:
+		break;
+	}
+	return false;
+}
+
+ColorBlendRow::Func
+ColorBlendRow::get_func(Color::BlendMethod method, Instructions instructions)
+{
+	assert(method < Color::BLEND_END);
+	if (!is_supported(instructions))
+		return nullptr;
+
+	switch(instructions) {
+	case INSTRUCTIONS_SCALAR: {
+		// same order as in Color::blend()
+		const static Func vtable[Color::BLEND_END] =
+		{
+			blend_row_scalar<blendfunc_COMPOSITE<Color> >,
+			blend_row_scalar<blendfunc_STRAIGHT<Color> >,
+			blend_row_scalar<blendfunc_BRIGHTEN<Color> >,
+			blend_row_scalar<blendfunc_DARKEN<Color> >,
+			blend_row_scalar<blendfunc_ADD<Color> >,
+			blend_row_scalar<blendfunc_SUBTRACT<Color> >,
+			blend_row_scalar<blendfunc_MULTIPLY<Color> >,
+			blend_row_scalar<blendfunc_DIVIDE<Color> >,
+			blend_row_scalar<blendfunc_COLOR<Color> >,
+			blend_row_scalar<blendfunc_HUE<Color> >,
+			blend_row_scalar<blendfunc_SATURATION<Color> >,
+			blend_row_scalar<blendfunc_LUMINANCE<Color> >,
+			blend_row_scalar<blendfunc_BEHIND<Color> >,
+			blend_row_scalar<blendfunc_ONTO<Color> >,
+			blend_row_scalar<blendfunc_ALPHA_BRIGHTEN<Color> >,
+			blend_row_scalar<blendfunc_ALPHA_DARKEN<Color> >,
+			blend_row_scalar<blendfunc_SCREEN<Color> >,
+			blend_row_scalar<blendfunc_HARD_LIGHT<Color> >,
+			blend_row_scalar<blendfunc_DIFFERENCE<Color> >,
+			blend_row_scalar<blendfunc_ALPHA_OVER<Color> >,
+			blend_row_scalar<blendfunc_OVERLAY<Color> >,
+			blend_row_scalar<blendfunc_STRAIGHT_ONTO<Color> >,
+			blend_row_scalar<blendfunc_ADD_COMPOSITE<Color> >,
+			blend_row_scalar<blendfunc_ALPHA<Color> >,
+			blend_row_scalar<blendfunc_ALPHA_INTERSECTION<Color> >,
+		};
+		return vtable[method];
+	}
+#ifdef SYNFIG_COLOR_BLEND_ROW_SSE2
+	case INSTRUCTIONS_SSE2:
+		return get_vectorized_func<Vec4>(method);
+#endif
+	case INSTRUCTIONS_AVX2:
+		return color_blend_row_avx2_func(method);
+	default:
+		break;
+	}
+	return nullptr;
+}
+
+ColorBlendRow::Func
+ColorBlendRow::get_func(Color::BlendMethod method)
+{
+	if (is_vectorized(method))
+		if (Func func = get_func(method, get_best_instructions()))
+			return func;
+	return get_func(method, INSTRUCTIONS_SCALAR);
+}
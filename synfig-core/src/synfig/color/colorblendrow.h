@@ -0,0 +1,91 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/color/colorblendrow.h
+**	\brief Row-wise color blending
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_COLOR_COLORBLENDROW_H
+#define __SYNFIG_COLOR_COLORBLENDROW_H
+
+/* === H E A D E R S ======================================================= */
+
+#include "color.h"
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig {
+
+/*!	\class ColorBlendRow
+**	\brief Blends a whole row of colors with a single call
+**
+**	A row function does the same as
+**	\code dest[i] = Color::blend(src[i], dest[i], amount, method) \endcode
+**	for every \a i in [0, count), and the result is bit-exact with it.
+**	The blend method is resolved once per row instead of once per pixel,
+**	and COMPOSITE, STRAIGHT, ONTO, BEHIND, ADD, MULTIPLY, SCREEN and ALPHA
+**	are processed with SSE2 or AVX2 when the build and the CPU support it.
+**	Other methods use a plain loop over the scalar blend functions.
+*/
+class ColorBlendRow
+{
+public:
+	typedef void (*Func)(Color *dest, const Color *src, int count, ColorReal amount);
+
+	enum Instructions
+	{
+		INSTRUCTIONS_SCALAR,
+		INSTRUCTIONS_SSE2,
+		INSTRUCTIONS_AVX2,
+		INSTRUCTIONS_COUNT
+	};
+
+	//! Returns true when \a instructions are compiled in and the running CPU has them
+	static bool is_supported(Instructions instructions);
+	//! Returns the widest instruction set for which is_supported() is true
+	static Instructions get_best_instructions();
+	//! Returns the name of \a instructions, used for logging
+	static const char* get_instructions_name(Instructions instructions);
+
+	//! Returns true if \a method has a vectorized implementation
+	static bool is_vectorized(Color::BlendMethod method);
+
+	//! Returns the row function for \a method using exactly \a instructions,
+	//! or null if they are not supported or \a method is not vectorized for them
+	static Func get_func(Color::BlendMethod method, Instructions instructions);
+	//! Returns the fastest available row function for \a method, never null
+	static Func get_func(Color::BlendMethod method);
+
+	static void blend(Color *dest, const Color *src, int count, ColorReal amount, Color::BlendMethod method)
+		{ get_func(method)(dest, src, count, amount); }
+}; // END of class ColorBlendRow
+
+}; // END of namespace synfig
+
+/* === E N D =============================================================== */
+
+#endif
@@ -0,0 +1,91 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file colorblendrow_avx2.cpp
+**	\brief AVX2 row blending kernels
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+// This file is built with AVX2 enabled (see color/CMakeLists.txt),
+// so it must not share inline code with the rest of the library.
+// Its functions are called only after ColorBlendRow has checked the CPU.
+
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include "colorblendrowkernels.h"
+
+#if defined(__AVX2__) && defined(SYNFIG_COLOR_BLEND_ROW_SSE2)
+#include <immintrin.h>
+#endif
+
+/* === U S I N G =========================================================== */
+
+using namespace synfig;
+
+/* === M A C R O S ========================================================= */
+
+/* === P R O C E D U R E S ================================================= */
+
+#if defined(__AVX2__) && defined(SYNFIG_COLOR_BLEND_ROW_SSE2)
+
+namespace {
+
+//! Two colors per register, lanes are r, g, b, a, r, g, b, a
+struct Vec8
+{
+	typedef __m256 type;
+	enum { pixels = 2 };
+
+	static type load(const Color *c) { return _mm256_loadu_ps(reinterpret_cast<const float*>(c)); }
+	static void store(Color *c, type v) { _mm256_storeu_ps(reinterpret_cast<float*>(c), v); }
+	static type set1(float x) { return _mm256_set1_ps(x); }
+	static type load_color(const Color &c)
+		{ return _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&c)); }
+
+	static type add(type a, type b) { return _mm256_add_ps(a, b); }
+	static type sub(type a, type b) { return _mm256_sub_ps(a, b); }
+	static type mul(type a, type b) { return _mm256_mul_ps(a, b); }
+	static type div(type a, type b) { return _mm256_div_ps(a, b); }
+	static type abs(type a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a); }
+	static type gt(type a, type b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+	static type eq(type a, type b) { return _mm256_cmp_ps(a, b, _CMP_EQ_OQ); }
+
+	static type select(type mask, type a, type b) { return _mm256_blendv_ps(b, a, mask); }
+	static type splat_a(type v) { return _mm256_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)); }
+	static type set_a(type v, type a) { return _mm256_blend_ps(v, a, 0x88); }
+};
+
+} // END of anonymous namespace
+
+ColorBlendRow::Func
+synfig::color_blend_row_avx2_func(Color::BlendMethod method)
+	{ return get_vectorized_func<Vec8>(method); }
+
+#else
+
+ColorBlendRow::Func
+synfig::color_blend_row_avx2_func(Color::BlendMethod)
+	{ return nullptr; }
+
+#endif
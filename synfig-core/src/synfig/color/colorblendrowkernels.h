@@ -0,0 +1,319 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/color/colorblendrowkernels.h
+**	\brief Vectorized row blending kernels, internal to ColorBlendRow
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_COLOR_COLORBLENDROWKERNELS_H
+#define __SYNFIG_COLOR_COLORBLENDROWKERNELS_H
+
+/* === H E A D E R S ======================================================= */
+
+#include "colorblendrow.h"
+#include "colorblendingfunctions.h"
+
+/* === M A C R O S ========================================================= */
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SYNFIG_COLOR_BLEND_ROW_SSE2
+#include <emmintrin.h>
+#endif
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig {
+
+//! Defined in colorblendrow_avx2.cpp, which is the only file built with AVX2 enabled.
+//! Returns null if the file was built without AVX2 or \a method is not vectorized.
+ColorBlendRow::Func color_blend_row_avx2_func(Color::BlendMethod method);
+
+//! Color::alpha(), defined in colorblendrow.cpp.
+//! Kernels must not call inline members of Color: if such a call is not inlined
+//! in the AVX2 file, the linker may pick that AVX2 copy for the whole library.
+extern const Color color_blend_row_transparent;
+
+#ifdef SYNFIG_COLOR_BLEND_ROW_SSE2
+
+// Everything below is included into translation units built with different
+// instruction sets, so it must stay local to each of them.
+namespace {
+
+/*
+ Each kernel repeats the operations of its scalar counterpart from
+ colorblendingfunctions.h in the same order, with every Color channel in its
+ own lane, so the results are bit-exact. Lanes that the scalar code leaves
+ alone are computed anyway and then replaced.
+ Division is done as multiplication by reciprocal, like Color::operator/=.
+ No FMA is used: fused rounding would differ from the scalar code.
+
+ V is a vector of V::pixels colors, see Vec4 here and Vec8 in
+ colorblendrow_avx2.cpp.
+*/
+
+struct Vec4
+{
+	typedef __m128 type;
+	enum { pixels = 1 };
+
+	static type load(const Color *c) { return _mm_loadu_ps(reinterpret_cast<const float*>(c)); }
+	static void store(Color *c, type v) { _mm_storeu_ps(reinterpret_cast<float*>(c), v); }
+	//! Puts \a c into every pixel
+	static type load_color(const Color &c) { return load(&c); }
+	static type set1(float x) { return _mm_set1_ps(x); }
+
+	static type add(type a, type b) { return _mm_add_ps(a, b); }
+	static type sub(type a, type b) { return _mm_sub_ps(a, b); }
+	static type mul(type a, type b) { return _mm_mul_ps(a, b); }
+	static type div(type a, type b) { return _mm_div_ps(a, b); }
+	static type abs(type a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a); }
+	static type gt(type a, type b) { return _mm_cmpgt_ps(a, b); }
+	static type eq(type a, type b) { return _mm_cmpeq_ps(a, b); }
+
+	//! mask ? a : b
+	static type select(type mask, type a, type b)
+		{ return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+	//! Broadcasts alpha of each pixel to all of its channels
+	static type splat_a(type v)
+		{ return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)); }
+	//! Takes color channels from \a v and alpha from \a a
+	static type set_a(type v, type a)
+		{ return select(_mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1)), a, v); }
+};
+
+static inline bool
+is_negligible(ColorReal amount)
+	{ return amount <= COLOR_EPSILON && amount >= -COLOR_EPSILON; }
+
+static inline ColorReal
+absolute(ColorReal amount)
+	{ return amount < 0 ? -amount : amount; }
+
+template<typename V>
+static inline typename V::type
+invert(typename V::type a)
+{
+	// Color::operator~
+	return V::set_a(V::sub(V::set1(1.f), a), a);
+}
+
+template<typename V>
+static inline typename V::type
+composite(typename V::type src, typename V::type dest, typename V::type amount)
+{
+	// blendfunc_COMPOSITE
+	typedef typename V::type T;
+	const T one = V::set1(1.f);
+	const T a_src = V::mul(V::splat_a(src), amount);
+	const T a_dest = V::splat_a(dest);
+	const T one_minus_a_src = V::sub(one, a_src);
+
+	T c = V::add(V::mul(src, a_src), V::mul(V::mul(dest, a_dest), one_minus_a_src));
+	const T a = V::add(a_src, V::mul(a_dest, one_minus_a_src));
+	c = V::set_a(V::mul(c, V::div(one, a)), a);
+
+	const T visible = V::gt(V::abs(a), V::set1(COLOR_EPSILON));
+	return V::select(visible, c, V::load_color(color_blend_row_transparent));
+}
+
+template<typename V>
+static inline typename V::type
+straight(typename V::type src, typename V::type bg, typename V::type amount)
+{
+	// blendfunc_STRAIGHT
+	typedef typename V::type T;
+	const T a_src = V::splat_a(src);
+	const T a_bg = V::splat_a(bg);
+	const T a_out = V::add(V::mul(V::sub(a_src, a_bg), amount), a_bg);
+
+	T c = V::mul(V::sub(V::mul(src, a_src), V::mul(bg, a_bg)), amount);
+	c = V::add(c, V::mul(bg, a_bg));
+	c = V::set_a(V::mul(c, V::div(V::set1(1.f), a_out)), a_out);
+
+	const T visible = V::gt(V::abs(a_out), V::set1(COLOR_EPSILON));
+	return V::select(visible, c, V::load_color(color_blend_row_transparent));
+}
+
+template<typename V>
+static inline typename V::type
+onto(typename V::type a, typename V::type b, typename V::type amount)
+{
+	// blendfunc_ONTO
+	return V::set_a(composite<V>(a, V::set_a(b, V::set1(1.f)), amount), b);
+}
+
+template<typename V>
+struct BlendComposite
+{
+	typedef typename V::type T;
+	T amount;
+	explicit BlendComposite(ColorReal amount): amount(V::set1(amount)) { }
+	T operator()(T a, T b) const { return composite<V>(a, b, amount); }
+};
+
+template<typename V>
+struct BlendStraight
+{
+	typedef typename V::type T;
+	T amount;
+	explicit BlendStraight(ColorReal amount): amount(V::set1(amount)) { }
+	T operator()(T a, T b) const { return straight<V>(a, b, amount); }
+};
+
+template<typename V>
+struct BlendOnto
+{
+	typedef typename V::type T;
+	T amount;
+	explicit BlendOnto(ColorReal amount): amount(V::set1(amount)) { }
+	T operator()(T a, T b) const { return onto<V>(a, b, amount); }
+};
+
+template<typename V>
+struct BlendBehind
+{
+	typedef typename V::type T;
+	T amount, zero_alpha;
+	explicit BlendBehind(ColorReal amount):
+		amount(V::set1(amount)), zero_alpha(V::set1(COLOR_EPSILON*amount)) { }
+	T operator()(T a, T b) const
+	{
+		// blendfunc_BEHIND
+		const T a_a = V::splat_a(a);
+		a = V::set_a(a, V::select(V::eq(a_a, V::set1(0.f)), zero_alpha, V::mul(a_a, amount)));
+		return composite<V>(b, a, V::set1(1.f));
+	}
+};
+
+template<typename V>
+struct BlendAdd
+{
+	typedef typename V::type T;
+	T amount;
+	explicit BlendAdd(ColorReal amount): amount(V::set1(amount)) { }
+	T operator()(T a, T b) const
+	{
+		// blendfunc_ADD
+		const T ba = V::splat_a(b);
+		const T aa = V::mul(V::splat_a(a), amount);
+		return V::set_a(V::add(V::mul(b, ba), V::mul(a, aa)), b);
+	}
+};
+
+template<typename V>
+struct BlendMultiply
+{
+	typedef typename V::type T;
+	T amount;
+	bool inverse;
+	explicit BlendMultiply(ColorReal amount):
+		amount(V::set1(absolute(amount))), inverse(amount < 0) { }
+	T operator()(T a, T b) const
+	{
+		// blendfunc_MULTIPLY
+		if (inverse) a = invert<V>(a);
+		const T k = V::mul(amount, V::splat_a(a));
+		return V::set_a(V::add(V::mul(V::sub(V::mul(b, a), b), k), b), b);
+	}
+};
+
+template<typename V>
+struct BlendScreen
+{
+	typedef typename V::type T;
+	T amount;
+	bool inverse;
+	explicit BlendScreen(ColorReal amount):
+		amount(V::set1(absolute(amount))), inverse(amount < 0) { }
+	T operator()(T a, T b) const
+	{
+		// blendfunc_SCREEN
+		if (inverse) a = invert<V>(a);
+		const T one = V::set1(1.f);
+		a = V::set_a(V::sub(one, V::mul(V::sub(one, a), V::sub(one, b))), a);
+		return onto<V>(a, b, amount);
+	}
+};
+
+template<typename V>
+struct BlendAlpha
+{
+	typedef typename V::type T;
+	T amount;
+	explicit BlendAlpha(ColorReal amount): amount(V::set1(amount)) { }
+	T operator()(T a, T b) const
+	{
+		// blendfunc_ALPHA
+		const T rm = V::set_a(b, V::mul(V::splat_a(a), V::splat_a(b)));
+		return straight<V>(rm, b, amount);
+	}
+};
+
+//! Blends the row with the \a Kernel, pixels which do not fill a whole V go through Vec4
+template<typename V, template<typename> class Kernel>
+static void
+blend_row(Color *dest, const Color *src, int count, ColorReal amount)
+{
+	// same as Color::blend()
+	if (is_negligible(amount)) return;
+
+	const Kernel<V> kernel(amount);
+	int i = 0;
+	for(; i + (int)V::pixels <= count; i += V::pixels)
+		V::store(dest + i, kernel(V::load(src + i), V::load(dest + i)));
+
+	if (i < count) {
+		const Kernel<Vec4> tail(amount);
+		for(; i < count; ++i)
+			Vec4::store(dest + i, tail(Vec4::load(src + i), Vec4::load(dest + i)));
+	}
+}
+
+//! Returns the row function for \a method built on V, or null if \a method is not vectorized
+template<typename V>
+static ColorBlendRow::Func
+get_vectorized_func(Color::BlendMethod method)
+{
+	switch(method) {
+	case Color::BLEND_COMPOSITE: return blend_row<V, BlendComposite>;
+	case Color::BLEND_STRAIGHT:  return blend_row<V, BlendStraight>;
+	case Color::BLEND_ONTO:      return blend_row<V, BlendOnto>;
+	case Color::BLEND_BEHIND:    return blend_row<V, BlendBehind>;
+	case Color::BLEND_ADD:       return blend_row<V, BlendAdd>;
+	case Color::BLEND_MULTIPLY:  return blend_row<V, BlendMultiply>;
+	case Color::BLEND_SCREEN:    return blend_row<V, BlendScreen>;
+	case Color::BLEND_ALPHA:     return blend_row<V, BlendAlpha>;
+	default: break;
+	}
+	return nullptr;
+}
+
+} // END of anonymous namespace
+
+#endif // SYNFIG_COLOR_BLEND_ROW_SSE2
+
+}; // END of namespace synfig
+
+/* === E N D =============================================================== */
+
+#endif
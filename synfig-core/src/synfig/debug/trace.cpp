@@ -0,0 +1,349 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file trace.cpp
+**	\brief Timeline of rendering tasks and optimizers
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <mutex>
+
+#include <synfig/general.h>
+
+#include "trace.h"
+
+#endif
+
+/* === U S I N G =========================================================== */
+
+using namespace synfig;
+using namespace debug;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+std::atomic<bool> Trace::enabled(false);
+
+namespace {
+
+struct Buffer
+{
+	std::mutex mutex;
+	std::vector<Trace::Event> events;
+	long long dropped;
+	int index;
+	Buffer(): dropped(), index() { }
+};
+
+std::mutex buffers_mutex;
+// buffers are never deleted, a thread may record an event at any moment,
+// and the events of an exited thread are kept until clear()
+std::vector<Buffer*> buffers;
+// buffers of exited threads, reused by new ones
+std::vector<Buffer*> free_buffers;
+
+//! returns the buffer to free_buffers when the thread exits
+struct ThreadBuffer
+{
+	Buffer *buffer;
+	ThreadBuffer(): buffer() { }
+	~ThreadBuffer()
+	{
+		if (!buffer) return;
+		std::lock_guard<std::mutex> lock(buffers_mutex);
+		free_buffers.push_back(buffer);
+	}
+};
+
+thread_local ThreadBuffer thread_buffer;
+
+std::atomic<long long> start_time(0);
+
+}
+
+/* === P R O C E D U R E S ================================================= */
+
+namespace {
+
+long long
+get_clock()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+Buffer&
+get_thread_buffer()
+{
+	if (!thread_buffer.buffer) {
+		std::lock_guard<std::mutex> lock(buffers_mutex);
+		if (!free_buffers.empty()) {
+			thread_buffer.buffer = free_buffers.back();
+			free_buffers.pop_back();
+		} else {
+			thread_buffer.buffer = new Buffer();
+			thread_buffer.buffer->index = (int)buffers.size();
+			buffers.push_back(thread_buffer.buffer);
+		}
+	}
+	return *thread_buffer.buffer;
+}
+
+String
+escape_json(const String &s)
+{
+	String result;
+	result.reserve(s.size());
+	for(String::const_iterator i = s.begin(); i != s.end(); ++i) {
+		const unsigned char c = *i;
+		if (c == '"' || c == '\\')
+			{ result += '\\'; result += c; }
+		else
+		if (c < 0x20)
+			result += strprintf("\\u%04x", (int)c);
+		else
+			result += c;
+	}
+	return result;
+}
+
+bool
+compare_events(const Trace::Event &a, const Trace::Event &b)
+	{ return a.begin < b.begin || (a.begin == b.begin && a.thread < b.thread); }
+
+bool
+compare_rows(const Trace::SummaryRow &a, const Trace::SummaryRow &b)
+	{ return a.total > b.total; }
+
+void
+write_summary_table(std::ostream &stream, const String &title, const std::vector<Trace::SummaryRow> &rows)
+{
+	stream << title << std::endl;
+	stream << strprintf("  %-10s %-40s %8s %12s %10s %12s",
+		"category", "name", "count", "total ms", "max ms", "Mpixels") << std::endl;
+	for(std::vector<Trace::SummaryRow>::const_iterator i = rows.begin(); i != rows.end(); ++i)
+		stream << strprintf("  %-10s %-40s %8lld %12.3f %10.3f %12.3f",
+			i->category.c_str(),
+			i->name.c_str(),
+			i->count,
+			(double)i->total*0.001,
+			(double)i->max*0.001,
+			(double)i->pixels*0.000001 ) << std::endl;
+}
+
+}
+
+/* === M E T H O D S ======================================================= */
+
+Trace::Scope::Scope(const char *category):
+	active(Trace::is_enabled()), category(category), pixels(), begin()
+{
+	if (active) begin = Trace::now();
+}
+
+Trace::Scope::Scope(const char *category, const String &name, const String &layer, long long pixels):
+	active(Trace::is_enabled()), category(category), pixels(pixels), begin()
+{
+	if (active) {
+		this->name = name;
+		this->layer = layer;
+		begin = Trace::now();
+	}
+}
+
+Trace::Scope::~Scope()
+{
+	if (active)
+		Trace::add(category, name, layer, pixels, begin, Trace::now());
+}
+
+void
+Trace::start()
+{
+	clear();
+	start_time = get_clock();
+	enabled = true;
+}
+
+void
+Trace::stop()
+	{ enabled = false; }
+
+void
+Trace::clear()
+{
+	std::lock_guard<std::mutex> lock(buffers_mutex);
+	for(std::vector<Buffer*>::const_iterator i = buffers.begin(); i != buffers.end(); ++i) {
+		std::lock_guard<std::mutex> buffer_lock((*i)->mutex);
+		(*i)->events.clear();
+		(*i)->dropped = 0;
+	}
+}
+
+long long
+Trace::now()
+	{ return get_clock() - start_time; }
+
+void
+Trace::add(
+	const char *category,
+	const String &name,
+	const String &layer,
+	long long pixels,
+	long long begin,
+	long long end )
+{
+	Buffer &buffer = get_thread_buffer();
+	std::lock_guard<std::mutex> lock(buffer.mutex);
+	if (buffer.events.size() >= max_events_per_thread)
+		{ ++buffer.dropped; return; }
+	buffer.events.push_back(Event());
+	Event &event = buffer.events.back();
+	event.category = category;
+	event.name = name;
+	event.layer = layer;
+	event.pixels = pixels;
+	event.begin = begin;
+	event.end = end;
+	event.thread = buffer.index;
+}
+
+std::vector<Trace::Event>
+Trace::get_events()
+{
+	std::vector<Event> events;
+	{
+		std::lock_guard<std::mutex> lock(buffers_mutex);
+		for(std::vector<Buffer*>::const_iterator i = buffers.begin(); i != buffers.end(); ++i) {
+			std::lock_guard<std::mutex> buffer_lock((*i)->mutex);
+			events.insert(events.end(), (*i)->events.begin(), (*i)->events.end());
+		}
+	}
+	std::sort(events.begin(), events.end(), compare_events);
+	return events;
+}
+
+long long
+Trace::get_dropped_count()
+{
+	long long count = 0;
+	std::lock_guard<std::mutex> lock(buffers_mutex);
+	for(std::vector<Buffer*>::const_iterator i = buffers.begin(); i != buffers.end(); ++i) {
+		std::lock_guard<std::mutex> buffer_lock((*i)->mutex);
+		count += (*i)->dropped;
+	}
+	return count;
+}
+
+std::vector<Trace::SummaryRow>
+Trace::get_summary(bool by_layer)
+{
+	typedef std::map<std::pair<String, String>, SummaryRow> Map;
+	Map map;
+
+	const std::vector<Event> events = get_events();
+	for(std::vector<Event>::const_iterator i = events.begin(); i != events.end(); ++i) {
+		const String category = i->category;
+		if (by_layer && category != "task")
+			continue;
+		const String name = !by_layer ? i->name
+		                  : i->layer.empty() ? String("(unknown)")
+		                  : i->layer;
+		SummaryRow &row = map[std::make_pair(category, name)];
+		const long long duration = i->end - i->begin;
+		row.category = category;
+		row.name = name;
+		++row.count;
+		row.pixels += i->pixels;
+		row.total += duration;
+		row.max = std::max(row.max, duration);
+	}
+
+	std::vector<SummaryRow> rows;
+	for(Map::const_iterator i = map.begin(); i != map.end(); ++i)
+		rows.push_back(i->second);
+	std::stable_sort(rows.begin(), rows.end(), compare_rows);
+	return rows;
+}
+
+void
+Trace::write(std::ostream &stream)
+{
+	const std::vector<Event> events = get_events();
+
+	stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	const char *separator = "\n";
+	int threads = 0;
+	for(std::vector<Event>::const_iterator i = events.begin(); i != events.end(); ++i)
+		threads = std::max(threads, i->thread + 1);
+	for(int i = 0; i < threads; ++i) {
+		stream << separator
+		       << strprintf("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"thread %d\"}}", i, i);
+		separator = ",\n";
+	}
+
+	for(std::vector<Event>::const_iterator i = events.begin(); i != events.end(); ++i) {
+		stream << separator
+		       << "{\"name\":\"" << escape_json(i->name)
+		       << "\",\"cat\":\"" << i->category
+		       << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << i->thread
+		       << ",\"ts\":" << i->begin
+		       << ",\"dur\":" << (i->end - i->begin)
+		       << ",\"args\":{\"layer\":\"" << escape_json(i->layer)
+		       << "\",\"pixels\":" << i->pixels << "}}";
+		separator = ",\n";
+	}
+	stream << std::endl << "]}" << std::endl;
+}
+
+bool
+Trace::write(const filesystem::Path &filename)
+{
+	std::ofstream stream(filename.c_str());
+	if (!stream) {
+		synfig::error("Trace: cannot write to %s", filename.u8_str());
+		return false;
+	}
+	write(stream);
+	return (bool)stream;
+}
+
+void
+Trace::write_summary(std::ostream &stream)
+{
+	write_summary_table(stream, "Rendering trace by task and optimizer:", get_summary(false));
+	write_summary_table(stream, "Rendering trace by layer:", get_summary(true));
+	if (long long dropped = get_dropped_count())
+		stream << "  " << dropped << " events were dropped" << std::endl;
+}
@@ -0,0 +1,165 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file trace.h
+**	\brief Timeline of rendering tasks and optimizers
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_DEBUG_TRACE_H
+#define __SYNFIG_DEBUG_TRACE_H
+
+/* === H E A D E R S ======================================================= */
+
+#include <atomic>
+#include <ostream>
+#include <vector>
+
+#include <synfig/filesystem_path.h>
+#include <synfig/string.h>
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig {
+namespace debug {
+
+/*!	\class Trace
+**	\brief Records when and where the rendering tasks and optimizers run
+**
+**	Events are kept in a separate buffer for each thread, so recording
+**	doesn't lock anything shared. The buffer of an exited thread is reused
+**	by the next new thread. While tracing is stopped, Scope costs
+**	a single atomic read.
+**	The result is written in the trace event format of Chrome and Perfetto
+**	(open it in chrome://tracing or https://ui.perfetto.dev), or summarized
+**	by task type and by layer.
+*/
+class Trace
+{
+public:
+	struct Event
+	{
+		//! static string: "task" or "optimizer"
+		const char *category;
+		String name;
+		//! description of the layer which built the task, if known
+		String layer;
+		long long pixels;
+		//! microseconds since start()
+		long long begin;
+		long long end;
+		//! index of the thread, in order of their first event,
+		//! a new thread takes the index of an exited one
+		int thread;
+
+		Event(): category(""), pixels(), begin(), end(), thread() { }
+	};
+
+	struct SummaryRow
+	{
+		String category;
+		//! name of the task or optimizer, or the layer description
+		String name;
+		long long count;
+		long long pixels;
+		//! microseconds
+		long long total;
+		long long max;
+
+		SummaryRow(): count(), pixels(), total(), max() { }
+	};
+
+	//! Records the event from construction to destruction
+	class Scope
+	{
+	private:
+		bool active;
+		const char *category;
+		String name;
+		String layer;
+		long long pixels;
+		long long begin;
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	public:
+		explicit Scope(const char *category);
+		Scope(const char *category, const String &name, const String &layer = String(), long long pixels = 0);
+		~Scope();
+
+		//! false if tracing was stopped at construction,
+		//! check it before building an expensive name
+		bool is_active() const
+			{ return active; }
+		void set_name(const String &name)
+			{ if (active) this->name = name; }
+	};
+
+	//! Events beyond this count are dropped, to keep long renders in memory
+	static const size_t max_events_per_thread = 1 << 20;
+
+private:
+	static std::atomic<bool> enabled;
+
+public:
+	static bool is_enabled()
+		{ return enabled.load(std::memory_order_relaxed); }
+
+	//! Drops the recorded events and starts recording
+	static void start();
+	static void stop();
+	static void clear();
+
+	//! Microseconds since start()
+	static long long now();
+	static void add(
+		const char *category,
+		const String &name,
+		const String &layer,
+		long long pixels,
+		long long begin,
+		long long end );
+
+	//! Returns the events of all threads sorted by begin time
+	static std::vector<Event> get_events();
+	static long long get_dropped_count();
+
+	//! Sums the events by name, or by layer (tasks only), longest total first
+	static std::vector<SummaryRow> get_summary(bool by_layer = false);
+
+	static void write(std::ostream &stream);
+	static bool write(const filesystem::Path &filename);
+	//! Writes both summaries as text tables
+	static void write_summary(std::ostream &stream);
+}; // END of class Trace
+
+}; // END of namespace debug
+}; // END of namespace synfig
+
+/* === E N D =============================================================== */
+
+#endif
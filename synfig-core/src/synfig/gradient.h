@@ -316,6 +316,53 @@ public:
 		if (fabs(w) < real_precision<Real>()) return color(x0);
 		return ((summary(x1) - summary(x0))/w).color();
 	}
+
+	/**
+	 * Fills \a count colors with average(x - radius, x + radius), where x = position(i).
+	 * It gives the same results as the separate calls, but searches the segments
+	 * starting from the previous ones, which is fast when the positions change
+	 * a little from pixel to pixel, as they do along a scanline.
+	 */
+	template<typename PositionFunc>
+	void average(Color* colors, int count, Real radius, PositionFunc position) const
+	{
+		List::const_iterator hint0 = list.begin(), hint1 = list.begin();
+		for (int i = 0; i < count; ++i) {
+			const Real x = position(i);
+			const Real x0 = x - radius, x1 = x + radius;
+			const Real w = x1 - x0;
+			if (std::isnan(w) || std::isinf(w))
+				colors[i] = average();
+			else
+			if (fabs(w) < real_precision<Real>())
+				colors[i] = color(x0, hint0);
+			else
+				colors[i] = ((summary(x1, hint1) - summary(x0, hint0))/w).color();
+		}
+	}
+
+private:
+	//! Same as find(x), but walks from \a hint instead of doing a binary search
+	inline List::const_iterator find(Real x, List::const_iterator hint) const {
+		const List::const_iterator last = list.end() - 1;
+		while (hint != list.begin() && !((hint - 1)->next_pos < x)) --hint;
+		while (hint != last && hint->next_pos < x) ++hint;
+		return hint;
+	}
+
+	inline Color color(Real x, List::const_iterator& hint) const {
+		if (repeat) x -= floor(x);
+		return (hint = find(x, hint))->color(x);
+	}
+
+	inline Accumulator summary(Real x, List::const_iterator& hint) const {
+		if (repeat) {
+			Real count = floor(x);
+			x -= count;
+			return summary_color*count + (hint = find(x, hint))->summary(x);
+		}
+		return (hint = find(x, hint))->summary(x);
+	}
 };
 
 }; // END of namespace synfig
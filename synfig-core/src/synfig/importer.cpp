@@ -39,6 +39,7 @@
 #include <algorithm>
 #include <functional>
 #include <map>
+#include <mutex>
 
 #include <glibmm.h>
 
@@ -46,6 +47,7 @@
 #include <synfig/localization.h>
 
 #include "importer.h"
+#include "importercache.h"
 #include "string.h"
 #include "surface.h"
 
@@ -63,6 +65,8 @@ using namespace synfig;
 Importer::Book* synfig::Importer::book_;
 
 static std::map<FileSystem::Identifier,Importer::LooseHandle> *__open_importers;
+//! Importers are also created and destroyed by ImporterCache::prefetch() threads
+static std::mutex open_importers_mutex;
 
 /* === P R O C E D U R E S ================================================= */
 
@@ -73,12 +77,13 @@ Importer::subsys_init()
 {
 	book_=new Book();
 	__open_importers=new std::map<FileSystem::Identifier,Importer::LooseHandle>();
-	return true;
+	return ImporterCache::subsys_init();
 }
 
 bool
 Importer::subsys_stop()
 {
+	ImporterCache::subsys_stop();
 	delete book_;
 	delete __open_importers;
 	return true;
@@ -95,18 +100,38 @@ Importer::open(const FileSystem::Identifier &identifier, bool force)
 {
 	if (force) forget(identifier); // force reload
 
-	if(identifier.filename.empty())
 	{
-		synfig::error(_("Importer::open(): Cannot open empty filename"));
-		return nullptr;
+		std::lock_guard<std::mutex> lock(open_importers_mutex);
+
+		// If we already have an importer open under that filename,
+		// then use it instead.
+		if(__open_importers->count(identifier))
+		{
+			//synfig::info("Found importer already open, using it...");
+			return (*__open_importers)[identifier];
+		}
 	}
 
-	// If we already have an importer open under that filename,
-	// then use it instead.
-	if(__open_importers->count(identifier))
+	// created without the lock, a failed constructor runs ~Importer()
+	Importer::Handle importer = create_unshared(identifier);
+	if (!importer)
+		return nullptr;
+
+	std::lock_guard<std::mutex> lock(open_importers_mutex);
+	Importer::LooseHandle &open_importer = (*__open_importers)[identifier];
+	if (open_importer)
+		return open_importer;
+	open_importer = importer;
+	return importer;
+}
+
+Importer::Handle
+Importer::create_unshared(const FileSystem::Identifier &identifier)
+{
+	if(identifier.filename.empty())
 	{
-		//synfig::info("Found importer already open, using it...");
-		return (*__open_importers)[identifier];
+		synfig::error(_("Importer::open(): Cannot open empty filename"));
+		return nullptr;
 	}
 
 	String ext(identifier.filename.extension().u8string());
@@ -126,10 +151,7 @@ Importer::open(const FileSystem::Identifier &identifier, bool force)
 	}
 
 	try {
-		Importer::Handle importer;
-		importer=Importer::book()[ext].factory(identifier);
-		(*__open_importers)[identifier]=importer;
-		return importer;
+		return Importer::Handle(Importer::book()[ext].factory(identifier));
 	}
 	catch (const String& str)
 	{
@@ -140,7 +162,11 @@ Importer::open(const FileSystem::Identifier &identifier, bool force)
 
 void Importer::forget(const FileSystem::Identifier &identifier)
 {
-	__open_importers->erase(identifier);
+	{
+		std::lock_guard<std::mutex> lock(open_importers_mutex);
+		__open_importers->erase(identifier);
+	}
+	ImporterCache::instance().erase(identifier);
 }
 
 Importer::Importer(const FileSystem::Identifier &identifier):
@@ -152,6 +178,7 @@ Importer::Importer(const FileSystem::Identifier &identifier):
 Importer::~Importer()
 {
 	// Remove ourselves from the open importer list
+	std::lock_guard<std::mutex> lock(open_importers_mutex);
 	std::map<FileSystem::Identifier,Importer::LooseHandle>::iterator iter;
 	for(iter=__open_importers->begin();iter!=__open_importers->end();)
 		if(iter->second==this)
@@ -159,25 +186,47 @@ Importer::~Importer()
 }
 
 rendering::Surface::Handle
-Importer::get_frame(const RendDesc & /* renddesc */, const Time &time)
+Importer::get_frame(const RendDesc &renddesc, const Time &time)
 {
-	if (last_surface_ && last_surface_->is_exists() && !is_animated())
+	if (is_animated()) {
+		if (rendering::Surface::Handle surface = decode_frame(renddesc, time))
+			last_surface_ = surface;
+		else
+			return nullptr;
+		return last_surface_;
+	}
+
+	if (last_surface_ && last_surface_->is_exists())
 		return last_surface_;
 
+	if (rendering::Surface::Handle surface = ImporterCache::instance().get(identifier))
+		return last_surface_ = surface;
+
+	rendering::Surface::Handle surface = decode_frame(renddesc, time);
+	if (!surface)
+		return nullptr;
+	ImporterCache::instance().put(identifier, surface);
+	return last_surface_ = surface;
+}
+
+rendering::Surface::Handle
+Importer::decode_frame(const RendDesc &renddesc, const Time &time)
+{
 	Surface surface;
-	if(!get_frame(surface, RendDesc(), time)) {
+	if(!get_frame(surface, renddesc, time)) {
 		warning(strprintf(_("Unable to get frame from \"%s\" [%s]"), identifier.filename.u8_str(), time.get_string().c_str()));
 		return nullptr;
 	}
 
+	rendering::Surface::Handle result;
 	const char *s = getenv("SYNFIG_PACK_IMAGES");
 	if (s == nullptr || atoi(s) != 0)
-		last_surface_ = new rendering::SurfaceSWPacked();
+		result = new rendering::SurfaceSWPacked();
 	else
-		last_surface_ = new rendering::SurfaceSW();
+		result = new rendering::SurfaceSW();
 
 	if (surface.is_valid())
-		last_surface_->assign(surface[0], surface.get_w(), surface.get_h());
+		result->assign(surface[0], surface.get_w(), surface.get_h());
 
-	return last_surface_;
+	return result;
 }
@@ -164,13 +164,21 @@ public:
 	*/
 	virtual bool get_frame(Surface &surface, const RendDesc &renddesc, Time time, ProgressCallback *callback=nullptr) = 0;
 
+	//! Returns the frame as a rendering surface.
+	//! Frames of still images are shared through ImporterCache.
 	virtual rendering::Surface::Handle get_frame(const RendDesc &renddesc, const Time &time);
 
+	//! Decodes the frame into a new rendering surface, without any caching.
+	//! Returns null on error.
+	rendering::Surface::Handle decode_frame(const RendDesc &renddesc, const Time &time);
+
 	//! Returns \c true if the importer pays attention to the \a time parameter of get_frame()
 	virtual bool is_animated() { return false; }
 
 	//! Attempts to open \a filename, and returns a handle to the associated Importer
 	static Handle open(const FileSystem::Identifier &identifier, bool force=false);
+	//! Creates a new importer for \a identifier, which is not shared through open()
+	static Handle create_unshared(const FileSystem::Identifier &identifier);
 	static void forget(const FileSystem::Identifier &identifier);
 };
 
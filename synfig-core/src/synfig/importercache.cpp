@@ -0,0 +1,272 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file importercache.cpp
+**	\brief Process-wide cache of decoded images
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+
+#include "importercache.h"
+
+#include "general.h"
+#include "importer.h"
+#include "threadpool.h"
+
+#include <synfig/rendering/software/surfaceswpacked.h>
+
+#endif
+
+/* === U S I N G =========================================================== */
+
+using namespace synfig;
+
+/* === M A C R O S ========================================================= */
+
+#define DEFAULT_BUDGET_MB	256
+
+/* === G L O B A L S ======================================================= */
+
+ImporterCache *ImporterCache::instance_ = nullptr;
+
+/* === M E T H O D S ======================================================= */
+
+ImporterCache::ImporterCache(size_t budget)
+{
+	statistics.budget = budget;
+}
+
+ImporterCache::~ImporterCache()
+{
+	wait_prefetches();
+	clear();
+}
+
+ImporterCache&
+ImporterCache::instance()
+{
+	assert(instance_);
+	return *instance_;
+}
+
+bool
+ImporterCache::subsys_init()
+{
+	size_t budget_mb = DEFAULT_BUDGET_MB;
+	if (const char *s = getenv("SYNFIG_IMPORTER_CACHE_SIZE"))
+		budget_mb = (size_t)std::max(0, atoi(s));
+	instance_ = new ImporterCache(budget_mb*1024*1024);
+	return true;
+}
+
+bool
+ImporterCache::subsys_stop()
+{
+	delete instance_;
+	instance_ = nullptr;
+	return true;
+}
+
+size_t
+ImporterCache::get_surface_size(const rendering::Surface::Handle &surface)
+{
+	if (!surface)
+		return 0;
+	if (const rendering::SurfaceSWPacked *packed = dynamic_cast<const rendering::SurfaceSWPacked*>(surface.get()))
+		return packed->get_surface().get_data_size();
+	return surface->get_buffer_size();
+}
+
+void
+ImporterCache::evict(size_t budget)
+{
+	while(statistics.bytes > budget && !order.empty()) {
+		std::map<FileSystem::Identifier, Entry>::iterator i = entries.find(order.back());
+		assert(i != entries.end());
+		statistics.bytes -= i->second.bytes;
+		entries.erase(i);
+		order.pop_back();
+		++statistics.evictions;
+	}
+	statistics.entries = (int)entries.size();
+}
+
+void
+ImporterCache::set_budget(size_t bytes)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	statistics.budget = bytes;
+	evict(bytes);
+}
+
+size_t
+ImporterCache::get_budget() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return statistics.budget;
+}
+
+rendering::Surface::Handle
+ImporterCache::get(const FileSystem::Identifier &identifier)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	std::map<FileSystem::Identifier, Entry>::iterator i = entries.find(identifier);
+	if (i == entries.end()) {
+		++statistics.misses;
+		return rendering::Surface::Handle();
+	}
+	++statistics.hits;
+	order.splice(order.begin(), order, i->second.order);
+	return i->second.surface;
+}
+
+void
+ImporterCache::put(const FileSystem::Identifier &identifier, const rendering::Surface::Handle &surface)
+{
+	if (!identifier || !surface)
+		return;
+	const size_t bytes = get_surface_size(surface);
+
+	std::lock_guard<std::mutex> lock(mutex);
+	std::map<FileSystem::Identifier, Entry>::iterator i = entries.find(identifier);
+	if (i != entries.end()) {
+		statistics.bytes -= i->second.bytes;
+		order.erase(i->second.order);
+		entries.erase(i);
+	}
+
+	if (bytes <= statistics.budget) {
+		evict(statistics.budget - bytes);
+		Entry &entry = entries[identifier];
+		entry.surface = surface;
+		entry.bytes = bytes;
+		entry.order = order.insert(order.begin(), identifier);
+		statistics.bytes += bytes;
+	}
+	statistics.entries = (int)entries.size();
+}
+
+bool
+ImporterCache::contains(const FileSystem::Identifier &identifier) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return entries.count(identifier) != 0;
+}
+
+void
+ImporterCache::erase(const FileSystem::Identifier &identifier)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	std::map<FileSystem::Identifier, Entry>::iterator i = entries.find(identifier);
+	if (i == entries.end())
+		return;
+	statistics.bytes -= i->second.bytes;
+	order.erase(i->second.order);
+	entries.erase(i);
+	statistics.entries = (int)entries.size();
+}
+
+void
+ImporterCache::clear()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	entries.clear();
+	order.clear();
+	statistics.bytes = 0;
+	statistics.entries = 0;
+}
+
+void
+ImporterCache::prefetch_func(FileSystem::Identifier identifier)
+{
+	rendering::Surface::Handle surface;
+	try {
+		Importer::Handle importer = Importer::create_unshared(identifier);
+		if (importer && !importer->is_animated())
+			surface = importer->decode_frame(RendDesc(), Time());
+	} catch (const String &str) {
+		synfig::error(str);
+	} catch (...) {
+		synfig::error("ImporterCache: unable to prefetch %s", identifier.filename.u8_str());
+	}
+
+	if (surface)
+		put(identifier, surface);
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (surface)
+		++statistics.prefetched;
+	pending_prefetches.erase(identifier);
+	prefetch_cond.notify_all();
+}
+
+void
+ImporterCache::prefetch(const FileSystem::Identifier &identifier)
+{
+	if (!identifier)
+		return;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (statistics.budget == 0 || entries.count(identifier))
+			return;
+		if (!pending_prefetches.insert(identifier).second)
+			return;
+	}
+	ThreadPool::instance().enqueue(
+		sigc::bind(sigc::mem_fun(*this, &ImporterCache::prefetch_func), identifier),
+		ThreadPool::PRIORITY_IO );
+}
+
+void
+ImporterCache::wait_prefetches()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while(!pending_prefetches.empty())
+		prefetch_cond.wait(lock);
+}
+
+ImporterCache::Statistics
+ImporterCache::get_statistics() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return statistics;
+}
+
+void
+ImporterCache::reset_statistics()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	statistics.hits = 0;
+	statistics.misses = 0;
+	statistics.evictions = 0;
+	statistics.prefetched = 0;
+}
@@ -0,0 +1,138 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file importercache.h
+**	\brief Process-wide cache of decoded images
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_IMPORTERCACHE_H
+#define __SYNFIG_IMPORTERCACHE_H
+
+/* === H E A D E R S ======================================================= */
+
+#include <condition_variable>
+#include <list>
+#include <map>
+#include <mutex>
+#include <set>
+
+#include "filesystem.h"
+
+#include <synfig/rendering/surface.h>
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig {
+
+/*!	\class ImporterCache
+**	\brief Decoded frames of still images, shared by all importers
+**
+**	Frames are kept by file identifier in least recently used order, and the
+**	oldest ones are dropped when their total size exceeds the budget.
+**	The size of a packed surface is the size of its packed data, so images
+**	with 8-bit channels take a quarter of their float size or less.
+**	The budget is given in megabytes by SYNFIG_IMPORTER_CACHE_SIZE
+**	or set by set_budget().
+*/
+class ImporterCache
+{
+public:
+	struct Statistics
+	{
+		long long hits;
+		long long misses;
+		long long evictions;
+		//! Frames decoded by prefetch()
+		long long prefetched;
+		size_t bytes;
+		size_t budget;
+		int entries;
+
+		Statistics(): hits(), misses(), evictions(), prefetched(), bytes(), budget(), entries() { }
+	};
+
+private:
+	typedef std::list<FileSystem::Identifier> Order;
+
+	struct Entry
+	{
+		rendering::Surface::Handle surface;
+		size_t bytes;
+		Order::iterator order;
+		Entry(): bytes() { }
+	};
+
+	mutable std::mutex mutex;
+	std::condition_variable prefetch_cond;
+
+	std::map<FileSystem::Identifier, Entry> entries;
+	//! Most recently used first
+	Order order;
+	std::set<FileSystem::Identifier> pending_prefetches;
+	Statistics statistics;
+
+	static ImporterCache *instance_;
+
+	void evict(size_t budget);
+	void prefetch_func(FileSystem::Identifier identifier);
+
+public:
+	explicit ImporterCache(size_t budget);
+	~ImporterCache();
+
+	static ImporterCache& instance();
+	static bool subsys_init();
+	static bool subsys_stop();
+
+	//! Returns the count of bytes taken by the pixels of \a surface
+	static size_t get_surface_size(const rendering::Surface::Handle &surface);
+
+	void set_budget(size_t bytes);
+	size_t get_budget() const;
+
+	//! Returns the cached frame of \a identifier, or null
+	rendering::Surface::Handle get(const FileSystem::Identifier &identifier);
+	//! Puts the frame into the cache, unless it is bigger than the whole budget
+	void put(const FileSystem::Identifier &identifier, const rendering::Surface::Handle &surface);
+	bool contains(const FileSystem::Identifier &identifier) const;
+	void erase(const FileSystem::Identifier &identifier);
+	void clear();
+
+	//! Decodes the still image of \a identifier in the background, if it is not cached yet
+	void prefetch(const FileSystem::Identifier &identifier);
+	//! Waits until all the frames queued by prefetch() are decoded
+	void wait_prefetches();
+
+	Statistics get_statistics() const;
+	void reset_statistics();
+}; // END of class ImporterCache
+
+}; // END of namespace synfig
+
+/* === E N D =============================================================== */
+
+#endif
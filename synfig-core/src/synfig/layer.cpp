@@ -66,6 +66,7 @@
 #include "valuenodes/valuenode_const.h"
 
 #include "rendering/common/task/tasklayer.h"
+#include "debug/trace.h"
 
 #include "importer.h"
 #include <atomic>
@@ -94,6 +95,9 @@ static struct _LayerCounter
 
 //int _LayerCounter::counter(0);
 
+static std::atomic<long long> _set_time_evaluated(0);
+static std::atomic<long long> _set_time_skipped(0);
+
 /* === P R O C E D U R E S ================================================= */
 
 Layer::Book&
@@ -166,7 +170,9 @@ Layer::Layer():
 	exclude_from_rendering_(false),
 	param_z_depth(Real(0.0f)),
 	time_mark_(Time::end()),
-	outline_grow_mark_(0.0)
+	outline_grow_mark_(0.0),
+	dynamic_param_table_valid_(false),
+	setting_time_(false)
 {
 	_layer_counter.counter++;
 	SET_INTERPOLATION_DEFAULTS();
@@ -296,6 +302,9 @@ Layer::set_description(const String& x)
 void
 Layer::static_param_changed(const String &param)
 {
+	// the value was set from outside, so it may differ from the linked one
+	if (!setting_time_)
+		clear_constant_param_interval(param);
 	on_static_param_changed(param);
 	if (!dynamic_param_list().count(param))
 		signal_static_param_changed_(param);
@@ -304,6 +313,7 @@ Layer::static_param_changed(const String &param)
 void
 Layer::dynamic_param_changed(const String &param)
 {
+	clear_constant_param_interval(param);
 	on_dynamic_param_changed(param);
 	if (!dynamic_param_list().count(param))
 		signal_dynamic_param_changed_(param);
@@ -322,6 +332,7 @@ Layer::connect_dynamic_param(const String& param, ValueNode::LooseHandle value_n
 		return true;
 
 	dynamic_param_list_[param]=ValueNode::Handle(value_node);
+	dynamic_param_table_valid_ = false;
 
 	if (previous)
 	{
@@ -355,6 +366,7 @@ Layer::disconnect_dynamic_param(const String& param)
 
 	ValueNode::Handle previous(i->second);
 	dynamic_param_list_.erase(i);
+	dynamic_param_table_valid_ = false;
 
 	if(previous)
 	{
@@ -603,16 +615,70 @@ Layer::reset_version()
 	{ }
 
 
+void
+Layer::clear_constant_param_intervals()
+{
+	for(std::vector<DynamicParamEntry>::iterator i = dynamic_param_table_.begin(); i != dynamic_param_table_.end(); ++i)
+		i->constant_node = nullptr;
+}
+
+void
+Layer::clear_constant_param_interval(const String &param)
+{
+	for(std::vector<DynamicParamEntry>::iterator i = dynamic_param_table_.begin(); i != dynamic_param_table_.end(); ++i)
+		if (*i->name == param)
+			i->constant_node = nullptr;
+}
+
+void
+Layer::update_dynamic_param_table()
+{
+	if (dynamic_param_table_valid_) return;
+	dynamic_param_table_.clear();
+	dynamic_param_table_.reserve(dynamic_param_list_.size());
+	for(DynamicParamList::const_iterator i = dynamic_param_list_.begin(); i != dynamic_param_list_.end(); ++i) {
+		DynamicParamEntry entry;
+		// names come from files too, don't register the unknown ones
+		entry.id = ParamID::find(i->first);
+		entry.name = &i->first;
+		entry.value_node = &i->second;
+		entry.constant_node = nullptr;
+		dynamic_param_table_.push_back(entry);
+	}
+	dynamic_param_table_valid_ = true;
+}
+
 void
 Layer::set_time(IndependentContext context, Time time)
 {
-	Layer::ParamList params;
-	Layer::DynamicParamList::const_iterator iter;
-	// For each parameter of the layer sets the value by the operator()(time)
-	for (iter = dynamic_param_list().begin(); iter != dynamic_param_list().end(); ++iter)
-		params[iter->first]=(*iter->second)(time);
-	// Sets the modified parameter list to the current context layer
-	const_cast<Layer*>(this)->set_param_list(params);
+	update_dynamic_param_table();
+
+	// For each parameter of the layer gets the value by the operator()(time),
+	// unless the value set before is known to be the same at this time
+	std::vector<std::pair<const DynamicParamEntry*, ValueBase> > values;
+	long long skipped = 0;
+	for(std::vector<DynamicParamEntry>::iterator i = dynamic_param_table_.begin(); i != dynamic_param_table_.end(); ++i)
+	{
+		const ValueNode *node = i->value_node->get();
+		if (i->constant_node == node && i->constant_begin <= time && time <= i->constant_end)
+			{ ++skipped; continue; }
+
+		if (values.empty()) values.reserve(dynamic_param_table_.size());
+		values.push_back(std::make_pair(&*i, (*node)(time)));
+
+		i->constant_node = node->get_constant_interval(time, i->constant_begin, i->constant_end) ? node : nullptr;
+	}
+	_set_time_evaluated += (long long)values.size();
+	_set_time_skipped += skipped;
+
+	// Sets the values to the layer, the interned names make set_param() lookups cheap
+	setting_time_ = true;
+	for(std::vector<std::pair<const DynamicParamEntry*, ValueBase> >::const_iterator i = values.begin(); i != values.end(); ++i)
+		if (i->first->id.is_valid())
+			set_param_by_id(i->first->id, i->second);
+		else
+			set_param(*i->first->name, i->second);
+	setting_time_ = false;
 
 	set_time_mark(time);
 
@@ -631,6 +697,22 @@ Layer::set_time_vfunc(IndependentContext context, Time time)const
 	context.set_time(time);
 }
 
+Layer::SetTimeStatistics
+Layer::get_set_time_statistics()
+{
+	SetTimeStatistics statistics;
+	statistics.evaluated = _set_time_evaluated;
+	statistics.skipped = _set_time_skipped;
+	return statistics;
+}
+
+void
+Layer::reset_set_time_statistics()
+{
+	_set_time_evaluated = 0;
+	_set_time_skipped = 0;
+}
+
 void
 Layer::load_resources_vfunc(IndependentContext context, Time time)const
 {
@@ -891,10 +973,25 @@ Layer::build_rendering_task_vfunc(Context context)const
 	return task;
 }
 
+//! Marks the tasks built by the layer, the tasks of the context
+//! are marked already by their own layers
+static void
+set_task_layer_name(const rendering::Task::Handle &task, const String &name)
+{
+	if (!task || !task->layer_name.empty())
+		return;
+	task->layer_name = name;
+	for(rendering::Task::List::const_iterator i = task->sub_tasks.begin(); i != task->sub_tasks.end(); ++i)
+		set_task_layer_name(*i, name);
+}
+
 rendering::Task::Handle
 Layer::build_rendering_task(Context context)const
 {
-	return build_rendering_task_vfunc(context);
+	rendering::Task::Handle task = build_rendering_task_vfunc(context);
+	if (debug::Trace::is_enabled())
+		set_task_layer_name(task, get_non_empty_description());
+	return task;
 }
 
 String
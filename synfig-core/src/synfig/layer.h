@@ -33,6 +33,7 @@
 /* === H E A D E R S ======================================================= */
 
 #include <map>
+#include <vector>
 
 #include <sigc++/signal.h>
 #include <sigc++/connection.h>
@@ -43,6 +44,7 @@
 #include "filesystem_path.h"
 #include "node.h"
 #include "paramdesc.h"
+#include "paramid.h"
 #include "progresscallback.h"
 #include "real.h"
 #include "rendering/task.h"
@@ -97,7 +99,7 @@
 
 //! Imports a parameter if it is of the same type as param
 #define IMPORT_VALUE(x) \
-	if (#x=="param_"+param && x.get_type()==value.get_type()) \
+	if (SYNFIG_PARAM_ID_OF_MEMBER(x).is_name(param) && x.get_type()==value.get_type()) \
 	{ \
 		x=value; \
         static_param_changed(param); \
@@ -107,7 +109,7 @@
 //! Imports a parameter 'x' and perform an action usually based on
 //! some condition 'y'
 #define IMPORT_VALUE_PLUS_BEGIN(x) \
-	if (#x=="param_"+param && x.get_type()==value.get_type()) \
+	if (SYNFIG_PARAM_ID_OF_MEMBER(x).is_name(param) && x.get_type()==value.get_type()) \
 	{ \
 		x=value; \
 		{
@@ -123,7 +125,7 @@
 
 //! Exports a parameter if it is the same type as value
 #define EXPORT_VALUE(x) \
-	if (#x=="param_"+param) \
+	if (SYNFIG_PARAM_ID_OF_MEMBER(x).is_name(param)) \
 	{ \
 		synfig::ValueBase ret; \
 		ret.copy(x); \
@@ -264,6 +266,14 @@ public:
 	//! Map of parameters that are animated Value Nodes indexed by the param name
 	typedef std::map<String,etl::rhandle<ValueNode> > DynamicParamList;
 
+	//! Counts dynamic parameters evaluated and skipped by set_time()
+	struct SetTimeStatistics
+	{
+		long long evaluated;
+		long long skipped;
+		SetTimeStatistics(): evaluated(), skipped() { }
+	};
+
 	//! A list type which describes all the parameters that a layer has.
 	/*! \see get_param_vocab() */
 	typedef ParamVocab Vocab;
@@ -304,6 +314,28 @@ private:
 	Time time_mark_;
 	Real outline_grow_mark_;
 
+	//! Entry of the flat table of dynamic parameters used by set_time()
+	struct DynamicParamEntry
+	{
+		//! Invalid if the name is not known to any layer
+		ParamID id;
+		//! Key in dynamic_param_list_
+		const String *name;
+		const etl::rhandle<ValueNode> *value_node;
+		//! The node for which the constant interval was found, null if there is none.
+		//! Inside the interval the value already set to the layer is still valid,
+		//! so set_time() doesn't evaluate it again.
+		const ValueNode *constant_node;
+		Time constant_begin;
+		Time constant_end;
+	};
+
+	//! dynamic_param_list_ with interned names, rebuilt after it changes
+	std::vector<DynamicParamEntry> dynamic_param_table_;
+	bool dynamic_param_table_valid_;
+	//! \c true while set_time() sets values of dynamic parameters
+	bool setting_time_;
+
 	//! Contains the name of the group that this layer belongs to
 	String group_;
 
@@ -383,6 +415,13 @@ protected:
 	void static_param_changed(const String &param);
 	void dynamic_param_changed(const String &param);
 
+private:
+	void clear_constant_param_intervals();
+	void clear_constant_param_interval(const String &param);
+	void update_dynamic_param_table();
+
+protected:
+
 	Layer();
 
 public:
@@ -548,12 +587,23 @@ public:
 	*/
 	virtual ValueBase get_param(const String &param)const;
 
+	//! Sets the parameter by its interned name.
+	/*! Layers match it by address in IMPORT_VALUE() chains,
+	**	without comparing the characters of the name.
+	**	\see set_param()
+	*/
+	bool set_param_by_id(const ParamID &param, const ValueBase &value)
+		{ return set_param(param.get_name(), value); }
+	//! Gets the parameter by its interned name, \see get_param()
+	ValueBase get_param_by_id(const ParamID &param)const
+		{ return get_param(param.get_name()); }
+
 	//! Get a list of all of the parameters and their values
 	virtual ParamList get_param_list()const;
 
 	Time get_time_mark() const { return time_mark_; }
 	void set_time_mark(Time time) { time_mark_ = time; }
-	void clear_time_mark() { time_mark_ = Time::end(); }
+	void clear_time_mark() { time_mark_ = Time::end(); clear_constant_param_intervals(); }
 
 	Real get_outline_grow_mark() const { return outline_grow_mark_; }
 	void set_outline_grow_mark(Real outline_grow) { outline_grow_mark_ = outline_grow; }
@@ -565,6 +615,11 @@ public:
 	**	\see Context::set_time()
 	*/
 	void set_time(IndependentContext context, Time time);
+
+	//! Returns the number of dynamic parameters evaluated and skipped
+	//! by set_time() of all layers since the last reset
+	static SetTimeStatistics get_set_time_statistics();
+	static void reset_set_time_statistics();
 	
 	//! Loads external resources (frames) for the Layer recursively
 	/*!	\param context		Context iterator referring to next Layer.
@@ -44,11 +44,12 @@
 #include <synfig/renddesc.h>
 #include <synfig/string.h>
 #include <synfig/surface.h>
+#include <synfig/threadpool.h>
 #include <synfig/time.h>
 #include <synfig/value.h>
 #include <synfig/valuenode.h>
 
-#include <synfig/rendering/common/task/taskblend.h>
+#include <synfig/rendering/common/task/taskaccumulate.h>
 
 #endif
 
@@ -170,7 +171,8 @@ Layer_Duplicate::build_rendering_task_vfunc(Context context) const
 	ColorReal amount = get_amount() * Context::z_depth_visibility(context.get_params(), *this);
 	Color::BlendMethod blend_method = get_blend_method();
 
-	rendering::Task::Handle task;
+	rendering::TaskAccumulate::Handle task(new rendering::TaskAccumulate());
+	task->blend_method = blend_method;
 
 	std::lock_guard<std::mutex> lock(mutex);
 	duplicate_param->reset_index(time_cur);
@@ -179,14 +181,9 @@ Layer_Duplicate::build_rendering_task_vfunc(Context context) const
 	Context dup_context(context, dup_context_params);
 	do
 	{
-		rendering::TaskBlend::Handle task_blend(new rendering::TaskBlend());
-		task_blend->amount = amount;
-		task_blend->blend_method = blend_method;
-		task_blend->sub_task_a() = task;
-		task_blend->sub_task_b() = dup_context.build_rendering_task();
-		task = task_blend;
+		task->add(dup_context.build_rendering_task(), amount);
 	}
 	while (duplicate_param->step(time_cur));
 
-	return task;
+	return task->build_groups(ThreadPool::instance().get_max_threads());
 }
@@ -40,10 +40,11 @@
 #include <synfig/context.h>
 #include <synfig/paramdesc.h>
 #include <synfig/string.h>
+#include <synfig/threadpool.h>
 #include <synfig/time.h>
 #include <synfig/value.h>
 
-#include <synfig/rendering/common/task/taskblend.h>
+#include <synfig/rendering/common/task/taskaccumulate.h>
 
 #endif
 
@@ -206,7 +207,10 @@ Layer_MotionBlur::build_rendering_task_vfunc(Context context) const
 	const Color::BlendMethod blend_method = no_blur_effect ? Color::BLEND_COMPOSITE : Color::BLEND_ADD_COMPOSITE;
 	const Real k = no_blur_effect ? 1.0 : (approximate_zero(sum) ? 0.0 : (1.0/sum));
 
-	rendering::Task::Handle task;
+	// all the samples are independent, so render them simultaneously
+	// and blend together in groups of about the count of threads
+	rendering::TaskAccumulate::Handle task(new rendering::TaskAccumulate());
+	task->blend_method = blend_method;
 	for(int i = 0; i < samples; i++)
 	{
 		const auto amount = no_blur_effect ? 1.0 : (scales[i]*k);
@@ -218,15 +222,10 @@ Layer_MotionBlur::build_rendering_task_vfunc(Context context) const
 		Real ipos = 1.0 - pos;
 		context.set_time(get_time_mark() - aperture*ipos);
 
-		rendering::TaskBlend::Handle task_blend(new rendering::TaskBlend());
-		task_blend->amount = amount;
-		task_blend->blend_method = blend_method;
-		task_blend->sub_task_a() = task;
-		task_blend->sub_task_b() = context.build_rendering_task();
-		task = task_blend;
+		task->add(context.build_rendering_task(), amount);
 	}
 
-	if (!task)
+	if (task->sub_tasks.empty())
 		return context.build_rendering_task();
-	return task;
+	return task->build_groups(ThreadPool::instance().get_max_threads());
 }
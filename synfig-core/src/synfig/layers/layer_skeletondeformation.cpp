@@ -222,83 +222,192 @@ Real Layer_SkeletonDeformation::distance_to_line(const Vector &p0, const Vector
 	return std::min(distance_to_line, std::min(distance_to_p0, distance_to_p1) );
 }
 
+static bool
+same_shapes(const std::vector<Bone::Shape> &a, const std::vector<Bone::Shape> &b)
+{
+	if (a.size() != b.size()) return false;
+	for(size_t i = 0; i < a.size(); ++i)
+		if ( a[i].p0 != b[i].p0 || a[i].r0 != b[i].r0
+		  || a[i].p1 != b[i].p1 || a[i].r1 != b[i].r1 ) return false;
+	return true;
+}
+
 void
-Layer_SkeletonDeformation::prepare_mesh()
+Layer_SkeletonDeformation::update_weight_cache()
 {
 	static const Real precision = 1e-10;
 
-	rendering::Mesh::Handle mesh(new rendering::Mesh());
+	WeightCache &cache = weight_cache;
 
 	// TODO: build grid with dynamic size
 
-	const Point grid_p0 = param_point1.get(Point());
-	const Point grid_p1 = param_point2.get(Point());
-	const int grid_side_count_x = std::max(1, param_x_subdivisions.get(int())) + 1;
-	const int grid_side_count_y = std::max(1, param_y_subdivisions.get(int())) + 1;
+	const Point &grid_p0 = cache.point1;
+	const Point &grid_p1 = cache.point2;
+	const int grid_side_count_x = cache.count_x;
+	const int grid_side_count_y = cache.count_y;
 
 	const Real grid_step_x = (grid_p1[0] - grid_p0[0]) / (Real)(grid_side_count_x - 1);
 	const Real grid_step_y = (grid_p1[1] - grid_p0[1]) / (Real)(grid_side_count_y - 1);
 	const Real grid_step_diagonal = sqrt(grid_step_x*grid_step_x + grid_step_y*grid_step_y);
 
 	// build grid
-	std::vector<GridPoint> grid;
-	grid.reserve(grid_side_count_x * grid_side_count_y);
+	cache.positions.clear();
+	cache.positions.reserve(grid_side_count_x * grid_side_count_y);
 	for(int j = 0; j < grid_side_count_y; ++j)
 		for(int i = 0; i < grid_side_count_x; ++i)
-			grid.push_back(GridPoint(Vector(
+			cache.positions.push_back(Vector(
 				grid_p0[0] + i*grid_step_x,
-				grid_p0[1] + j*grid_step_y )));
+				grid_p0[1] + j*grid_step_y ));
 
-	// apply deformation
-	if (param_bones.can_get(ValueBase::List()))
+	// weights of bones in the setup pose
+	const int bones_count = (int)cache.setup_shapes.size();
+	std::vector<Bone::Shape> expanded_shapes;
+	expanded_shapes.reserve(bones_count);
+	for(std::vector<Bone::Shape>::const_iterator i = cache.setup_shapes.begin(); i != cache.setup_shapes.end(); ++i)
 	{
-		const ValueBase::List &bones = param_bones.get_list();
-		for(ValueBase::List::const_iterator i = bones.begin(); i != bones.end(); ++i)
+		Bone::Shape expandedShape0 = *i;
+		expandedShape0.r0 += 2.0*grid_step_diagonal;
+		expandedShape0.r1 += 2.0*grid_step_diagonal;
+		expanded_shapes.push_back(expandedShape0);
+	}
+
+	cache.weights.clear();
+	cache.weights_begin.clear();
+	cache.weights_begin.reserve(cache.positions.size() + 1);
+	for(std::vector<Vector>::const_iterator j = cache.positions.begin(); j != cache.positions.end(); ++j)
+	{
+		cache.weights_begin.push_back((int)cache.weights.size());
+		for(int b = 0; b < bones_count; ++b)
 		{
-			if (i->can_get(BonePair()))
-			{
-				const BonePair &bone_pair = i->get(BonePair());
-				Bone::Shape shape0 = bone_pair.first.get_shape();
-				Bone::Shape shape1 = bone_pair.second.get_shape();
-				Bone::Shape expandedShape0 = shape0;
-				expandedShape0.r0 += 2.0*grid_step_diagonal;
-				expandedShape0.r1 += 2.0*grid_step_diagonal;
-				Real depth = bone_pair.second.get_depth();
-
-				Matrix into_bone(
-					shape0.p1[0] - shape0.p0[0], shape0.p1[1] - shape0.p0[1], 0.0,
-					shape0.p0[1] - shape0.p1[1], shape0.p1[0] - shape0.p0[0], 0.0,
-					shape0.p0[0], shape0.p0[1], 1.0
-				);
-				into_bone.invert();
-				Matrix from_bone(
-					shape1.p1[0] - shape1.p0[0], shape1.p1[1] - shape1.p0[1], 0.0,
-					shape1.p0[1] - shape1.p1[1], shape1.p1[0] - shape1.p0[0], 0.0,
-					shape1.p0[0], shape1.p0[1], 1.0
-				);
-				Matrix matrix = from_bone * into_bone;
-
-				for(std::vector<GridPoint>::iterator j = grid.begin(); j != grid.end(); ++j)
-				{
-					Real percent = Bone::distance_to_shape_center_percent(expandedShape0, j->initial_position);
-					if (percent > precision) {
-						Real distance = distance_to_line(shape0.p0, shape0.p1, j->initial_position);
-						if (distance < precision) distance = precision;
-						Real weight =
-							percent/(distance*distance);
-							// 1.0/distance;
-							// 1.0/(distance*distance);
-							// 1.0/(distance*distance*distance);
-							// exp(-4.0*distance);
-						j->summary_position += matrix.get_transformed(j->initial_position) * weight;
-						j->summary_depth += depth * weight;
-						j->summary_weight += weight;
-						j->used = true;
-					}
-				}
+			const Bone::Shape &shape0 = cache.setup_shapes[b];
+			Real percent = Bone::distance_to_shape_center_percent(expanded_shapes[b], *j);
+			if (percent > precision) {
+				Real distance = distance_to_line(shape0.p0, shape0.p1, *j);
+				if (distance < precision) distance = precision;
+				Real weight =
+					percent/(distance*distance);
+					// 1.0/distance;
+					// 1.0/(distance*distance);
+					// 1.0/(distance*distance*distance);
+					// exp(-4.0*distance);
+				cache.weights.push_back(WeightCache::Weight(b, weight));
 			}
 		}
 	}
+	cache.weights_begin.push_back((int)cache.weights.size());
+
+	// quads with all vertices moved by bones
+	cache.quads.clear();
+	for(int j = 1; j < grid_side_count_y; ++j)
+	{
+		for(int i = 1; i < grid_side_count_x; ++i)
+		{
+			int v[] = {
+				(j-1)*grid_side_count_x + (i-1),
+				(j-1)*grid_side_count_x +  i,
+				 j   *grid_side_count_x +  i,
+				 j   *grid_side_count_x + (i-1),
+			};
+			bool used = true;
+			for(int k = 0; k < 4; ++k)
+				if (cache.weights_begin[v[k]] == cache.weights_begin[v[k] + 1])
+					used = false;
+			if (used)
+				cache.quads.push_back(v[0]);
+		}
+	}
+
+	// triangles will be sorted again
+	cache.depths.clear();
+	cache.triangles.clear();
+}
+
+void
+Layer_SkeletonDeformation::prepare_mesh()
+{
+	static const Real precision = 1e-10;
+
+	rendering::Mesh::Handle mesh(new rendering::Mesh());
+
+	std::vector<const BonePair*> bones;
+	if (param_bones.can_get(ValueBase::List()))
+	{
+		const ValueBase::List &list = param_bones.get_list();
+		for(ValueBase::List::const_iterator i = list.begin(); i != list.end(); ++i)
+			if (i->can_get(BonePair()))
+				bones.push_back(&i->get(BonePair()));
+	}
+
+	// bone weights are calculated only when the grid or the setup pose is changed,
+	// for the animated pose only the deformed positions are calculated
+	WeightCache &cache = weight_cache;
+	{
+		const Point grid_p0 = param_point1.get(Point());
+		const Point grid_p1 = param_point2.get(Point());
+		const int grid_side_count_x = std::max(1, param_x_subdivisions.get(int())) + 1;
+		const int grid_side_count_y = std::max(1, param_y_subdivisions.get(int())) + 1;
+
+		std::vector<Bone::Shape> setup_shapes;
+		setup_shapes.reserve(bones.size());
+		for(std::vector<const BonePair*>::const_iterator i = bones.begin(); i != bones.end(); ++i)
+			setup_shapes.push_back((*i)->first.get_shape());
+
+		if ( cache.positions.empty()
+		  || cache.point1 != grid_p0
+		  || cache.point2 != grid_p1
+		  || cache.count_x != grid_side_count_x
+		  || cache.count_y != grid_side_count_y
+		  || !same_shapes(cache.setup_shapes, setup_shapes) )
+		{
+			cache.point1 = grid_p0;
+			cache.point2 = grid_p1;
+			cache.count_x = grid_side_count_x;
+			cache.count_y = grid_side_count_y;
+			cache.setup_shapes.swap(setup_shapes);
+			update_weight_cache();
+		}
+	}
+
+	// transformations of bones from the setup pose
+	std::vector<Matrix> matrices;
+	std::vector<Real> depths;
+	matrices.reserve(bones.size());
+	depths.reserve(bones.size());
+	for(int b = 0; b < (int)bones.size(); ++b)
+	{
+		const Bone::Shape &shape0 = cache.setup_shapes[b];
+		Bone::Shape shape1 = bones[b]->second.get_shape();
+		Matrix into_bone(
+			shape0.p1[0] - shape0.p0[0], shape0.p1[1] - shape0.p0[1], 0.0,
+			shape0.p0[1] - shape0.p1[1], shape0.p1[0] - shape0.p0[0], 0.0,
+			shape0.p0[0], shape0.p0[1], 1.0
+		);
+		into_bone.invert();
+		Matrix from_bone(
+			shape1.p1[0] - shape1.p0[0], shape1.p1[1] - shape1.p0[1], 0.0,
+			shape1.p0[1] - shape1.p1[1], shape1.p1[0] - shape1.p0[0], 0.0,
+			shape1.p0[0], shape1.p0[1], 1.0
+		);
+		matrices.push_back(from_bone * into_bone);
+		depths.push_back(bones[b]->second.get_depth());
+	}
+
+	// apply deformation
+	std::vector<GridPoint> grid;
+	grid.reserve(cache.positions.size());
+	for(int i = 0; i < (int)cache.positions.size(); ++i)
+	{
+		grid.push_back(GridPoint(cache.positions[i]));
+		GridPoint &point = grid.back();
+		for(int j = cache.weights_begin[i]; j < cache.weights_begin[i + 1]; ++j)
+		{
+			const WeightCache::Weight &w = cache.weights[j];
+			point.summary_position += matrices[w.first].get_transformed(point.initial_position) * w.second;
+			point.summary_depth += depths[w.first] * w.second;
+			point.summary_weight += w.second;
+			point.used = true;
+		}
+	}
 
 	// build vertices
 	mesh->vertices.reserve(grid.size());
@@ -309,36 +418,37 @@ Layer_SkeletonDeformation::prepare_mesh()
 			average_position, i->initial_position ));
 	}
 
-	// build triangles
-	std::vector< std::pair<Real, rendering::Mesh::Triangle> > triangles;
-	triangles.reserve(2*(grid_side_count_x-1)*(grid_side_count_y-1));
-	for(int j = 1; j < grid_side_count_y; ++j)
+	// order of triangles depends only on depths of bones
+	if (cache.triangles.empty() || cache.depths != depths)
 	{
-		for(int i = 1; i < grid_side_count_x; ++i)
+		// build triangles
+		std::vector< std::pair<Real, rendering::Mesh::Triangle> > triangles;
+		triangles.reserve(2*cache.quads.size());
+		for(std::vector<int>::const_iterator i = cache.quads.begin(); i != cache.quads.end(); ++i)
 		{
 			int v[] = {
-				(j-1)*grid_side_count_x + (i-1),
-				(j-1)*grid_side_count_x +  i,
-				 j   *grid_side_count_x +  i,
-				 j   *grid_side_count_x + (i-1),
+				*i,
+				*i + 1,
+				*i + cache.count_x + 1,
+				*i + cache.count_x,
 			};
-			if (grid[v[0]].used && grid[v[1]].used && grid[v[2]].used && grid[v[3]].used)
-			{
-				Real depth = 0.25*(grid[v[0]].average_depth
-						         + grid[v[1]].average_depth
-								 + grid[v[2]].average_depth
-								 + grid[v[3]].average_depth);
-				triangles.push_back(std::make_pair(depth, rendering::Mesh::Triangle(v[0], v[1], v[3])));
-				triangles.push_back(std::make_pair(depth, rendering::Mesh::Triangle(v[1], v[2], v[3])));
-			}
+			Real depth = 0.25*(grid[v[0]].average_depth
+					         + grid[v[1]].average_depth
+							 + grid[v[2]].average_depth
+							 + grid[v[3]].average_depth);
+			triangles.push_back(std::make_pair(depth, rendering::Mesh::Triangle(v[0], v[1], v[3])));
+			triangles.push_back(std::make_pair(depth, rendering::Mesh::Triangle(v[1], v[2], v[3])));
 		}
-	}
 
-	// sort triangles
-	std::sort(triangles.begin(), triangles.end(), GridPoint::compare_triagles);
-	mesh->triangles.reserve(triangles.size());
-	for(std::vector< std::pair<Real, rendering::Mesh::Triangle> >::iterator i = triangles.begin(); i != triangles.end(); ++i)
-		mesh->triangles.push_back(i->second);
+		// sort triangles
+		std::sort(triangles.begin(), triangles.end(), GridPoint::compare_triagles);
+		cache.triangles.clear();
+		cache.triangles.reserve(triangles.size());
+		for(std::vector< std::pair<Real, rendering::Mesh::Triangle> >::iterator i = triangles.begin(); i != triangles.end(); ++i)
+			cache.triangles.push_back(i->second);
+		cache.depths.swap(depths);
+	}
+	mesh->triangles = cache.triangles;
 
 	prepare_mask();
 	this->mesh = mesh;
@@ -34,6 +34,8 @@
 #include <synfig/pair.h>
 #include <synfig/bone.h>
 
+#include <vector>
+
 /* === M A C R O S ========================================================= */
 
 /* === T Y P E D E F S ===================================================== */
@@ -63,6 +65,36 @@ private:
 	struct GridPoint;
 	static Real distance_to_line(const Vector &p0, const Vector &p1, const Vector &x);
 
+	//! Bone weights of the grid points. They depend only on the grid and on the
+	//! setup pose of bones, so they are reused while the pose is animated.
+	struct WeightCache
+	{
+		typedef std::pair<int, Real> Weight;
+
+		Point point1;
+		Point point2;
+		int count_x;
+		int count_y;
+		std::vector<Bone::Shape> setup_shapes;
+
+		std::vector<Vector> positions;
+		//! weights of the point i are [weights_begin[i], weights_begin[i+1])
+		std::vector<int> weights_begin;
+		//! bone index and weight, in order of bones
+		std::vector<Weight> weights;
+		//! first vertex of every quad whose vertices are all moved by bones
+		std::vector<int> quads;
+
+		//! depths of bones the triangles were sorted for
+		std::vector<Real> depths;
+		std::vector<rendering::Mesh::Triangle> triangles;
+
+		WeightCache(): count_x(0), count_y(0) { }
+	};
+	WeightCache weight_cache;
+
+	void update_weight_cache();
+
 public:
 	typedef etl::handle<Layer_SkeletonDeformation> Handle;
 	typedef etl::handle<const Layer_SkeletonDeformation> ConstHandle;
@@ -33,12 +33,15 @@
 #	include <config.h>
 #endif
 
+#include <algorithm>
+
 #include "listimporter.h"
 
 #include "general.h"
 #include <synfig/localization.h>
 
 #include "filesystemnative.h"
+#include "importercache.h"
 #include <synfig/rendering/software/surfacesw.h>
 
 
@@ -50,7 +53,7 @@ using namespace synfig;
 
 /* === M A C R O S ========================================================= */
 
-#define LIST_IMPORTER_CACHE_SIZE	20
+#define LIST_IMPORTER_PREFETCH_FRAMES	4
 
 /* === G L O B A L S ======================================================= */
 
@@ -184,12 +187,11 @@ ListImporter::get_sub_importer(const RendDesc &renddesc, Time time, ProgressCall
 		return Importer::Handle();
 	}
 
-	for(std::list<Importer::Handle>::iterator i = frame_cache.begin(); i != frame_cache.end();)
-		if (*i == importer) i = frame_cache.erase(i); else ++i;
-
-	while (frame_cache.size() >= LIST_IMPORTER_CACHE_SIZE)
-		frame_cache.pop_front();
-	frame_cache.push_back(importer);
+	// decoded frames are kept by ImporterCache, start decoding of the next ones
+	const int last = std::min((int)filename_list.size(), frame + 1 + LIST_IMPORTER_PREFETCH_FRAMES);
+	for(int i = frame + 1; i < last; ++i)
+		if (filename_list[i] != filename_list[i - 1])
+			ImporterCache::instance().prefetch(FileSystem::Identifier(FileSystemNative::instance(), filename_list[i]));
 
 	return importer;
 }
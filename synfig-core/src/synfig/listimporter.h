@@ -34,7 +34,6 @@
 #include "importer.h"
 #include "surface.h"
 #include <vector>
-#include <list>
 
 /* === M A C R O S ========================================================= */
 
@@ -53,7 +52,6 @@ class ListImporter : public Importer
 private:
 	float fps;
 	std::vector<String> filename_list;
-	std::list<Importer::Handle> frame_cache;
 
 	Importer::Handle get_sub_importer(const RendDesc &renddesc, Time time, ProgressCallback *cb);
 
@@ -43,13 +43,17 @@
 
 #include <iostream>
 #include <map>
+#include <memory>
+#include <sstream>
 #include <vector>
 #include <stdexcept>
 
 #include <libxml++/libxml++.h>
+#include <libxml/xmlreader.h>
 #include <sigc++/bind.h>
 
 #include "loadcanvas.h"
+#include "canvasbinary.h"
 
 #include "general.h"
 #include "localization.h"
@@ -132,6 +136,67 @@ upgrade_guide_metadata(std::string& content, const std::string& metadata, bool i
 		content.pop_back();
 }
 
+namespace {
+
+//! Collects the messages of libxml in the same form as xmlpp::DomParser does
+void
+reader_error_callback(void *arg, const char *msg, xmlParserSeverities severity, xmlTextReaderLocatorPtr locator)
+{
+	if (severity != XML_PARSER_SEVERITY_ERROR && severity != XML_PARSER_SEVERITY_VALIDITY_ERROR)
+		return;
+	String &errors = *static_cast<String*>(arg);
+	errors += strprintf("Line %d (error): %s", xmlTextReaderLocatorLineNumber(locator), msg);
+}
+
+void
+read_stream_data(std::istream &stream, std::vector<char> &data)
+{
+	const size_t chunk_size = 1 << 16;
+	size_t size = 0;
+	while(stream) {
+		data.resize(size + chunk_size);
+		stream.read(&data[size], chunk_size);
+		size += (size_t)stream.gcount();
+	}
+	data.resize(size);
+}
+
+int
+read_stream_callback(void *context, char *buffer, int len)
+{
+	std::istream &stream = *static_cast<std::istream*>(context);
+	stream.read(buffer, len);
+	return stream.bad() ? -1 : (int)stream.gcount();
+}
+
+int
+close_stream_callback(void *)
+	{ return 0; }
+
+struct ReaderDeleter
+{
+	void operator()(xmlTextReaderPtr reader) const
+		{ xmlFreeTextReader(reader); }
+};
+
+//! Creates the xmlpp wrappers of the subtree expanded by the reader
+//! and deletes them before the reader frees the subtree
+class ExpandedElement
+{
+	xmlNodePtr node;
+	ExpandedElement(const ExpandedElement&) = delete;
+	ExpandedElement& operator=(const ExpandedElement&) = delete;
+public:
+	explicit ExpandedElement(xmlNodePtr node): node(node)
+		{ xmlpp::Node::create_wrapper(node); }
+	~ExpandedElement()
+		{ xmlpp::Node::free_wrappers(node); }
+	xmlpp::Element* get() const
+		{ return static_cast<xmlpp::Element*>(node->_private); }
+};
+
+}
+
 OpenCanvasMap& synfig::get_open_canvas_map()
 {
 	static OpenCanvasMap open_canvas_map_;
@@ -3013,7 +3078,9 @@ CanvasParser::parse_layer(xmlpp::Element *element,Canvas::Handle canvas)
 				} else {
 					// Set the layer's parameter, and make sure that
 					// the layer linked it
-					if(!layer->set_param(param_name,data))
+					// the name is not trusted, so it is only looked up, not registered
+					const ParamID param_id = ParamID::find(param_name);
+					if(!(param_id.is_valid() ? layer->set_param_by_id(param_id,data) : layer->set_param(param_name,data)))
 					{
 						// TODO(ice0): Add normal version comparison function (check glib)
 						// TODO(ice0): Remove stubs after updating image files (.sif)
@@ -3148,18 +3215,11 @@ CanvasParser::parse_layer(xmlpp::Element *element,Canvas::Handle canvas)
 }
 
 Canvas::Handle
-CanvasParser::parse_canvas(xmlpp::Element *element,Canvas::Handle parent,bool inline_,const FileSystem::Identifier &identifier,String filename)
+CanvasParser::parse_canvas_header(xmlpp::Element *element,Canvas::Handle parent,bool inline_,const FileSystem::Identifier &identifier,String filename,bool &found)
 {
-
-	if(element->get_name()!="canvas")
-	{
-		error_unexpected_element(element,element->get_name(),"canvas");
-		return Canvas::Handle();
-	}
+	found=false;
 	Canvas::Handle canvas;
 
-
-
 	if(parent && (element->get_attribute("id") || inline_))
 	{
 		if(inline_)
@@ -3196,7 +3256,10 @@ CanvasParser::parse_canvas(xmlpp::Element *element,Canvas::Handle parent,bool in
 	{
 		GUID guid(element->get_attribute("guid")->get_value());
 		if(guid_cast<Canvas>(guid))
+		{
+			found=true;
 			return guid_cast<Canvas>(guid);
+		}
 		else
 			canvas->set_guid(guid);
 	}
@@ -3316,165 +3379,162 @@ CanvasParser::parse_canvas(xmlpp::Element *element,Canvas::Handle parent,bool in
 	}
 
 	canvas->rend_desc().set_flags(RendDesc::PX_ASPECT|RendDesc::IM_SPAN);
+	return canvas;
+}
 
-	std::list<ValueNode::Handle> bone_list;
-	xmlpp::Element::NodeList list = element->get_children();
-	for(xmlpp::Element::NodeList::iterator iter = list.begin(); iter != list.end(); ++iter)
+void
+CanvasParser::parse_canvas_child(xmlpp::Element *child,Canvas::Handle canvas)
+{
+	if(child->get_name()=="defs")
 	{
-		xmlpp::Element *child(dynamic_cast<xmlpp::Element*>(*iter));
-		if(child)
+		if(canvas->is_inline())
+			error(child,_("Group canvases cannot have a <defs> section"));
+		parse_canvas_defs(child, canvas);
+	}
+	else
+	if(child->get_name()=="bones")
+	{
+		if(canvas->is_inline())
+			error(child,_("Inline canvas cannot have a <bones> section"));
+		parse_canvas_bones(child, canvas);
+	}
+	else
+	if(child->get_name()=="keyframe")
+	{
+		if(canvas->is_inline())
 		{
-			if(child->get_name()=="defs")
-			{
-				if(canvas->is_inline())
-					error(child,_("Group canvases cannot have a <defs> section"));
-				parse_canvas_defs(child, canvas);
-			}
-			else
-			if(child->get_name()=="bones")
-			{
-				if(canvas->is_inline())
-					error(child,_("Inline canvas cannot have a <bones> section"));
-				bone_list = parse_canvas_bones(child, canvas);
-			}
-			else
-			if(child->get_name()=="keyframe")
-			{
-				if(canvas->is_inline())
-				{
-					warning(child,_("Group canvases cannot have keyframes"));
-					continue;
-				}
+			warning(child,_("Group canvases cannot have keyframes"));
+			return;
+		}
 
-				canvas->keyframe_list().add(parse_keyframe(child,canvas));
-				canvas->keyframe_list().sync();
-			}
-			else
-			if(child->get_name()=="meta")
-			{
-				if(canvas->is_inline())
-				{
-					warning(child,_("Group canvases cannot have metadata"));
-					continue;
-				}
+		canvas->keyframe_list().add(parse_keyframe(child,canvas));
+		canvas->keyframe_list().sync();
+	}
+	else
+	if(child->get_name()=="meta")
+	{
+		if(canvas->is_inline())
+		{
+			warning(child,_("Group canvases cannot have metadata"));
+			return;
+		}
 
-				if(!child->get_attribute("name"))
-				{
-					warning(child,_("<meta> must have a name"));
-					continue;
-				}
+		if(!child->get_attribute("name"))
+		{
+			warning(child,_("<meta> must have a name"));
+			return;
+		}
 
-				if(!child->get_attribute("content"))
-				{
-					warning(child,_("<meta> must have content"));
-					continue;
-				}
-				
-				std::string meta_name = child->get_attribute("name")->get_value();
-				std::string content = child->get_attribute("content")->get_value();
-
-				// In Synfig prior to version 1.0 we have messed decimal separator:
-				// some files use ".", but other ones use ","/
-				// Let's try to put a workaround for that.
-				std::vector<String> replacelist;
-				replacelist.push_back("background_first_color");
-				replacelist.push_back("background_second_color");
-				replacelist.push_back("background_size");
-				replacelist.push_back("grid_color");
-				replacelist.push_back("grid_size");
-				replacelist.push_back("jack_offset");
-				if(std::find(replacelist.begin(), replacelist.end(), meta_name) != replacelist.end())
-				{
-					size_t index = 0;
-					while (true) {
-					     /* Locate the substring to replace. */
-					     index = content.find(',', index);
-					     if (index == std::string::npos) break;
+		if(!child->get_attribute("content"))
+		{
+			warning(child,_("<meta> must have content"));
+			return;
+		}
+		
+		std::string meta_name = child->get_attribute("name")->get_value();
+		std::string content = child->get_attribute("content")->get_value();
 
-					     /* Make the replacement. */
-					     content.replace(index, 1, ".");
+		// In Synfig prior to version 1.0 we have messed decimal separator:
+		// some files use ".", but other ones use ","/
+		// Let's try to put a workaround for that.
+		std::vector<String> replacelist;
+		replacelist.push_back("background_first_color");
+		replacelist.push_back("background_second_color");
+		replacelist.push_back("background_size");
+		replacelist.push_back("grid_color");
+		replacelist.push_back("grid_size");
+		replacelist.push_back("jack_offset");
+		if(std::find(replacelist.begin(), replacelist.end(), meta_name) != replacelist.end())
+		{
+			size_t index = 0;
+			while (true) {
+			     /* Locate the substring to replace. */
+			     index = content.find(',', index);
+			     if (index == std::string::npos) break;
 
-					     /* Advance index forward so the next iteration doesn't pick it up as well. */
-					     index += 1;
-					}
-					
-				}
+			     /* Make the replacement. */
+			     content.replace(index, 1, ".");
 
-				// Commit b172e37 (#2777) changed guide lines storage to give them rotation ability
-				if (meta_name == "guide_x") {
-					upgrade_guide_metadata(content, canvas->get_meta_data("guide"), true);
-					meta_name = "guide";
-				}
+			     /* Advance index forward so the next iteration doesn't pick it up as well. */
+			     index += 1;
+			}
+			
+		}
 
-				if (meta_name == "guide_y") {
-					upgrade_guide_metadata(content, canvas->get_meta_data("guide"), false);
-					meta_name = "guide";
-				}
+		// Commit b172e37 (#2777) changed guide lines storage to give them rotation ability
+		if (meta_name == "guide_x") {
+			upgrade_guide_metadata(content, canvas->get_meta_data("guide"), true);
+			meta_name = "guide";
+		}
 
-				canvas->set_meta_data(meta_name, content);
-			}
-			else if(child->get_name()=="name")
-			{
-				xmlpp::Element::NodeList list = child->get_children();
+		if (meta_name == "guide_y") {
+			upgrade_guide_metadata(content, canvas->get_meta_data("guide"), false);
+			meta_name = "guide";
+		}
 
-				// If we don't have any name, warn
-				if(list.empty())
-					warning(child,_("blank \"name\" entity"));
+		canvas->set_meta_data(meta_name, content);
+	}
+	else if(child->get_name()=="name")
+	{
+		xmlpp::Element::NodeList list = child->get_children();
 
-				std::string tmp;
-				for(xmlpp::Element::NodeList::iterator iter = list.begin(); iter != list.end(); ++iter)
-					if(dynamic_cast<xmlpp::TextNode*>(*iter))tmp+=dynamic_cast<xmlpp::TextNode*>(*iter)->get_content();
-				canvas->set_name(tmp);
-			}
-			else
-			if(child->get_name()=="desc")
-			{
+		// If we don't have any name, warn
+		if(list.empty())
+			warning(child,_("blank \"name\" entity"));
 
-				xmlpp::Element::NodeList list = child->get_children();
+		std::string tmp;
+		for(xmlpp::Element::NodeList::iterator iter = list.begin(); iter != list.end(); ++iter)
+			if(dynamic_cast<xmlpp::TextNode*>(*iter))tmp+=dynamic_cast<xmlpp::TextNode*>(*iter)->get_content();
+		canvas->set_name(tmp);
+	}
+	else
+	if(child->get_name()=="desc")
+	{
 
-				// If we don't have any description, warn
-				if(list.empty())
-					warning(child,_("blank \"desc\" entity"));
+		xmlpp::Element::NodeList list = child->get_children();
 
-				std::string tmp;
-				for(xmlpp::Element::NodeList::iterator iter = list.begin(); iter != list.end(); ++iter)
-					if(dynamic_cast<xmlpp::TextNode*>(*iter))tmp+=dynamic_cast<xmlpp::TextNode*>(*iter)->get_content();
-				canvas->set_description(tmp);
-			}
-			else
-			if(child->get_name()=="author")
-			{
+		// If we don't have any description, warn
+		if(list.empty())
+			warning(child,_("blank \"desc\" entity"));
 
-				xmlpp::Element::NodeList list = child->get_children();
+		std::string tmp;
+		for(xmlpp::Element::NodeList::iterator iter = list.begin(); iter != list.end(); ++iter)
+			if(dynamic_cast<xmlpp::TextNode*>(*iter))tmp+=dynamic_cast<xmlpp::TextNode*>(*iter)->get_content();
+		canvas->set_description(tmp);
+	}
+	else
+	if(child->get_name()=="author")
+	{
 
-				// If we don't have any description, warn
-				if(list.empty())
-					warning(child,_("blank \"author\" entity"));
+		xmlpp::Element::NodeList list = child->get_children();
 
-				std::string tmp;
-				for(xmlpp::Element::NodeList::iterator iter = list.begin(); iter != list.end(); ++iter)
-					if(dynamic_cast<xmlpp::TextNode*>(*iter))tmp+=dynamic_cast<xmlpp::TextNode*>(*iter)->get_content();
-				canvas->set_author(tmp);
-			}
-			else
-			if(child->get_name()=="layer")
-			{
-				//if(canvas->is_inline())
-				//	canvas->push_front(parse_layer(child,canvas->parent()));
-				//else
-					canvas->push_front(parse_layer(child,canvas));
-			}
-			else
-			{
-				printf("%s:%d\n", __FILE__, __LINE__);
-				error_unexpected_element(child,child->get_name());
-			}
-		}
-//		else
-//		if((child->get_name()=="text"||child->get_name()=="comment") && child->has_child_text())
-//			continue;
+		// If we don't have any description, warn
+		if(list.empty())
+			warning(child,_("blank \"author\" entity"));
+
+		std::string tmp;
+		for(xmlpp::Element::NodeList::iterator iter = list.begin(); iter != list.end(); ++iter)
+			if(dynamic_cast<xmlpp::TextNode*>(*iter))tmp+=dynamic_cast<xmlpp::TextNode*>(*iter)->get_content();
+		canvas->set_author(tmp);
+	}
+	else
+	if(child->get_name()=="layer")
+	{
+		//if(canvas->is_inline())
+		//	canvas->push_front(parse_layer(child,canvas->parent()));
+		//else
+			canvas->push_front(parse_layer(child,canvas));
 	}
+	else
+	{
+		printf("%s:%d\n", __FILE__, __LINE__);
+		error_unexpected_element(child,child->get_name());
+	}
+}
 
+void
+CanvasParser::parse_canvas_end(xmlpp::Element *element,Canvas::Handle canvas)
+{
 	if(canvas->value_node_list().placeholder_count())
 	{
 		String nodes;
@@ -3492,6 +3552,152 @@ CanvasParser::parse_canvas(xmlpp::Element *element,Canvas::Handle parent,bool in
 	}
 
 	canvas->set_version(CURRENT_CANVAS_VERSION);
+}
+
+Canvas::Handle
+CanvasParser::parse_canvas(xmlpp::Element *element,Canvas::Handle parent,bool inline_,const FileSystem::Identifier &identifier,String filename)
+{
+	if(element->get_name()!="canvas")
+	{
+		error_unexpected_element(element,element->get_name(),"canvas");
+		return Canvas::Handle();
+	}
+
+	bool found;
+	Canvas::Handle canvas(parse_canvas_header(element,parent,inline_,identifier,filename,found));
+	if(found)
+		return canvas;
+
+	xmlpp::Element::NodeList list = element->get_children();
+	for(xmlpp::Element::NodeList::iterator iter = list.begin(); iter != list.end(); ++iter)
+		if(xmlpp::Element *child = dynamic_cast<xmlpp::Element*>(*iter))
+			parse_canvas_child(child,canvas);
+
+	parse_canvas_end(element,canvas);
+	return canvas;
+}
+
+Canvas::Handle
+CanvasParser::parse_canvas_stream(std::istream &stream,const FileSystem::Identifier &identifier,String filename)
+{
+	// the reader pulls the text from the stream chunk by chunk,
+	// so neither the text nor the tree of the whole document is kept in memory
+	std::unique_ptr<xmlTextReader, ReaderDeleter> reader(
+		xmlReaderForIO(read_stream_callback, close_stream_callback, &stream, filename.c_str(), nullptr, 0) );
+	if(!reader)
+		throw xmlpp::internal_error("Couldn't create parsing context");
+
+	String reader_errors;
+	xmlTextReaderSetErrorHandler(reader.get(), reader_error_callback, &reader_errors);
+	const auto throw_parse_error = [&reader_errors]() {
+		throw xmlpp::parse_error(reader_errors.empty() ? String("Document not well-formed.") : reader_errors);
+	};
+
+	int ret;
+	while((ret = xmlTextReaderRead(reader.get())) == 1)
+		if(xmlTextReaderNodeType(reader.get()) == XML_READER_TYPE_ELEMENT)
+			break;
+	if(ret != 1)
+		throw_parse_error();
+
+	// copy the root element without children, so the reader is free to drop them
+	xmlpp::Document root_document;
+	xmlpp::Element *root = root_document.create_root_node((const char*)xmlTextReaderConstName(reader.get()));
+	root->cobj()->line = xmlTextReaderCurrentNode(reader.get())->line;
+	while(xmlTextReaderMoveToNextAttribute(reader.get()) == 1)
+		root->set_attribute(
+			(const char*)xmlTextReaderConstName(reader.get()),
+			(const char*)xmlTextReaderConstValue(reader.get()) );
+	xmlTextReaderMoveToElement(reader.get());
+
+	if(root->get_name()!="canvas")
+	{
+		error_unexpected_element(root,root->get_name(),"canvas");
+		return Canvas::Handle();
+	}
+
+	bool found;
+	Canvas::Handle canvas(parse_canvas_header(root,nullptr,false,identifier,filename,found));
+	if(found)
+		return canvas;
+
+	// the canvas is registered by the caller only when the whole document is parsed,
+	// so if the document turns out to be broken nothing of it is kept
+	try
+	{
+		// expand and parse the top-level elements one by one
+		if(!xmlTextReaderIsEmptyElement(reader.get()))
+		{
+			ret = xmlTextReaderRead(reader.get());
+			while(ret == 1 && xmlTextReaderDepth(reader.get()) > 0)
+			{
+				if(xmlTextReaderNodeType(reader.get()) != XML_READER_TYPE_ELEMENT)
+				{
+					ret = xmlTextReaderRead(reader.get());
+					continue;
+				}
+				xmlNodePtr node = xmlTextReaderExpand(reader.get());
+				if(!node)
+					throw_parse_error();
+				{
+					ExpandedElement child(node);
+					parse_canvas_child(child.get(),canvas);
+				}
+				ret = xmlTextReaderNext(reader.get());
+			}
+		}
+
+		// the rest of the document must be well-formed too, as for DomParser
+		while(ret == 1)
+			ret = xmlTextReaderRead(reader.get());
+		if(ret != 0)
+			throw_parse_error();
+	}
+	catch(...)
+	{
+		// drop the layers now, they may keep the external canvases loaded for them
+		canvas->clear();
+		throw;
+	}
+
+	parse_canvas_end(root,canvas);
+	return canvas;
+}
+
+Canvas::Handle
+CanvasParser::parse_canvas_binary(const char *data,size_t size,const FileSystem::Identifier &identifier,String filename)
+{
+	CanvasBinary::Reader reader;
+	if(!reader.open(data,size))
+		throw std::runtime_error(String("  * ") + _("Can't read binary canvas") + " \"" + filename + "\": " + reader.get_error());
+
+	// build the top-level elements one by one under a copy of the root, like parse_canvas_stream()
+	xmlpp::Document root_document;
+	xmlpp::Element *root = root_document.create_root_node(reader.get_string(reader.get_node(0).name));
+	reader.copy_attributes(0,root);
+
+	if(root->get_name()!="canvas")
+	{
+		error_unexpected_element(root,root->get_name(),"canvas");
+		return Canvas::Handle();
+	}
+
+	bool found;
+	Canvas::Handle canvas(parse_canvas_header(root,nullptr,false,identifier,filename,found));
+	if(found)
+		return canvas;
+
+	const size_t end = reader.get_node(0).end;
+	for(size_t i = 1; i < end; i = reader.get_node(i).end)
+	{
+		if(reader.get_node(i).kind != CanvasBinary::NODE_ELEMENT)
+			continue;
+		xmlpp::Node *child = reader.build(i,root);
+		parse_canvas_child(static_cast<xmlpp::Element*>(child),canvas);
+		root->remove_child(child);
+	}
+
+	parse_canvas_end(root,canvas);
 	return canvas;
 }
 
@@ -3536,11 +3742,52 @@ CanvasParser::parse_from_file_as(const FileSystem::Identifier &identifier,const
 		total_warnings_=0;
 		
 		synfig::info(String("Loading file: ") + filename);
-		FileSystem::ReadStream::Handle stream = identifier.get_read_stream();
+		const auto open_stream = [&identifier]() {
+			FileSystem::ReadStream::Handle stream = identifier.get_read_stream();
+			if (stream && identifier.filename.extension().u8string() == ".sifz")
+				stream = FileSystem::ReadStream::Handle(new ZReadStream(stream, zstreambuf::compression::gzip));
+			return stream;
+		};
+		FileSystem::ReadStream::Handle stream = open_stream();
 		if (stream)
 		{
-			if (identifier.filename.extension().u8string() == ".sifz")
-				stream = FileSystem::ReadStream::Handle(new ZReadStream(stream, zstreambuf::compression::gzip));
+			if (identifier.filename.extension().u8string() == ".sifb")
+			{
+				std::vector<char> data;
+				read_stream_data(*stream,data);
+				stream.reset();
+				Canvas::Handle canvas(parse_canvas_binary(data.empty() ? nullptr : &data.front(),data.size(),identifier,as));
+				if (!canvas) return canvas;
+				register_canvas_in_map(canvas, as);
+
+				return canvas;
+			}
+
+			if(streaming_ && !getenv("SYNFIG_LOAD_CANVAS_DOM"))
+			{
+				Canvas::Handle canvas;
+				try
+				{
+					canvas = parse_canvas_stream(*stream,identifier,as);
+				}
+				catch(xmlpp::parse_error&)
+				{
+					// the file is broken, read it once more
+					// to report the error in the same words as the DOM path
+					stream = open_stream();
+					if (stream)
+					{
+						xmlpp::DomParser parser;
+						parser.parse_stream(*stream);
+					}
+					throw;
+				}
+				stream.reset();
+				if (!canvas) return canvas;
+				register_canvas_in_map(canvas, as);
+
+				return canvas;
+			}
 
 			xmlpp::DomParser parser;
 			parser.parse_stream(*stream);
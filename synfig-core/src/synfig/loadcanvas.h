@@ -32,6 +32,8 @@
 
 /* === H E A D E R S ======================================================= */
 
+#include <iosfwd>
+
 #include "string.h"
 #include "canvas.h"
 #include "valuenode.h"
@@ -87,6 +89,8 @@ private:
 	GUID guid_;
 	//
 	bool in_bones_section;
+	//! True if files are read element by element instead of the whole DOM
+	bool streaming_;
 
 	/*
  --	** -- C O N S T R U C T O R S ---------------------------------------------
@@ -99,7 +103,8 @@ public:
 		total_warnings_	(0),
 		total_errors_	(0),
 		allow_errors_	(false),
-		in_bones_section(false)
+		in_bones_section(false),
+		streaming_		(true)
 	{ }
 
 	/*
@@ -111,6 +116,12 @@ public:
 	//! Sets allow errors variable
 	CanvasParser &set_allow_errors(bool x) { allow_errors_=x; return *this; }
 
+	//! Sets whether files are parsed as a stream of top-level elements,
+	//! or loaded into a DOM first. Streaming keeps only one layer of the root
+	//! canvas in memory at a time, results and errors are the same.
+	//! SYNFIG_LOAD_CANVAS_DOM environment variable forces the DOM parser.
+	CanvasParser &set_streaming(bool x) { streaming_=x; return *this; }
+
 	//! Sets the maximum number of warnings before a fatal error is thrown
 	CanvasParser &set_max_warnings(int i) { max_warnings_=i; return *this; }
 
@@ -167,6 +178,18 @@ private:
 
 	//! Canvas Parsing Function
 	Canvas::Handle parse_canvas(xmlpp::Element *node,Canvas::Handle parent=0,bool inline_=false,const FileSystem::Identifier &identifier = FileSystemNative::instance()->get_identifier(std::string()),String path=".");
+	//! Root Canvas Parsing Function, reads the stream with xmlTextReader
+	//! and expands the top-level elements one at a time
+	Canvas::Handle parse_canvas_stream(std::istream &stream,const FileSystem::Identifier &identifier,String path);
+	//! Root Canvas Parsing Function for the binary form, see CanvasBinary
+	Canvas::Handle parse_canvas_binary(const char *data,size_t size,const FileSystem::Identifier &identifier,String path);
+	//! Creates the canvas and reads the attributes of <canvas>.
+	//! Sets \a found if the canvas with the same guid already exists, so its content must be skipped
+	Canvas::Handle parse_canvas_header(xmlpp::Element *node,Canvas::Handle parent,bool inline_,const FileSystem::Identifier &identifier,String path,bool &found);
+	//! Parses a child element of <canvas>: layer, defs, keyframe, meta etc.
+	void parse_canvas_child(xmlpp::Element *node,Canvas::Handle canvas);
+	//! Checks the canvas after all children are parsed
+	void parse_canvas_end(xmlpp::Element *node,Canvas::Handle canvas);
 	//! Canvas definitions Parsing Function (exported value nodes and exported canvases)
 	void parse_canvas_defs(xmlpp::Element *node,Canvas::Handle canvas);
 
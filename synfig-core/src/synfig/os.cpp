@@ -373,6 +373,14 @@ public:
 	{
 		return fgetc(read_file);
 	}
+	size_t read(void* ptr, size_t size, size_t n) override
+	{
+		if (!read_file) {
+			synfig::error(_("Should not try to read() a non-readable pipe"));
+			return 0;
+		}
+		return fread(ptr, size, n, read_file);
+	}
 	int scanf(const char* __format, ...) override
 	{
 		va_list args;
@@ -684,6 +692,14 @@ public:
 		return "";
 	}
 	int getc() override { return fgetc(read_file); }
+	size_t read(void* ptr, size_t size, size_t n) override
+	{
+		if (!read_file) {
+			synfig::error(_("Should not try to read() a non-readable pipe"));
+			return 0;
+		}
+		return fread(ptr, size, n, read_file);
+	}
 	int scanf(const char* __format, ...) override
 	{
 		va_list args;
@@ -0,0 +1,120 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file paramid.cpp
+**	\brief Interned names of layer parameters
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include "paramid.h"
+
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+
+#endif
+
+/* === U S I N G =========================================================== */
+
+using namespace synfig;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+namespace {
+
+struct Registry
+{
+	std::mutex mutex;
+	// deque keeps addresses of the names when it grows
+	std::deque<String> names;
+	std::map<String, int> ids;
+};
+
+Registry&
+registry()
+{
+	// IDs are created from static initializers of other files
+	static Registry registry;
+	return registry;
+}
+
+} // END of anonymous namespace
+
+/* === M E T H O D S ======================================================= */
+
+ParamID::ParamID(const String &name)
+{
+	Registry &r = registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+	std::map<String, int>::const_iterator i = r.ids.find(name);
+	if (i == r.ids.end()) {
+		i = r.ids.insert(std::make_pair(name, (int)r.names.size())).first;
+		r.names.push_back(name);
+	}
+	id_ = i->second;
+	name_ = &r.names[id_];
+}
+
+ParamID
+ParamID::find(const String &name)
+{
+	Registry &r = registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+	std::map<String, int>::const_iterator i = r.ids.find(name);
+	if (i == r.ids.end())
+		return ParamID();
+	return ParamID(i->second, &r.names[i->second]);
+}
+
+ParamID
+ParamID::from_member_name(const char *member_name, const char *prefix)
+{
+	const size_t prefix_length = strlen(prefix);
+	if (strncmp(member_name, prefix, prefix_length))
+		return ParamID();
+	return ParamID(String(member_name + prefix_length));
+}
+
+int
+ParamID::count()
+{
+	Registry &r = registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+	return (int)r.names.size();
+}
+
+const String&
+ParamID::get_name() const
+{
+	static const String empty_name;
+	return name_ ? *name_ : empty_name;
+}
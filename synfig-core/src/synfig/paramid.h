@@ -0,0 +1,101 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file paramid.h
+**	\brief Interned names of layer parameters
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_PARAMID_H
+#define __SYNFIG_PARAMID_H
+
+/* === H E A D E R S ======================================================= */
+
+#include "string.h"
+
+/* === M A C R O S ========================================================= */
+
+//! ParamID of the member \a x of a layer, "param_origin" gives "origin".
+//! The name is interned once per place where the macro is used.
+#define SYNFIG_PARAM_ID_OF_MEMBER(x) \
+	([]() -> const synfig::ParamID& { \
+		static const synfig::ParamID id(synfig::ParamID::from_member_name(#x)); \
+		return id; }())
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig {
+
+/*!	\class ParamID
+**	\brief Integer ID of a parameter name
+**
+**	Every distinct name is registered once and keeps its ID and its single
+**	String instance until the program ends. IDs are compared as integers,
+**	and a name passed as the String of an ID matches it by address,
+**	so set_param() chains don't have to compare characters.
+*/
+class ParamID
+{
+private:
+	int id_;
+	const String *name_;
+
+	ParamID(int id, const String *name): id_(id), name_(name) { }
+
+public:
+	//! Invalid ID, doesn't match any name
+	ParamID(): id_(-1), name_(nullptr) { }
+	//! Registers \a name if it is new and returns its ID
+	explicit ParamID(const String &name);
+
+	//! Returns the ID of \a name if it is registered already, or an invalid ID.
+	//! Use it for names read from files, so they don't fill the registry
+	static ParamID find(const String &name);
+
+	//! Returns the ID for the layer member \a member_name without \a prefix,
+	//! or an invalid ID if the member name doesn't start with \a prefix
+	static ParamID from_member_name(const char *member_name, const char *prefix = "param_");
+
+	//! Returns the number of names registered so far
+	static int count();
+
+	bool is_valid() const { return name_ != nullptr; }
+	int get_id() const { return id_; }
+	//! Returns the registered instance of the name, or an empty string for an invalid ID
+	const String& get_name() const;
+
+	//! Returns true if \a name is the name of this ID
+	bool is_name(const String &name) const
+		{ return name_ && (&name == name_ || *name_ == name); }
+
+	bool operator==(const ParamID &other) const { return id_ == other.id_; }
+	bool operator!=(const ParamID &other) const { return id_ != other.id_; }
+	bool operator<(const ParamID &other) const { return id_ < other.id_; }
+}; // END of class ParamID
+
+}; // END of namespace synfig
+
+/* === E N D =============================================================== */
+
+#endif
@@ -32,11 +32,15 @@
 #	include <config.h>
 #endif
 
+#include <algorithm>
+
 #include <synfig/general.h>
 #include <synfig/localization.h>
+#include <synfig/threadpool.h>
 
 #include "optimizerblendmerge.h"
 
+#include "../task/taskaccumulate.h"
 #include "../task/taskblend.h"
 
 #endif
@@ -96,6 +100,68 @@ OptimizerBlendMerge::run(const RunParams& params) const
 			apply(params, new_blend);
 		}
 	}
+
+	//
+	// merge nested accumulation (only for associative blend methods)
+	//
+	//  accumulateA(targetA)
+	//  - taskB(targetB)
+	//  - accumulateC(targetC) - with amount 1
+	//    - taskD(targetD)
+	//    - taskE(targetE)
+	//
+	// converts to:
+	//
+	//  accumulateA(targetA)
+	//  - taskB(targetB)
+	//  - taskD(targetD)
+	//  - taskE(targetE)
+	//
+	// but not more inputs than TaskAccumulate::build_groups() puts together
+	//
+
+	TaskAccumulate::Handle accumulate = TaskAccumulate::Handle::cast_dynamic(params.ref_task);
+	if ( accumulate
+	  && ((1 << accumulate->blend_method) & Color::BLEND_METHODS_ASSOCIATIVE) )
+	{
+		const int max_inputs = std::max(2, ThreadPool::instance().get_max_threads());
+		int count = (int)accumulate->sub_tasks.size();
+		bool found = false;
+		std::vector<TaskAccumulate::Handle> sub_accumulates(accumulate->sub_tasks.size());
+		for(int i = 0; i < (int)accumulate->sub_tasks.size(); ++i)
+		{
+			TaskAccumulate::Handle sub_accumulate = TaskAccumulate::Handle::cast_dynamic(accumulate->sub_tasks[i]);
+			if ( sub_accumulate
+			  && sub_accumulate->blend_method == accumulate->blend_method
+			  && approximate_equal_lp(accumulate->get_amount(i), ColorReal(1.0))
+			  && count - 1 + (int)sub_accumulate->sub_tasks.size() <= max_inputs )
+			{
+				sub_accumulates[i] = sub_accumulate;
+				count += (int)sub_accumulate->sub_tasks.size() - 1;
+				found = true;
+			}
+		}
+
+		if (found)
+		{
+			TaskAccumulate::Handle new_accumulate = TaskAccumulate::Handle::cast_dynamic(accumulate->clone());
+			new_accumulate->sub_tasks.clear();
+			new_accumulate->amounts.clear();
+			for(int i = 0; i < (int)accumulate->sub_tasks.size(); ++i)
+			{
+				if (sub_accumulates[i])
+				{
+					for(int j = 0; j < (int)sub_accumulates[i]->sub_tasks.size(); ++j)
+						new_accumulate->add(sub_accumulates[i]->sub_tasks[j], sub_accumulates[i]->get_amount(j));
+				}
+				else
+				{
+					new_accumulate->add(accumulate->sub_tasks[i], accumulate->get_amount(i));
+				}
+			}
+			apply(params, new_accumulate);
+		}
+	}
 }
 
 /* === E N T R Y P O I N T ================================================= */
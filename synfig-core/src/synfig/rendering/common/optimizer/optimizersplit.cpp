@@ -75,15 +75,19 @@ OptimizerSplit::run(const RunParams &params) const
 			{
 				int hh = h/t;
 				int y = r.miny;
+				Task::List bands;
 				for(int j = 1; j < t; ++j, y += hh)
 				{
 					Task::Handle task = (*i)->clone();
 					task->trunc_target_rect( RectInt(r.minx, y, r.maxx, y + hh) );
+					bands.push_back(task);
 					i = params.list->insert(i, task);
 					++i;
 				}
 				*i = (*i)->clone();
 				(*i)->trunc_target_rect( RectInt(r.minx, y, r.maxx, r.maxy) );
+				bands.push_back(*i);
+				bands.front().type_pointer<TaskInterfaceSplit>()->on_split(bands, r);
 				apply(params);
 			}
 		}
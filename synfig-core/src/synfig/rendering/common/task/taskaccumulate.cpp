@@ -0,0 +1,154 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/common/task/taskaccumulate.cpp
+**	\brief TaskAccumulate
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <algorithm>
+
+#include "taskaccumulate.h"
+#include "taskblend.h"
+
+#endif
+
+using namespace synfig;
+using namespace rendering;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+/* === P R O C E D U R E S ================================================= */
+
+/* === M E T H O D S ======================================================= */
+
+
+SYNFIG_EXPORT Task::Token TaskAccumulate::token(
+	DescAbstract<TaskAccumulate>("Accumulate") );
+
+int
+TaskAccumulate::get_pass_subtask_index() const
+{
+	// nothing can be blended onto the empty target
+	if (Color::is_onto(blend_method))
+		return PASSTO_NO_TASK;
+
+	int index = PASSTO_NO_TASK;
+	for(int i = 0; i < (int)sub_tasks.size(); ++i) {
+		if (!sub_tasks[i] || approximate_zero_lp(get_amount(i)))
+			continue;
+		if (index != PASSTO_NO_TASK)
+			return PASSTO_THIS_TASK;
+		index = i;
+	}
+
+	if ( index != PASSTO_NO_TASK
+	  && ( blend_method != Color::BLEND_COMPOSITE
+	    || !approximate_equal_lp(get_amount(index), ColorReal(1.0)) ))
+		return PASSTO_THIS_TASK;
+	return index;
+}
+
+bool
+TaskAccumulate::hash_params(TaskHash &hash) const
+{
+	hash.add(blend_method);
+	for(int i = 0; i < (int)sub_tasks.size(); ++i)
+		hash.add(get_amount(i));
+	return true;
+}
+
+Rect
+TaskAccumulate::calc_bounds() const
+{
+	// the same as for the chain of TaskBlend
+	Rect bounds = Rect::zero();
+	for(int i = 0; i < (int)sub_tasks.size(); ++i) {
+		Rect rb = sub_tasks[i] ? sub_tasks[i]->get_bounds() : Rect::zero();
+		Rect r = bounds | rb;
+		if (Color::is_onto(blend_method))
+			r &= bounds;
+		if (approximate_equal(get_amount(i), Color::value_type(1)) && Color::is_straight(blend_method))
+			r &= rb;
+		bounds = r;
+	}
+	return bounds;
+}
+
+Task::Handle
+TaskAccumulate::build_groups(int max_inputs) const
+{
+	if (!((1 << blend_method) & Color::BLEND_METHODS_ASSOCIATIVE))
+	{
+		// order of blending is significant
+		Task::Handle task;
+		for(int i = 0; i < (int)sub_tasks.size(); ++i)
+		{
+			TaskBlend::Handle task_blend(new TaskBlend());
+			task_blend->amount = get_amount(i);
+			task_blend->blend_method = blend_method;
+			task_blend->sub_task_a() = task;
+			task_blend->sub_task_b() = sub_tasks[i];
+			task = task_blend;
+		}
+		return task;
+	}
+
+	max_inputs = std::max(2, max_inputs);
+	TaskAccumulate::Handle accumulate = TaskAccumulate::Handle::cast_dynamic(clone());
+	while((int)accumulate->sub_tasks.size() > max_inputs)
+	{
+		Task::List tasks;
+		std::vector<Color::value_type> amounts;
+		for(int i = 0; i < (int)accumulate->sub_tasks.size(); i += max_inputs)
+		{
+			const int count = std::min(max_inputs, (int)accumulate->sub_tasks.size() - i);
+			if (count == 1)
+			{
+				tasks.push_back(accumulate->sub_tasks[i]);
+				amounts.push_back(accumulate->get_amount(i));
+				continue;
+			}
+
+			TaskAccumulate::Handle group(new TaskAccumulate());
+			group->blend_method = blend_method;
+			for(int j = i; j < i + count; ++j)
+				group->add(accumulate->sub_tasks[j], accumulate->get_amount(j));
+			tasks.push_back(group);
+			amounts.push_back(1.0);
+		}
+		accumulate->sub_tasks.swap(tasks);
+		accumulate->amounts.swap(amounts);
+	}
+	return accumulate;
+}
+
+/* === E N T R Y P O I N T ================================================= */
@@ -0,0 +1,100 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/common/task/taskaccumulate.h
+**	\brief TaskAccumulate Header
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_RENDERING_TASKACCUMULATE_H
+#define __SYNFIG_RENDERING_TASKACCUMULATE_H
+
+/* === H E A D E R S ======================================================= */
+
+#include <vector>
+
+#include "../../task.h"
+#include "tasktransformation.h"
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig
+{
+namespace rendering
+{
+
+
+//! Blends all the sub-tasks one by one onto the empty target,
+//! each sub-task with its own amount and with the common blend method.
+//! The result is the same as of the chain of TaskBlend
+//!   blend(... blend(blend(none, sub_task(0)), sub_task(1)) ..., sub_task(n-1)),
+//! but the sub-tasks don't depend on each other and may run simultaneously.
+//! The task is not split into bands by OptimizerSplit, the software
+//! implementation blends bands in parallel by itself, and results of the
+//! sub-tasks may be released when it's done (see Renderer::mark_released_targets()).
+class TaskAccumulate: public Task,
+	public TaskInterfaceTransformationPass
+{
+public:
+	typedef etl::handle<TaskAccumulate> Handle;
+	SYNFIG_EXPORT static Token token;
+	virtual Token::Handle get_token() const { return token.handle(); }
+
+	Color::BlendMethod blend_method;
+	//! amount for each sub-task
+	std::vector<Color::value_type> amounts;
+
+	TaskAccumulate():
+		blend_method(Color::BLEND_COMPOSITE) { }
+
+	void add(const Task::Handle &task, Color::value_type amount)
+		{ sub_tasks.push_back(task); amounts.push_back(amount); }
+	Color::value_type get_amount(int index) const
+		{ return index >= 0 && index < (int)amounts.size() ? amounts[index] : Color::value_type(1.0); }
+
+	VectorInt get_offset(int index) const
+		{ return sub_task(index) ? TaskList::calc_target_offset(*this, *sub_task(index)) : VectorInt(); }
+
+	virtual int get_pass_subtask_index() const;
+	virtual bool hash_params(TaskHash &hash) const;
+	virtual Rect calc_bounds() const;
+
+	//! Builds the task with the same result, where only a few of sub-tasks
+	//! are blended together. Results of all sub-tasks of one accumulation are
+	//! kept until it runs, so for the associative blend methods the sub-tasks
+	//! are grouped into the tree of accumulations with at most \a max_inputs
+	//! sub-tasks in each. For other methods the chain of TaskBlend is built,
+	//! it paints the sub-tasks one by one onto the common target.
+	Task::Handle build_groups(int max_inputs) const;
+};
+
+
+} /* end namespace rendering */
+} /* end namespace synfig */
+
+/* -- E N D ----------------------------------------------------------------- */
+
+#endif
@@ -54,6 +54,14 @@ using namespace rendering;
 SYNFIG_EXPORT Task::Token TaskBlur::token(
 	DescAbstract<TaskBlur>("Blur") );
 
+bool
+TaskBlur::hash_params(TaskHash &hash) const
+{
+	hash.add(blur.type);
+	hash.add(blur.size);
+	return true;
+}
+
 Rect
 TaskBlur::calc_bounds() const
 {
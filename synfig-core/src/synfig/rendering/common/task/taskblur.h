@@ -59,6 +59,7 @@ public:
 	const Task::Handle& sub_task() const { return Task::sub_task(0); }
 	Task::Handle& sub_task() { return Task::sub_task(0); }
 
+	virtual bool hash_params(TaskHash &hash) const;
 	virtual Rect calc_bounds() const;
 	virtual void set_coords_sub_tasks();
 };
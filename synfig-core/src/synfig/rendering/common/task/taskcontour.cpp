@@ -60,4 +60,30 @@ TaskContour::calc_bounds() const
          :                   contour->calc_bounds(transformation->matrix);
 }
 
+bool
+TaskContour::hash_params(TaskHash &hash) const
+{
+	hash.add(detail);
+	hash.add(allow_antialias);
+	hash.add(transformation->matrix);
+	hash.add((bool)contour);
+	if (!contour)
+		return true;
+
+	hash.add(contour->invert);
+	hash.add(contour->antialias);
+	hash.add(contour->winding_style);
+	hash.add(contour->color);
+	hash.add(contour->beginning_of_unclosed());
+	const Contour::ChunkList &chunks = contour->get_chunks();
+	hash.add(chunks.size());
+	for(Contour::ChunkList::const_iterator i = chunks.begin(); i != chunks.end(); ++i) {
+		hash.add(i->type);
+		hash.add(i->p1);
+		hash.add(i->pp0);
+		hash.add(i->pp1);
+	}
+	return true;
+}
+
 /* === E N T R Y P O I N T ================================================= */
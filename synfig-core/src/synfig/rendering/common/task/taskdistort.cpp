@@ -33,6 +33,9 @@
 #  include <config.h>
 # endif
 
+# include <algorithm>
+# include <cmath>
+
 # include "taskdistort.h"
 
 #endif
@@ -70,5 +73,21 @@ rendering::TaskDistort::set_coords_sub_tasks()
 	Matrix inv_matrix = bounds_transformation.get_inverted();
 
 	required_source_rect = compute_required_source_rect(source_rect, inv_matrix);
-	sub_task()->set_coords(required_source_rect, target_rect.get_size());
+
+	// a few more pixels around, so cubic sampling near the edges stays inside the source
+	const Vector upp = get_units_per_pixel();
+	required_source_rect.expand_x(source_margin_pixels*std::fabs(upp[0]));
+	required_source_rect.expand_y(source_margin_pixels*std::fabs(upp[1]));
+
+	// keep the pixel density of the target, so the distorted image stays sharp,
+	// but don't let the source surface grow beyond max_source_area_factor target areas
+	Vector size( std::ceil(required_source_rect.get_width()*std::fabs(ppu[0])),
+	             std::ceil(required_source_rect.get_height()*std::fabs(ppu[1])) );
+	const Real max_area = max_source_area_factor*(Real)target_rect.get_width()*(Real)target_rect.get_height();
+	if (size[0]*size[1] > max_area)
+		size *= std::sqrt(max_area/(size[0]*size[1]));
+
+	sub_task()->set_coords(
+		required_source_rect,
+		VectorInt( std::max(1, (int)std::ceil(size[0])), std::max(1, (int)std::ceil(size[1])) ) );
 }
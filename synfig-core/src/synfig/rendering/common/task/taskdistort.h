@@ -72,6 +72,12 @@ public:
 	 */
 	Rect required_source_rect;
 
+	//! Extra target pixels added on each side of required_source_rect
+	static constexpr int source_margin_pixels = 2;
+	//! The sub task is rendered with the pixel density of this task,
+	//! but its area is limited by this number of target areas
+	static constexpr Real max_source_area_factor = 16.0;
+
 	void set_coords_sub_tasks() override;
 
 	const Task::Handle& sub_task() const { return Task::sub_task(0); }
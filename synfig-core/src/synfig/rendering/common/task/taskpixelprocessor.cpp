@@ -75,4 +75,23 @@ TaskPixelProcessorBase::get_offset() const
 	return VectorInt((int)round(offset[0]), (int)round(offset[1])) - sub_task()->target_rect.get_min();
 }
 
+
+bool
+TaskPixelGamma::hash_params(TaskHash &hash) const
+{
+	hash.add(gamma.get_r());
+	hash.add(gamma.get_g());
+	hash.add(gamma.get_b());
+	return true;
+}
+
+
+bool
+TaskPixelColorMatrix::hash_params(TaskHash &hash) const
+{
+	for(int i = 0; i < 25; ++i)
+		hash.add(matrix.c[i]);
+	return true;
+}
+
 /* === E N T R Y P O I N T ================================================= */
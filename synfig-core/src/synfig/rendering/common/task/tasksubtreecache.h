@@ -0,0 +1,82 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/common/task/tasksubtreecache.h
+**	\brief TaskSubtreeCache Header
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_RENDERING_TASKSUBTREECACHE_H
+#define __SYNFIG_RENDERING_TASKSUBTREECACHE_H
+
+/* === H E A D E R S ======================================================= */
+
+#include "../../task.h"
+#include "../../taskhash.h"
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig
+{
+namespace rendering
+{
+
+
+//! Copies the result of the sub-task into the target.
+//! The sub-task is either the TaskSurface with the surface taken from
+//! the SubtreeCache, or the subtree itself, which renders into its own surface.
+//! Optimizers never retarget the sub-task through this task, so its surface
+//! is complete when the task runs, and it is put into the cache
+//! if store_to_cache is set.
+class TaskSubtreeCache: public Task
+{
+public:
+	typedef etl::handle<TaskSubtreeCache> Handle;
+	SYNFIG_EXPORT static Token token;
+	virtual Token::Handle get_token() const { return token.handle(); }
+
+	//! hash of the subtree, see Renderer::apply_subtree_cache()
+	TaskHash hash;
+	bool store_to_cache;
+
+	TaskSubtreeCache(): store_to_cache() { }
+
+	const Task::Handle& sub_task() const { return Task::sub_task(0); }
+	Task::Handle& sub_task() { return Task::sub_task(0); }
+
+	virtual int get_pass_subtask_index() const
+		{ return sub_task() ? PASSTO_THIS_TASK : PASSTO_NO_TASK; }
+
+	virtual Rect calc_bounds() const;
+};
+
+
+} /* end namespace rendering */
+} /* end namespace synfig */
+
+/* -- E N D ----------------------------------------------------------------- */
+
+#endif
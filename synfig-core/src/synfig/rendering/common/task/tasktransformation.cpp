@@ -137,4 +137,13 @@ TaskTransformationAffine::get_pass_subtask_index() const
 	return TaskTransformation::get_pass_subtask_index();
 }
 
+bool
+TaskTransformationAffine::hash_params(TaskHash &hash) const
+{
+	hash.add(interpolation);
+	hash.add(supersample);
+	hash.add(transformation->matrix);
+	return true;
+}
+
 /* === E N T R Y P O I N T ================================================= */
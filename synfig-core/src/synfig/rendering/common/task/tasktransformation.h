@@ -117,6 +117,7 @@ public:
 		{ return transformation.handle(); }
 
 	virtual int get_pass_subtask_index() const;
+	virtual bool hash_params(TaskHash &hash) const;
 };
 
 
@@ -39,6 +39,7 @@
 
 #include <algorithm> // std::sort
 #include <cassert>
+#include <limits>
 
 #include <synfig/general.h>
 #include <synfig/localization.h>
@@ -136,6 +137,40 @@ Polyspan::close()
 	}
 }
 
+//take the marks of a closed and sorted polyspan which fall into the window
+void
+Polyspan::crop(const Polyspan &polyspan, const RectInt &window)
+{
+	init(window);
+	flags = 0;
+
+	// the window clipping of line_to() ignores lines above and below the window,
+	// and moves lines to the left or to the right onto the window border,
+	// where they keep their cover but have no area
+	const cover_array &src = polyspan.covers;
+	cover_array::const_iterator i = std::lower_bound(
+		src.begin(), src.end(), PenMark(std::numeric_limits<int>::min(), window.miny, 0, 0) );
+	while(i != src.end() && i->y < window.maxy)
+	{
+		const int y = i->y;
+
+		Real cover = 0;
+		for(; i != src.end() && i->y == y && i->x < window.minx; ++i)
+			cover += i->cover;
+		if (cover)
+			covers.push_back(PenMark(window.minx, y, cover, 0));
+
+		for(; i != src.end() && i->y == y && i->x < window.maxx; ++i)
+			covers.push_back(*i);
+
+		cover = 0;
+		for(; i != src.end() && i->y == y; ++i)
+			cover += i->cover;
+		if (cover)
+			covers.push_back(PenMark(window.maxx, y, cover, 0));
+	}
+}
+
 // Not recommended - destroys any separation of spans currently held
 void
 Polyspan::merge_all()
@@ -158,6 +158,10 @@ public:
 	//close the primitives with a line (or rendering will not work as expected)
 	void close();
 
+	//take the marks of a closed and sorted polyspan which fall into the window,
+	//the result is the same as if the primitives were drawn with this window
+	void crop(const Polyspan &polyspan, const RectInt &window);
+
 	// Not recommended - destroys any separation of spans currently held
 	void merge_all();
 
@@ -33,6 +33,7 @@
 #endif
 
 #include <algorithm> // std::sort
+#include <cctype>
 #include <cstdlib>
 #include <climits>
 #include <typeinfo>
@@ -43,15 +44,21 @@
 #include <synfig/debug/debugsurface.h>
 #include <synfig/debug/log.h>
 #include <synfig/debug/measure.h>
+#include <synfig/debug/trace.h>
 
 #include "renderer.h"
 #include "renderqueue.h"
+#include "subtreecache.h"
+
+#include "common/task/taskaccumulate.h"
+#include "common/task/tasksubtreecache.h"
 
 #include "software/renderersw.h"
 #include "software/rendererdraftsw.h"
 #include "software/rendererpreviewsw.h"
 #include "software/rendererlowressw.h"
 #include "software/renderersafe.h"
+#include "software/surfaceswcompact.h"
 #ifdef WITH_OPENGL
 #include "opengl/renderergl.h"
 #include "opengl/task/taskgl.h"
@@ -78,8 +85,132 @@ using namespace rendering;
 
 /* === G L O B A L S ======================================================= */
 
+//! Smaller subtrees are rendered faster than they are copied from the cache
+#define SUBTREE_CACHE_MIN_TASKS 3
+
 /* === P R O C E D U R E S ================================================= */
 
+namespace {
+
+struct SubtreeInfo
+{
+	bool hashable;
+	int count;
+	TaskHash hash;
+	SubtreeInfo(): hashable(), count() { }
+};
+
+typedef std::map<const Task*, SubtreeInfo> SubtreeInfoMap;
+
+//! Calculates the hash of the subtree from the parameters and coordinates
+//! of all its tasks, the same subtree gives the same hash in every frame
+const SubtreeInfo&
+calc_subtree_info(const Task &task, SubtreeInfoMap &map)
+{
+	SubtreeInfoMap::iterator found = map.find(&task);
+	if (found != map.end())
+		return found->second;
+
+	SubtreeInfo info;
+	TaskHash params;
+	info.hashable = task.hash_params(params);
+	info.count = 1;
+	info.hash.add(task.get_token()->name);
+	info.hash.add(params);
+	info.hash.add(task.source_rect);
+	info.hash.add(task.target_rect);
+	info.hash.add(task.target_surface ? task.target_surface->get_size() : VectorInt::zero());
+	info.hash.add(task.sub_tasks.size());
+	for(Task::List::const_iterator i = task.sub_tasks.begin(); i != task.sub_tasks.end(); ++i) {
+		info.hash.add((bool)*i);
+		if (!*i) continue;
+		const SubtreeInfo &sub_info = calc_subtree_info(**i, map);
+		info.hashable = info.hashable && sub_info.hashable;
+		info.count += sub_info.count;
+		info.hash.add(sub_info.hash);
+	}
+	return map[&task] = info;
+}
+
+//! Replaces the static subtrees by the surfaces from the cache,
+//! and marks the subtrees seen in previous frames to be stored there.
+//! Changed tasks are cloned, so the incoming tree stays untouched.
+//! Returns true if \a task was changed.
+bool
+apply_subtree_cache_recursive(
+	Task::Handle &task,
+	const String &renderer_name,
+	SubtreeCache &cache,
+	SubtreeInfoMap &map )
+{
+	const SubtreeInfo &info = calc_subtree_info(*task, map);
+	if ( info.hashable
+	  && info.count >= SUBTREE_CACHE_MIN_TASKS
+	  && task->is_valid_coords()
+	  && task->target_surface
+	  && task->target_surface->is_exists() )
+	{
+		TaskSubtreeCache::Handle cached(new TaskSubtreeCache());
+		cached->assign_target(*task);
+		cached->hash.add(renderer_name);
+		cached->hash.add(info.hash);
+
+		if (SurfaceResource::Handle surface = cache.get(cached->hash)) {
+			TaskSurface::Handle sub(new TaskSurface());
+			sub->assign_target(*task);
+			sub->target_surface = surface;
+			cached->sub_task() = sub;
+			task = cached;
+			return true;
+		}
+
+		if (cache.admit(cached->hash)) {
+			// render into own surface, which will be kept by the cache
+			Task::Handle sub = task->clone();
+			sub->target_surface = new SurfaceResource();
+			sub->target_surface->create(task->target_surface->get_size());
+			cached->sub_task() = sub;
+			cached->store_to_cache = true;
+			task = cached;
+			return true;
+		}
+
+		// seen for the first time, maybe some parts of it are static
+	}
+
+	bool changed = false;
+	for(int i = 0; i < (int)task->sub_tasks.size(); ++i) {
+		Task::Handle sub = task->sub_tasks[i];
+		if (sub && apply_subtree_cache_recursive(sub, renderer_name, cache, map)) {
+			if (!changed)
+				{ task = task->clone(); changed = true; }
+			task->sub_tasks[i] = sub;
+		}
+	}
+	return changed;
+}
+
+//! Class name of the optimizer without namespaces, for the trace
+String
+get_optimizer_name(const Optimizer &optimizer)
+{
+	String name = typeid(optimizer).name();
+	// mangled "N6synfig9rendering17OptimizerBlendZeroE"
+	// or "class synfig::rendering::OptimizerBlendZero"
+	String::size_type pos = name.rfind("rendering");
+	if (pos == String::npos)
+		return name;
+	pos += 9;
+	while(pos < name.size() && (isdigit(name[pos]) || name[pos] == ':'))
+		++pos;
+	name = name.substr(pos);
+	if (!name.empty() && name[name.size() - 1] == 'E')
+		name.erase(name.size() - 1);
+	return name;
+}
+
+} // end of anonymous namespace
+
 /* === M E T H O D S ======================================================= */
 
 Renderer::Handle Renderer::blank;
@@ -111,6 +242,23 @@ Renderer::initialize_renderers()
 #ifdef WITH_OPENGL
 	register_renderer("gl", new RendererGL());
 #endif
+
+	// override the surface type of intermediate results for all renderers
+	if (const char *s = getenv("SYNFIG_RENDERING_COMPACT_SURFACES")) {
+		const String format(s);
+		Surface::Token::Handle token;
+		if (format == "rgba8")
+			token = SurfaceSWRGBA8::token.handle();
+		else
+		if (format == "rgba16f")
+			token = SurfaceSWRGBA16F::token.handle();
+		else
+		if (format != "none")
+			synfig::warning("rendering::Renderer: unknown SYNFIG_RENDERING_COMPACT_SURFACES '%s', expected none, rgba8 or rgba16f", s);
+		if (token || format == "none")
+			for(std::map<String, Handle>::const_iterator i = renderers->begin(); i != renderers->end(); ++i)
+				i->second->set_compact_surface_token(token);
+	}
 }
 
 void
@@ -133,6 +281,10 @@ Renderer::get_max_simultaneous_threads() const
 	return queue->get_threads_count() - 1;
 }
 
+int
+Renderer::get_queue_size()
+	{ return queue ? queue->get_queue_size() : 0; }
+
 bool
 Renderer::is_optimizer_registered(const Optimizer::Handle &optimizer) const
 {
@@ -211,6 +363,21 @@ Renderer::calc_coords(const Task::List &list) const
 		if (*i) (*i)->touch_coords();
 }
 
+void
+Renderer::apply_subtree_cache(Task::List &list) const
+{
+	SubtreeCache *cache = SubtreeCache::instance();
+	if (!cache || !cache->is_enabled())
+		return;
+
+	#ifdef DEBUG_OPTIMIZATION_MEASURE
+	debug::Measure t("apply subtree cache");
+	#endif
+	SubtreeInfoMap map;
+	for(Task::List::iterator i = list.begin(); i != list.end(); ++i)
+		if (*i) apply_subtree_cache_recursive(*i, get_name(), *cache, map);
+}
+
 void
 Renderer::specialize_recursive(Task::List &list) const
 {
@@ -505,12 +672,18 @@ Renderer::optimize(Task::List &list) const
 	while(categories_to_process &= Optimizer::CATEGORY_ALL)
 	{
 		while (prepared_category_id < current_category_id) {
+			debug::Trace::Scope trace("optimizer");
 			switch (++prepared_category_id) {
 			case Optimizer::CATEGORY_ID_COORDS:
-				calc_coords(list); break;
+				trace.set_name("calc coords");
+				calc_coords(list);
+				apply_subtree_cache(list);
+				break;
 			case Optimizer::CATEGORY_ID_SPECIALIZED:
+				trace.set_name("specialize");
 				specialize(list); break;
 			case Optimizer::CATEGORY_ID_LIST:
+				trace.set_name("linearize");
 				linearize(list); break;
 			default:
 				break;
@@ -581,6 +754,12 @@ Renderer::optimize(Task::List &list) const
 		debug::Measure t(strprintf("optimize category %d index %d", current_category_id, current_optimizer_index));
 		#endif
 
+		debug::Trace::Scope trace("optimizer");
+		if (trace.is_active())
+			trace.set_name( simultaneous_run
+			              ? strprintf("category %d", current_category_id)
+			              : get_optimizer_name(*current_optimizers.front()) );
+
 		#ifdef DEBUG_OPTIMIZATION_COUNTERS
 		std::atomic<int> calls_count(0), *calls_count_ptr = &calls_count;
 		std::atomic<int> optimizations_count(0), *optimizations_count_ptr = &optimizations_count;
@@ -696,6 +875,8 @@ Renderer::find_deps(const Task::List &list, long long batch_index) const
 
 		task_rd.deps.clear();
 		task_rd.back_deps.clear();
+		task_rd.tmp_fixed_deps.clear();
+		task_rd.tmp_fixed_back_deps.clear();
 
 		if ((*i)->is_valid()) {
 			for(Task::List::const_iterator j = (*i)->sub_tasks.begin(); j != (*i)->sub_tasks.end(); ++j)
@@ -731,29 +912,29 @@ Renderer::find_deps(const Task::List &list, long long batch_index) const
 			dep_rd.tmp_back_deps.erase(task);
 
 			if (!task->allow_run_before(*dep)) {
-				task_rd.deps.insert(dep);
-				dep_rd.back_deps.insert(task);
+				task_rd.tmp_fixed_deps.insert(dep);
+				dep_rd.tmp_fixed_back_deps.insert(task);
 				++iterations;
 			} else {
-				iterations += dep_rd.deps.size() + dep_rd.tmp_deps.size() + task_rd.back_deps.size() + task_rd.tmp_back_deps.size();
-				for(Task::Set::iterator j = dep_rd.deps.begin(); j != dep_rd.deps.end(); ++j)
-					if (task_rd.deps.count(*j) == 0) {
+				iterations += dep_rd.tmp_fixed_deps.size() + dep_rd.tmp_deps.size() + task_rd.tmp_fixed_back_deps.size() + task_rd.tmp_back_deps.size();
+				for(Task::Set::iterator j = dep_rd.tmp_fixed_deps.begin(); j != dep_rd.tmp_fixed_deps.end(); ++j)
+					if (task_rd.tmp_fixed_deps.count(*j) == 0) {
 						task_rd.tmp_deps.insert(*j);
 						(*j)->renderer_data.tmp_back_deps.insert(task);
 					}
 				for(Task::Set::iterator j = dep_rd.tmp_deps.begin(); j != dep_rd.tmp_deps.end(); ++j)
-					if (task_rd.deps.count(*j) == 0) {
+					if (task_rd.tmp_fixed_deps.count(*j) == 0) {
 						task_rd.tmp_deps.insert(*j);
 						(*j)->renderer_data.tmp_back_deps.insert(task);
 					}
-				for(Task::Set::iterator j = task_rd.back_deps.begin(); j != task_rd.back_deps.end(); ++j)
-					if ((*j)->renderer_data.deps.count(dep) == 0) {
+				for(Task::Set::iterator j = task_rd.tmp_fixed_back_deps.begin(); j != task_rd.tmp_fixed_back_deps.end(); ++j)
+					if ((*j)->renderer_data.tmp_fixed_deps.count(dep) == 0) {
 						if ((*j)->renderer_data.tmp_deps.empty()) tasks_to_process.insert(*j);
 						(*j)->renderer_data.tmp_deps.insert(dep);
 						dep_rd.tmp_back_deps.insert(*j);
 					}
 				for(Task::Set::iterator j = task_rd.tmp_back_deps.begin(); j != task_rd.tmp_back_deps.end(); ++j)
-					if ((*j)->renderer_data.deps.count(dep) == 0) {
+					if ((*j)->renderer_data.tmp_fixed_deps.count(dep) == 0) {
 						(*j)->renderer_data.tmp_deps.insert(dep);
 						dep_rd.tmp_back_deps.insert(*j);
 					}
@@ -772,21 +953,100 @@ Renderer::find_deps(const Task::List &list, long long batch_index) const
 	info("find deps iterations: %d (%d from %d tasks not optimized)", iterations, (int)tasks_to_process.size(), (int)list.size());
 	#endif
 
-	// copy tmp_deps to deps
+	// merge tmp_deps with fixed deps and store them as plain lists with counters
 	for(Task::List::const_iterator i = list.begin(); i != list.end(); ++i) {
 		Task::Handle task = *i;
 		Task::RendererData &task_rd = task->renderer_data;
 
-		task_rd.deps     .insert(task_rd.tmp_deps     .begin(), task_rd.tmp_deps     .end());
-		task_rd.back_deps.insert(task_rd.tmp_back_deps.begin(), task_rd.tmp_back_deps.end());
+		task_rd.tmp_fixed_deps     .insert(task_rd.tmp_deps     .begin(), task_rd.tmp_deps     .end());
+		task_rd.tmp_fixed_back_deps.insert(task_rd.tmp_back_deps.begin(), task_rd.tmp_back_deps.end());
+
+		task_rd.deps     .assign(task_rd.tmp_fixed_deps     .begin(), task_rd.tmp_fixed_deps     .end());
+		task_rd.back_deps.assign(task_rd.tmp_fixed_back_deps.begin(), task_rd.tmp_fixed_back_deps.end());
+		task_rd.deps_count = (int)task_rd.deps.size();
 
 		task_rd.tmp_deps.clear();
 		task_rd.tmp_back_deps.clear();
+		task_rd.tmp_fixed_deps.clear();
+		task_rd.tmp_fixed_back_deps.clear();
 	}
 }
 
+void
+Renderer::mark_compact_targets(const Task::List &roots, const Task::List &list) const
+{
+	if (!get_compact_surface_token())
+		return;
+
+	// the results are read by the caller in their own format
+	std::set<SurfaceResource::Handle> root_targets;
+	for(Task::List::const_iterator i = roots.begin(); i != roots.end(); ++i)
+		if (*i) root_targets.insert((*i)->target_surface);
+
+	// the surfaces stored into the subtree cache keep the float precision,
+	// otherwise every cache hit gives the lossy copy and decodes it again
+	std::set<SurfaceResource::Handle> cached_targets;
+	for(Task::List::const_iterator i = list.begin(); i != list.end(); ++i)
+		if (TaskSubtreeCache::Handle cached = TaskSubtreeCache::Handle::cast_dynamic(*i))
+			if (cached->store_to_cache && cached->sub_task())
+				cached_targets.insert(cached->sub_task()->target_surface);
+
+	// compact only the surfaces written by a single task,
+	// otherwise the next writer will convert it back to float
+	std::map<SurfaceResource::Handle, int> writers;
+	for(Task::List::const_iterator i = list.begin(); i != list.end(); ++i)
+		if (*i && (*i)->target_surface)
+			++writers[(*i)->target_surface];
+
+	for(Task::List::const_iterator i = list.begin(); i != list.end(); ++i)
+		if ( *i
+		  && (*i)->is_valid()
+		  && (*i)->target_surface
+		  && !i->type_is<TaskSurface>()
+		  && !root_targets.count((*i)->target_surface)
+		  && !cached_targets.count((*i)->target_surface)
+		  && writers[(*i)->target_surface] == 1 )
+			(*i)->renderer_data.compact_target = true;
+}
+
+void
+Renderer::mark_released_targets(const Task::List &roots, const Task::List &list) const
+{
+	// results of the sub-tasks of accumulation (motion blur samples, duplicates)
+	// are released right after blending, so only a few of them are kept in memory
+
+	std::set<SurfaceResource::Handle> root_targets;
+	for(Task::List::const_iterator i = roots.begin(); i != roots.end(); ++i)
+		if (*i) root_targets.insert((*i)->target_surface);
+
+	// release only the surfaces written by a single task and read by a single task,
+	// others may be the targets of the subtree cache or the results of the split tasks
+	std::map<SurfaceResource::Handle, int> writers;
+	std::map<SurfaceResource::Handle, int> readers;
+	for(Task::List::const_iterator i = list.begin(); i != list.end(); ++i)
+	{
+		if (!*i) continue;
+		if ((*i)->target_surface)
+			++writers[(*i)->target_surface];
+		for(Task::List::const_iterator j = (*i)->sub_tasks.begin(); j != (*i)->sub_tasks.end(); ++j)
+			if (*j && (*j)->target_surface && (*j)->target_surface != (*i)->target_surface)
+				++readers[(*j)->target_surface];
+	}
+
+	for(Task::List::const_iterator i = list.begin(); i != list.end(); ++i)
+		if (*i && TaskAccumulate::Handle::cast_dynamic(*i))
+			for(Task::List::const_iterator j = (*i)->sub_tasks.begin(); j != (*i)->sub_tasks.end(); ++j)
+				if ( *j
+				  && (*j)->target_surface
+				  && (*j)->target_surface != (*i)->target_surface
+				  && !root_targets.count((*j)->target_surface)
+				  && writers[(*j)->target_surface] == 1
+				  && readers[(*j)->target_surface] == 1 )
+					(*j)->renderer_data.release_target = true;
+}
+
 bool
-Renderer::run(const Task::List &list, bool quiet) const
+Renderer::run(const Task::List &list, bool quiet, bool optimized) const
 {
 	//if (!quiet) info("renderer.debug.result_image: %s", get_debug_options().result_image.c_str());
 
@@ -795,7 +1055,7 @@ Renderer::run(const Task::List &list, bool quiet) const
 	#endif
 
 	TaskEvent::Handle task_event = new TaskEvent();
-	enqueue(list, task_event, quiet);
+	enqueue(list, task_event, quiet, optimized);
 
 	{
 		#ifdef DEBUG_TASK_MEASURE
@@ -817,7 +1077,7 @@ Renderer::run(const Task::List &list, bool quiet) const
 }
 
 void
-Renderer::enqueue(const Task::List &list, const TaskEvent::Handle &finish_event_task, bool quiet) const
+Renderer::enqueue(const Task::List &list, const TaskEvent::Handle &finish_event_task, bool quiet, bool optimized) const
 {
 	assert(finish_event_task);
 	if (!finish_event_task || finish_event_task->is_finished()) return;
@@ -838,8 +1098,14 @@ Renderer::enqueue(const Task::List &list, const TaskEvent::Handle &finish_event_
 		log(get_debug_options().task_list_log, list, "input list");
 
 	Task::List optimized_list(list);
-	optimize(optimized_list);
-	find_deps(optimized_list, ++last_batch_index);
+	if (!optimized)
+		optimize(optimized_list);
+	{
+		debug::Trace::Scope trace("optimizer", "find deps");
+		find_deps(optimized_list, ++last_batch_index);
+	}
+	mark_compact_targets(list, optimized_list);
+	mark_released_targets(list, optimized_list);
 
 	#ifdef DEBUG_TASK_LIST
 	if (!quiet) log("", optimized_list, "optimized list");
@@ -850,9 +1116,11 @@ Renderer::enqueue(const Task::List &list, const TaskEvent::Handle &finish_event_
 
 	if (finish_event_task)
 	{
-		finish_event_task->renderer_data.deps.insert(optimized_list.begin(), optimized_list.end());
+		Task::RendererData &event_rd = finish_event_task->renderer_data;
+		event_rd.deps.insert(event_rd.deps.end(), optimized_list.begin(), optimized_list.end());
+		event_rd.deps_count = (int)event_rd.deps.size();
 		for(Task::List::const_iterator i = optimized_list.begin(); i != optimized_list.end(); ++i)
-			(*i)->renderer_data.back_deps.insert(finish_event_task);
+			(*i)->renderer_data.back_deps.push_back(finish_event_task);
 		optimized_list.push_back(finish_event_task);
 	}
 
@@ -889,7 +1157,7 @@ Renderer::log(
 		if (!trd.deps.empty())
 		{
 			std::multiset<int> deps_set;
-			for(Task::Set::const_iterator i = trd.deps.begin(); i != trd.deps.end(); ++i)
+			for(Task::List::const_iterator i = trd.deps.begin(); i != trd.deps.end(); ++i)
 				deps_set.insert((*i)->renderer_data.index);
 			for(std::multiset<int>::const_iterator i = deps_set.begin(); i != deps_set.end(); ++i)
 				deps += strprintf("%d ", *i);
@@ -900,7 +1168,7 @@ Renderer::log(
 		if (!trd.back_deps.empty())
 		{
 			std::multiset<int> back_deps_set;
-			for(Task::Set::const_iterator i = trd.back_deps.begin(); i != trd.back_deps.end(); ++i)
+			for(Task::List::const_iterator i = trd.back_deps.begin(); i != trd.back_deps.end(); ++i)
 				back_deps_set.insert((*i)->renderer_data.index);
 			for(std::multiset<int>::const_iterator i = back_deps_set.begin(); i != back_deps_set.end(); ++i)
 				back_deps += strprintf("%d ", *i);
@@ -988,9 +1256,14 @@ Renderer::initialize()
 		debug_options.task_list_optimized_log = {s};
 	if (const char *s = getenv("SYNFIG_RENDERING_DEBUG_RESULT_IMAGE"))
 		debug_options.result_image = {s};
+	if (const char *s = getenv("SYNFIG_RENDERING_TRACE"))
+		debug_options.trace_file = {s};
+	if (!debug_options.trace_file.empty())
+		debug::Trace::start();
 
 	renderers = new std::map<String, Handle>();
 	queue = new RenderQueue();
+	SubtreeCache::initialize();
 
 	initialize_renderers();
 }
@@ -1010,6 +1283,12 @@ Renderer::deinitialize()
 	renderers = nullptr;
 	delete queue;
 	queue = nullptr;
+	SubtreeCache::deinitialize();
+
+	if (!debug_options.trace_file.empty()) {
+		debug::Trace::stop();
+		debug::Trace::write(debug_options.trace_file);
+	}
 }
 
 void
@@ -61,6 +61,8 @@ public:
 		filesystem::Path task_list_log;
 		filesystem::Path task_list_optimized_log;
 		filesystem::Path result_image;
+		//! Chrome trace of the tasks and optimizers, written at deinitialize()
+		filesystem::Path trace_file;
 	};
 
 private:
@@ -73,6 +75,7 @@ private:
 
 	ModeList modes;
 	Optimizer::List optimizers[Optimizer::CATEGORIES_COUNT];
+	Surface::Token::Handle compact_surface_token;
 
 public:
 
@@ -93,10 +96,18 @@ public:
 	void register_mode(const ModeToken::Handle &mode);
 	void unregister_mode(const ModeToken::Handle &mode);
 
+	//! Surface type to keep the intermediate results between the tasks,
+	//! null keeps them as the tasks wrote them
+	const Surface::Token::Handle& get_compact_surface_token() const
+		{ return compact_surface_token; }
+	void set_compact_surface_token(const Surface::Token::Handle &token)
+		{ compact_surface_token = token; }
+
 private:
 	int count_tasks_recursive(Task::List &list) const;
 	int count_tasks(Task::List &list) const;
 	void calc_coords(const Task::List &list) const;
+	void apply_subtree_cache(Task::List &list) const;
 	void specialize_recursive(Task::List &list) const;
 	void specialize(Task::List &list) const;
 	void remove_dummy(Task::List &list) const;
@@ -141,28 +152,39 @@ private:
 	typedef DepTargetMap::value_type                    DepTargetPair;
 
 	void find_deps(const Task::List &list, long long batch_index) const;
+	void mark_compact_targets(const Task::List &roots, const Task::List &list) const;
+	void mark_released_targets(const Task::List &roots, const Task::List &list) const;
 
 public:
 	int get_max_simultaneous_threads() const;
+	//! Count of tasks which are ready to run, but still wait for a free thread
+	static int get_queue_size();
 	void optimize(Task::List &list) const;
 
+	//! Optimizes and runs the tasks and waits for them.
+	//! Pass \a optimized if the list already went through optimize(),
+	//! so only the run phase is done (used by benchmarks).
 	bool run(
 		const Task::List &list,
-		bool quiet = false ) const;
+		bool quiet = false,
+		bool optimized = false ) const;
 	bool run(
 		const Task::Handle &task,
-		bool quiet = false ) const
-			{ return run(Task::List(1, task), quiet); }
+		bool quiet = false,
+		bool optimized = false ) const
+			{ return run(Task::List(1, task), quiet, optimized); }
 
 	void enqueue(
 		const Task::List &list,
 		const TaskEvent::Handle &finish_event_task,
-		bool quiet = false ) const;
+		bool quiet = false,
+		bool optimized = false ) const;
 	void enqueue(
 		const Task::Handle &task,
 		const TaskEvent::Handle &finish_event_task,
-		bool quiet = false ) const
-			{ return enqueue(Task::List(1, task), finish_event_task, quiet); }
+		bool quiet = false,
+		bool optimized = false ) const
+			{ return enqueue(Task::List(1, task), finish_event_task, quiet, optimized); }
 
 	static void cancel(const Task::Handle &task);
 	static void cancel(const Task::List &list);
@@ -40,6 +40,8 @@
 #include <synfig/debug/debugsurface.h>
 #include <synfig/debug/log.h>
 #include <synfig/debug/measure.h>
+#include <synfig/debug/trace.h>
+#include <synfig/threadpool.h>
 
 #include "renderqueue.h"
 #include "renderer.h"
@@ -86,7 +88,9 @@ Task::Token TaskSubQueue::token(
 } // end of anonimous namespace
 
 
-RenderQueue::RenderQueue(): started(false) { start(); }
+RenderQueue::RenderQueue():
+	started(false), ready_count(0), scheduled_count(0), running_workers(0), next_worker(0)
+	{ start(); }
 RenderQueue::~RenderQueue() { stop(); }
 
 void
@@ -95,27 +99,20 @@ RenderQueue::start()
 	std::lock_guard<std::mutex> lock(mutex);
 	if (started) return;
 
+	// workers are run by the ThreadPool, so the count of the simultaneously
+	// running workers is limited by ThreadPool::set_num_threads(),
+	// worker 0 is never used, thread 0 takes tasks from single_ready_tasks
+	workers.clear();
+	for(int i = 0; i < SYNFIG_RENDERING_MAX_THREADS; ++i)
+		workers.push_back(std::shared_ptr<Worker>(new Worker()));
+
+	started = true;
+
 	// one thread reserved for non-multithreading tasks (OpenGL)
 	// also this thread almost don't use CPU time
 	// so we have ~50% of one core for GUI
-	unsigned int count = std::thread::hardware_concurrency();
-
-	#ifdef DEBUG_TASK_SURFACE
-	count = 2;
-	#endif
-
-	if (const char *s = getenv("SYNFIG_RENDERING_THREADS"))
-		count = atoi(s) + 1;
-
-	if (count > SYNFIG_RENDERING_MAX_THREADS) count = SYNFIG_RENDERING_MAX_THREADS;
-	if (count < 2) count = 2;
-
-	for(unsigned int i = 0; i < count; ++i)
-		threads.push_back(
-			std::thread(
-				sigc::bind(sigc::mem_fun(*this, &RenderQueue::process), i) ));
-	info("rendering threads %d", count);
-	started = true;
+	single_thread = std::thread(sigc::mem_fun(*this, &RenderQueue::process_single));
+	info("rendering threads %d", get_threads_count());
 }
 
 void
@@ -124,142 +121,269 @@ RenderQueue::stop()
 	{
 		std::lock_guard<std::mutex> lock(mutex);
 		started = false;
-		cond.notify_all();
 		single_cond.notify_all();
 	}
-	while(!threads.empty())
-		{ threads.front().join(); threads.pop_front(); }
+	if (single_thread.joinable())
+		single_thread.join();
+
+	// workers already enqueued into ThreadPool will exit immediately,
+	// wait for them, because they refer to this queue
+	std::unique_lock<std::mutex> lock(mutex);
+	while(running_workers > 0)
+		cond.wait(lock);
+}
+
+void
+RenderQueue::process_single()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while(started)
+	{
+		if (single_ready_tasks.empty())
+			{ single_cond.wait(lock); continue; }
+
+		Task::Handle task = single_ready_tasks.front();
+		single_ready_tasks.pop_front();
+		if (!task) continue;
+
+		lock.unlock();
+		run_task(0, task);
+		lock.lock();
+	}
 }
 
 void
-RenderQueue::process(int thread_index)
+RenderQueue::process(int worker_index)
 {
-	while(Task::Handle task = get(thread_index))
+	Worker &worker = *workers[worker_index];
+	while(true)
 	{
-		#ifdef DEBUG_THREAD_TASK
-		info( "thread %d: begin task #%05d-%04d '%s'",
-			  thread_index,
-			  task->renderer_data.batch_index,
-			  task->renderer_data.index,
-			  task->get_token()->name.c_str() );
-		#endif
+		while(started)
+		{
+			Task::Handle task = pop(worker_index);
+			if (!task) task = steal(worker_index);
+			if (!task) break;
+			run_task(worker_index, task);
+		}
+
+		// give the thread back to the pool,
+		// but recheck the queue to not miss the task pushed in the meantime
+		worker.scheduled = false;
+		--scheduled_count;
+		if (!started || ready_count <= 0 || worker.scheduled.exchange(true))
+			break;
+		++scheduled_count;
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	--running_workers;
+	cond.notify_all();
+}
 
+void
+RenderQueue::run_task(int worker_index, const Task::Handle &task)
+{
+	if (task->renderer_data.cancelled)
+	{
+		// don't run, but release the tasks which are waiting for this one
 		if (TaskSubQueue::Handle task_sub_queue = TaskSubQueue::Handle::cast_dynamic(task))
 		{
-			done(thread_index, task_sub_queue->sub_task());
-			done(thread_index, task_sub_queue);
-			continue;
+			task_sub_queue->sub_task()->renderer_data.cancelled = true;
+			done(worker_index, task_sub_queue->sub_task());
 		}
+		if (TaskEvent::Handle task_event = TaskEvent::Handle::cast_dynamic(task))
+			task_event->finish(false);
+		done(worker_index, task);
+		return;
+	}
+
+	#ifdef DEBUG_THREAD_TASK
+	info( "thread %d: begin task #%05d-%04d '%s'",
+		  worker_index,
+		  task->renderer_data.batch_index,
+		  task->renderer_data.index,
+		  task->get_token()->name.c_str() );
+	#endif
 
-		bool success = false;
+	if (TaskSubQueue::Handle task_sub_queue = TaskSubQueue::Handle::cast_dynamic(task))
+	{
+		done(worker_index, task_sub_queue->sub_task());
+		done(worker_index, task_sub_queue);
+		return;
+	}
+
+	bool success = false;
+	{
+		debug::Trace::Scope trace(
+			"task",
+			task->get_token()->name,
+			task->layer_name,
+			task->target_rect.is_valid() ? (long long)task->target_rect.get_width()*task->target_rect.get_height() : 0 );
 		try {
 			success = task->run(task->renderer_data.params);
 		} catch(...) { }
-		if (!success)
-			task->renderer_data.success = false;
-
-		#ifdef DEBUG_TASK_SURFACE
-		debug::DebugSurface::save_to_file(
-			task->target_surface,
-			strprintf(
-				"task-%05d-%04d-%05d",
-				task->renderer_data.batch_index,
-				task->renderer_data.index,
-				task->target_surface ? task->target_surface->get_id() : 0 ));
-		#endif
-
-		#ifdef DEBUG_THREAD_TASK
-		info( "thread %d: end task #%05d-%04d '%s'",
-			  thread_index,
-			  task->renderer_data.batch_index,
-			  task->renderer_data.index,
-			  task->get_token()->name.c_str() );
-		#endif
-
-		if (!task->renderer_data.params.sub_queue.empty())
+	}
+	if (!success)
+		task->renderer_data.success = false;
+
+	#ifdef DEBUG_TASK_SURFACE
+	debug::DebugSurface::save_to_file(
+		task->target_surface,
+		strprintf(
+			"task-%05d-%04d-%05d",
+			task->renderer_data.batch_index,
+			task->renderer_data.index,
+			task->target_surface ? task->target_surface->get_id() : 0 ));
+	#endif
+
+	#ifdef DEBUG_THREAD_TASK
+	info( "thread %d: end task #%05d-%04d '%s'",
+		  worker_index,
+		  task->renderer_data.batch_index,
+		  task->renderer_data.index,
+		  task->get_token()->name.c_str() );
+	#endif
+
+	if (!task->renderer_data.params.sub_queue.empty())
+	{
+		if (task->renderer_data.params.renderer)
 		{
-			if (task->renderer_data.params.renderer)
-			{
-				TaskSubQueue::Handle task_sub_queue(new TaskSubQueue());
-				task_sub_queue->sub_task() = task;
-				task->renderer_data.params.renderer->enqueue(task->renderer_data.params.sub_queue, task_sub_queue, true);
-				continue;
-			}
-			task->renderer_data.success = false;
+			TaskSubQueue::Handle task_sub_queue(new TaskSubQueue());
+			task_sub_queue->sub_task() = task;
+			task->renderer_data.params.renderer->enqueue(task->renderer_data.params.sub_queue, task_sub_queue, true);
+			return;
 		}
-
-		done(thread_index, task);
+		task->renderer_data.success = false;
 	}
+
+	// the result keeps its own format if it doesn't fit into the compact one
+	// (out-of-range colors for SurfaceSWRGBA8)
+	if (success && task->renderer_data.compact_target && task->renderer_data.params.renderer)
+		if (const Surface::Token::Handle &token = task->renderer_data.params.renderer->get_compact_surface_token())
+			if (task->target_surface)
+				task->target_surface->convert(token);
+
+	// intermediate results read only by this task are not needed anymore
+	if (success)
+		for(Task::List::const_iterator i = task->sub_tasks.begin(); i != task->sub_tasks.end(); ++i)
+			if (*i && (*i)->renderer_data.release_target && (*i)->target_surface)
+				(*i)->target_surface->reset();
+
+	done(worker_index, task);
 }
 
 void
-RenderQueue::done(int thread_index, const Task::Handle &task)
+RenderQueue::done(int worker_index, const Task::Handle &task)
 {
 	assert(task);
-	int single_signals = 0;
-	int signals = 0;
-	std::lock_guard<std::mutex> lock(mutex);
-	for(Task::Set::iterator i = task->renderer_data.back_deps.begin(); i != task->renderer_data.back_deps.end(); ++i)
+	Task::RendererData &task_rd = task->renderer_data;
+	const bool cancelled = task_rd.cancelled;
+
+	// nobody else touches back_deps of the finished task,
+	// so only the counters of the waiting tasks are shared
+	for(Task::List::const_iterator i = task_rd.back_deps.begin(); i != task_rd.back_deps.end(); ++i)
 	{
 		assert(*i);
-		(*i)->renderer_data.deps.erase(task);
-		if ((*i)->renderer_data.deps.empty())
-		{
-			bool mt = (*i)->get_allow_multithreading();
-			TaskQueue &queue = mt ? ready_tasks     : single_ready_tasks;
-			TaskSet   &wait  = mt ? not_ready_tasks : single_not_ready_tasks;
-			wait.erase(*i);
-			queue.push_back(*i);
-			++(mt ? signals : single_signals);
-		}
+		Task::RendererData &rd = (*i)->renderer_data;
+		if (cancelled)
+			mark_cancelled(*i);
+		if (rd.deps_count.fetch_sub(1) == 1)
+			push(worker_index, *i);
 	}
-	task->renderer_data.back_deps.clear();
-	assert( tasks_in_process.count(thread_index) == 1 );
-	tasks_in_process.erase(thread_index);
-	//info("rendering threads used %d", tasks_in_process.size());
-
-	// limit signals count
-	int threads = get_threads_count() - 1;
-	if (signals > threads) signals = threads;
-	if (single_signals > 1) single_signals = 1;
-
-	// we don't need to wakeup the current thread
-	--(thread_index ? signals : single_signals);
-
-	// wake up
-	while(signals-- > 0) cond.notify_one();
-	while(single_signals-- > 0) single_cond.notify_one();
+	task_rd.back_deps.clear();
 }
 
-Task::Handle
-RenderQueue::get(int thread_index)
+int
+RenderQueue::get_workers_limit() const
 {
-	std::unique_lock<std::mutex> lock(mutex);
+	return std::min(
+		(int)workers.size() - 1,
+		std::max(1, ThreadPool::instance().get_max_threads()) );
+}
 
-	TaskQueue &queue  = thread_index == 0 ? single_ready_tasks     : ready_tasks;
-	TaskQueue &queue2 = thread_index != 0 ? single_ready_tasks     : ready_tasks;
-	TaskSet   &wait   = thread_index == 0 ? single_not_ready_tasks : not_ready_tasks;
-	while(started)
+void
+RenderQueue::schedule_workers()
+{
+	// schedule not more workers than ready tasks
+	const int limit = get_workers_limit();
+	for(int i = 1; i <= limit && started && scheduled_count < ready_count; ++i)
 	{
-		if (!queue.empty())
-		{
-			Task::Handle task = queue.front();
-			queue.pop_front();
-			if (!task) continue;
-			assert( tasks_in_process.count(thread_index) == 0 );
-			tasks_in_process[thread_index] = task;
-			//info("rendering threads used %d", tasks_in_process.size());
-			return task;
-		}
+		Worker &worker = *workers[i];
+		if (worker.scheduled.exchange(true))
+			continue;
+		++scheduled_count;
+		++running_workers;
+		ThreadPool::instance().enqueue(
+			sigc::bind(sigc::mem_fun(*this, &RenderQueue::process), i),
+			ThreadPool::PRIORITY_RENDER );
+	}
+}
+
+void
+RenderQueue::push(int worker_index, const Task::Handle &task)
+{
+	if (!task->get_allow_multithreading())
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		single_ready_tasks.push_back(task);
+		single_cond.notify_one();
+		return;
+	}
 
-		#ifdef DEBUG_THREAD_WAIT
-		if (!wait.empty())
-			info("thread %d: rendering wait for task", thread_index);
-		#endif
+	// tasks from outside and from the single thread are distributed evenly,
+	// worker keeps the tasks released by itself for the better cache locality
+	int index = worker_index;
+	if (index <= 0 || index >= (int)workers.size())
+		index = 1 + (int)(next_worker++ % (unsigned int)get_workers_limit());
 
-		assert( wait.empty() || !tasks_in_process.empty() || !queue2.empty() );
+	Worker &worker = *workers[index];
+	{
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		worker.tasks.push_back(task);
+		++worker.size;
+	}
+
+	++ready_count;
+	schedule_workers();
+}
+
+Task::Handle
+RenderQueue::pop(int worker_index)
+{
+	Worker &worker = *workers[worker_index];
+	if (worker.size <= 0)
+		return Task::Handle();
+	std::lock_guard<std::mutex> lock(worker.mutex);
+	if (worker.tasks.empty())
+		return Task::Handle();
+	Task::Handle task = worker.tasks.back();
+	worker.tasks.pop_back();
+	--worker.size;
+	--ready_count;
+	return task;
+}
 
-		(thread_index ? cond : single_cond).wait(lock);
+Task::Handle
+RenderQueue::steal(int worker_index)
+{
+	// deques beyond the current limit are checked too,
+	// they may keep tasks if the limit was decreased
+	const int count = (int)workers.size();
+	for(int i = 1; i < count; ++i)
+	{
+		int index = (worker_index + i) % count;
+		if (!index) continue;
+		Worker &worker = *workers[index];
+		if (worker.size <= 0)
+			continue;
+		std::lock_guard<std::mutex> lock(worker.mutex);
+		if (worker.tasks.empty())
+			continue;
+		Task::Handle task = worker.tasks.front();
+		worker.tasks.pop_front();
+		--worker.size;
+		--ready_count;
+		return task;
 	}
 	return Task::Handle();
 }
@@ -267,94 +391,49 @@ RenderQueue::get(int thread_index)
 void
 RenderQueue::fix_task(const Task &task, const Task::RunParams &params)
 {
-	//for(Task::List::iterator i = task.back_deps.begin(); i != task.back_deps.end();)
-	//	if (*i) ++i; else i = (*i)->back_deps.erase(i);
 	task.renderer_data.params = params;
 	task.renderer_data.params.sub_queue.clear();
 	task.renderer_data.success = true;
+	task.renderer_data.cancelled = false;
+	task.renderer_data.live_back_deps = (int)task.renderer_data.back_deps.size();
 }
 
-int
-RenderQueue::get_threads_count() const
+void
+RenderQueue::mark_cancelled(const Task::Handle &task)
 {
-	return threads.size();
+	// task is not needed anymore if all tasks waiting for it was cancelled,
+	// deps are not changed after enqueue, but back_deps are cleared
+	// when the task is done, so the count of live back_deps is used
+	Task::List stack(1, task);
+	while(!stack.empty())
+	{
+		Task::Handle t = stack.back();
+		stack.pop_back();
+		if (t->renderer_data.cancelled.exchange(true))
+			continue;
+		for(Task::List::const_iterator i = t->renderer_data.deps.begin(); i != t->renderer_data.deps.end(); ++i)
+			if (*i && (*i)->renderer_data.live_back_deps.fetch_sub(1) == 1)
+				stack.push_back(*i);
+	}
 }
 
-bool
-RenderQueue::remove_if_orphan(const Task::Handle &task, bool in_queue)
+int
+RenderQueue::get_threads_count() const
 {
-	// mutex must be already locked
-
-	if (!task)
-		return true;
-
-	TaskSet* tasks = nullptr;
-	TaskSet::iterator ii;
-	if (!in_queue) {
-		bool mt = task->get_allow_multithreading();
-		tasks = mt ? &not_ready_tasks : &single_not_ready_tasks;
-		ii = tasks->find(task);
-		if (ii == tasks->end())
-			return true;
-	}
-
-	if (TaskEvent::Handle task_event = TaskEvent::Handle::cast_dynamic(task))
-		if (!task_event->is_finished())
-			return false;
-
-	if (!task->renderer_data.back_deps.empty())
-		return false;
-		
-	for(TaskSet::iterator i = task->renderer_data.deps.begin(); i != task->renderer_data.deps.end(); ++i)
-		if (*i) {
-			(*i)->renderer_data.back_deps.erase(task);
-			if ((*i)->renderer_data.back_deps.empty())
-				remove_if_orphan(*i, false);
-		}
-	task->renderer_data.deps.clear();
-
-	// don't remove task if 'in_queue' is set (it will removed by caller)
-	if (tasks) tasks->erase(ii);
-	return true;
+	return 1 + get_workers_limit();
 }
 
-void
-RenderQueue::remove_orphans()
+int
+RenderQueue::get_queue_size() const
 {
-	// mutex must be already locked
-
-	for(TaskQueue::iterator i = ready_tasks.begin(); i != ready_tasks.end();)
-		if (remove_if_orphan(*i, true)) ready_tasks.erase(i++); else ++i;
-	for(TaskQueue::iterator i = single_ready_tasks.begin(); i != single_ready_tasks.end();)
-		if (remove_if_orphan(*i, true)) single_ready_tasks.erase(i++); else ++i;
-
-	for(TaskSet::iterator i = not_ready_tasks.begin(); i != not_ready_tasks.end();)
-		if (remove_if_orphan(*i, true)) not_ready_tasks.erase(i++); else ++i;
-	for(TaskSet::iterator i = single_not_ready_tasks.begin(); i != single_not_ready_tasks.end();)
-		if (remove_if_orphan(*i, true)) single_not_ready_tasks.erase(i++); else ++i;
+	return std::max(0, (int)ready_count);
 }
 
-
 void
 RenderQueue::enqueue(const Task::Handle &task, const Task::RunParams &params)
 {
 	if (!task) return;
-	fix_task(*task, params);
-	std::lock_guard<std::mutex> lock(mutex);
-
-	bool mt = task->get_allow_multithreading();
-	TaskQueue &queue = mt ? ready_tasks     : single_ready_tasks;
-	TaskSet   &wait  = mt ? not_ready_tasks : single_not_ready_tasks;
-	if (task->renderer_data.deps.empty()) {
-		queue.push_back(task);
-		(mt ? cond : single_cond).notify_one();
-	}
-	else
-	{
-		wait.insert(task);
-	}
-
-	remove_orphans();
+	enqueue(Task::List(1, task), params);
 }
 
 void
@@ -362,62 +441,19 @@ RenderQueue::enqueue(const Task::List &tasks, const Task::RunParams &params)
 {
 	Task::RunParams p(params);
 	p.sub_queue.clear();
-	int count = 0;
-	for(Task::List::const_iterator i = tasks.begin(); i != tasks.end(); ++i)
-		if (*i) { fix_task(**i, p); ++count; }
-	if (!count) return;
 
-	std::lock_guard<std::mutex> lock(mutex);
-	int single_signals = 0;
-	int signals = 0;
+	// collect ready tasks before any of them will started,
+	// because finished tasks will push their dependents by themselves
+	Task::List ready;
 	for(Task::List::const_iterator i = tasks.begin(); i != tasks.end(); ++i)
-	{
-		if (*i)
-		{
-			bool mt = (*i)->get_allow_multithreading();
-			if ((*i)->renderer_data.deps.empty()) {
-				TaskQueue &queue = mt ? ready_tasks     : single_ready_tasks;
-				queue.push_back(*i);
-				++(mt ? signals : single_signals);
-			} else {
-				TaskSet   &wait  = mt ? not_ready_tasks : single_not_ready_tasks;
-				wait.insert(*i);
-			}
+		if (*i) {
+			fix_task(**i, p);
+			if ((*i)->renderer_data.deps_count == 0)
+				ready.push_back(*i);
 		}
-	}
-
-	// limit signals count
-	int threads = get_threads_count() - 1;
-	if (signals > threads) signals = threads;
-	if (single_signals > 1) single_signals = 1;
-
-	// wake up
-	while(signals-- > 0) cond.notify_one();
-	while(single_signals-- > 0) single_cond.notify_one();
 
-	remove_orphans();
-}
-
-bool
-RenderQueue::remove_task(const Task::Handle &task)
-{
-	bool found = false;
-	if (task) {
-		bool mt = task->get_allow_multithreading();
-		TaskQueue &queue = mt ? ready_tasks     : single_ready_tasks;
-		TaskSet   &wait  = mt ? not_ready_tasks : single_not_ready_tasks;
-
-		for(TaskQueue::iterator i = queue.begin(); i != queue.end(); ) {
-			if (*i == task) {
-				found = true;
-				i = queue.erase(i);
-			} else {
-				++i;
-			}
-		}
-		if (wait.erase(task)) found = true;
-	}
-	return found;
+	for(Task::List::const_iterator i = ready.begin(); i != ready.end(); ++i)
+		push(-1, *i);
 }
 
 void
@@ -425,11 +461,9 @@ RenderQueue::cancel(const Task::Handle &task)
 {
 	if (!task) return;
 
-	{
-		std::lock_guard<std::mutex> lock(mutex);
-		if (remove_task(task))
-			remove_orphans();
-	}
+	// task will be skipped when it became ready, and so will be
+	// the pending tasks which was needed only for it
+	mark_cancelled(task);
 
 	if (TaskEvent::Handle task_event = TaskEvent::Handle::cast_dynamic(task))
 		task_event->finish(false);
@@ -438,34 +472,24 @@ RenderQueue::cancel(const Task::Handle &task)
 void
 RenderQueue::cancel(const Task::List &list)
 {
-	if (list.empty()) return;
-
-	TaskEvent::List events;
-
-	{
-		std::lock_guard<std::mutex> lock(mutex);
-		bool found = false;
-		for(Task::List::const_iterator i = list.begin(); i != list.end(); ++i) {
-			if (remove_task(*i))
-				found = true;
-			if (TaskEvent::Handle task_event = TaskEvent::Handle::cast_dynamic(*i))
-				events.push_back(task_event);
-		}
-		if (found) remove_orphans();
-	}
-
-	for(TaskEvent::List::const_iterator i = events.begin(); i != events.end(); ++i)
-		(*i)->finish(false);
+	for(Task::List::const_iterator i = list.begin(); i != list.end(); ++i)
+		cancel(*i);
 }
 
 void
 RenderQueue::clear()
 {
-	std::lock_guard<std::mutex> lock(mutex);
-	ready_tasks.clear();
-	single_ready_tasks.clear();
-	not_ready_tasks.clear();
-	single_not_ready_tasks.clear();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		single_ready_tasks.clear();
+	}
+	for(WorkerList::const_iterator i = workers.begin(); i != workers.end(); ++i)
+	{
+		std::lock_guard<std::mutex> lock((*i)->mutex);
+		ready_count -= (int)(*i)->tasks.size();
+		(*i)->size = 0;
+		(*i)->tasks.clear();
+	}
 }
 
 /* === E N T R Y P O I N T ================================================= */
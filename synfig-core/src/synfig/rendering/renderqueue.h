@@ -30,7 +30,10 @@
 
 /* === H E A D E R S ======================================================= */
 
-#include <map>
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <vector>
 
 #include <mutex>
 #include <condition_variable>
@@ -49,49 +52,82 @@ namespace synfig
 namespace rendering
 {
 
+/*!	\class RenderQueue
+**	\brief Runs the enqueued tasks when their dependencies are done.
+**
+**	The dedicated thread 0 is reserved for the tasks which don't allow
+**	multithreading (see Task::get_allow_multithreading()), they are handled
+**	one by one in order. The other tasks are run by the workers scheduled
+**	into synfig::ThreadPool with ThreadPool::PRIORITY_RENDER, so rendering
+**	shares the core budget with the optimizer. Every worker owns a deque
+**	of ready tasks: it takes its own work from the back and steals from
+**	the front of the other deques when its own deque is empty. A worker
+**	returns its thread to the pool when there are no ready tasks left.
+**	Dependencies are tracked by the atomic Task::RendererData::deps_count
+**	counters, so finishing a task doesn't need any global lock.
+**	Cancellation of a task is passed to the tasks which are waiting for it
+**	and to the pending tasks which are not needed by anybody else.
+*/
 class RenderQueue
 {
 public:
-	typedef std::list<std::thread> ThreadList;
-	typedef std::map<int, Task::Handle> ThreadTaskMap;
-	typedef std::set<Task::Handle> TaskSet;
-	typedef std::list<Task::Handle> TaskQueue;
+	typedef std::deque<Task::Handle> TaskQueue;
 
 private:
-	static int last_batch_index;
+	struct Worker
+	{
+		std::mutex mutex;
+		TaskQueue tasks;
+		std::atomic<int> size;
+		std::atomic<bool> scheduled;
+		Worker(): size(0), scheduled(false) { }
+	};
+	typedef std::vector< std::shared_ptr<Worker> > WorkerList;
 
 	std::mutex mutex;
-	std::mutex threads_mutex;
 	std::condition_variable cond;
 	std::condition_variable single_cond;
 
-	TaskQueue ready_tasks;
 	TaskQueue single_ready_tasks;
-	TaskSet not_ready_tasks;
-	TaskSet single_not_ready_tasks;
+	WorkerList workers;
 
-	bool started;
+	std::atomic<bool> started;
+	std::atomic<int> ready_count;
+	std::atomic<int> scheduled_count;
+	std::atomic<int> running_workers; // including workers which are waiting in the pool queue
+	std::atomic<unsigned int> next_worker;
 
-	ThreadList threads;
-	ThreadTaskMap tasks_in_process;
+	std::thread single_thread;
 
 	void start();
 	void stop();
 
-	void process(int thread_index);
-	void done(int thread_index, const Task::Handle &task);
-	Task::Handle get(int thread_index);
+	void process_single();
+	void process(int worker_index);
+	void run_task(int worker_index, const Task::Handle &task);
+	void done(int worker_index, const Task::Handle &task);
+
+	int get_workers_limit() const;
+	void schedule_workers();
+	void push(int worker_index, const Task::Handle &task);
+	Task::Handle pop(int worker_index);
+	Task::Handle steal(int worker_index);
 
 	static void fix_task(const Task &task, const Task::RunParams &params);
-	bool remove_if_orphan(const Task::Handle &task, bool in_queue);
-	void remove_orphans();
-	bool remove_task(const Task::Handle &task);
+	static void mark_cancelled(const Task::Handle &task);
 
 public:
 	RenderQueue();
 	~RenderQueue();
 
+	//! Count of threads which may run tasks simultaneously, including thread 0
 	int get_threads_count() const;
+	//! Count of tasks which are ready to run but still wait for a free thread
+	int get_queue_size() const;
+	//! Count of workers which are currently scheduled into the thread pool
+	int get_scheduled_workers_count() const
+		{ return scheduled_count; }
+
 	void enqueue(const Task::Handle &task, const Task::RunParams &params);
 	void enqueue(const Task::List &tasks, const Task::RunParams &params);
 	void cancel(const Task::Handle &task);
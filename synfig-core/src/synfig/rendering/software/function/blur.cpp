@@ -35,7 +35,11 @@
 #include <cassert>
 
 #include <algorithm>
+#include <deque>
 #include <functional>
+#include <vector>
+
+#include <synfig/threadpool.h>
 
 #include "blur.h"
 
@@ -51,8 +55,155 @@ using namespace rendering;
 
 /* === G L O B A L S ======================================================= */
 
+namespace {
+//! Smaller FFT blurs are not worth to spread over threads
+const int fft_parallel_min_pixels = 256*256;
+//! Lines of a channel transformed in one task of separable FFT blur
+const int fft_lines_per_task = 64;
+
+//! Smaller box and pattern blurs run in the calling thread
+const int blur_parallel_min_pixels = 128*128;
+//! Rows in one task of a horizontal pass
+const int blur_band_rows = 32;
+//! Columns in one task of a vertical pass, they are copied into
+//! contiguous lines to not walk the surface with the stride of a row
+const int blur_tile_cols = 16;
+}
+
 /* === P R O C E D U R E S ================================================= */
 
+namespace {
+
+using software::BlurTemplates;
+using software::FFT;
+
+void
+fft_blur_full(software::Array<Complex, 2> channel, software::Array<Complex, 2> pattern)
+{
+	FFT::fft2d(channel, false);
+	channel.process< std::multiplies<Complex> >(pattern);
+	FFT::fft2d(channel, true);
+}
+
+void
+fft_blur_lines(software::Array<Complex, 2> lines, software::Array<Complex, 1> pattern)
+{
+	FFT::fft2d(lines, false, true, false);
+	for(software::Array<Complex, 2>::Iterator l(lines); l; ++l)
+		l->process< std::multiplies<Complex> >(pattern);
+	FFT::fft2d(lines, true, true, false);
+}
+
+//! Blurs the lines of each channel, in blocks of lines when \a parallel
+void
+fft_blur_channels_lines(const software::Array<Complex, 3> &channels, const software::Array<Complex, 1> &pattern, bool parallel)
+{
+	if (!parallel) {
+		for(software::Array<Complex, 3>::Iterator channel(channels); channel; ++channel)
+			fft_blur_lines(*channel, pattern);
+		return;
+	}
+
+	ThreadPool::Group group(ThreadPool::PRIORITY_RENDER);
+	for(software::Array<Complex, 3>::Iterator channel(channels); channel; ++channel)
+		for(int i = 0; i < channel->count; i += fft_lines_per_task)
+			group.enqueue( sigc::bind(
+				sigc::ptr_fun(&fft_blur_lines),
+				channel->get_range(0, i, std::min(i + fft_lines_per_task, channel->count)),
+				pattern ));
+	group.run();
+}
+
+typedef software::Array<ColorReal, 3> SurfaceArray;
+
+//! Runs \a slot in \a group, or right now when not \a parallel
+void
+run_task(ThreadPool::Group &group, const ThreadPool::Slot &slot, bool parallel)
+	{ if (parallel) group.enqueue(slot); else slot(); }
+
+//! Copies the columns of \a surface ([rows][cols][channels])
+//! into contiguous lines of \a buffer ([channels][cols][rows])
+SurfaceArray
+columns_to_lines(const SurfaceArray &surface, std::vector<ColorReal> &buffer)
+{
+	const int rows = surface.get_count(0);
+	const int cols = surface.get_count(1);
+	const int channels = surface.get_count(2);
+	buffer.resize((size_t)rows*cols*channels);
+	SurfaceArray lines(&buffer.front());
+	lines
+		.set_dim(channels, cols*rows)
+		.set_dim(cols, rows)
+		.set_dim(rows, 1);
+	lines.reorder(2, 1, 0).assign(surface);
+	return lines;
+}
+
+void
+blur_box_lines(const software::Array<ColorReal, 2> &lines, std::deque<ColorReal> &q, int size, int count)
+{
+	for(software::Array<ColorReal, 2>::Iterator l(lines); l; ++l)
+		for(int i = 0; i < count; ++i)
+			BlurTemplates::blur_box_discrete(*l, q, size);
+}
+
+void
+blur_box_rows(SurfaceArray surface, int size, int count)
+{
+	std::deque<ColorReal> q;
+	for(SurfaceArray::Iterator r(surface); r; ++r)
+		blur_box_lines(r->reorder(1, 0), q, size, count);
+}
+
+void
+blur_box_columns(SurfaceArray surface, int size, int count)
+{
+	std::vector<ColorReal> buffer;
+	SurfaceArray lines = columns_to_lines(surface, buffer);
+	std::deque<ColorReal> q;
+	for(SurfaceArray::Iterator channel(lines); channel; ++channel)
+		blur_box_lines(*channel, q, size, count);
+	surface.assign(lines.reorder(2, 1, 0));
+}
+
+void
+blur_pattern_lines(
+	const software::Array<ColorReal, 2> &dst,
+	const software::Array<ColorReal, 2> &src,
+	const software::Array<ColorReal, 1> &pattern )
+{
+	for(software::Array<ColorReal, 2>::Iterator dl(dst), sl(src); dl; ++dl, ++sl)
+		BlurTemplates::blur_pattern(*dl, *sl, pattern);
+}
+
+void
+blur_pattern_rows(SurfaceArray dst, SurfaceArray src, software::Array<ColorReal, 1> pattern)
+{
+	for(SurfaceArray::Iterator dr(dst), sr(src); dr; ++dr, ++sr)
+		blur_pattern_lines(dr->reorder(1, 0), sr->reorder(1, 0), pattern);
+}
+
+void
+blur_2d_pattern_rows(SurfaceArray dst, SurfaceArray src, software::Array<ColorReal, 2> pattern)
+{
+	for(SurfaceArray::Iterator dc(dst.reorder(2, 0, 1)), sc(src.reorder(2, 0, 1)); dc; ++dc, ++sc)
+		BlurTemplates::blur_2d_pattern(*dc, *sc, pattern);
+}
+
+void
+blur_pattern_columns(SurfaceArray dst, SurfaceArray src, software::Array<ColorReal, 1> pattern)
+{
+	std::vector<ColorReal> dst_buffer;
+	std::vector<ColorReal> src_buffer;
+	SurfaceArray dst_lines = columns_to_lines(dst, dst_buffer);
+	SurfaceArray src_lines = columns_to_lines(src, src_buffer);
+	for(SurfaceArray::Iterator dc(dst_lines), sc(src_lines); dc; ++dc, ++sc)
+		blur_pattern_lines(*dc, *sc, pattern);
+	dst.assign(dst_lines.reorder(2, 1, 0));
+}
+
+}
+
 /* === M E T H O D S ======================================================= */
 
 bool
@@ -175,6 +326,7 @@ software::Blur::blur_pattern(const Params &params)
 	std::vector<ColorReal> col_pattern;
 	bool full = false;
 	bool cross = false;
+	const bool parallel = rows*cols >= blur_parallel_min_pixels;
 
 	Array<ColorReal, 3> arr_src_surface(&src_surface.front());
 	Array<ColorReal, 3> arr_dst_surface(&dst_surface.front());
@@ -255,40 +407,56 @@ software::Blur::blur_pattern(const Params &params)
 	if (full)
 	{
 		BlurTemplates::normalize_half_pattern_2d( arr_full_pattern );
-		for(Array<ColorReal, 3>::Iterator dst(arr_dst_surface.reorder(2, 0, 1)), src(arr_src_surface.reorder(2, 0, 1)); dst; ++dst, ++src)
-			BlurTemplates::blur_2d_pattern(*dst, *src, arr_full_pattern);
+
+		// each band of rows reads pattern_rows - 1 rows around it
+		const int margin = pattern_rows - 1;
+		ThreadPool::Group group(ThreadPool::PRIORITY_RENDER);
+		for(int y = margin; y < rows - margin; y += blur_band_rows)
+			run_task(group, sigc::bind(
+				sigc::ptr_fun(&blur_2d_pattern_rows),
+				arr_dst_surface.get_range(0, y - margin, std::min(y + blur_band_rows, rows - margin) + margin),
+				arr_src_surface.get_range(0, y - margin, std::min(y + blur_band_rows, rows - margin) + margin),
+				arr_full_pattern ), parallel);
+		group.run();
 	}
 	else
 	{
 		BlurTemplates::normalize_half_pattern( arr_row_pattern );
 		BlurTemplates::normalize_half_pattern( arr_col_pattern );
 
-		Array<ColorReal, 3> arr_src_surface_rows(arr_src_surface.reorder(2, 0, 1));
-		Array<ColorReal, 3> arr_src_surface_cols(arr_src_surface_rows.reorder(0, 2, 1));
-
-		Array<ColorReal, 3> arr_dst_surface_rows(arr_dst_surface.reorder(2, 0, 1));
-		Array<ColorReal, 3> arr_dst_surface_cols(arr_dst_surface_rows.reorder(0, 2, 1));
-
 		if (cross)
 		{
 			arr_row_pattern.process< std::multiplies<ColorReal> >(0.5);
 			arr_col_pattern.process< std::multiplies<ColorReal> >(0.5);
 		}
 
-		for(Array<ColorReal, 3>::Iterator src_channel(arr_src_surface_rows), dst_channel(arr_dst_surface_rows); dst_channel; ++src_channel, ++dst_channel)
-			for(Array<ColorReal, 2>::Iterator sr(*src_channel), dr(*dst_channel); dr; ++sr, ++dr)
-				BlurTemplates::blur_pattern(*dr, *sr, arr_row_pattern);
+		{
+			ThreadPool::Group group(ThreadPool::PRIORITY_RENDER);
+			for(int y = 0; y < rows; y += blur_band_rows)
+				run_task(group, sigc::bind(
+					sigc::ptr_fun(&blur_pattern_rows),
+					arr_dst_surface.get_range(0, y, std::min(y + blur_band_rows, rows)),
+					arr_src_surface.get_range(0, y, std::min(y + blur_band_rows, rows)),
+					arr_row_pattern ), parallel);
+			group.run();
+		}
 
 		if (!cross)
 		{
-			std::swap(arr_src_surface_cols.pointer, arr_dst_surface_cols.pointer);
 			std::swap(arr_src_surface.pointer, arr_dst_surface.pointer);
 			memset(&src_surface.front(), 0, sizeof(src_surface.front())*src_surface.size());
 		}
 
-		for(Array<ColorReal, 3>::Iterator src_channel(arr_src_surface_cols), dst_channel(arr_dst_surface_cols); dst_channel; ++src_channel, ++dst_channel)
-			for(Array<ColorReal, 2>::Iterator sr(*src_channel), dr(*dst_channel); dr; ++sr, ++dr)
-				BlurTemplates::blur_pattern(*dr, *sr, arr_col_pattern);
+		{
+			ThreadPool::Group group(ThreadPool::PRIORITY_RENDER);
+			for(int x = 0; x < cols; x += blur_tile_cols)
+				run_task(group, sigc::bind(
+					sigc::ptr_fun(&blur_pattern_columns),
+					arr_dst_surface.get_range(1, x, std::min(x + blur_tile_cols, cols)),
+					arr_src_surface.get_range(1, x, std::min(x + blur_tile_cols, cols)),
+					arr_col_pattern ), parallel);
+			group.run();
+		}
 	}
 
 	// copy result surface and restore alpha
@@ -315,6 +483,9 @@ software::Blur::blur_fft(const Params &params)
 	std::vector<Complex> col_pattern;
 	bool full = false;
 	bool cross = false;
+	// FFT plans are executed without locks, so channels
+	// and blocks of lines may be transformed simultaneously
+	const bool parallel = rows*cols >= fft_parallel_min_pixels;
 
 	Array<Real, 4> arr_surface((Real*)&surface.front());
 
@@ -397,12 +568,18 @@ software::Blur::blur_fft(const Params &params)
 		BlurTemplates::normalize_full_pattern_2d( arr_full_pattern.reorder(0, 1) );
 
 		FFT::fft2d(arr_full_pattern.group_items<Complex>(), false);
+		ThreadPool::Group group(ThreadPool::PRIORITY_RENDER);
 		for(Array<Complex, 3>::Iterator channel(arr_surface.group_items<Complex>().reorder(2, 0, 1)); channel; ++channel)
 		{
-			FFT::fft2d(*channel, false);
-			channel->process< std::multiplies<Complex> >(arr_full_pattern.group_items<Complex>());
-			FFT::fft2d(*channel, true);
+			if (parallel)
+				group.enqueue( sigc::bind(
+					sigc::ptr_fun(&fft_blur_full),
+					*channel,
+					arr_full_pattern.group_items<Complex>() ));
+			else
+				fft_blur_full(*channel, arr_full_pattern.group_items<Complex>());
 		}
+		group.run();
 	}
 	else
 	{
@@ -424,22 +601,10 @@ software::Blur::blur_fft(const Params &params)
 		}
 
 		FFT::fft(arr_row_pattern.group_items<Complex>(), false);
-		for(Array<Complex, 3>::Iterator channel(arr_surface_rows); channel; ++channel)
-		{
-			FFT::fft2d(*channel, false, true, false);
-			for(Array<Complex, 2>::Iterator r(*channel); r; ++r)
-				r->process< std::multiplies<Complex> >(arr_row_pattern.group_items<Complex>());
-			FFT::fft2d(*channel, true, true, false);
-		}
+		fft_blur_channels_lines(arr_surface_rows, arr_row_pattern.group_items<Complex>(), parallel);
 
 		FFT::fft(arr_col_pattern.group_items<Complex>(), false);
-		for(Array<Complex, 3>::Iterator channel(arr_surface_cols); channel; ++channel)
-		{
-			FFT::fft2d(*channel, false, true, false);
-			for(Array<Complex, 2>::Iterator c(*channel); c; ++c)
-				c->process< std::multiplies<Complex> >(arr_col_pattern.group_items<Complex>());
-			FFT::fft2d(*channel, true, true, false);
-		}
+		fft_blur_channels_lines(arr_surface_cols, arr_col_pattern.group_items<Complex>(), parallel);
 
 		arr_surface_rows.process< BlurTemplates::Abs<Complex> >();
 		if (cross)
@@ -465,7 +630,6 @@ software::Blur::blur_fft(const Params &params)
 void
 software::Blur::blur_box(const Params &params)
 {
-	const Real precision(1e-5);
 	const int channels = 4;
 	int rows = params.src_rect.get_size()[1];
 	int cols = params.src_rect.get_size()[0];
@@ -498,10 +662,9 @@ software::Blur::blur_box(const Params &params)
 		return;
 	}
 
-	std::deque<ColorReal> q;
+	const bool parallel = rows*cols >= blur_parallel_min_pixels;
 	std::vector<ColorReal> surface_copy;
-	Array<ColorReal, 3> arr_surface_rows(arr_surface.reorder(2, 0, 1));
-	Array<ColorReal, 3> arr_surface_cols(arr_surface_rows.reorder(0, 2, 1));
+	Array<ColorReal, 3> arr_surface_cols(arr_surface);
 
 	if (cross)
 	{
@@ -510,32 +673,31 @@ software::Blur::blur_box(const Params &params)
 		arr_surface_cols.pointer = &surface_copy.front();
 	}
 
-	if (true || fabs(size[0] - round(size[0])) < precision)
-		for(Array<ColorReal, 3>::Iterator channel(arr_surface_rows); channel; ++channel)
-			for(Array<ColorReal, 2>::Iterator r(*channel); r; ++r)
-				for(int i = 0; i < count; ++i)
-					BlurTemplates::blur_box_discrete(*r, q, (int)round(size[0]));
-	else
-		for(Array<ColorReal, 3>::Iterator channel(arr_surface_rows); channel; ++channel)
-			for(Array<ColorReal, 2>::Iterator r(*channel); r; ++r)
-				for(int i = 0; i < count; ++i)
-					BlurTemplates::blur_box_aa(*r, q, (ColorReal)size[0]);
-
-	if (true || fabs(size[1] - round(size[1])) < precision)
-		for(Array<ColorReal, 3>::Iterator channel(arr_surface_cols); channel; ++channel)
-			for(Array<ColorReal, 2>::Iterator c(*channel); c; ++c)
-				for(int i = 0; i < count; ++i)
-					BlurTemplates::blur_box_discrete(*c, q, (int)round(size[1]));
-	else
-		for(Array<ColorReal, 3>::Iterator channel(arr_surface_cols); channel; ++channel)
-			for(Array<ColorReal, 2>::Iterator c(*channel); c; ++c)
-				for(int i = 0; i < count; ++i)
-					BlurTemplates::blur_box_aa(*c, q, (ColorReal)size[1]);
+	// sizes are rounded, the antialiased box (BlurTemplates::blur_box_aa) was always disabled here
+	{
+		ThreadPool::Group group(ThreadPool::PRIORITY_RENDER);
+		for(int y = 0; y < rows; y += blur_band_rows)
+			run_task(group, sigc::bind(
+				sigc::ptr_fun(&blur_box_rows),
+				arr_surface.get_range(0, y, std::min(y + blur_band_rows, rows)),
+				(int)round(size[0]),
+				(int)count ), parallel);
+		group.run();
+	}
+
+	{
+		ThreadPool::Group group(ThreadPool::PRIORITY_RENDER);
+		for(int x = 0; x < cols; x += blur_tile_cols)
+			run_task(group, sigc::bind(
+				sigc::ptr_fun(&blur_box_columns),
+				arr_surface_cols.get_range(1, x, std::min(x + blur_tile_cols, cols)),
+				(int)round(size[1]),
+				(int)count ), parallel);
+		group.run();
+	}
 
 	if (cross)
-		arr_surface_rows
-			.process< std::plus<ColorReal> >(
-				arr_surface_cols.reorder(0, 2, 1) );
+		arr_surface.process< std::plus<ColorReal> >(arr_surface_cols);
 
 	BlurTemplates::surface_write(
 		*params.dest,
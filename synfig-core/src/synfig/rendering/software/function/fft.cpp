@@ -34,8 +34,12 @@
 
 #include <cassert>
 #include <climits>
+#include <cstdlib>
+#include <cstring>
 //#include <ccomplex>
 
+#include <map>
+#include <memory>
 #include <mutex>
 
 #include <vector>
@@ -43,6 +47,8 @@
 
 #include <fftw3.h>
 
+#include <synfig/general.h>
+
 #include "fft.h"
 
 #endif
@@ -54,6 +60,11 @@ using namespace rendering;
 
 /* === G L O B A L S ======================================================= */
 
+namespace {
+//! Seconds, FFTW_MEASURE falls back to estimation when it's out of time
+const double fft_measure_timelimit = 2.0;
+}
+
 /* === P R O C E D U R E S ================================================= */
 
 /* === M E T H O D S ======================================================= */
@@ -61,12 +72,137 @@ using namespace rendering;
 class software::FFT::Internal
 {
 public:
+	//! Layout of the transform: sign, alignment and the guru dims,
+	//! plans are reusable for any array with the same key
+	typedef std::vector<int> Key;
+
+	//! Destroys the plan under the planner lock,
+	//! fftw_destroy_plan is not thread-safe
+	class Plan
+	{
+	public:
+		fftw_plan plan;
+		explicit Plan(fftw_plan plan): plan(plan) { }
+		~Plan() {
+			std::lock_guard<std::mutex> lock(Internal::mutex);
+			fftw_destroy_plan(plan);
+		}
+	};
+	typedef std::shared_ptr<Plan> PlanPtr;
+	typedef std::map<Key, PlanPtr> PlanMap;
+
+	//! The cache is dropped entirely when it grows bigger
+	static const size_t max_plans = 256;
 	static std::set<int> counts;
+	//! Guards the FFTW planner, the only thread-safe FFTW calls are fftw_execute*
 	static std::mutex mutex;
+
+	static std::mutex plans_mutex;
+	static PlanMap plans;
+
+	static bool measure;
+	static bool wisdom_changed;
+	static std::string wisdom_filename;
+
+	static void add_dims(Key &key, int rank, const fftw_iodim *dims)
+	{
+		key.push_back(rank);
+		for(const fftw_iodim *i = dims; i < dims + rank; ++i)
+			{ key.push_back(i->n); key.push_back(i->is); key.push_back(i->os); }
+	}
+
+	static long long get_extent(int rank, const fftw_iodim *dims, long long extent)
+	{
+		for(const fftw_iodim *i = dims; i < dims + rank; ++i) {
+			if (i->is < 0) return 0;
+			extent += (long long)(i->n - 1)*i->is;
+		}
+		return extent;
+	}
+
+	static fftw_plan create_plan(
+		int rank, const fftw_iodim *dims,
+		int howmany_rank, const fftw_iodim *howmany_dims,
+		Complex *pointer, int sign )
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		// FFTW_MEASURE overwrites the array while planning,
+		// so plan on a scratch buffer with the same alignment
+		if (measure) {
+			long long extent = get_extent(rank, dims, 1);
+			if (extent > 0)
+				extent = get_extent(howmany_rank, howmany_dims, extent);
+			if (extent > 0) {
+				const int alignment = fftw_alignment_of((double*)pointer);
+				if (char *buffer = (char*)fftw_malloc(extent*sizeof(fftw_complex) + alignment)) {
+					fftw_complex *scratch = (fftw_complex*)(buffer + alignment);
+					fftw_plan plan = fftw_plan_guru_dft(
+						rank, dims, howmany_rank, howmany_dims,
+						scratch, scratch, sign, FFTW_MEASURE );
+					fftw_free(buffer);
+					if (plan) {
+						wisdom_changed = true;
+						return plan;
+					}
+				}
+			}
+		}
+
+		return fftw_plan_guru_dft(
+			rank, dims, howmany_rank, howmany_dims,
+			(fftw_complex*)pointer, (fftw_complex*)pointer,
+			sign, FFTW_ESTIMATE );
+	}
+
+	//! Plans are created once for each layout and then executed without locks
+	static void execute(
+		int rank, const fftw_iodim *dims,
+		int howmany_rank, const fftw_iodim *howmany_dims,
+		Complex *pointer, bool invert )
+	{
+		const int sign = invert ? FFTW_BACKWARD : FFTW_FORWARD;
+
+		Key key;
+		key.reserve(4 + 3*(rank + howmany_rank));
+		key.push_back(sign);
+		key.push_back(fftw_alignment_of((double*)pointer));
+		add_dims(key, rank, dims);
+		add_dims(key, howmany_rank, howmany_dims);
+
+		PlanPtr plan;
+		{
+			std::lock_guard<std::mutex> lock(plans_mutex);
+			PlanMap::const_iterator i = plans.find(key);
+			if (i != plans.end()) plan = i->second;
+		}
+
+		if (!plan) {
+			fftw_plan p = create_plan(rank, dims, howmany_rank, howmany_dims, pointer, sign);
+			if (!p) {
+				synfig::error("FFT: cannot create plan");
+				return;
+			}
+			plan = std::make_shared<Plan>(p);
+
+			std::lock_guard<std::mutex> lock(plans_mutex);
+			if (plans.size() >= max_plans)
+				plans.clear();
+			// another thread could create the same plan meanwhile, keep any of them
+			plans[key] = plan;
+		}
+
+		fftw_execute_dft(plan->plan, (fftw_complex*)pointer, (fftw_complex*)pointer);
+	}
 };
 
 std::set<int> software::FFT::Internal::counts;
 std::mutex software::FFT::Internal::mutex;
+std::mutex software::FFT::Internal::plans_mutex;
+software::FFT::Internal::PlanMap software::FFT::Internal::plans;
+bool software::FFT::Internal::measure = false;
+bool software::FFT::Internal::wisdom_changed = false;
+std::string software::FFT::Internal::wisdom_filename;
 
 void
 software::FFT::initialize()
@@ -80,12 +216,34 @@ software::FFT::initialize()
 			for(int c5 = c3; c5 < max5; c5 *= 5)
 				for(int c7 = c5; c7 < max7; c7 *= 7)
 					Internal::counts.insert(c7);
-	fftw_set_timelimit(0.0);
+
+	std::lock_guard<std::mutex> lock(Internal::mutex);
+
+	const char *planner = getenv("SYNFIG_FFT_PLANNER");
+	Internal::measure = planner && !strcmp(planner, "measure");
+	fftw_set_timelimit(Internal::measure ? fft_measure_timelimit : 0.0);
+
+	Internal::wisdom_changed = false;
+	const char *wisdom = getenv("SYNFIG_FFT_WISDOM");
+	Internal::wisdom_filename = wisdom ? wisdom : "";
+	if (!Internal::wisdom_filename.empty() && !fftw_import_wisdom_from_filename(Internal::wisdom_filename.c_str()))
+		synfig::info("FFT: cannot import wisdom from %s", Internal::wisdom_filename.c_str());
 }
 
 void
 software::FFT::deinitialize()
 {
+	{
+		std::lock_guard<std::mutex> lock(Internal::plans_mutex);
+		Internal::plans.clear();
+	}
+
+	std::lock_guard<std::mutex> lock(Internal::mutex);
+	if (Internal::wisdom_changed && !Internal::wisdom_filename.empty()
+	 && !fftw_export_wisdom_to_filename(Internal::wisdom_filename.c_str()) )
+		synfig::warning("FFT: cannot export wisdom to %s", Internal::wisdom_filename.c_str());
+	Internal::wisdom_changed = false;
+
 	Internal::counts.clear();
 }
 
@@ -120,15 +278,7 @@ software::FFT::fft(const Array<Complex, 1> &x, bool invert)
 	iodim.is = x.stride;
 	iodim.os = x.stride;
 
-	{
-		std::lock_guard<std::mutex> lock(Internal::mutex);
-		fftw_plan plan = fftw_plan_guru_dft(
-			1, &iodim, 0, nullptr,
-			(fftw_complex*)x.pointer, (fftw_complex*)x.pointer,
-			invert ? FFTW_BACKWARD : FFTW_FORWARD, FFTW_ESTIMATE );
-		fftw_execute(plan);
-		fftw_destroy_plan(plan);
-	}
+	Internal::execute(1, &iodim, 0, nullptr, x.pointer, invert);
 
 	// divide by count to complete back-FFT
 	if (invert)
@@ -155,27 +305,10 @@ software::FFT::fft2d(const Array<Complex, 2> &x, bool invert, bool do_rows, bool
 	iodim[1].is = x.stride;
 	iodim[1].os = x.stride;
 
-	{
-		std::lock_guard<std::mutex> lock(Internal::mutex);
-
-		fftw_plan plan;
-		if (do_rows && do_cols)
-		{
-			plan = fftw_plan_guru_dft(
-				2, iodim, 0, nullptr,
-				(fftw_complex*)x.pointer, (fftw_complex*)x.pointer,
-				invert ? FFTW_BACKWARD : FFTW_FORWARD, FFTW_ESTIMATE );
-		}
-		else
-		{
-			plan = fftw_plan_guru_dft(
-				1, &iodim[do_rows ? 0 : 1], 1, &iodim[do_rows ? 1 : 0],
-				(fftw_complex*)x.pointer, (fftw_complex*)x.pointer,
-				invert ? FFTW_BACKWARD : FFTW_FORWARD, FFTW_ESTIMATE );
-		}
-		fftw_execute(plan);
-		fftw_destroy_plan(plan);
-	}
+	if (do_rows && do_cols)
+		Internal::execute(2, iodim, 0, nullptr, x.pointer, invert);
+	else
+		Internal::execute(1, &iodim[do_rows ? 0 : 1], 1, &iodim[do_rows ? 1 : 0], x.pointer, invert);
 
 	// divide by count to complete back-FFT
 	if (invert)
@@ -32,6 +32,12 @@
 #	include <config.h>
 #endif
 
+#include <algorithm>
+#include <vector>
+
+#include <synfig/color/colorblendrow.h>
+#include <synfig/threadpool.h>
+
 #include "mesh.h"
 
 #endif
@@ -43,6 +49,16 @@ using namespace rendering;
 
 /* === G L O B A L S ======================================================= */
 
+namespace {
+//! Smaller meshes are rendered in the calling thread
+const int mesh_parallel_min_pixels = 128*128;
+const int mesh_parallel_min_triangles = 16;
+//! Side of a tile, triangles are binned to tiles and the tiles are rendered in parallel
+const int mesh_tile_size = 64;
+//! Pixels of a span written with one call of the row blend function
+const int mesh_span_chunk = 64;
+}
+
 /* === P R O C E D U R E S ================================================= */
 
 /* === M E T H O D S ======================================================= */
@@ -86,6 +102,193 @@ namespace {
 			if (coords[1] < 0.0 || coords[1] > size[1])
 				coords[1] -= floor(coords[1]/size[1])*size[1];
 		}
+
+		//! Blends pixels [x0, x1] of row \a y with a solid color,
+		//! \a colors holds mesh_span_chunk copies of it
+		inline static void fill_span(
+			synfig::Surface &surface, int x0, int x1, int y,
+			const Color *colors, Color::value_type opacity, ColorBlendRow::Func blend_row )
+		{
+			Color *dest = &surface[y][x0];
+			for(int count = x1 - x0 + 1; count > 0; count -= mesh_span_chunk, dest += mesh_span_chunk)
+				blend_row(dest, colors, std::min(count, mesh_span_chunk), opacity);
+		}
+
+		//! Blends pixels [x0, x1] of row \a y with the texture,
+		//! \a matrix transforms target pixels to texture coordinates
+		static void texture_span(
+			synfig::Surface &surface, int x0, int x1, int y,
+			const Matrix &matrix, const synfig::Surface &texture, const Rect &tex_bounds,
+			Color::value_type opacity, ColorBlendRow::Func blend_row )
+		{
+			Real tx[mesh_span_chunk], ty[mesh_span_chunk];
+			bool inside[mesh_span_chunk];
+			Color colors[mesh_span_chunk];
+
+			// coordinates are taken from the row origin for each pixel and not accumulated,
+			// so the result does not depend on where the span was clipped by the tile
+			const Vector origin = matrix.get_transformed(Vector(0.0, Real(y)));
+			const Vector tdx = matrix.get_transformed(Vector(1.0, 0.0), false);
+			Color *dest = &surface[y][x0];
+			for(int cx = x0; cx <= x1; cx += mesh_span_chunk, dest += mesh_span_chunk)
+			{
+				const int count = std::min(x1 - cx + 1, mesh_span_chunk);
+
+				// plain arrays without branches, so the compiler vectorizes this loop
+				for(int i = 0; i < count; ++i)
+				{
+					const Real x = Real(cx + i);
+					tx[i] = origin[0] + x*tdx[0];
+					ty[i] = origin[1] + x*tdx[1];
+					inside[i] = tx[i] >= tex_bounds.minx && tx[i] <= tex_bounds.maxx
+					         && ty[i] >= tex_bounds.miny && ty[i] <= tex_bounds.maxy;
+				}
+
+				// blend runs of pixels inside and outside of the texture,
+				// outside pixels get transparent color with zero alpha, as with alpha_pen before
+				for(int i = 0; i < count; )
+				{
+					int j = i + 1;
+					while(j < count && inside[j] == inside[i]) ++j;
+					if (inside[i])
+					{
+						for(int k = i; k < j; ++k)
+							colors[k] = texture.cubic_sample(tx[k], ty[k]);
+						blend_row(dest + i, colors + i, j - i, opacity);
+					}
+					else
+					{
+						std::fill(colors + i, colors + j, Color());
+						blend_row(dest + i, colors + i, j - i, Color::value_type(0));
+					}
+					i = j;
+				}
+			}
+		}
+	};
+
+	//! Triangles of a mesh with transformed vertices, binned to tiles of the target
+	class Rasterizer {
+	public:
+		struct Triangle
+		{
+			Vector p[3];
+			Vector t[3];
+			RectInt bounds;
+		};
+
+		synfig::Surface &target_surface;
+		RectInt bounds;
+		const synfig::Surface *texture;
+		Rect texture_rect;
+		Color color;
+		Color::value_type opacity;
+		Color::BlendMethod blend_method;
+		std::vector<Triangle> triangles;
+
+		Rasterizer(
+			synfig::Surface &target_surface,
+			const RectInt &target_rect,
+			const synfig::Surface *texture,
+			const Rect &texture_rect,
+			const Color &color,
+			Color::value_type opacity,
+			Color::BlendMethod blend_method
+		):
+			target_surface(target_surface),
+			bounds(target_rect & RectInt(0, 0, target_surface.get_w(), target_surface.get_h())),
+			texture(texture),
+			texture_rect(texture_rect),
+			color(color),
+			opacity(opacity),
+			blend_method(blend_method)
+		{ }
+
+		void add(const Vector &p0, const Vector &t0, const Vector &p1, const Vector &t1, const Vector &p2, const Vector &t2)
+		{
+			// pixels touched by render_triangle() lay between the rounded vertices
+			Internal::IntVector ip0(p0), ip1(p1), ip2(p2);
+			RectInt rect(
+				std::min(ip0.x, std::min(ip1.x, ip2.x)),
+				std::min(ip0.y, std::min(ip1.y, ip2.y)),
+				std::max(ip0.x, std::max(ip1.x, ip2.x)) + 1,
+				std::max(ip0.y, std::max(ip1.y, ip2.y)) + 1 );
+			rect &= bounds;
+			if (!rect.is_valid()) return;
+
+			triangles.push_back(Triangle());
+			Triangle &t = triangles.back();
+			t.p[0] = p0; t.p[1] = p1; t.p[2] = p2;
+			t.t[0] = t0; t.t[1] = t1; t.t[2] = t2;
+			t.bounds = rect;
+		}
+
+		void render_triangle(const Triangle &t, const RectInt &rect) const
+		{
+			if (texture)
+				software::Mesh::render_triangle(
+					target_surface, rect,
+					t.p[0], t.t[0], t.p[1], t.t[1], t.p[2], t.t[2],
+					*texture, texture_rect, opacity, blend_method );
+			else
+				software::Mesh::render_triangle(
+					target_surface, rect,
+					t.p[0], t.p[1], t.p[2],
+					color, opacity, blend_method );
+		}
+
+		void render_tile(const RectInt &rect, const std::vector<int> *indices) const
+		{
+			for(std::vector<int>::const_iterator i = indices->begin(); i != indices->end(); ++i)
+				render_triangle(triangles[*i], rect);
+		}
+
+		void run() const
+		{
+			if (!bounds.is_valid() || triangles.empty()) return;
+
+			if ( (int)triangles.size() < mesh_parallel_min_triangles
+			  || bounds.get_width()*bounds.get_height() < mesh_parallel_min_pixels )
+			{
+				for(std::vector<Triangle>::const_iterator i = triangles.begin(); i != triangles.end(); ++i)
+					render_triangle(*i, bounds);
+				return;
+			}
+
+			// tiles own disjoint pixels and keep the order of triangles,
+			// so the result is the same as when triangles are rendered one by one
+			const int tiles_x = (bounds.get_width() + mesh_tile_size - 1)/mesh_tile_size;
+			const int tiles_y = (bounds.get_height() + mesh_tile_size - 1)/mesh_tile_size;
+			std::vector< std::vector<int> > bins(tiles_x*tiles_y);
+			for(int i = 0; i < (int)triangles.size(); ++i)
+			{
+				const RectInt &r = triangles[i].bounds;
+				const int tx0 = (r.minx - bounds.minx)/mesh_tile_size;
+				const int ty0 = (r.miny - bounds.miny)/mesh_tile_size;
+				const int tx1 = (r.maxx - 1 - bounds.minx)/mesh_tile_size;
+				const int ty1 = (r.maxy - 1 - bounds.miny)/mesh_tile_size;
+				for(int ty = ty0; ty <= ty1; ++ty)
+					for(int tx = tx0; tx <= tx1; ++tx)
+						bins[ty*tiles_x + tx].push_back(i);
+			}
+
+			ThreadPool::Group group(ThreadPool::PRIORITY_RENDER);
+			for(int ty = 0; ty < tiles_y; ++ty)
+			{
+				for(int tx = 0; tx < tiles_x; ++tx)
+				{
+					const std::vector<int> &bin = bins[ty*tiles_x + tx];
+					if (bin.empty()) continue;
+					const int x = bounds.minx + tx*mesh_tile_size;
+					const int y = bounds.miny + ty*mesh_tile_size;
+					const RectInt rect = bounds & RectInt(x, y, x + mesh_tile_size, y + mesh_tile_size);
+					group.enqueue(
+						sigc::bind(sigc::mem_fun(*this, &Rasterizer::render_tile), rect, &bin),
+						Real(bin.size()) );
+				}
+			}
+			group.run();
+		}
 	};
 }
 
@@ -114,9 +317,10 @@ software::Mesh::render_triangle(
 	if (ip0.x >= bounds.maxx && ip1.x >= bounds.maxx && ip2.x >= bounds.maxx) return;
 	if (ip0.y >= bounds.maxy && ip1.y >= bounds.maxy && ip2.y >= bounds.maxy) return;
 
-	synfig::Surface::alpha_pen apen(target_surface.get_pen(0, 0));
-	apen.set_alpha(opacity);
-	apen.set_blend_method(blend_method);
+	// select the blend function once, instead of once per pixel in alpha_pen::put_value()
+	const ColorBlendRow::Func blend_row = ColorBlendRow::get_func(blend_method);
+	Color colors[mesh_span_chunk];
+	std::fill(colors, colors + mesh_span_chunk, color);
 
 	// sort points
 	if (ip0.y > ip1.y) std::swap(ip0, ip1);
@@ -150,14 +354,7 @@ software::Mesh::render_triangle(
 			if (x0 <  bounds.minx) x0 = bounds.minx;
 			if (x1 >= bounds.maxx) x1 = bounds.maxx-1;
 			if (x1 >= x0)
-			{
-				apen.move_to(x0, y);
-				for(int x = x0; x <= x1; ++x)
-				{
-					apen.put_value(color);
-					apen.inc_x();
-				}
-			}
+				Internal::fill_span(target_surface, x0, x1, y, colors, opacity, blend_row);
     	}
 
 		wx0 += dx02;
@@ -185,14 +382,7 @@ software::Mesh::render_triangle(
 			if (x0 <  bounds.minx) x0 = bounds.minx;
 			if (x1 >= bounds.maxx) x1 = bounds.maxx-1;
 			if (x1 >= x0)
-			{
-				apen.move_to(x0, y);
-				for(int x = x0; x <= x1; ++x)
-				{
-					apen.put_value(color);
-					apen.inc_x();
-				}
-			}
+				Internal::fill_span(target_surface, x0, x1, y, colors, opacity, blend_row);
     	}
 
 		wx0 += dx02_copy;
@@ -257,12 +447,9 @@ software::Mesh::render_triangle(
 	matrix_of_target_triangle.invert();
 
 	Matrix matrix = matrix_of_texture_triangle * matrix_of_target_triangle;
-	Vector tdx = matrix.get_transformed(Vector(1.0, 0.0), false);
-	//Vector tdy = matrix.get_transformed(Vector(0.0, 1.0), false);
 
-	synfig::Surface::alpha_pen apen(target_surface.get_pen(0, 0));
-	apen.set_alpha(opacity);
-	apen.set_blend_method(blend_method);
+	// select the blend function once, instead of once per pixel in alpha_pen::put_value()
+	const ColorBlendRow::Func blend_row = ColorBlendRow::get_func(blend_method);
 
     // sort points
     if (ip0.y > ip1.y) std::swap(ip0, ip1);
@@ -296,28 +483,9 @@ software::Mesh::render_triangle(
 			if (x0 <  bounds.minx) x0 = bounds.minx;
 			if (x1 >= bounds.maxx) x1 = bounds.maxx-1;
 			if (x1 >= x0)
-			{
-				apen.move_to(x0, y);
-				Vector tex_point = matrix.get_transformed(Vector(Real(x0), Real(y)));
-				for(int x = x0; x <= x1; ++x)
-				{
-					if (tex_point[0] < tex_bounds.minx || tex_point[0] > tex_bounds.maxx
-					 || tex_point[1] < tex_bounds.miny || tex_point[1] > tex_bounds.maxy)
-					{
-						apen.set_alpha(0.0);
-						apen.put_value(Color());
-					}
-					else
-					{
-						apen.set_alpha(opacity);
-						apen.put_value(texture.cubic_sample(tex_point[0], tex_point[1]));
-					}
-					// uncomment following line to debug
-					//apen.put_value(Color(0,0,1,0.5));
-					apen.inc_x();
-					tex_point += tdx;
-				}
-			}
+				Internal::texture_span(
+					target_surface, x0, x1, y,
+					matrix, texture, tex_bounds, opacity, blend_row );
     	}
 
 		wx0 += dx02;
@@ -345,28 +513,9 @@ software::Mesh::render_triangle(
 			if (x0 <  bounds.minx) x0 = bounds.minx;
 			if (x1 >= bounds.maxx) x1 = bounds.maxx-1;
 			if (x1 >= x0)
-			{
-				apen.move_to(x0, y);
-				Vector tex_point = matrix.get_transformed(Vector(Real(x0), Real(y)));
-				for(int x = x0; x <= x1; ++x)
-				{
-					if (tex_point[0] < tex_bounds.minx || tex_point[0] > tex_bounds.maxx
-					 || tex_point[1] < tex_bounds.miny || tex_point[1] > tex_bounds.maxy)
-					{
-						apen.set_alpha(0.0);
-						apen.put_value(Color());
-					}
-					else
-					{
-						apen.set_alpha(opacity);
-						apen.put_value(texture.cubic_sample(tex_point[0], tex_point[1]));
-					}
-					// uncomment following line to debug
-					//apen.put_value(Color(1,0,0,0.5));
-					apen.inc_x();
-					tex_point += tdx;
-				}
-			}
+				Internal::texture_span(
+					target_surface, x0, x1, y,
+					matrix, texture, tex_bounds, opacity, blend_row );
     	}
 
 		wx0 += dx02_copy;
@@ -396,19 +545,18 @@ software::Mesh::render_polygon(
 	if (vertices_strip <= 0) vertices_strip = sizeof(Vector);
 	if (triangles_strip <= 0) triangles_strip = sizeof(int[3]);
 
+	Rasterizer rasterizer(
+		target_surface, target_rect, nullptr, Rect(), color, opacity, blend_method );
+	rasterizer.triangles.reserve(triangles_count);
 	for(int i = 0; i < triangles_count; ++i)
 	{
 		int *triangle = (int*)((char*)triangles + i*triangles_strip);
-		render_triangle(
-			target_surface,
-			target_rect,
-			transform_matrix.get_transformed(*(Vector*)((char*)vertices + triangle[0]*vertices_strip)),
-			transform_matrix.get_transformed(*(Vector*)((char*)vertices + triangle[1]*vertices_strip)),
-			transform_matrix.get_transformed(*(Vector*)((char*)vertices + triangle[2]*vertices_strip)),
-			color,
-			opacity,
-			blend_method );
+		rasterizer.add(
+			transform_matrix.get_transformed(*(Vector*)((char*)vertices + triangle[0]*vertices_strip)), Vector(),
+			transform_matrix.get_transformed(*(Vector*)((char*)vertices + triangle[1]*vertices_strip)), Vector(),
+			transform_matrix.get_transformed(*(Vector*)((char*)vertices + triangle[2]*vertices_strip)), Vector() );
 	}
+	rasterizer.run();
 }
 
 void
@@ -477,23 +625,21 @@ software::Mesh::render_mesh(
 	if (tex_coords_strip <= 0) tex_coords_strip = sizeof(Vector);
 	if (triangles_strip <= 0) triangles_strip = sizeof(int[3]);
 
+	Rasterizer rasterizer(
+		target_surface, target_rect, &texture, texture_rect, Color(), opacity, blend_method );
+	rasterizer.triangles.reserve(triangles_count);
 	for(int i = 0; i < triangles_count; ++i)
 	{
 		int *triangle = (int*)((char*)triangles + i*triangles_strip);
-		render_triangle(
-			target_surface,
-			target_rect,
+		rasterizer.add(
 			transform_matrix.get_transformed(*(Vector*)((char*)vertices + triangle[0]*vertices_strip)),
 			texture_matrix.get_transformed(*(Vector*)((char*)tex_coords + triangle[0]*tex_coords_strip)),
 			transform_matrix.get_transformed(*(Vector*)((char*)vertices + triangle[1]*vertices_strip)),
 			texture_matrix.get_transformed(*(Vector*)((char*)tex_coords + triangle[1]*tex_coords_strip)),
 			transform_matrix.get_transformed(*(Vector*)((char*)vertices + triangle[2]*vertices_strip)),
-			texture_matrix.get_transformed(*(Vector*)((char*)tex_coords + triangle[2]*tex_coords_strip)),
-			texture,
-			texture_rect,
-			opacity,
-			blend_method );
+			texture_matrix.get_transformed(*(Vector*)((char*)tex_coords + triangle[2]*tex_coords_strip)) );
 	}
+	rasterizer.run();
 }
 
 void
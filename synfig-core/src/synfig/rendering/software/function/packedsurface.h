@@ -164,6 +164,8 @@ public:
 	void set_pixels(const Color *pixels, int width, int height, int pitch = 0);
 	int get_width() const { return width; }
 	int get_height() const { return height; }
+	//! Bytes taken by the packed pixels
+	size_t get_data_size() const { return data.size(); }
 	void get_pixels(Color *target) const;
 };
 
@@ -35,6 +35,7 @@
 #include <synfig/localization.h>
 
 #include "rendererdraftsw.h"
+#include "surfaceswcompact.h"
 
 #include "task/tasksw.h"
 
@@ -63,6 +64,7 @@ using namespace rendering;
 RendererDraftSW::RendererDraftSW()
 {
 	register_mode(TaskSW::mode_token.handle());
+	set_compact_surface_token(SurfaceSWRGBA8::token.handle());
 
 	// register optimizers
 	register_optimizer(new OptimizerDraftContour(2.0, true));
@@ -35,6 +35,7 @@
 #include <synfig/localization.h>
 
 #include "rendererlowressw.h"
+#include "surfaceswcompact.h"
 
 #include "task/tasksw.h"
 
@@ -64,6 +65,7 @@ RendererLowResSW::RendererLowResSW(int level):
 	level(level)
 {
 	register_mode(TaskSW::mode_token.handle());
+	set_compact_surface_token(SurfaceSWRGBA16F::token.handle());
 
 	// register optimizers
 	register_optimizer(new OptimizerDraftLowRes(level));
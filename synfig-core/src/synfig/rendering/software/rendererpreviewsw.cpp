@@ -35,6 +35,7 @@
 #include <synfig/localization.h>
 
 #include "rendererpreviewsw.h"
+#include "surfaceswcompact.h"
 
 #include  "task/tasksw.h"
 
@@ -65,6 +66,7 @@ using namespace rendering;
 RendererPreviewSW::RendererPreviewSW()
 {
 	register_mode(TaskSW::mode_token.handle());
+	set_compact_surface_token(SurfaceSWRGBA16F::token.handle());
 
 	// register optimizers
 	register_optimizer(new OptimizerTransformation());
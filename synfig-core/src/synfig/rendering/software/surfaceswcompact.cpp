@@ -0,0 +1,301 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/software/surfaceswcompact.cpp
+**	\brief SurfaceSWRGBA8 and SurfaceSWRGBA16F
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+#include "surfaceswcompact.h"
+
+#endif
+
+using namespace synfig;
+using namespace rendering;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+/* === P R O C E D U R E S ================================================= */
+
+namespace {
+
+//! Returns the pixels of \a surface, converted into \a buffer if it has no direct pointer
+const Color*
+get_source_pixels(const rendering::Surface &surface, std::vector<Color> &buffer)
+{
+	if (const Color *pixels = surface.get_pixels_pointer())
+		return pixels;
+	buffer.resize(surface.get_pixels_count());
+	return surface.get_pixels(&buffer.front()) ? &buffer.front() : nullptr;
+}
+
+inline uint8_t
+float_to_uint8(float x)
+{
+	// NaN goes to zero
+	return !(x > 0.f) ? 0
+	     : x >= 1.f   ? 255
+	     : (uint8_t)(x*255.f + 0.5f);
+}
+
+}
+
+/* === M E T H O D S ======================================================= */
+
+
+rendering::Surface::Token SurfaceSWRGBA8::token(
+	Desc<SurfaceSWRGBA8>("SurfaceSWRGBA8") );
+
+rendering::Surface::Token SurfaceSWRGBA16F::token(
+	Desc<SurfaceSWRGBA16F>("SurfaceSWRGBA16F") );
+
+
+bool
+SurfaceSWRGBA8::fits(const Color *src, size_t count)
+{
+	for(const Color *end = src + count; src < end; ++src) {
+		const float a = src->get_a();
+		// written this way to reject NaN too
+		if (!(a >= 0.f && a <= 1.f))
+			return false;
+		const float r = src->get_r()*a, g = src->get_g()*a, b = src->get_b()*a;
+		if (!(r >= 0.f && r <= 1.f && g >= 0.f && g <= 1.f && b >= 0.f && b <= 1.f))
+			return false;
+	}
+	return true;
+}
+
+void
+SurfaceSWRGBA8::encode(const Color *src, uint8_t *dest, size_t count)
+{
+	for(const Color *end = src + count; src < end; ++src, dest += 4) {
+		const float a = std::max(0.f, std::min(1.f, src->get_a()));
+		dest[0] = float_to_uint8(src->get_r()*a);
+		dest[1] = float_to_uint8(src->get_g()*a);
+		dest[2] = float_to_uint8(src->get_b()*a);
+		dest[3] = float_to_uint8(a);
+	}
+}
+
+void
+SurfaceSWRGBA8::decode(const uint8_t *src, Color *dest, size_t count)
+{
+	for(Color *end = dest + count; dest < end; ++dest, src += 4) {
+		if (!src[3]) {
+			*dest = Color(0.f, 0.f, 0.f, 0.f);
+			continue;
+		}
+		// (c/255)/(a/255) == c/a
+		const float k = 1.f/src[3];
+		*dest = Color(src[0]*k, src[1]*k, src[2]*k, src[3]*(1.f/255.f));
+	}
+}
+
+bool
+SurfaceSWRGBA8::create_vfunc(int width, int height)
+{
+	pixels.assign((size_t)width*height*4, 0);
+	return true;
+}
+
+bool
+SurfaceSWRGBA8::assign_vfunc(const rendering::Surface &surface)
+{
+	if (const SurfaceSWRGBA8 *same = dynamic_cast<const SurfaceSWRGBA8*>(&surface))
+		{ pixels = same->pixels; return true; }
+
+	std::vector<Color> buffer;
+	const Color *src = get_source_pixels(surface, buffer);
+	if (!src || !fits(src, surface.get_pixels_count()))
+		return false;
+	pixels.resize((size_t)surface.get_pixels_count()*4);
+	encode(src, &pixels.front(), surface.get_pixels_count());
+	return true;
+}
+
+bool
+SurfaceSWRGBA8::clear_vfunc()
+{
+	std::fill(pixels.begin(), pixels.end(), 0);
+	return true;
+}
+
+bool
+SurfaceSWRGBA8::reset_vfunc()
+{
+	std::vector<uint8_t>().swap(pixels);
+	return true;
+}
+
+bool
+SurfaceSWRGBA8::get_pixels_vfunc(Color *dest) const
+{
+	assert(pixels.size() == (size_t)get_pixels_count()*4);
+	decode(&pixels.front(), dest, get_pixels_count());
+	return true;
+}
+
+
+uint16_t
+SurfaceSWRGBA16F::float_to_half(float x)
+{
+	uint32_t bits;
+	memcpy(&bits, &x, sizeof(bits));
+	const uint16_t sign = (bits >> 16) & 0x8000;
+	bits &= 0x7fffffff;
+
+	if (bits > 0x7f800000)
+		return 0; // NaN
+	if (bits >= 0x477ff000)
+		return sign | 0x7bff; // clamp to the max finite value (65504)
+
+	if (bits < 0x38800000) {
+		// subnormal half, the value is m*2^-24
+		if (bits < 0x33000000)
+			return sign;
+		const int shift = 126 - (int)(bits >> 23);
+		const uint32_t m = (bits & 0x7fffff) | 0x800000;
+		uint32_t h = m >> shift;
+		const uint32_t rest = m & ((1u << shift) - 1);
+		const uint32_t middle = 1u << (shift - 1);
+		if (rest > middle || (rest == middle && (h & 1))) ++h;
+		return sign | (uint16_t)h;
+	}
+
+	// rebias the exponent from 127 to 15 and round to nearest even,
+	// the carry from the mantissa goes to the exponent correctly
+	uint32_t h = (bits - 0x38000000) >> 13;
+	const uint32_t rest = bits & 0x1fff;
+	if (rest > 0x1000 || (rest == 0x1000 && (h & 1))) ++h;
+	return sign | (uint16_t)h;
+}
+
+float
+SurfaceSWRGBA16F::half_to_float(uint16_t x)
+{
+	const uint32_t sign = (uint32_t)(x & 0x8000) << 16;
+	const uint32_t exponent = (x >> 10) & 0x1f;
+	const uint32_t mantissa = x & 0x3ff;
+
+	uint32_t bits;
+	if (exponent == 0) {
+		const float f = mantissa*(1.f/16777216.f);
+		return sign ? -f : f;
+	} else
+	if (exponent == 31) {
+		bits = sign | 0x7f800000 | (mantissa << 13);
+	} else {
+		bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+	}
+
+	float f;
+	memcpy(&f, &bits, sizeof(f));
+	return f;
+}
+
+void
+SurfaceSWRGBA16F::encode(const Color *src, uint16_t *dest, size_t count)
+{
+	for(const Color *end = src + count; src < end; ++src, dest += 4) {
+		const float a = src->get_a();
+		dest[0] = float_to_half(src->get_r()*a);
+		dest[1] = float_to_half(src->get_g()*a);
+		dest[2] = float_to_half(src->get_b()*a);
+		dest[3] = float_to_half(a);
+	}
+}
+
+void
+SurfaceSWRGBA16F::decode(const uint16_t *src, Color *dest, size_t count)
+{
+	for(Color *end = dest + count; dest < end; ++dest, src += 4) {
+		const float a = half_to_float(src[3]);
+		if (a == 0.f) {
+			*dest = Color(0.f, 0.f, 0.f, 0.f);
+			continue;
+		}
+		const float k = 1.f/a;
+		*dest = Color(
+			half_to_float(src[0])*k,
+			half_to_float(src[1])*k,
+			half_to_float(src[2])*k,
+			a );
+	}
+}
+
+bool
+SurfaceSWRGBA16F::create_vfunc(int width, int height)
+{
+	pixels.assign((size_t)width*height*4, 0);
+	return true;
+}
+
+bool
+SurfaceSWRGBA16F::assign_vfunc(const rendering::Surface &surface)
+{
+	if (const SurfaceSWRGBA16F *same = dynamic_cast<const SurfaceSWRGBA16F*>(&surface))
+		{ pixels = same->pixels; return true; }
+
+	std::vector<Color> buffer;
+	const Color *src = get_source_pixels(surface, buffer);
+	if (!src)
+		return false;
+	pixels.resize((size_t)surface.get_pixels_count()*4);
+	encode(src, &pixels.front(), surface.get_pixels_count());
+	return true;
+}
+
+bool
+SurfaceSWRGBA16F::clear_vfunc()
+{
+	std::fill(pixels.begin(), pixels.end(), 0);
+	return true;
+}
+
+bool
+SurfaceSWRGBA16F::reset_vfunc()
+{
+	std::vector<uint16_t>().swap(pixels);
+	return true;
+}
+
+bool
+SurfaceSWRGBA16F::get_pixels_vfunc(Color *dest) const
+{
+	assert(pixels.size() == (size_t)get_pixels_count()*4);
+	decode(&pixels.front(), dest, get_pixels_count());
+	return true;
+}
+
+/* === E N T R Y P O I N T ================================================= */
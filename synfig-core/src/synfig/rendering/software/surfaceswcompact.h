@@ -0,0 +1,125 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/software/surfaceswcompact.h
+**	\brief SurfaceSWRGBA8 and SurfaceSWRGBA16F Header
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_RENDERING_SURFACESWCOMPACT_H
+#define __SYNFIG_RENDERING_SURFACESWCOMPACT_H
+
+/* === H E A D E R S ======================================================= */
+
+#include <cstdint>
+#include <vector>
+
+#include <synfig/synfig_export.h>
+
+#include "../surface.h"
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig
+{
+namespace rendering
+{
+
+//! Premultiplied RGBA with 8 bits per channel, a quarter of the size of SurfaceSW.
+//! It fits only the results in the visible range, surfaces with any premultiplied
+//! channel out of [0, 1] are not assigned (see fits()) and keep their own format.
+class SurfaceSWRGBA8: public Surface
+{
+public:
+	typedef etl::handle<SurfaceSWRGBA8> Handle;
+	SYNFIG_EXPORT static Token token;
+	virtual Token::Handle get_token() const
+		{ return token.handle(); }
+
+protected:
+	virtual bool create_vfunc(int width, int height);
+	virtual bool assign_vfunc(const Surface &surface);
+	virtual bool clear_vfunc();
+	virtual bool reset_vfunc();
+	virtual bool get_pixels_vfunc(Color *dest) const;
+
+private:
+	std::vector<uint8_t> pixels;
+
+public:
+	virtual bool is_compact() const
+		{ return true; }
+
+	const std::vector<uint8_t>& get_data() const
+		{ return pixels; }
+
+	//! Checks that the pixels can be encoded without clamping
+	static bool fits(const Color *src, size_t count);
+	static void encode(const Color *src, uint8_t *dest, size_t count);
+	static void decode(const uint8_t *src, Color *dest, size_t count);
+};
+
+//! Premultiplied RGBA with 16-bit floats (IEEE 754 half precision) per channel,
+//! a half of the size of SurfaceSW. Keeps the values out of [0, 1]
+//! with 11 significant bits, out-of-range values are clamped to +-65504.
+class SurfaceSWRGBA16F: public Surface
+{
+public:
+	typedef etl::handle<SurfaceSWRGBA16F> Handle;
+	SYNFIG_EXPORT static Token token;
+	virtual Token::Handle get_token() const
+		{ return token.handle(); }
+
+protected:
+	virtual bool create_vfunc(int width, int height);
+	virtual bool assign_vfunc(const Surface &surface);
+	virtual bool clear_vfunc();
+	virtual bool reset_vfunc();
+	virtual bool get_pixels_vfunc(Color *dest) const;
+
+private:
+	std::vector<uint16_t> pixels;
+
+public:
+	virtual bool is_compact() const
+		{ return true; }
+
+	const std::vector<uint16_t>& get_data() const
+		{ return pixels; }
+
+	static uint16_t float_to_half(float x);
+	static float half_to_float(uint16_t x);
+
+	static void encode(const Color *src, uint16_t *dest, size_t count);
+	static void decode(const uint16_t *src, Color *dest, size_t count);
+};
+
+} /* end namespace rendering */
+} /* end namespace synfig */
+
+/* -- E N D ----------------------------------------------------------------- */
+
+#endif
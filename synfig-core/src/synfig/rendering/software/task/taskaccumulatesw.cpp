@@ -0,0 +1,195 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/software/task/taskaccumulatesw.cpp
+**	\brief TaskAccumulateSW
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <algorithm>
+#include <list>
+#include <vector>
+
+#include <synfig/color/colorblendrow.h>
+#include <synfig/debug/debugsurface.h>
+#include <synfig/threadpool.h>
+
+#include "../../common/task/taskaccumulate.h"
+#include "tasksw.h"
+
+#endif
+
+using namespace synfig;
+using namespace rendering;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+/* === P R O C E D U R E S ================================================= */
+
+/* === M E T H O D S ======================================================= */
+
+namespace {
+
+class TaskAccumulateSW: public TaskAccumulate, public TaskSW
+{
+public:
+	typedef etl::handle<TaskAccumulateSW> Handle;
+	static Token token;
+	virtual Token::Handle get_token() const { return token.handle(); }
+
+private:
+	struct Input
+	{
+		const synfig::Surface *surface;
+		VectorInt offset;
+		//! region of the target covered by the sub-task
+		RectInt rect;
+		//! region of the target covered by the previous sub-tasks
+		RectInt prev_rect;
+		Color::value_type amount;
+		Input(): surface(), amount() { }
+	};
+
+	typedef std::vector<Input> InputList;
+
+	void blend_rows(synfig::Surface *c, const InputList *inputs, int miny, int maxy) const {
+		// all the sub-tasks are blended into the same few rows,
+		// so these rows stay in cache until the last sub-task
+		const bool straight = Color::is_straight(blend_method);
+		std::vector<Color> empty_row;
+		if (straight)
+			empty_row.resize(target_rect.maxx - target_rect.minx, Color(0, 0, 0, 0));
+
+		for(InputList::const_iterator i = inputs->begin(); i != inputs->end(); ++i)
+		{
+			if (i->surface)
+				for(int y = std::max(miny, i->rect.miny); y < std::min(maxy, i->rect.maxy); ++y)
+					ColorBlendRow::blend(
+						&(*c)[y][i->rect.minx],
+						&(*i->surface)[y + i->offset[1]][i->rect.minx + i->offset[0]],
+						i->rect.maxx - i->rect.minx,
+						i->amount,
+						blend_method );
+
+			// transparent pixels of straight sub-task affect the already blended region
+			if (straight && i->prev_rect.is_valid())
+			{
+				const RectInt &ra = i->prev_rect;
+				const RectInt &rb = i->rect;
+				RectInt fill[] = { ra, RectInt::zero(), RectInt::zero(), RectInt::zero() };
+				if (rb.is_valid())
+				{
+					fill[0] = fill[1] = fill[2] = fill[3] = ra;
+					fill[0].maxx = fill[2].minx = fill[3].minx = synfig::clamp(rb.minx, ra.minx, ra.maxx);
+					fill[1].minx = fill[2].maxx = fill[3].maxx = synfig::clamp(rb.maxx, ra.minx, ra.maxx);
+					fill[2].maxy = synfig::clamp(rb.miny, ra.miny, ra.maxy);
+					fill[3].miny = synfig::clamp(rb.maxy, ra.miny, ra.maxy);
+				}
+				for(int j = 0; j < 4; ++j)
+					if (fill[j].valid())
+						for(int y = std::max(miny, fill[j].miny); y < std::min(maxy, fill[j].maxy); ++y)
+							ColorBlendRow::blend(
+								&(*c)[y][fill[j].minx],
+								&empty_row.front(),
+								fill[j].maxx - fill[j].minx,
+								i->amount,
+								blend_method );
+			}
+		}
+	}
+
+public:
+	virtual bool run(RunParams&) const {
+		if (!is_valid()) return true;
+
+		LockWrite lc(this);
+		if (!lc) return false;
+		synfig::Surface &c = lc->get_surface();
+		const RectInt r = target_rect;
+
+		// sub-tasks are already rendered into their own surfaces
+		std::list<LockRead> locks;
+		InputList inputs;
+		RectInt ra = RectInt::zero();
+		for(int i = 0; i < (int)sub_tasks.size(); ++i)
+		{
+			const Task::Handle &sub = sub_tasks[i];
+			if (!sub || !sub->is_valid())
+				continue;
+
+			Input input;
+			input.offset = get_offset(i);
+			input.amount = get_amount(i);
+			input.prev_rect = ra;
+			input.rect = sub->target_rect - input.offset;
+			if (input.rect.is_valid())
+				rect_set_intersect(input.rect, input.rect, r);
+			if (input.rect.is_valid())
+			{
+				locks.emplace_back(sub);
+				if (!locks.back()) return false;
+				input.surface = &locks.back().cast_handle()->get_surface();
+
+				assert( 0 <= input.rect.minx && input.rect.maxx <= c.get_w()
+					 && 0 <= input.rect.miny && input.rect.maxy <= c.get_h() );
+				assert( 0 <= input.rect.minx + input.offset[0] && input.rect.maxx + input.offset[0] <= input.surface->get_w()
+					 && 0 <= input.rect.miny + input.offset[1] && input.rect.maxy + input.offset[1] <= input.surface->get_h() );
+			}
+			inputs.push_back(input);
+			ra |= input.rect;
+		}
+
+		// reduce bands of rows in parallel
+		const int band_height = 32;
+		if (r.maxy - r.miny <= band_height)
+		{
+			blend_rows(&c, &inputs, r.miny, r.maxy);
+			return true;
+		}
+
+		ThreadPool::Group group(ThreadPool::PRIORITY_RENDER);
+		for(int y = r.miny; y < r.maxy; y += band_height)
+			group.enqueue( sigc::bind(
+				sigc::mem_fun(*this, &TaskAccumulateSW::blend_rows),
+				&c, &inputs, y, std::min(y + band_height, r.maxy) ));
+		group.run();
+
+		return true;
+	}
+};
+
+
+Task::Token TaskAccumulateSW::token(
+	DescReal<TaskAccumulateSW, TaskAccumulate>("AccumulateSW") );
+
+} // end of anonimous namespace
+
+/* === E N T R Y P O I N T ================================================= */
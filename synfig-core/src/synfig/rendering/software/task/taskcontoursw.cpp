@@ -32,6 +32,9 @@
 #	include <config.h>
 #endif
 
+#include <memory>
+#include <mutex>
+
 #include <synfig/debug/debugsurface.h>
 
 #include "../../primitive/polyspan.h"
@@ -55,6 +58,23 @@ using namespace rendering;
 
 namespace {
 
+//! Contour flattened once for all the bands of a split task
+class SharedPolyspan
+{
+public:
+	//! Target rect of the task before split, the same for all bands
+	const RectInt window;
+
+	std::mutex mutex;
+	bool valid;
+	Matrix matrix;
+	Real detail;
+	Polyspan polyspan;
+
+	explicit SharedPolyspan(const RectInt &window):
+		window(window), valid(), detail() { }
+};
+
 class TaskContourSW: public TaskContour, public TaskSW,
 	public TaskInterfaceBlendToTarget,
 	public TaskInterfaceSplit
@@ -64,6 +84,16 @@ public:
 	static Token token;
 	virtual Token::Handle get_token() const { return token.handle(); }
 
+	//! Set only for the bands made by OptimizerSplit, they share it
+	std::shared_ptr<SharedPolyspan> shared_polyspan;
+
+	virtual void on_split(const Task::List &bands, const RectInt &rect) {
+		std::shared_ptr<SharedPolyspan> shared = std::make_shared<SharedPolyspan>(rect);
+		for(Task::List::const_iterator i = bands.begin(); i != bands.end(); ++i)
+			if (TaskContourSW *band = i->type_pointer<TaskContourSW>())
+				band->shared_polyspan = shared;
+	}
+
 	virtual void on_target_set_as_source() {
 		Task::Handle &subtask = sub_task(0);
 		if ( subtask
@@ -79,6 +109,23 @@ public:
 	virtual Color::BlendMethodFlags get_supported_blend_methods() const
 		{ return Color::BLEND_METHODS_ALL & ~Color::BLEND_METHODS_STRAIGHT; }
 
+	//! Target rect before split, cut down to the bounds of the contour
+	RectInt get_shared_window(const Matrix &matrix) const {
+		const Rect bounds = contour->get_bounds();
+		Rect pixel_bounds(matrix.get_transformed(bounds.get_min()));
+		pixel_bounds.expand(matrix.get_transformed(Vector(bounds.minx, bounds.maxy)));
+		pixel_bounds.expand(matrix.get_transformed(Vector(bounds.maxx, bounds.miny)));
+		pixel_bounds.expand(matrix.get_transformed(bounds.get_max()));
+
+		const RectInt &window = shared_polyspan->window;
+		pixel_bounds.expand(1.0);
+		rect_set_intersect(pixel_bounds, pixel_bounds, Rect(window.minx, window.miny, window.maxx, window.maxy));
+		if (!pixel_bounds.is_valid())
+			return RectInt();
+		return RectInt( (int)floor(pixel_bounds.minx), (int)floor(pixel_bounds.miny),
+		                (int)ceil(pixel_bounds.maxx), (int)ceil(pixel_bounds.maxy) );
+	}
+
 	virtual bool run(RunParams&) const {
 		if (!is_valid())
 			return true;
@@ -96,10 +143,29 @@ public:
 		Matrix matrix = bounds_transformation * transformation->matrix;
 
 		Polyspan polyspan;
-		polyspan.init(target_rect);
-		software::Contour::build_polyspan(contour->get_chunks(), matrix, polyspan, detail);
-		polyspan.close();
-		polyspan.sort_marks();
+		if (shared_polyspan) {
+			// task was split into bands, so flatten the whole contour once
+			// and let every band take only the marks of its own rows
+			std::lock_guard<std::mutex> lock(shared_polyspan->mutex);
+			if ( !shared_polyspan->valid
+			  || shared_polyspan->matrix != matrix
+			  || shared_polyspan->detail != detail )
+			{
+				shared_polyspan->matrix = matrix;
+				shared_polyspan->detail = detail;
+				shared_polyspan->polyspan.init(get_shared_window(matrix));
+				software::Contour::build_polyspan(contour->get_chunks(), matrix, shared_polyspan->polyspan, detail);
+				shared_polyspan->polyspan.close();
+				shared_polyspan->polyspan.sort_marks();
+				shared_polyspan->valid = true;
+			}
+			polyspan.crop(shared_polyspan->polyspan, target_rect);
+		} else {
+			polyspan.init(target_rect);
+			software::Contour::build_polyspan(contour->get_chunks(), matrix, polyspan, detail);
+			polyspan.close();
+			polyspan.sort_marks();
+		}
 
 		LockWrite la(this);
 		if (!la)
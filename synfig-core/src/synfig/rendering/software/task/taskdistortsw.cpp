@@ -85,7 +85,11 @@ bool TaskDistortSW::run_task(const rendering::TaskDistort& task) const
 
 	for (int iy = task.target_rect.miny; iy < task.target_rect.maxy; ++iy, p += dy, pen.inc_y(), pen.dec_x(tw)) {
 		for (int ix = task.target_rect.minx; ix < task.target_rect.maxx; ++ix, p += dx, pen.inc_x()) {
-			Point tmp = point_vfunc(p);
+			Point tmp;
+			if (!point_clip_vfunc(p, tmp)) {
+				pen.put_value(Color::alpha());
+				continue;
+			}
 
 			float u = (tmp[0]-task.required_source_rect.minx)*ppub[0];
 			float v = (tmp[1]-task.required_source_rect.miny)*ppub[1];
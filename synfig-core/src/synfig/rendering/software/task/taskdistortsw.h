@@ -68,6 +68,17 @@ protected:
 	 */
 	virtual Point point_vfunc(const Point &point) const = 0;
 
+	/**
+	 * Like point_vfunc(), but may also reject @a point, then the target pixel becomes transparent.
+	 * By default nothing is rejected.
+	 *
+	 * @param point The transformed vectorial coordinates in target region
+	 * @param source_point From where in source region should take the color
+	 * @return false, if the target pixel gets nothing from source region
+	 */
+	virtual bool point_clip_vfunc(const Point &point, Point &source_point) const
+		{ source_point = point_vfunc(point); return true; }
+
 public:
 	/**
 	 * Scan the target surface and fill each pixel according to point_vfunc().
@@ -35,6 +35,9 @@
 
 #include "taskpaintpixelsw.h"
 
+#include <vector>
+
+#include <synfig/color/colorblendrow.h>
 #include <synfig/general.h>
 #include <synfig/localization.h>
 
@@ -65,6 +68,14 @@ rendering::TaskPaintPixelSW::on_target_set_as_source() {
 	}
 }
 
+void
+rendering::TaskPaintPixelSW::get_color_span(Color* colors, int count, const Vector& p, const Vector& dp) const
+{
+	Vector q = p;
+	for (Color *end = colors + count; colors < end; ++colors, q += dp)
+		*colors = get_color(q);
+}
+
 synfig::Color::BlendMethodFlags
 synfig::rendering::TaskPaintPixelSW::get_supported_blend_methods() const
 {
@@ -102,8 +113,6 @@ synfig::rendering::TaskPaintPixelSW::run_task() const
 
 	const int tw = target_rect.get_width();
 	const Vector dx = raster_to_world.axis_x();
-	const Vector dy = raster_to_world.axis_y() - dx * (Real)tw;
-	Vector p = raster_to_world.get_transformed( Vector((Real)target_rect.minx, (Real)target_rect.miny) );
 
 	pre_run(world_to_raster, raster_to_world);
 
@@ -111,14 +120,15 @@ synfig::rendering::TaskPaintPixelSW::run_task() const
 	if (!la)
 		return false;
 
-	synfig::Surface::alpha_pen apen(la->get_surface().get_pen(target_rect.minx, target_rect.miny));
+	synfig::Surface &surface = la->get_surface();
 	const ColorReal amount = blend ? this->amount : ColorReal(1.0);
-	apen.set_blend_method(blend ? blend_method : Color::BLEND_COMPOSITE);
+	const ColorBlendRow::Func blend_row = ColorBlendRow::get_func(blend ? blend_method : Color::BLEND_COMPOSITE);
 
-	for (int iy = target_rect.miny; iy < target_rect.maxy; ++iy, p += dy, apen.inc_y(), apen.dec_x(tw)) {
-		for (int ix = target_rect.minx; ix < target_rect.maxx; ++ix, p += dx, apen.inc_x()) {
-			apen.put_value(get_color(p), amount);
-		}
+	std::vector<Color> span(tw);
+	for (int iy = target_rect.miny; iy < target_rect.maxy; ++iy) {
+		const Vector p = raster_to_world.get_transformed( Vector((Real)target_rect.minx, (Real)iy) );
+		get_color_span(&span.front(), tw, p, dx);
+		blend_row(&surface[iy][target_rect.minx], &span.front(), tw, amount);
 	}
 
 	return true;
@@ -50,7 +50,8 @@ namespace rendering
 /**
  * Paint each pixel depending on its position.
  *
- * The color of each pixel is defined by get_color() calls.
+ * The color of each pixel is defined by get_color() calls,
+ * or by get_color_span() calls for a whole row at once.
  *
  * To use this abstract class, call run_task() inside of your implementation of Task::run().
  *
@@ -71,6 +72,12 @@ public:
 	//! Fetch color at position p (in synfig units) when antialias is false
 	virtual Color get_color(const Vector& p) const = 0;
 
+	//! Fetch colors of \a count pixels of a scanline into \a colors.
+	//! The first pixel is at position \a p, and each next one is \a dp further.
+	//! The default implementation calls get_color() for each pixel.
+	//! Override it to compute values that are constant along the span only once.
+	virtual void get_color_span(Color* colors, int count, const Vector& p, const Vector& dp) const;
+
 	//! Call this method from run() method of the real task implementation
 	virtual bool run_task() const;
 
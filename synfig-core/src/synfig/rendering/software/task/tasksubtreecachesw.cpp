@@ -0,0 +1,100 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/software/task/tasksubtreecachesw.cpp
+**	\brief TaskSubtreeCacheSW
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include "../../common/task/tasksubtreecache.h"
+#include "../../subtreecache.h"
+#include "tasksw.h"
+
+#endif
+
+using namespace synfig;
+using namespace rendering;
+
+/* === M A C R O S ========================================================= */
+
+/* === G L O B A L S ======================================================= */
+
+/* === P R O C E D U R E S ================================================= */
+
+/* === M E T H O D S ======================================================= */
+
+namespace {
+
+class TaskSubtreeCacheSW: public TaskSubtreeCache, public TaskSW
+{
+public:
+	typedef etl::handle<TaskSubtreeCacheSW> Handle;
+	static Token token;
+	virtual Token::Handle get_token() const { return token.handle(); }
+
+	virtual bool run(RunParams&) const {
+		if (!is_valid() || !sub_task() || !sub_task()->is_valid())
+			return true;
+
+		VectorInt offset = TaskList::calc_target_offset(*this, *sub_task());
+		RectInt r = sub_task()->target_rect - offset;
+		rect_set_intersect(r, r, target_rect);
+		if (r.is_valid() && sub_task()->target_surface != target_surface) {
+			LockWrite ldst(this);
+			if (!ldst) return false;
+			LockRead lsrc(sub_task());
+			if (!lsrc) return false;
+
+			synfig::Surface &dst = ldst->get_surface();
+			const synfig::Surface &src = lsrc->get_surface();
+			synfig::Surface::pen p = dst.get_pen(r.minx, r.miny);
+			src.blit_to(
+				p,
+				r.minx + offset[0],
+				r.miny + offset[1],
+				r.maxx - r.minx,
+				r.maxy - r.miny );
+		}
+
+		// the surface of sub-task is complete here, and nobody writes into it anymore
+		if (store_to_cache)
+			if (SubtreeCache *cache = SubtreeCache::instance())
+				cache->put(hash, sub_task()->target_surface);
+
+		return true;
+	}
+};
+
+
+Task::Token TaskSubtreeCacheSW::token(
+	DescReal<TaskSubtreeCacheSW, TaskSubtreeCache>("SubtreeCacheSW") );
+
+} // end of anonimous namespace
+
+/* === E N T R Y P O I N T ================================================= */
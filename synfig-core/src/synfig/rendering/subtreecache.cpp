@@ -0,0 +1,217 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/subtreecache.cpp
+**	\brief SubtreeCache
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#ifdef USING_PCH
+#	include "pch.h"
+#else
+#ifdef HAVE_CONFIG_H
+#	include <config.h>
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cstdlib>
+
+#include <synfig/color.h>
+
+#include "subtreecache.h"
+
+#endif
+
+using namespace synfig;
+using namespace rendering;
+
+/* === M A C R O S ========================================================= */
+
+#define DEFAULT_BUDGET_MB	256
+
+/* === G L O B A L S ======================================================= */
+
+SubtreeCache *SubtreeCache::instance_ = nullptr;
+
+/* === M E T H O D S ======================================================= */
+
+SubtreeCache::SubtreeCache(size_t budget)
+{
+	statistics.budget = budget;
+}
+
+SubtreeCache::~SubtreeCache()
+	{ clear(); }
+
+SubtreeCache*
+SubtreeCache::instance()
+	{ return instance_; }
+
+void
+SubtreeCache::initialize()
+{
+	size_t budget_mb = DEFAULT_BUDGET_MB;
+	if (const char *s = getenv("SYNFIG_RENDERING_SUBTREE_CACHE_SIZE"))
+		budget_mb = (size_t)std::max(0, atoi(s));
+	delete instance_;
+	instance_ = new SubtreeCache(budget_mb*1024*1024);
+}
+
+void
+SubtreeCache::deinitialize()
+{
+	delete instance_;
+	instance_ = nullptr;
+}
+
+size_t
+SubtreeCache::get_surface_size(const SurfaceResource::Handle &surface)
+{
+	if (!surface)
+		return 0;
+	const VectorInt size = surface->get_size();
+	return (size_t)std::max(0, size[0])*(size_t)std::max(0, size[1])*sizeof(Color);
+}
+
+void
+SubtreeCache::evict(size_t budget)
+{
+	while(statistics.bytes > budget && !order.empty()) {
+		std::map<TaskHash, Entry>::iterator i = entries.find(order.back());
+		assert(i != entries.end());
+		statistics.bytes -= i->second.bytes;
+		entries.erase(i);
+		order.pop_back();
+		++statistics.evictions;
+	}
+	statistics.entries = (int)entries.size();
+}
+
+void
+SubtreeCache::set_budget(size_t bytes)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	statistics.budget = bytes;
+	evict(bytes);
+}
+
+size_t
+SubtreeCache::get_budget() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return statistics.budget;
+}
+
+SurfaceResource::Handle
+SubtreeCache::get(const TaskHash &hash)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	std::map<TaskHash, Entry>::iterator i = entries.find(hash);
+	if (i == entries.end()) {
+		++statistics.misses;
+		return SurfaceResource::Handle();
+	}
+	++statistics.hits;
+	order.splice(order.begin(), order, i->second.order);
+	return i->second.surface;
+}
+
+bool
+SubtreeCache::admit(const TaskHash &hash)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if (statistics.budget == 0)
+		return false;
+	if (seen.count(hash))
+		return true;
+	seen.insert(hash);
+	seen_order.push_back(hash);
+	while((int)seen_order.size() > max_seen) {
+		seen.erase(seen_order.front());
+		seen_order.pop_front();
+	}
+	return false;
+}
+
+void
+SubtreeCache::put(const TaskHash &hash, const SurfaceResource::Handle &surface)
+{
+	if (!surface)
+		return;
+	const size_t bytes = get_surface_size(surface);
+
+	std::lock_guard<std::mutex> lock(mutex);
+	std::map<TaskHash, Entry>::iterator i = entries.find(hash);
+	if (i != entries.end()) {
+		statistics.bytes -= i->second.bytes;
+		order.erase(i->second.order);
+		entries.erase(i);
+	}
+
+	if (bytes <= statistics.budget) {
+		evict(statistics.budget - bytes);
+		Entry &entry = entries[hash];
+		entry.surface = surface;
+		entry.bytes = bytes;
+		entry.order = order.insert(order.begin(), hash);
+		statistics.bytes += bytes;
+		++statistics.stores;
+	}
+	statistics.entries = (int)entries.size();
+}
+
+bool
+SubtreeCache::contains(const TaskHash &hash) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return entries.count(hash) != 0;
+}
+
+void
+SubtreeCache::clear()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	entries.clear();
+	order.clear();
+	seen.clear();
+	seen_order.clear();
+	statistics.bytes = 0;
+	statistics.entries = 0;
+}
+
+SubtreeCache::Statistics
+SubtreeCache::get_statistics() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return statistics;
+}
+
+void
+SubtreeCache::reset_statistics()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	statistics.hits = 0;
+	statistics.misses = 0;
+	statistics.stores = 0;
+	statistics.evictions = 0;
+}
@@ -0,0 +1,139 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/subtreecache.h
+**	\brief SubtreeCache Header
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_RENDERING_SUBTREECACHE_H
+#define __SYNFIG_RENDERING_SUBTREECACHE_H
+
+/* === H E A D E R S ======================================================= */
+
+#include <list>
+#include <map>
+#include <mutex>
+#include <set>
+
+#include "surface.h"
+#include "taskhash.h"
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig
+{
+namespace rendering
+{
+
+//! Rendered surfaces of the static parts of the task tree, shared between frames.
+//! Surfaces are kept by the hash of the task subtree in least recently used order,
+//! and the oldest ones are dropped when their total size exceeds the budget.
+//! A subtree is stored only when its hash was already seen in a previous frame
+//! (see admit()), so animated subtrees don't pay for the copy into the cache.
+//! The budget is given in megabytes by SYNFIG_RENDERING_SUBTREE_CACHE_SIZE
+//! or set by set_budget(), zero budget disables the cache.
+class SubtreeCache
+{
+public:
+	struct Statistics
+	{
+		long long hits;
+		long long misses;
+		long long stores;
+		long long evictions;
+		size_t bytes;
+		size_t budget;
+		int entries;
+
+		Statistics(): hits(), misses(), stores(), evictions(), bytes(), budget(), entries() { }
+	};
+
+private:
+	typedef std::list<TaskHash> Order;
+
+	struct Entry
+	{
+		SurfaceResource::Handle surface;
+		size_t bytes;
+		Order::iterator order;
+		Entry(): bytes() { }
+	};
+
+	mutable std::mutex mutex;
+
+	std::map<TaskHash, Entry> entries;
+	//! Most recently used first
+	Order order;
+	//! Hashes which were seen but are not stored yet, oldest first
+	std::set<TaskHash> seen;
+	Order seen_order;
+	Statistics statistics;
+
+	static SubtreeCache *instance_;
+
+	void evict(size_t budget);
+
+public:
+	//! Count of hashes remembered by admit()
+	static const int max_seen = 4096;
+
+	explicit SubtreeCache(size_t budget);
+	~SubtreeCache();
+
+	//! Returns the process-wide cache, or null if the renderer is not initialized
+	static SubtreeCache* instance();
+	static void initialize();
+	static void deinitialize();
+
+	//! Returns the count of bytes taken by the pixels of \a surface
+	static size_t get_surface_size(const SurfaceResource::Handle &surface);
+
+	void set_budget(size_t bytes);
+	size_t get_budget() const;
+	bool is_enabled() const
+		{ return get_budget() > 0; }
+
+	//! Returns the cached surface of \a hash, or null
+	SurfaceResource::Handle get(const TaskHash &hash);
+	//! Returns true if \a hash was passed here before and is worth to be stored,
+	//! otherwise remembers it for the next time
+	bool admit(const TaskHash &hash);
+	//! Puts the rendered surface into the cache, unless it is bigger than the whole budget
+	void put(const TaskHash &hash, const SurfaceResource::Handle &surface);
+	bool contains(const TaskHash &hash) const;
+	void clear();
+
+	Statistics get_statistics() const;
+	void reset_statistics();
+};
+
+} /* end namespace rendering */
+} /* end namespace synfig */
+
+/* -- E N D ----------------------------------------------------------------- */
+
+#endif
@@ -276,18 +276,14 @@ SurfaceResource::get_surface(
 			if (!surface->create(width, height))
 				return Surface::Handle();
 		} else {
-			bool found = false;
-			for(Map::const_iterator i = surfaces.begin(); i != surfaces.end() && !found; ++i)
-				if (i->second->get_pixels_pointer() && surface->assign(*i->second))
-					found = true;
-			for(Map::const_iterator i = surfaces.begin(); i != surfaces.end() && !found; ++i)
-				if (!i->second->get_pixels_pointer() && surface->assign(*i->second))
-					found = true;
-			if (!found)
+			if (!assign_from_surfaces(*surface))
 				return Surface::Handle();
 		}
 
 		if (exclusive) surfaces.clear(); // all other surfaces invalidated
+
+		// the copy of the compact surface decoded for reading is shared
+		// by all readers and released by the last of them (see end_read())
 		surfaces[token] = surface;
 	}
 
@@ -300,6 +296,80 @@ SurfaceResource::get_surface(
 	return surface;
 }
 
+void
+SurfaceResource::begin_read()
+{
+	rwlock.reader_lock();
+	std::lock_guard<std::mutex> lock(mutex);
+	++readers;
+}
+
+void
+SurfaceResource::end_read()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		assert(readers > 0);
+		if (--readers == 0) {
+			// drop the copies decoded from the compact surface,
+			// otherwise the resource will hold the full-size copy anyway
+			bool compact = false;
+			for(Map::const_iterator i = surfaces.begin(); i != surfaces.end() && !compact; ++i)
+				if (i->second->is_compact())
+					compact = true;
+			for(Map::iterator i = surfaces.begin(); compact && i != surfaces.end();) {
+				if (i->second->is_compact()) ++i;
+				else i = surfaces.erase(i);
+			}
+		}
+	}
+	rwlock.reader_unlock();
+}
+
+bool
+SurfaceResource::assign_from_surfaces(Surface &surface) const
+{
+	for(Map::const_iterator i = surfaces.begin(); i != surfaces.end(); ++i)
+		if (i->second->get_pixels_pointer() && surface.assign(*i->second))
+			return true;
+	for(Map::const_iterator i = surfaces.begin(); i != surfaces.end(); ++i)
+		if (!i->second->get_pixels_pointer() && surface.assign(*i->second))
+			return true;
+	return false;
+}
+
+bool
+SurfaceResource::convert(const Surface::Token::Handle &token)
+{
+	if (!token)
+		return false;
+
+	Glib::Threads::RWLock::WriterLock lock(rwlock);
+	std::lock_guard<std::mutex> short_lock(mutex);
+
+	if (width <= 0 || height <= 0)
+		return true;
+	if (blank) {
+		// blank surface will be created on demand
+		surfaces.clear();
+		return true;
+	}
+
+	Surface::Handle surface;
+	Map::const_iterator i = surfaces.find(token);
+	if (i != surfaces.end()) {
+		surface = i->second;
+	} else {
+		surface = token->fabric();
+		if (!surface || !assign_from_surfaces(*surface))
+			return false;
+	}
+
+	surfaces.clear();
+	surfaces[token] = surface;
+	return true;
+}
+
 void
 SurfaceResource::create(int width, int height)
 {
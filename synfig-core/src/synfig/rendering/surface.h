@@ -134,6 +134,10 @@ public:
 
 	virtual bool is_read_only() const
 		{ return false; }
+	//! Compact surfaces keep pixels in a smaller format than Color,
+	//! SurfaceResource doesn't store the copies converted from them for reading
+	virtual bool is_compact() const
+		{ return false; }
 
 	bool create(int width, int height);
 	bool assign(const Surface &other);
@@ -187,14 +191,14 @@ public:
 		void lock() {
 			if (resource) {
 				if (write) resource->rwlock.writer_lock();
-				      else resource->rwlock.reader_lock();
+				      else resource->begin_read();
 			}
 		}
 		void unlock() {
 			if (resource) {
 				surface.reset();
 				if (write) resource->rwlock.writer_unlock();
-				      else resource->rwlock.reader_unlock();
+				      else resource->end_read();
 			}
 		}
 
@@ -335,6 +339,7 @@ private:
 	int height;
 	bool blank;
 	Map surfaces;
+	int readers = 0; //!< count of the read locks, guarded by mutex
 
 	mutable std::mutex mutex;
 	mutable Glib::Threads::RWLock rwlock;
@@ -346,6 +351,10 @@ private:
 		const RectInt &rect,
 		bool create,
 		bool any );
+	bool assign_from_surfaces(Surface &surface) const;
+
+	void begin_read();
+	void end_read();
 
 public:
 	SurfaceResource();
@@ -360,6 +369,9 @@ public:
 	void create(const VectorInt &x)
 		{ create(x[0], x[1]); }
 
+	//! Replaces all surfaces by the single one of \a token, keeps the content
+	bool convert(const Surface::Token::Handle &token);
+
 	int get_id() const //!< helps to debug of renderer optimizers
 		{ return id; }
 	int get_width() const
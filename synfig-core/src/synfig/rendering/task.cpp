@@ -33,6 +33,7 @@
 #endif
 
 #include <synfig/general.h>
+#include <synfig/threadpool.h>
 
 #include "task.h"
 #include "renderer.h"
@@ -109,6 +110,7 @@ void
 Task::assign(const Task &other) {
 	assign_target(other);
 	sub_tasks = other.sub_tasks;
+	layer_name = other.layer_name;
 	renderer_data = other.renderer_data; // TODO: remove renderer_data from task
 }
 
@@ -420,15 +422,16 @@ TaskEvent::finish(bool success)
 		(success ? done : cancelled) = true;
 	}
 	signal_finished(success);
-	cond.notify_one();
+	cond.notify_all();
 }
 
 void
 TaskEvent::wait()
 {
 	std::unique_lock<std::mutex> lock(mutex);
-	if (done || cancelled) return;
-	cond.wait(lock);
+	// let the thread pool use the core of this thread while it waits
+	while(!done && !cancelled)
+		ThreadPool::instance().wait(cond, lock);
 }
 
 bool
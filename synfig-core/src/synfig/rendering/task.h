@@ -41,6 +41,7 @@
 #include <synfig/synfig_export.h>
 
 #include "surface.h"
+#include "taskhash.h"
 
 /* === M A C R O S ========================================================= */
 
@@ -286,16 +287,57 @@ public:
 	{
 		int batch_index;
 		int index;
-		Set deps;
-		Set back_deps;
 
+		//! tasks which should be done before this one
+		List deps;
+		//! tasks which are waiting for this one
+		List back_deps;
+		//! count of not finished tasks from deps
+		std::atomic<int> deps_count;
+		//! count of not cancelled tasks from back_deps
+		std::atomic<int> live_back_deps;
+		std::atomic<bool> cancelled;
+
+		// used by Renderer::find_deps only
 		Set tmp_deps;
 		Set tmp_back_deps;
+		Set tmp_fixed_deps;
+		Set tmp_fixed_back_deps;
 
 		RunParams params;
 		bool success;
-
-		RendererData(): batch_index(), index(), success() { }
+		//! result doesn't need float precision and should be converted
+		//! to the compact surface of the renderer after run
+		//! \sa Renderer::get_compact_surface_token()
+		bool compact_target;
+		//! target is read only by the parent task
+		//! and should be released after the parent task run
+		//! \sa Renderer::mark_released_targets()
+		bool release_target;
+
+		RendererData(): batch_index(), index(), deps_count(), live_back_deps(), cancelled(), success(), compact_target(), release_target() { }
+		RendererData(const RendererData &other):
+			deps_count(), live_back_deps(), cancelled(), success(), compact_target(), release_target()
+			{ *this = other; }
+
+		RendererData& operator=(const RendererData &other) {
+			batch_index = other.batch_index;
+			index = other.index;
+			deps = other.deps;
+			back_deps = other.back_deps;
+			deps_count = other.deps_count.load();
+			live_back_deps = other.live_back_deps.load();
+			cancelled = other.cancelled.load();
+			tmp_deps = other.tmp_deps;
+			tmp_back_deps = other.tmp_back_deps;
+			tmp_fixed_deps = other.tmp_fixed_deps;
+			tmp_fixed_back_deps = other.tmp_fixed_back_deps;
+			params = other.params;
+			success = other.success;
+			compact_target = other.compact_target;
+			release_target = other.release_target;
+			return *this;
+		}
 	};
 
 	class LockReadBase: public SurfaceResource::LockReadBase
@@ -373,6 +415,9 @@ public:
 	RectInt target_rect;
 	SurfaceResource::Handle target_surface;
 	List sub_tasks;
+	/// Description of the layer which built the task, filled while tracing only
+	/// \sa synfig::debug::Trace
+	String layer_name;
 
 	mutable RendererData renderer_data;
 
@@ -467,6 +512,13 @@ public:
 	virtual int get_pass_subtask_index() const
 		{ return PASSTO_THIS_TASK; }
 
+	/// Adds own parameters of the task to the hash, without coordinates and sub-tasks.
+	/// The result of two tasks with the same hash and the same sub-tasks must be the same.
+	/// \return false if the task cannot be hashed, so the subtrees with it are never cached
+	/// \sa synfig::rendering::SubtreeCache
+	virtual bool hash_params(TaskHash & /* hash */) const
+		{ return false; }
+
 	void touch_coords();
 	void set_coords(const Rect &source_rect, const VectorInt &target_size);
 	void set_coords_zero();
@@ -492,6 +544,10 @@ class TaskInterfaceSplit
 public:
 	virtual bool is_splittable() const
 		{ return true; }
+	//! Called by OptimizerSplit for the first of the \a bands which
+	//! this task was split into, \a rect is the whole target rect
+	virtual void on_split(const Task::List &bands, const RectInt &rect)
+		{ }
 	virtual ~TaskInterfaceSplit() { }
 };
 
@@ -570,6 +626,8 @@ public:
 	virtual Token::Handle get_token() const { return token.handle(); }
 	virtual bool run(RunParams&) const
 		{ return true; }
+	virtual bool hash_params(TaskHash&) const
+		{ return true; }
 	static VectorInt calc_target_offset(const Task &a, const Task &b);
 };
 
@@ -0,0 +1,118 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file synfig/rendering/taskhash.h
+**	\brief TaskHash Header
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === S T A R T =========================================================== */
+
+#ifndef __SYNFIG_RENDERING_TASKHASH_H
+#define __SYNFIG_RENDERING_TASKHASH_H
+
+/* === H E A D E R S ======================================================= */
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include <synfig/color.h>
+#include <synfig/matrix.h>
+#include <synfig/rect.h>
+#include <synfig/string.h>
+#include <synfig/vector.h>
+
+/* === M A C R O S ========================================================= */
+
+/* === T Y P E D E F S ===================================================== */
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace synfig
+{
+namespace rendering
+{
+
+//! 128-bit hash of the task parameters, built of two independent 64-bit hashes,
+//! so the accidental collision of two different subtrees is practically impossible.
+//! Values are hashed by their bytes, the same values always give the same hash
+//! within the process, but the hash is not meant to be stored anywhere.
+class TaskHash
+{
+public:
+	uint64_t a;
+	uint64_t b;
+
+	TaskHash(): a(UINT64_C(14695981039346656037)), b(UINT64_C(0x9e3779b97f4a7c15)) { }
+
+	void add_bytes(const void *data, size_t size)
+	{
+		const unsigned char *c = (const unsigned char*)data;
+		for(const unsigned char *end = c + size; c < end; ++c) {
+			// FNV-1a
+			a = (a ^ *c)*UINT64_C(1099511628211);
+			// multiply-xorshift with the other constants
+			b = (b + *c + 1)*UINT64_C(0xff51afd7ed558ccd);
+			b ^= b >> 29;
+		}
+	}
+
+	template<typename T>
+	typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type
+	add(T x)
+		{ add_bytes(&x, sizeof(x)); }
+
+	void add(double x)
+		{ if (x == 0.0) x = 0.0; add_bytes(&x, sizeof(x)); } // don't distinguish -0 and +0
+	void add(float x)
+		{ if (x == 0.f) x = 0.f; add_bytes(&x, sizeof(x)); }
+
+	void add(const String &x)
+		{ add(x.size()); add_bytes(x.c_str(), x.size()); }
+	void add(const Vector &x)
+		{ add(x[0]); add(x[1]); }
+	void add(const VectorInt &x)
+		{ add(x[0]); add(x[1]); }
+	void add(const Rect &x)
+		{ add(x.minx); add(x.miny); add(x.maxx); add(x.maxy); }
+	void add(const RectInt &x)
+		{ add(x.minx); add(x.miny); add(x.maxx); add(x.maxy); }
+	void add(const Color &x)
+		{ add(x.get_r()); add(x.get_g()); add(x.get_b()); add(x.get_a()); }
+	void add(const Matrix &x)
+		{ for(int i = 0; i < 3; ++i) for(int j = 0; j < 3; ++j) add(x.m[i][j]); }
+	void add(const TaskHash &x)
+		{ add(x.a); add(x.b); }
+
+	bool operator==(const TaskHash &other) const
+		{ return a == other.a && b == other.b; }
+	bool operator!=(const TaskHash &other) const
+		{ return !(*this == other); }
+	bool operator<(const TaskHash &other) const
+		{ return a < other.a || (a == other.a && b < other.b); }
+};
+
+} /* end namespace rendering */
+} /* end namespace synfig */
+
+/* -- E N D ----------------------------------------------------------------- */
+
+#endif
@@ -35,6 +35,7 @@
 #endif
 
 #include "savecanvas.h"
+#include "canvasbinary.h"
 
 #include "general.h"
 #include <synfig/localization.h>
@@ -1052,7 +1053,16 @@ synfig::save_canvas(const FileSystem::Identifier &identifier, Canvas::ConstHandl
 		if (identifier.filename.extension().u8string() == ".sifz")
 			stream = FileSystem::WriteStream::Handle(new ZWriteStream(stream));
 
-		document.write_to_stream_formatted(*stream, "UTF-8");
+		if (identifier.filename.extension().u8string() == ".sifb")
+		{
+			if (!CanvasBinary::write(document.get_root_node(), *stream))
+			{
+				synfig::error("synfig::save_canvas(): Unable to write binary canvas");
+				return false;
+			}
+		}
+		else
+			document.write_to_stream_formatted(*stream, "UTF-8");
 
 		// close stream
 		stream.reset();
@@ -34,6 +34,7 @@
 #endif
 
 #include "surface.h"
+#include "color/colorblendrow.h"
 #include "target_scanline.h"
 #include "target_tile.h"
 #include <synfig/localization.h>
@@ -236,7 +237,36 @@ synfig::Surface::blit_to(alpha_pen& pen, int x, int y, int w, int h) const
 		return;
 	}
 #endif
-	surface<Color, ColorPrep>::blit_to(pen,x,y,w,h);
+
+	// same clipping as in surface<>::blit_to()
+	if(x>=get_w() || y>=get_h())
+		return;
+
+	if(x<0)
+	{
+		w+=x;
+		x=0;
+	}
+
+	if(y<0)
+	{
+		h+=y;
+		y=0;
+	}
+
+	w = std::min((long)w,(long)(pen.end_x()-pen.x()));
+	h = std::min((long)h,(long)(pen.end_y()-pen.y()));
+
+	w = std::min(w,get_w()-x);
+	h = std::min(h,get_h()-y);
+
+	if(w<=0 || h<=0)
+		return;
+
+	// select the blend function once, instead of once per pixel in alpha_pen::put_value()
+	const ColorBlendRow::Func blend_row = ColorBlendRow::get_func(pen.get_blend_method());
+	for(int i = 0; i < h; i++, pen.inc_y())
+		blend_row(pen.x(), operator[](y+i)+x, w, alpha);
 }
 
 
@@ -36,6 +36,13 @@
 
 #include "target_scanline.h"
 
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 #include "general.h"
 #include <synfig/localization.h>
 
@@ -58,16 +65,167 @@ using namespace rendering;
 /* === M A C R O S ========================================================= */
 
 #define DEFAULT_PIXEL_RENDERING_LIMIT 9000000 // 1500000 - original limit, 2100000 - full HD 1920x1080, 8300000 - 4k UHD, 33200000 - 8k UHD
+#define DEFAULT_WRITE_QUEUE_DEPTH 2
 
 /* === G L O B A L S ======================================================= */
 
 /* === P R O C E D U R E S ================================================= */
 
+namespace {
+
+Real
+seconds_since(const std::chrono::steady_clock::time_point &time)
+	{ return std::chrono::duration<Real>(std::chrono::steady_clock::now() - time).count(); }
+
+}
+
+/* === C L A S S E S ======================================================= */
+
+//! Thread which puts the rendered frames onto the target in order,
+//! the frames wait for it in a bounded queue
+class Target_Scanline::FrameWriter
+{
+private:
+	Target_Scanline &target;
+	const size_t depth;
+	WriteStatistics &statistics;
+
+	std::mutex mutex;
+	//! signaled when a frame is taken from the queue or writing failed
+	std::condition_variable cond_taken;
+	//! signaled when a frame is added to the queue or no more frames will come
+	std::condition_variable cond_added;
+	std::deque<SurfaceResource::Handle> queue;
+	bool finished;
+	bool failed;
+	String error;
+
+	std::thread thread;
+
+	bool write(const SurfaceResource::Handle &surface)
+	{
+		SurfaceResource::LockRead<SurfaceSW> lock(surface);
+		if (!lock) {
+			error = _("Bad surface");
+			return false;
+		}
+		if (!target.add_frame(&lock->get_surface(), nullptr)) {
+			error = _("Unable to put surface on target");
+			return false;
+		}
+		return true;
+	}
+
+	void run()
+	{
+		while(true) {
+			SurfaceResource::Handle surface;
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				const std::chrono::steady_clock::time_point wait_start = std::chrono::steady_clock::now();
+				cond_added.wait(lock, [&]() { return !queue.empty() || finished; });
+				statistics.idle_time += seconds_since(wait_start);
+				if (queue.empty())
+					return;
+				surface = queue.front();
+				queue.pop_front();
+			}
+			cond_taken.notify_one();
+
+			const std::chrono::steady_clock::time_point write_start = std::chrono::steady_clock::now();
+			bool success;
+			try {
+				success = write(surface);
+			} catch(const String &str) {
+				error = str;
+				success = false;
+			} catch(const std::exception &e) {
+				error = e.what();
+				success = false;
+			}
+			surface.reset();
+
+			std::lock_guard<std::mutex> lock(mutex);
+			statistics.write_time += seconds_since(write_start);
+			++statistics.frames;
+			if (!success) {
+				failed = true;
+				queue.clear();
+				cond_taken.notify_all();
+				return;
+			}
+		}
+	}
+
+public:
+	FrameWriter(Target_Scanline &target, int depth):
+		target(target),
+		depth(std::max(1, depth)),
+		statistics(target.write_statistics_),
+		finished(false),
+		failed(false)
+	{
+		statistics = WriteStatistics();
+		thread = std::thread(&FrameWriter::run, this);
+	}
+
+	~FrameWriter()
+		{ cancel(); }
+
+	//! Adds the frame into the queue, waits while the queue is full.
+	//! Returns false if the writer failed
+	bool put(const SurfaceResource::Handle &surface)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			if (!failed && queue.size() >= depth) {
+				const std::chrono::steady_clock::time_point wait_start = std::chrono::steady_clock::now();
+				cond_taken.wait(lock, [&]() { return failed || queue.size() < depth; });
+				statistics.stall_time += seconds_since(wait_start);
+			}
+			if (failed)
+				return false;
+			queue.push_back(surface);
+			statistics.max_queue_size = std::max(statistics.max_queue_size, (int)queue.size());
+		}
+		cond_added.notify_one();
+		return true;
+	}
+
+	//! Waits until all queued frames are written
+	bool finish()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			finished = true;
+		}
+		cond_added.notify_one();
+		if (thread.joinable())
+			thread.join();
+		return !failed;
+	}
+
+	//! Drops the queued frames and stops the thread
+	void cancel()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			queue.clear();
+		}
+		finish();
+	}
+
+	const String& get_error() const
+		{ return error; }
+};
+
 /* === M E T H O D S ======================================================= */
 
 Target_Scanline::Target_Scanline()
-	: threads_(2),
-	  pixel_rendering_limit_(DEFAULT_PIXEL_RENDERING_LIMIT)
+	: threads_(1),
+	  pixel_rendering_limit_(DEFAULT_PIXEL_RENDERING_LIMIT),
+	  frames_per_second_(0.0),
+	  write_queue_depth_(DEFAULT_WRITE_QUEUE_DEPTH)
 {
 	curr_frame_=0;
 	if (const char *s = getenv("SYNFIG_TARGET_DEFAULT_ENGINE"))
@@ -80,8 +238,8 @@ Target_Scanline::next_frame(Time& time)
 	return Target::next_frame(time);
 }
 
-bool
-synfig::Target_Scanline::call_renderer(
+rendering::Task::Handle
+synfig::Target_Scanline::build_frame_task(
 	const etl::handle<rendering::SurfaceResource> &surface,
 	Canvas &canvas,
 	const ContextParams &context_params,
@@ -92,10 +250,6 @@ synfig::Target_Scanline::call_renderer(
 
 	if (task)
 	{
-		rendering::Renderer::Handle renderer = rendering::Renderer::get_renderer(get_engine());
-		if (!renderer)
-			throw strprintf(_("Renderer '%s' not found"), get_engine().c_str());
-
 		Vector p0 = renddesc.get_tl();
 		Vector p1 = renddesc.get_br();
 		if (p0[0] > p1[0] || p0[1] > p1[1]) {
@@ -111,6 +265,24 @@ synfig::Target_Scanline::call_renderer(
 		task->target_surface = surface;
 		task->target_rect = RectInt( VectorInt(), surface->get_size() );
 		task->source_rect = Rect(p0, p1);
+	}
+	return task;
+}
+
+bool
+synfig::Target_Scanline::call_renderer(
+	const etl::handle<rendering::SurfaceResource> &surface,
+	Canvas &canvas,
+	const ContextParams &context_params,
+	const RendDesc &renddesc )
+{
+	rendering::Task::Handle task = build_frame_task(surface, canvas, context_params, renddesc);
+
+	if (task)
+	{
+		rendering::Renderer::Handle renderer = rendering::Renderer::get_renderer(get_engine());
+		if (!renderer)
+			throw strprintf(_("Renderer '%s' not found"), get_engine().c_str());
 
 		rendering::Task::List list;
 		list.push_back(task);
@@ -119,6 +291,114 @@ synfig::Target_Scanline::call_renderer(
 	return true;
 }
 
+bool
+synfig::Target_Scanline::put_frame(const SurfaceResource::Handle &surface, FrameWriter *writer, ProgressCallback *cb)
+{
+	if (writer) {
+		if (!writer->put(surface)) {
+			if(cb)cb->error(writer->get_error());
+			return false;
+		}
+		return true;
+	}
+
+	SurfaceResource::LockRead<SurfaceSW> lock(surface);
+	if(!lock)
+	{
+		if(cb)cb->error(_("Bad surface"));
+		return false;
+	}
+
+	// Put the surface we renderer
+	// onto the target.
+	if(!add_frame(&lock->get_surface(), cb))
+	{
+		if(cb)cb->error(_("Unable to put surface on target"));
+		return false;
+	}
+	return true;
+}
+
+bool
+synfig::Target_Scanline::render_frames_parallel(int max_frames_in_flight, FrameWriter *writer, ProgressCallback *cb)
+{
+	// The task tree built for the frame is a snapshot of the canvas
+	// at the frame time: it holds the evaluated parameters (or clones
+	// of the legacy layers), so the shared canvas can be moved to the
+	// next frame while the previous frames are still being rendered.
+	struct PendingFrame {
+		SurfaceResource::Handle surface;
+		TaskEvent::Handle event;
+	};
+
+	rendering::Renderer::Handle renderer = rendering::Renderer::get_renderer(get_engine());
+	if (!renderer)
+		throw strprintf(_("Renderer '%s' not found"), get_engine().c_str());
+
+	const int frame_start = desc.get_frame_start();
+	const int frame_end = desc.get_frame_end();
+	const int total_frames = frame_end >= frame_start ? (frame_end - frame_start + 1) : 1;
+
+	ContextParams context_params(desc.get_render_excluded_contexts());
+	std::deque<PendingFrame> pending;
+
+	// waits for the oldest frame and puts it onto the target
+	auto write_oldest = [&]() -> bool {
+		PendingFrame frame = pending.front();
+		pending.pop_front();
+
+		if (frame.event) {
+			frame.event->wait();
+			if (!frame.event->is_done()) {
+				if(cb)cb->error(_("Accelerated Renderer Failure"));
+				return false;
+			}
+		}
+
+		return put_frame(frame.surface, writer, cb);
+	};
+
+	// don't leave the frames in the render queue if we fail
+	auto cancel_pending = [&]() {
+		for(const PendingFrame &frame : pending)
+			if (frame.event)
+				rendering::Renderer::cancel(frame.event);
+		pending.clear();
+	};
+
+	Time t = 0;
+	int frames = 0;
+	do {
+		frames = next_frame(t);
+
+		if(cb && !cb->amount_complete(total_frames-frames,total_frames))
+			{ cancel_pending(); return false; }
+
+		if(!get_avoid_time_sync() || canvas->get_time()!=t) {
+			canvas->set_time(t);
+			canvas->load_resources(t);
+		}
+		canvas->set_outline_grow(desc.get_outline_grow());
+
+		PendingFrame frame;
+		frame.surface = new SurfaceResource();
+		if (rendering::Task::Handle task = build_frame_task(frame.surface, *canvas, context_params, desc)) {
+			frame.event = new TaskEvent();
+			renderer->enqueue(task, frame.event);
+		}
+		pending.push_back(frame);
+
+		if ((int)pending.size() >= max_frames_in_flight && !write_oldest())
+			{ cancel_pending(); return false; }
+	} while(frames);
+
+	while(!pending.empty())
+		if (!write_oldest())
+			{ cancel_pending(); return false; }
+
+	return true;
+}
+
 bool
 synfig::Target_Scanline::render(ProgressCallback *cb)
 {
@@ -146,7 +426,50 @@ synfig::Target_Scanline::render(ProgressCallback *cb)
 	const int rows = 1 + desc.get_h() / rowheight;
 	const int lastrowheight = desc.get_h() - (rows - 1) * rowheight;
 
+	// Frames that are too large are already split into blocks,
+	// so don't multiply their memory usage by rendering them simultaneously
+	const int max_frames_in_flight = is_rendering_split ? 1 : std::min(threads_, total_frames);
+
+	frames_per_second_ = 0.0;
+	const std::chrono::steady_clock::time_point start_timepoint = std::chrono::steady_clock::now();
+	auto report_frames_per_second = [&]() {
+		const std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start_timepoint;
+		if (duration.count() > 0.0)
+			frames_per_second_ = total_frames/duration.count();
+		synfig::info(_("Rendered %d frames (%d simultaneously) at %.2f frames/second"),
+					 total_frames, std::max(1, max_frames_in_flight), frames_per_second_);
+	};
+
+	// the writer thread is stopped and its queue is dropped on any return
+	std::unique_ptr<FrameWriter> writer;
+	write_statistics_ = WriteStatistics();
+	if (write_queue_depth_ > 0 && supports_async_write() && !is_rendering_split)
+		writer.reset(new FrameWriter(*this, write_queue_depth_));
+
+	// waits for the writer thread to put the queued frames onto the target
+	auto finish_writer = [&]() -> bool {
+		if (!writer)
+			return true;
+		if (!writer->finish()) {
+			if(cb)cb->error(writer->get_error());
+			return false;
+		}
+		synfig::info(_("Frame writer: %d frames, rendering waited %.3f s for the queue of %d, writing took %.3f s, writer waited %.3f s"),
+					 write_statistics_.frames, write_statistics_.stall_time, write_queue_depth_,
+					 write_statistics_.write_time, write_statistics_.idle_time);
+		return true;
+	};
+
 	try {
+		if (max_frames_in_flight > 1) {
+			if (!render_frames_parallel(max_frames_in_flight, writer.get(), cb))
+				return false;
+			if (!finish_writer())
+				return false;
+			report_frames_per_second();
+			return true;
+		}
+
 		Time t = 0;
 		int frames = 0;
 		do{
@@ -232,23 +555,14 @@ synfig::Target_Scanline::render(ProgressCallback *cb)
 						return false;
 					}
 
-					SurfaceResource::LockRead<SurfaceSW> lock(surface);
-					if(!lock)
-					{
-						if(cb)cb->error(_("Bad surface"));
+					if (!put_frame(surface, writer.get(), cb))
 						return false;
-					}
-
-					// Put the surface we renderer
-					// onto the target.
-					if(!add_frame(&lock->get_surface(), cb))
-					{
-						if(cb)cb->error(_("Unable to put surface on target"));
-						return false;
-					}
 				}
 			}
 		} while(frames);
+		if (!finish_writer())
+			return false;
+		report_frames_per_second();
 	}
 	catch(const String& str)
 	{
@@ -31,6 +31,8 @@
 
 /* === H E A D E R S ======================================================= */
 
+#include <algorithm>
+
 #include "target.h"
 
 /* === M A C R O S ========================================================= */
@@ -41,7 +43,7 @@
 
 namespace synfig {
 
-namespace rendering { class SurfaceResource; }
+namespace rendering { class SurfaceResource; class Task; }
 
 /*!	\class Target_Scanline
 **	\brief This is a Target class that implements the render function
@@ -49,6 +51,27 @@ namespace rendering { class SurfaceResource; }
 */
 class Target_Scanline : public Target
 {
+public:
+	//! Statistics of the frame writer thread of the last call of render()
+	struct WriteStatistics
+	{
+		//! Frames passed through the writer thread
+		int frames;
+		//! Largest number of frames waiting in the queue
+		int max_queue_size;
+		//! Seconds the rendering waited for a free place in the queue
+		Real stall_time;
+		//! Seconds the writer spent putting frames onto the target
+		Real write_time;
+		//! Seconds the writer waited for rendered frames
+		Real idle_time;
+
+		WriteStatistics(): frames(), max_queue_size(), stall_time(), write_time(), idle_time() { }
+	};
+
+private:
+	class FrameWriter;
+
 	//! Number of threads to use
 	int threads_;
 
@@ -56,12 +79,42 @@ class Target_Scanline : public Target
 
 	int pixel_rendering_limit_;
 
+	//! Frames per second achieved by the last call of render()
+	Real frames_per_second_;
+
+	//! Number of rendered frames which may wait for the writer thread
+	int write_queue_depth_;
+
+	WriteStatistics write_statistics_;
+
+	etl::handle<rendering::Task> build_frame_task(
+		const etl::handle<rendering::SurfaceResource> &surface,
+		Canvas &canvas,
+		const ContextParams &context_params,
+		const RendDesc &renddesc );
+
 	bool call_renderer(
 		const etl::handle<rendering::SurfaceResource> &surface,
 		Canvas &canvas,
 		const ContextParams &context_params,
 		const RendDesc &renddesc );
 
+	//! Renders several frames simultaneously, but passes them to the target in order
+	bool render_frames_parallel(int max_frames_in_flight, FrameWriter *writer, ProgressCallback* cb);
+
+	//! Puts the rendered frame onto the target, or into the queue of \a writer if any
+	bool put_frame(const etl::handle<rendering::SurfaceResource> &surface, FrameWriter *writer, ProgressCallback* cb);
+
+protected:
+	//! Returns true if the frames may be put onto the target by a separate thread.
+	/*! start_frame(), start_scanline(), end_scanline() and end_frame() are
+	**	still called for one frame after another from a single thread, but
+	**	while the next frames are rendered, so they must not use the canvas.
+	**	The callback given to them is null.
+	**	\see set_write_queue_depth()
+	*/
+	virtual bool supports_async_write() const { return false; }
+
 public:
 	typedef etl::handle<Target_Scanline> Handle;
 	typedef etl::loose_handle<Target_Scanline> LooseHandle;
@@ -104,6 +157,11 @@ public:
 	virtual bool end_scanline()=0;
 
 	//! Sets the number of threads
+	/*! When it is greater than one, render() keeps up to this number of
+	**	animation frames in flight at once. Each frame is rendered from the
+	**	task tree built for its own time, and the frames are still passed
+	**	to the target in order. By default frames are rendered one by one.
+	*/
 	void set_threads(int x) { threads_=x; }
 	//! Gets the number of threads
 	int get_threads()const { return threads_; }
@@ -121,6 +179,22 @@ public:
 	/** Get the loose limit of pixels to render. @see set_pixel_rendering_limit() */
 	int get_pixel_rendering_limit() const { return pixel_rendering_limit_; }
 
+	//! Gets the frames per second achieved by the last call of render()
+	Real get_frames_per_second() const { return frames_per_second_; }
+
+	//! Sets the number of rendered frames which may wait for the writer thread
+	/*! If the target supports it, a separate thread converts the rendered
+	**	frames and puts them onto the target (encodes, writes into a file or
+	**	pipe), while the next frames are rendered. When the queue is full,
+	**	rendering waits for the writer. Zero writes the frames synchronously.
+	**	Frames split into blocks (see set_pixel_rendering_limit()) are always
+	**	written synchronously.
+	*/
+	void set_write_queue_depth(int x) { write_queue_depth_ = std::max(0, x); }
+	int get_write_queue_depth() const { return write_queue_depth_; }
+	//! Gets the statistics of the writer thread for the last call of render()
+	const WriteStatistics& get_write_statistics() const { return write_statistics_; }
+
 	//! Puts the rendered surface onto the target.
 	bool add_frame(const synfig::Surface *surface, ProgressCallback* cb);
 private:
@@ -58,15 +58,40 @@ using namespace synfig;
 
 /* === G L O B A L S ======================================================= */
 
+//! Time spent by the current thread in ThreadPool::wait() during the current slot,
+//! it is not counted as busy time
+static thread_local long long slot_wait_time = 0; // in microseconds
+
+/* === P R O C E D U R E S ================================================= */
+
+//! Count of threads forced by the environment variables, or zero
+static int
+get_env_threads()
+{
+	int threads = 0;
+	// rendering threads are the same threads now
+	if (const char *s = getenv("SYNFIG_RENDERING_THREADS"))
+		threads = atoi(s) + 1;
+	if (const char *s = getenv("SYNFIG_GENERIC_THREADS"))
+		threads = atoi(s) + 1;
+	return threads;
+}
+
 /* === M E T H O D S ======================================================= */
 
 ThreadPool* ThreadPool::instance_ = 0;
 
 
+// ThreadPool::Statistics
+
+ThreadPool::Statistics::Statistics():
+	max_threads(), threads(), running_threads(), queue_size(), processed(), utilisation() { }
+
+
 // ThreadPool::Group
 
-ThreadPool::Group::Group():
-	multithreading(), running_threads(0), sum_weight() { }
+ThreadPool::Group::Group(Priority priority):
+	priority(priority), multithreading(), running_threads(0), sum_weight() { }
 
 ThreadPool::Group::~Group()
 	{ run(); }
@@ -100,7 +125,7 @@ ThreadPool::Group::run(bool force_thread) {
 		if (sum >= 0.75) {
 			multithreading = true;
 			++running_threads;
-			instance().enqueue( sigc::bind( sigc::mem_fun(this, &Group::process), begin, end ));
+			instance().enqueue( sigc::bind( sigc::mem_fun(this, &Group::process), begin, end ), priority);
 			sum_weight -= sum;
 			sum = 0.0;
 			begin = end;
@@ -113,7 +138,7 @@ ThreadPool::Group::run(bool force_thread) {
 		if (force_thread) {
 			multithreading = true;
 			++running_threads;
-			instance().enqueue( sigc::bind( sigc::mem_fun(this, &Group::process), begin, end ));
+			instance().enqueue( sigc::bind( sigc::mem_fun(this, &Group::process), begin, end ), priority);
 		} else {
 			for(int i = begin; i < end; ++i)
 				tasks[i].second();
@@ -141,12 +166,16 @@ ThreadPool::ThreadPool():
 	running_threads(0),
 	ready_threads(0),
 	queue_size(0),
-	stopped(false)
+	stopped(false),
+	busy_time(0),
+	statistics_reset_time(std::chrono::steady_clock::now())
 {
-	max_running_threads = std::thread::hardware_concurrency();
+	for(int i = 0; i < PRIORITIES_COUNT; ++i)
+		processed[i] = 0;
 
-	if (const char *s = getenv("SYNFIG_GENERIC_THREADS"))
-		max_running_threads = atoi(s) + 1;
+	max_running_threads = std::thread::hardware_concurrency();
+	if (int threads = get_env_threads())
+		max_running_threads = threads;
 
 	if (max_running_threads < 2) max_running_threads = 2;
 	if (max_running_threads > 2) --max_running_threads;
@@ -185,7 +214,7 @@ ThreadPool::~ThreadPool() {
 	{
 		#ifdef DEBUG_PTHREAD_MEASURE
 		std::lock_guard<std::mutex> lock(mutex);
-		info("ThreadPool destroyed with unprocessed tasks in queue: %d", queue.size());
+		info("ThreadPool destroyed with unprocessed tasks in queue: %d", (int)queue_size);
 		#endif
 	}
 }
@@ -207,9 +236,10 @@ ThreadPool::thread_loop(int
 
 	while(true) {
 		Slot slot;
+		int priority = 0;
 		{
 			std::unique_lock<std::mutex> lock(mutex);
-			while(!stopped && (queue.empty() || running_threads > max_running_threads)) {
+			while(!stopped && (queue_size <= 0 || running_threads > max_running_threads)) {
 				++ready_threads;
 				--running_threads;
 				cond.wait(lock);
@@ -217,11 +247,15 @@ ThreadPool::thread_loop(int
 				--ready_threads;
 			}
 			if (stopped) break;
-			slot = queue.front();
-			queue.pop();
+			while(queue[priority].empty()) ++priority;
+			slot = queue[priority].front();
+			queue[priority].pop();
 			--queue_size;
 		}
 
+		std::chrono::steady_clock::time_point begin_time = std::chrono::steady_clock::now();
+		slot_wait_time = 0;
+
 		#ifdef DEBUG_PTHREAD_MEASURE
 		struct timespec spec;
 		clock_gettime(clock_id, &spec);
@@ -237,6 +271,10 @@ ThreadPool::thread_loop(int
 
 		slot();
 
+		busy_time += std::chrono::duration_cast<std::chrono::microseconds>(
+			std::chrono::steady_clock::now() - begin_time ).count() - slot_wait_time;
+		++processed[priority];
+
 		#ifdef DEBUG_PTHREAD_MEASURE
 		clock_gettime(clock_id, &spec);
 		long long time1 = spec.tv_sec*1000000000ll + spec.tv_nsec;
@@ -270,10 +308,11 @@ ThreadPool::wakeup() {
 }
 
 void
-ThreadPool::enqueue(const Slot &slot) {
+ThreadPool::enqueue(const Slot &slot, Priority priority) {
+	assert(priority >= 0 && priority < PRIORITIES_COUNT);
 	std::lock_guard<std::mutex> lock(mutex);
 	++queue_size;
-	queue.push(slot);
+	queue[priority].push(slot);
 	wakeup();
 }
 
@@ -284,10 +323,46 @@ ThreadPool::set_num_threads(int num_threads){
 	if(num_threads!=0){
 		max_running_threads = num_threads;
 	}
-	if (const char *s = getenv("SYNFIG_GENERIC_THREADS"))
-		max_running_threads = atoi(s) + 1;
+	if (int threads = get_env_threads())
+		max_running_threads = threads;
 
 	if (max_running_threads < 2) max_running_threads = 2;
+
+	// use the new limit for the waiting tasks
+	std::lock_guard<std::mutex> lock(mutex);
+	wakeup();
+}
+
+ThreadPool::Statistics
+ThreadPool::get_statistics() {
+	Statistics statistics;
+	std::chrono::steady_clock::time_point reset_time;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		statistics.threads = (int)threads.size();
+		for(int i = 0; i < PRIORITIES_COUNT; ++i)
+			statistics.queue_size[i] = (int)queue[i].size();
+		reset_time = statistics_reset_time;
+	}
+	statistics.max_threads = max_running_threads;
+	statistics.running_threads = running_threads;
+	for(int i = 0; i < PRIORITIES_COUNT; ++i)
+		statistics.processed[i] = processed[i];
+
+	long long available_time = std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now() - reset_time ).count() * max_running_threads;
+	if (available_time > 0)
+		statistics.utilisation = synfig::clamp((Real)busy_time/(Real)available_time, 0.0, 1.0);
+	return statistics;
+}
+
+void
+ThreadPool::reset_statistics() {
+	std::lock_guard<std::mutex> lock(mutex);
+	for(int i = 0; i < PRIORITIES_COUNT; ++i)
+		processed[i] = 0;
+	busy_time = 0;
+	statistics_reset_time = std::chrono::steady_clock::now();
 }
 
 void
@@ -295,7 +370,10 @@ ThreadPool::wait(std::condition_variable &cond, std::unique_lock<std::mutex> &lo
 	if (--running_threads < max_running_threads)
 		if (queue_size) // wakeup or create ready thread if we have tasks in queue
 			{ std::lock_guard<std::mutex> lock(this->mutex); wakeup(); }
+	std::chrono::steady_clock::time_point begin_time = std::chrono::steady_clock::now();
 	cond.wait(lock);
+	slot_wait_time += std::chrono::duration_cast<std::chrono::microseconds>(
+		std::chrono::steady_clock::now() - begin_time ).count();
 	++running_threads;
 }
 
@@ -31,6 +31,7 @@
 /* === H E A D E R S ======================================================= */
 
 #include <atomic>
+#include <chrono>
 #include <queue>
 
 #include <sigc++/signal.h>
@@ -48,16 +49,48 @@
 
 namespace synfig {
 
+/*!	\class ThreadPool
+**	\brief Process-wide executor with the shared budget of running threads.
+**
+**	The optimizer (through ThreadPool::Group), the render queue of
+**	rendering::Renderer and the asynchronous I/O jobs are all run by the
+**	threads of this pool, so they don't compete for the cores with each other.
+**	The count of threads is configured by set_num_threads().
+*/
 class ThreadPool {
 public:
 	typedef sigc::slot<void> Slot;
 
+	//! Slots with the higher priority (lower value) are taken from the queue first
+	enum Priority {
+		PRIORITY_OPTIMIZER,
+		PRIORITY_RENDER,
+		PRIORITY_IO,
+		PRIORITIES_COUNT
+	};
+
+	//! Counters to estimate the load of the pool, see get_statistics()
+	struct Statistics {
+		int max_threads;
+		int threads;
+		int running_threads;
+		int queue_size[PRIORITIES_COUNT];
+		long long processed[PRIORITIES_COUNT];
+		//! Time of the slots execution related to the time available
+		//! for max_threads since the last reset_statistics(), in range [0, 1].
+		//! Time which the slots spent blocked in wait() is not counted
+		Real utilisation;
+
+		Statistics();
+	};
+
 	class Group {
 	public:
 	typedef std::pair<Real, Slot> Entry;
 	typedef std::vector<Entry> List;
 
 	private:
+		Priority priority;
 		bool multithreading;
 		std::atomic<int> running_threads;
 		std::mutex mutex;
@@ -68,7 +101,7 @@ public:
 
 		void process(int begin, int end);
 	public:
-		Group();
+		explicit Group(Priority priority = PRIORITY_OPTIMIZER);
 		~Group();
 
 		void enqueue(const Slot &slot, Real weight = 1.0);
@@ -83,10 +116,14 @@ private:
 	std::atomic<int> running_threads;
 	std::atomic<int> ready_threads;
 	std::atomic<int> queue_size;
-	std::queue<Slot> queue;
+	std::queue<Slot> queue[PRIORITIES_COUNT];
 	std::vector<std::thread*> threads;
 	bool stopped;
 
+	std::atomic<long long> processed[PRIORITIES_COUNT];
+	std::atomic<long long> busy_time; // in microseconds
+	std::chrono::steady_clock::time_point statistics_reset_time;
+
 	static ThreadPool *instance_;
 
 	void thread_loop(int id);
@@ -98,11 +135,14 @@ private:
 public:
 	~ThreadPool();
 
-	void enqueue(const Slot &slot);
+	void enqueue(const Slot &slot, Priority priority = PRIORITY_OPTIMIZER);
 	void wait(std::condition_variable &cond, std::unique_lock<std::mutex>& lock);
 
 	void set_num_threads(int num_threads);
 
+	Statistics get_statistics();
+	void reset_statistics();
+
 	int get_max_threads() const
 		{ return max_running_threads; }
 	int get_running_threads() const
@@ -349,6 +349,29 @@ ValueNode::get_values_vfunc(std::map<Time, ValueBase> &x) const
 	calc_values(x);
 }
 
+bool
+ValueNode::get_constant_interval_vfunc(Time /* t */, Time & /* begin */, Time & /* end */) const
+{
+	return false;
+}
+
+bool
+ValueNode::get_constant_interval(Time t, Time &begin, Time &end) const
+{
+	begin = Time::begin();
+	end = Time::end();
+	return get_constant_interval_vfunc(t, begin, end);
+}
+
+bool
+ValueNode::is_time_invariant() const
+{
+	Time begin, end;
+	return get_constant_interval(0, begin, end)
+	    && begin == Time::begin()
+	    && end == Time::end();
+}
+
 
 ValueNodeList::ValueNodeList():
 	placeholder_count_(0)
@@ -828,3 +851,18 @@ LinkableValueNode::get_values_vfunc(std::map<Time, ValueBase> &x) const
 	for(std::set<Time>::const_iterator i = times.begin(); i != times.end(); ++i)
 		add_value_to_map(x, *i, (*this)(*i));
 }
+
+bool
+LinkableValueNode::get_links_constant_interval(Time t, Time &begin, Time &end) const
+{
+	for(int i = 0; i < link_count(); ++i) {
+		ValueNode::Handle link = get_link(i);
+		if (!link) continue;
+		Time link_begin, link_end;
+		if (!link->get_constant_interval(t, link_begin, link_end))
+			return false;
+		begin = std::max(begin, link_begin);
+		end = std::min(end, link_end);
+	}
+	return true;
+}
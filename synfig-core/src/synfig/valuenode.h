@@ -275,6 +275,14 @@ public:
 	static int time_to_frame(Time t, Real fps);
 	static void add_value_to_map(std::map<Time, ValueBase> &x, Time t, const ValueBase &v);
 
+	//! Finds the interval of time around \a t in which the value doesn't change.
+	//! On success \a begin and \a end receive the bounds of the interval, both included.
+	//! Time::begin() and Time::end() mean that the interval is not bounded.
+	//! \return false if the value may change right before or after \a t
+	bool get_constant_interval(Time t, Time &begin, Time &end) const;
+	//! Returns true if the value is the same at any time
+	bool is_time_invariant() const;
+
 private:
 	static void canvas_time_bounds(const Canvas &canvas, bool &found, Time &begin, Time &end, Real &fps);
 	static void find_time_bounds(const Node &node, bool &found, Time &begin, Time &end, Real &fps);
@@ -286,6 +294,11 @@ protected:
 	virtual void on_changed();
 
 	virtual void get_values_vfunc(std::map<Time, ValueBase> &x) const;
+
+	//! Narrows [\a begin, \a end] to the interval around \a t in which the value doesn't change,
+	//! see get_constant_interval(). The default implementation knows nothing
+	//! about the value and returns false.
+	virtual bool get_constant_interval_vfunc(Time t, Time &begin, Time &end) const;
 }; // END of class ValueNode
 
 
@@ -466,6 +479,11 @@ protected:
 	virtual void init_children_vocab();
 
 	void get_values_vfunc(std::map<Time, ValueBase> &x) const override;
+
+	//! Narrows [\a begin, \a end] to the interval in which all the links are constant.
+	//! Nodes whose value is a pure function of their links return this
+	//! from get_constant_interval_vfunc(), the others are never constant.
+	bool get_links_constant_interval(Time t, Time &begin, Time &end) const;
 }; // END of class LinkableValueNode
 
 /*!	\class ValueNodeList
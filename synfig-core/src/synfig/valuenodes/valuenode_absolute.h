@@ -85,6 +85,10 @@ protected:
 
 	virtual Vocab
 	        get_children_vocab_vfunc() const override;
+
+	virtual bool
+	        get_constant_interval_vfunc(Time t, Time &begin, Time &end) const override
+	        { return get_links_constant_interval(t, begin, end); }
 }; // END of class ValueNode_Absolute
 
 }; // END of namespace synfig
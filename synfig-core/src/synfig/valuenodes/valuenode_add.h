@@ -74,6 +74,9 @@ protected:
 	virtual ValueNode::LooseHandle get_link_vfunc(int i) const override;
 
 	virtual Vocab get_children_vocab_vfunc() const override;
+
+	virtual bool get_constant_interval_vfunc(Time t, Time &begin, Time &end) const override
+		{ return get_links_constant_interval(t, begin, end); }
 }; // END of class ValueNode_Add
 
 }; // END of namespace synfig
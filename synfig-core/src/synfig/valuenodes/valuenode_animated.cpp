@@ -113,6 +113,10 @@ void
 ValueNode_Animated::get_values_vfunc(std::map<Time, ValueBase> &x) const
 	{ ValueNode_AnimatedInterface::get_values_vfunc(x); }
 
+bool
+ValueNode_Animated::get_constant_interval_vfunc(Time t, Time &begin, Time &end) const
+	{ return ValueNode_AnimatedInterface::get_constant_interval_vfunc(t, begin, end); }
+
 void
 ValueNode_Animated::get_times_vfunc(Node::time_set &set) const
 	{ ValueNode_AnimatedInterface::get_times_vfunc(set); }
@@ -77,6 +77,7 @@ protected:
 	virtual void on_changed();
 	virtual void get_times_vfunc(Node::time_set &set) const;
 	virtual void get_values_vfunc(std::map<Time, ValueBase> &x) const;
+	virtual bool get_constant_interval_vfunc(Time t, Time &begin, Time &end) const;
 };
 
 }; // END of namespace synfig
@@ -81,6 +81,8 @@ protected:
 	virtual LinkableValueNode::Vocab get_children_vocab_vfunc() const override;
 
 	virtual void get_values_vfunc(std::map<Time, ValueBase> &x) const override;
+	//! The file may contain animated values
+	virtual bool get_constant_interval_vfunc(Time, Time&, Time&) const override { return false; }
 
 	virtual void on_changed() override;
 };
@@ -36,6 +36,7 @@
 #include <cmath>
 
 #include <algorithm>
+#include <atomic>
 #include <typeinfo>
 #include <vector>
 #include <list>
@@ -231,9 +232,51 @@ class ValueNode_AnimatedInterfaceConst::Interpolator
 public:
 	ValueNode_AnimatedInterfaceConst &animated;
 
-	explicit Interpolator(ValueNode_AnimatedInterfaceConst &animated): animated(animated) { }
+private:
+	//! Segment found by the last find_segment(), playback usually asks for it or for the next one
+	mutable std::atomic<size_t> segment_cursor;
+
+public:
+	explicit Interpolator(ValueNode_AnimatedInterfaceConst &animated): animated(animated), segment_cursor(0) { }
 	virtual ~Interpolator() { }
 
+	//! Returns the first of \a count segments for which \a t < end_time(segment),
+	//! or \a count if there is no such segment.
+	//! Ends of the segments must increase.
+	template<typename EndTime>
+	size_t find_segment(size_t count, Time t, EndTime end_time) const
+	{
+		size_t i = segment_cursor.load(std::memory_order_relaxed);
+		if (i < count && (i == 0 || t >= end_time(i - 1))) {
+			if (t < end_time(i))
+				return i;
+			if (i + 1 < count && t < end_time(i + 1))
+				{ segment_cursor.store(i + 1, std::memory_order_relaxed); return i + 1; }
+		}
+
+		size_t begin = 0, end = count;
+		while(begin < end) {
+			size_t middle = begin + (end - begin)/2;
+			if (t < end_time(middle))
+				end = middle;
+			else
+				begin = middle + 1;
+		}
+		if (begin < count)
+			segment_cursor.store(begin, std::memory_order_relaxed);
+		return begin;
+	}
+
+	//! Returns the waypoint which starts the segment containing \a t,
+	//! waypoints must be sorted and \a t must be inside of them
+	WaypointList::const_iterator find_segment_waypoint(Time t) const
+	{
+		const WaypointList &list = animated.waypoint_list_;
+		const size_t i = find_segment(list.size() - 1, t,
+			[&list](size_t segment) { return list[segment + 1].get_time(); });
+		return list.begin() + std::min(i, list.size() - 1);
+	}
+
 	virtual Interpolator* create(ValueNode_AnimatedInterfaceConst &node) const = 0;
 	virtual WaypointList::iterator new_waypoint(Time t, ValueBase value) = 0;
 	virtual WaypointList::iterator new_waypoint(Time t, ValueNode::Handle value_node) = 0;
@@ -654,15 +697,12 @@ public:
 			if(t>=s)
 				return animated.waypoint_list_.back().get_value(t);
 
-			typename curve_list_type::const_iterator iter;
-
-			// This next line will set iter to the
-			// correct iterator for the given time.
-			for(iter=curve_list.begin();iter<curve_list.end() && t>=iter->first.get_s();++iter)
-				continue;
-			if(iter==curve_list.end())
+			const curve_list_type &curves = curve_list;
+			const size_t i = this->find_segment(curves.size(), t,
+				[&curves](size_t segment) { return curves[segment].first.get_s(); });
+			if(i==curves.size())
 				return animated.waypoint_list_.back().get_value(t);
-			return iter->resolve(t);
+			return curves[i].resolve(t);
 		}
 	}; // END of class Hermite
 
@@ -745,15 +785,8 @@ public:
 			if(t>=s)
 				return animated.waypoint_list_.back().get_value(t);
 
-			WaypointList::const_iterator iter;
-			WaypointList::const_iterator next;
-
-			// This next line will set iter to the
-			// correct iterator for the given time.
-			for(next=animated.waypoint_list_.begin(),iter=next++;next!=animated.waypoint_list_.end() && t>=next->get_time();iter=next++)
-				continue;
-
-			return iter->get_value(t);
+			// the last waypoint which is not after t
+			return find_segment_waypoint(t)->get_value(t);
 		}
 
 		virtual void get_values_vfunc(std::map<Time, ValueBase> &x) const
@@ -836,13 +869,8 @@ public:
 			if(t>=s)
 				return animated.waypoint_list_.back().get_value(t);
 
-			WaypointList::const_iterator iter = animated.waypoint_list_.begin();
-
 			// A waypoint sets the boolean value until next waypoint
-			for (auto next = iter+1; next != animated.waypoint_list_.end(); iter = next++)
-				if (iter->get_time()==t || t < next->get_time())
-					return iter->get_value(t);
-			return iter->get_value(t);
+			return find_segment_waypoint(t)->get_value(t);
 		}
 
 		virtual void get_values_vfunc(std::map<Time, ValueBase> &x) const
@@ -960,6 +988,35 @@ void
 ValueNode_AnimatedInterfaceConst::get_values_vfunc(std::map<Time, ValueBase> &x) const
 	{ interpolator_->get_values_vfunc(x); }
 
+bool
+ValueNode_AnimatedInterfaceConst::get_constant_interval_vfunc(Time t, Time &begin, Time &end) const
+{
+	if (waypoint_list_.empty())
+		return true;
+
+	const Waypoint *waypoint;
+	if (waypoint_list_.size() == 1) {
+		waypoint = &waypoint_list_.front();
+	} else
+	if (t <= waypoint_list_.front().get_time()) {
+		waypoint = &waypoint_list_.front();
+		end = std::min(end, waypoint->get_time());
+	} else
+	if (t >= waypoint_list_.back().get_time()) {
+		waypoint = &waypoint_list_.back();
+		begin = std::max(begin, waypoint->get_time());
+	} else {
+		return false;
+	}
+
+	Time value_begin, value_end;
+	if (!waypoint->get_value_node() || !waypoint->get_value_node()->get_constant_interval(t, value_begin, value_end))
+		return false;
+	begin = std::max(begin, value_begin);
+	end = std::min(end, value_end);
+	return true;
+}
+
 Waypoint
 ValueNode_AnimatedInterfaceConst::new_waypoint_at_time(const Time& time)const
 {
@@ -124,6 +124,9 @@ protected:
 	ValueBase operator()(Time t) const;
 	void get_times_vfunc(Node::time_set &set) const;
 	void get_values_vfunc(std::map<Time, ValueBase> &x) const;
+	//! Before the first and after the last waypoint the value is
+	//! taken from that waypoint, so it is constant while the waypoint's value is
+	bool get_constant_interval_vfunc(Time t, Time &begin, Time &end) const;
 
 	void assign(const ValueNode_AnimatedInterfaceConst &animated, const synfig::GUID& deriv_guid);
 
@@ -40,6 +40,7 @@
 #include <synfig/localization.h>
 #include <synfig/valuenode_registry.h>
 #include <synfig/canvas.h>
+#include <algorithm>
 
 #endif
 
@@ -429,6 +430,63 @@ ValueNode_Bone::get_parent(Time t)const
 	return new ValueNode_Bone_Root();
 }
 
+bool
+ValueNode_Bone::get_constant_interval_vfunc(Time t, Time &begin, Time &end) const
+{
+	if (is_root())
+		return true;
+
+	for(int i = 0; i < link_count(); ++i) {
+		ValueNode::Handle link = get_link(i);
+		if (!link || link.get() == parent_.get()) continue;
+		Time link_begin, link_end;
+		if (!link->get_constant_interval(t, link_begin, link_end))
+			return false;
+		begin = std::max(begin, link_begin);
+		end = std::min(end, link_end);
+	}
+
+	// the parent may be switched by an animated link
+	Time parent_begin, parent_end;
+	if (!ValueNode_Const::Handle::cast_dynamic(parent_)) {
+		if (!parent_->get_constant_interval(t, parent_begin, parent_end))
+			return false;
+		begin = std::max(begin, parent_begin);
+		end = std::min(end, parent_end);
+	}
+
+	// get_parent() breaks loops in the ancestry, so the recursion ends at the root bone
+	if (!get_parent(t)->get_constant_interval(t, parent_begin, parent_end))
+		return false;
+	begin = std::max(begin, parent_begin);
+	end = std::min(end, parent_end);
+	return true;
+}
+
+bool
+ValueNode_Bone::get_bone_link_constant_interval(const ValueNode::Handle &bone_link, Time t, Time &begin, Time &end)
+{
+	if (!bone_link)
+		return true;
+
+	Time link_begin, link_end;
+	if (!ValueNode_Const::Handle::cast_dynamic(bone_link)) {
+		if (!bone_link->get_constant_interval(t, link_begin, link_end))
+			return false;
+		begin = std::max(begin, link_begin);
+		end = std::min(end, link_end);
+	}
+
+	ValueNode_Bone::Handle bone((*bone_link)(t).get(ValueNode_Bone::Handle()));
+	if (!bone)
+		return true;
+	if (!bone->get_constant_interval(t, link_begin, link_end))
+		return false;
+	begin = std::max(begin, link_begin);
+	end = std::min(end, link_end);
+	return true;
+}
+
 ValueBase
 ValueNode_Bone::operator()(Time t)const
 {
@@ -88,6 +88,8 @@ protected:
 
 	virtual Vocab get_children_vocab_vfunc() const override;
 
+	virtual bool get_constant_interval_vfunc(Time t, Time &begin, Time &end) const override;
+
 	virtual void on_changed() override;
 
 public:
@@ -122,6 +124,10 @@ public:
 
 	static ValueNode_Bone::Handle get_root_bone();
 
+	//! Narrows [begin, end] to the interval around \a t in which the bone referenced
+	//! by \a bone_link (of type bone_valuenode) and all of its parents don't change
+	static bool get_bone_link_constant_interval(const ValueNode::Handle &bone_link, Time t, Time &begin, Time &end);
+
 #ifdef _DEBUG
 	void ref() const noexcept override;
 	void unref() const override;
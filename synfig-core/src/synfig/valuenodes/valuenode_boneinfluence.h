@@ -71,6 +71,9 @@ protected:
 
 	virtual Vocab get_children_vocab_vfunc() const override;
 
+	virtual bool get_constant_interval_vfunc(Time t, Time &begin, Time &end) const override
+		{ return get_links_constant_interval(t, begin, end); }
+
 public:
 	Matrix calculate_transform(Time t)const;
 	Matrix& get_transform(bool rebuild=false, Time t=0)const;
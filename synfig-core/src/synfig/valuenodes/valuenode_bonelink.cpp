@@ -39,6 +39,7 @@
 #include <synfig/localization.h>
 #include <synfig/valuenode_registry.h>
 #include <synfig/valueoperations.h>
+#include <algorithm>
 
 #endif
 
@@ -189,6 +190,24 @@ ValueNode_BoneLink::check_type(Type &type)
 	return ValueTransformation::check_type(type);
 }
 
+bool
+ValueNode_BoneLink::get_constant_interval_vfunc(Time t, Time &begin, Time &end) const
+{
+	if (!ValueNode_Bone::get_bone_link_constant_interval(bone_, t, begin, end))
+		return false;
+
+	for(int i = 0; i < link_count(); ++i) {
+		ValueNode::Handle link = get_link(i);
+		if (!link || link.get() == bone_.get()) continue;
+		Time link_begin, link_end;
+		if (!link->get_constant_interval(t, link_begin, link_end))
+			return false;
+		begin = std::max(begin, link_begin);
+		end = std::min(end, link_end);
+	}
+	return true;
+}
+
 LinkableValueNode::Vocab
 ValueNode_BoneLink::get_children_vocab_vfunc()const
 {
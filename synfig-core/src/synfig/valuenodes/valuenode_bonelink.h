@@ -73,6 +73,8 @@ protected:
 
 	virtual Vocab get_children_vocab_vfunc() const override;
 
+	virtual bool get_constant_interval_vfunc(Time t, Time &begin, Time &end) const override;
+
 public:
 	Transformation get_bone_transformation(Time t) const;
 }; // END of class ValueNode_Pow
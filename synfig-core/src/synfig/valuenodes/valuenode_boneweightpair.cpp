@@ -42,6 +42,7 @@
 #include <synfig/localization.h>
 #include <synfig/valuenode_registry.h>
 #include <synfig/boneweightpair.h>
+#include <algorithm>
 
 #endif
 
@@ -149,6 +150,21 @@ ValueNode_BoneWeightPair::get_link_vfunc(int i)const
 }
 
 
+bool
+ValueNode_BoneWeightPair::get_constant_interval_vfunc(Time t, Time &begin, Time &end) const
+{
+	// ValueNode_BoneInfluence gets its interval from these pairs in its weight list
+	if (!ValueNode_Bone::get_bone_link_constant_interval(bone_, t, begin, end))
+		return false;
+
+	Time weight_begin, weight_end;
+	if (!weight_->get_constant_interval(t, weight_begin, weight_end))
+		return false;
+	begin = std::max(begin, weight_begin);
+	end = std::min(end, weight_end);
+	return true;
+}
+
 LinkableValueNode::Vocab
 ValueNode_BoneWeightPair::get_children_vocab_vfunc() const
 {
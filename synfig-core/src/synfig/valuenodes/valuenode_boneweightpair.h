@@ -67,6 +67,8 @@ protected:
 	virtual ValueNode::LooseHandle get_link_vfunc(int i) const override;
 
 	virtual Vocab get_children_vocab_vfunc() const override;
+
+	virtual bool get_constant_interval_vfunc(Time t, Time &begin, Time &end) const override;
 }; // END of class ValueNode_BoneWeightPair
 
 }; // END of namespace synfig
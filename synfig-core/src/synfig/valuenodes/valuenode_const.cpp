@@ -185,3 +185,10 @@ void ValueNode_Const::get_values_vfunc(std::map<Time, ValueBase> &x) const
 {
 	add_value_to_map(x, 0, value);
 }
+
+bool ValueNode_Const::get_constant_interval_vfunc(Time /*t*/, Time &/*begin*/, Time &/*end*/) const
+{
+	// the referenced bone is evaluated with its parents at the given time,
+	// so the value is only as constant as that bone chain (see ValueNode_Bone)
+	return get_type() != type_bone_valuenode;
+}
@@ -70,6 +70,7 @@ public:
 protected:
 	virtual void get_times_vfunc(Node::time_set &set) const override;
 	virtual void get_values_vfunc(std::map<Time, ValueBase> &x) const override;
+	virtual bool get_constant_interval_vfunc(Time t, Time &begin, Time &end) const override;
 
 public:
 	const ValueBase& get_value() const;
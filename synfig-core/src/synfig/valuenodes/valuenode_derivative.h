@@ -86,6 +86,9 @@ protected:
 	virtual ValueNode::LooseHandle get_link_vfunc(int i) const override;
 
 	virtual Vocab get_children_vocab_vfunc() const override;
+
+	//! The derivative is taken over time
+	virtual bool get_constant_interval_vfunc(Time, Time&, Time&) const override { return false; }
 }; // END of class ValueNode_Derivative
 
 }; // END of namespace synfig
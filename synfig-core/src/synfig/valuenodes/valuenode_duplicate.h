@@ -74,6 +74,9 @@ protected:
 	virtual ValueNode::LooseHandle get_link_vfunc(int i) const override;
 
 	virtual Vocab get_children_vocab_vfunc() const override;
+
+	//! The index is changed by the Duplicate layer, not by time
+	virtual bool get_constant_interval_vfunc(Time, Time&, Time&) const override { return false; }
 }; // END of class ValueNode_Duplicate
 
 }; // END of namespace synfig
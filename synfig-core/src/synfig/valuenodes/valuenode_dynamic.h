@@ -107,6 +107,9 @@ protected:
 	virtual ValueNode::LooseHandle get_link_vfunc(int i) const override;
 
 	virtual Vocab get_children_vocab_vfunc() const override;
+
+	//! The simulation depends on time
+	virtual bool get_constant_interval_vfunc(Time, Time&, Time&) const override { return false; }
 }; // END of class ValueNode_Dynamic
 
 
@@ -869,6 +869,15 @@ void ValueNode_DynamicList::get_times_vfunc(Node::time_set &set) const
 	}
 }
 
+bool ValueNode_DynamicList::get_constant_interval_vfunc(Time t, Time &begin, Time &end) const
+{
+	// entries may be turned on and off by activepoints
+	for(std::vector<ListEntry>::const_iterator i = list.begin(); i != list.end(); ++i)
+		if (!i->timing_info.empty())
+			return false;
+	return get_links_constant_interval(t, begin, end);
+}
+
 
 //new find functions that don't throw
 struct timecmp
@@ -193,6 +193,7 @@ protected:
 
 	virtual bool set_link_vfunc(int i,ValueNode::Handle x) override;
 	virtual void get_times_vfunc(Node::time_set &set) const override;
+	virtual bool get_constant_interval_vfunc(Time t, Time &begin, Time &end) const override;
 
 	virtual Vocab get_children_vocab_vfunc() const override;
 
@@ -68,6 +68,9 @@ protected:
 	virtual ValueNode::LooseHandle get_link_vfunc(int i)const;
 
 	virtual Vocab get_children_vocab_vfunc()const;
+
+	virtual bool get_constant_interval_vfunc(Time t, Time &begin, Time &end) const
+		{ return get_links_constant_interval(t, begin, end); }
 }; // END of class ValueNode_IntString
 
 }; // END of namespace synfig
@@ -74,6 +74,9 @@ protected:
 
 	virtual Vocab get_children_vocab_vfunc() const override;
 
+	virtual bool get_constant_interval_vfunc(Time t, Time &begin, Time &end) const override
+		{ return get_links_constant_interval(t, begin, end); }
+
 private:
 	ValueBase get_inverse(const Time& t, const synfig::Vector &target_value) const;
 	ValueBase get_inverse(const Time& t, const synfig::Angle &target_value) const;
@@ -88,6 +88,9 @@ protected:
 
 	virtual Vocab get_children_vocab_vfunc() const override;
 
+	virtual bool get_constant_interval_vfunc(Time t, Time &begin, Time &end) const override
+		{ return get_links_constant_interval(t, begin, end); }
+
 public:
 	/*! \note The construction parameter (\a type) is the type that the list
 	**	contains, rather than the type that it will yield
@@ -75,6 +75,9 @@ protected:
 
 	virtual Vocab get_children_vocab_vfunc() const override;
 
+	virtual bool get_constant_interval_vfunc(Time t, Time &begin, Time &end) const override
+		{ return get_links_constant_interval(t, begin, end); }
+
 public:
 	//! Gets the left-hand-side value_node
 	ValueNode::Handle get_lhs() const { return ref_a; }
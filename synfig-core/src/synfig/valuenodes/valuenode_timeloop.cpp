@@ -157,6 +157,12 @@ ValueNode_TimeLoop::check_type(Type &type)
 }
 
 
+bool
+ValueNode_TimeLoop::get_constant_interval_vfunc(Time /*t*/, Time &/*begin*/, Time &/*end*/) const
+{
+	return link_->is_time_invariant();
+}
+
 LinkableValueNode::Vocab
 ValueNode_TimeLoop::get_children_vocab_vfunc()const
 {
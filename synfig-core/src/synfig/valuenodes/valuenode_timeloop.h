@@ -76,6 +76,9 @@ protected:
 	virtual ValueNode::LooseHandle get_link_vfunc(int i) const override;
 
 	virtual Vocab get_children_vocab_vfunc() const override;
+
+	//! Time is remapped, so the value is constant only if the looped link is constant at any time
+	virtual bool get_constant_interval_vfunc(Time t, Time &begin, Time &end) const override;
 }; // END of class ValueNode_TimeLoop
 
 }; // END of namespace synfig
@@ -38,7 +38,8 @@ SynfigToolGeneralOptions::SynfigToolGeneralOptions()
 	  _threads(1),
 	  _should_be_quiet(false),
 	  _should_print_benchmarks(false),
-	  _repeats(1)
+	  _repeats(1),
+	  _write_queue_depth(-1)
 { }
 
 std::string SynfigToolGeneralOptions::get_binary_path() const
@@ -103,3 +104,23 @@ void SynfigToolGeneralOptions::set_repeats(int repeats)
 {
 	_repeats = repeats;
 }
+
+const std::string& SynfigToolGeneralOptions::get_trace_file() const
+{
+	return _trace_file;
+}
+
+void SynfigToolGeneralOptions::set_trace_file(const std::string& trace_file)
+{
+	_trace_file = trace_file;
+}
+
+int SynfigToolGeneralOptions::get_write_queue_depth() const
+{
+	return _write_queue_depth;
+}
+
+void SynfigToolGeneralOptions::set_write_queue_depth(int depth)
+{
+	_write_queue_depth = depth;
+}
@@ -114,6 +114,15 @@ public:
 
 	void set_repeats(int repeats);
 
+	const std::string& get_trace_file() const;
+
+	void set_trace_file(const std::string& trace_file);
+
+	//! Negative value keeps the default of the target
+	int get_write_queue_depth() const;
+
+	void set_write_queue_depth(int depth);
+
 private:
 	SynfigToolGeneralOptions();
 	std::string _binary_path;
@@ -123,6 +132,8 @@ private:
 		 _should_print_benchmarks;
 
 	int _repeats;
+	std::string _trace_file;
+	int _write_queue_depth;
 };
 
 #endif
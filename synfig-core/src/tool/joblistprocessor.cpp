@@ -44,6 +44,8 @@
 #include <synfig/target_tile.h>
 #include <synfig/savecanvas.h>
 #include <synfig/filesystemnative.h>
+#include <synfig/threadpool.h>
+#include <synfig/debug/trace.h>
 
 #include "definitions.h"
 #include "synfigtoolexception.h"
@@ -159,7 +161,6 @@ static bool create_target(Job& job, const TargetParam& target_parameters)
 		return false;
 	}
 
-	job.sifout = job.target_name == "sif";
 	return true;
 }
 
@@ -184,6 +185,8 @@ static void set_target_engine_and_threads(Job& job)
 	{
 		scanline_target->set_threads(SynfigToolGeneralOptions::instance()->get_threads());
 		scanline_target->set_engine(job.render_engine);
+		if (SynfigToolGeneralOptions::instance()->get_write_queue_depth() >= 0)
+			scanline_target->set_write_queue_depth(SynfigToolGeneralOptions::instance()->get_write_queue_depth());
 	} else if(auto tile_target = Target_Tile::Handle::cast_dynamic(job.target))
 	{
 		tile_target->set_threads(SynfigToolGeneralOptions::instance()->get_threads());
@@ -214,6 +217,11 @@ bool setup_job(Job& job, const TargetParam& target_parameters)
 		return false;
 	}
 
+	// saving into another canvas format (e.g. .sif <-> .sifb) doesn't need a render target
+	job.sifout = job.target_name == "sif" || job.target_name == "sifz" || job.target_name == "sifb";
+	if (job.sifout)
+		return true;
+
 	if (!create_target(job, target_parameters)) {
 		return false;
 	}
@@ -250,6 +258,9 @@ static void save_canvas_to_file(const std::string& filename, const synfig::Canva
 void render_job(const Job& job, RenderProgress& progress, bool should_print_benchmarks, int repeats) {
 	double total_duration = 0.f;
 
+	if(should_print_benchmarks)
+		ThreadPool::instance().reset_statistics();
+
 	for(int i = 0; i < repeats; i++)
 	{
 		std::chrono::steady_clock::time_point start_timepoint =
@@ -279,6 +290,50 @@ void render_job(const Job& job, RenderProgress& progress, bool should_print_benc
 				  << _(" Average time per render: ")
 				  << total_duration / repeats
 				  << _(" ms.") << std::endl;
+
+		if (auto scanline_target = Target_Scanline::Handle::cast_dynamic(job.target))
+		{
+			std::cout << job.filename.c_str()
+					  << _(": Rendered at ")
+					  << scanline_target->get_frames_per_second()
+					  << _(" frames/second with ")
+					  << scanline_target->get_threads()
+					  << _(" frames in flight.") << std::endl;
+
+			const Target_Scanline::WriteStatistics& write_stats = scanline_target->get_write_statistics();
+			if (write_stats.frames > 0)
+				std::cout << job.filename.c_str()
+						  << _(": Encoder thread wrote ")
+						  << write_stats.frames
+						  << _(" frames in ")
+						  << write_stats.write_time*1000.0
+						  << _(" ms, rendering stalled on the full queue for ")
+						  << write_stats.stall_time*1000.0
+						  << _(" ms, encoder waited for frames ")
+						  << write_stats.idle_time*1000.0
+						  << _(" ms, max queue ")
+						  << write_stats.max_queue_size << "/"
+						  << scanline_target->get_write_queue_depth() << std::endl;
+		}
+
+		const ThreadPool::Statistics stats = ThreadPool::instance().get_statistics();
+		std::cout << job.filename.c_str()
+				  << _(": Thread pool of ")
+				  << stats.max_threads
+				  << _(" threads utilised at ")
+				  << stats.utilisation*100.0
+				  << _("%, processed jobs (optimizer/render/io): ")
+				  << stats.processed[ThreadPool::PRIORITY_OPTIMIZER] << "/"
+				  << stats.processed[ThreadPool::PRIORITY_RENDER] << "/"
+				  << stats.processed[ThreadPool::PRIORITY_IO] << std::endl;
+	}
+
+	const std::string& trace_file = SynfigToolGeneralOptions::instance()->get_trace_file();
+	if (!trace_file.empty())
+	{
+		debug::Trace::write(filesystem::Path(trace_file));
+		if(should_print_benchmarks)
+			debug::Trace::write_summary(std::cout);
 	}
 }
 
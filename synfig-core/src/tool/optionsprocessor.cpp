@@ -46,6 +46,7 @@
 #include <synfig/loadcanvas.h>
 #include <synfig/valuenode_registry.h>
 #include <synfig/rendering/renderer.h>
+#include <synfig/debug/trace.h>
 
 #include "definitions.h"
 #include "job.h"
@@ -109,6 +110,8 @@ SynfigCommandLineParser::SynfigCommandLineParser() :
 	set_dpi_x(),
 	set_dpi_y(),
 	set_repeats(),
+	set_trace_file(),
+	set_write_queue(-1),
 
 	// Switch group
 	sw_verbosity(),
@@ -155,7 +158,7 @@ SynfigCommandLineParser::SynfigCommandLineParser() :
 	add_option(og_set, "span",        's', set_span,		_("Set the diagonal size of image window (Span)"), "NUM");
 	add_option(og_set, "antialias",   'a', set_antialias,	_("Set antialias amount for parametric renderer."), "1..30");
 	//og_set.add_option("quality",     'Q', quality_arg_desc, strprintf(_("Specify image quality for accelerated renderer (Default: %d)"), DEFAULT_QUALITY).c_str(), "NUM");
-	add_option(og_set, "threads",     'T', set_num_threads, _("Enable multithreaded renderer using the specified number of threads"), "NUM");
+	add_option(og_set, "threads",     'T', set_num_threads, _("Enable multithreaded renderer using the specified number of threads (frames rendered simultaneously)"), "NUM");
 	add_option(og_set, "input-file",  'i', set_input_file, 	_("Specify input filename"), "filename");
 	add_option(og_set, "output-file", 'o', set_output_file, _("Specify output filename"), "filename");
 	add_option(og_set, "renderer",    ' ', set_renderer,    _("Specify which renderer to use"), "string");
@@ -170,6 +173,8 @@ SynfigCommandLineParser::SynfigCommandLineParser() :
 	add_option(og_set, "dpi-x",       ' ', set_dpi_x, 		_("Set the physical X resolution (Dots-per-inch)"), "NUM");
 	add_option(og_set, "dpi-y",       ' ', set_dpi_y, 		_("Set the physical Y resolution (Dots-per-inch)"), "NUM");
 	add_option(og_set, "repeats",	  ' ', set_repeats,		_("Set the number of times to render the same target"), "NUM");
+	add_option(og_set, "write-queue", ' ', set_write_queue,	_("Set the number of rendered frames which may wait for the encoder thread (0 writes them synchronously)"), "NUM");
+	add_option_filename(og_set, "trace", ' ', set_trace_file, _("Write the timeline of rendering tasks and optimizers to <filename> in Chrome trace format, with --benchmarks also print its summary"), _("filename"));
 
 	// Switch options
 	//og_switch("switch", _("Switch options"), "Show switch help");
@@ -362,6 +367,17 @@ void SynfigCommandLineParser::process_settings_options() const
 		SynfigToolGeneralOptions::instance()->set_repeats(set_repeats);
 	}
 
+	if (set_write_queue >= 0)
+	{
+		SynfigToolGeneralOptions::instance()->set_write_queue_depth(set_write_queue);
+	}
+
+	if (!set_trace_file.empty())
+	{
+		SynfigToolGeneralOptions::instance()->set_trace_file(set_trace_file);
+		synfig::debug::Trace::start();
+	}
+
 	if (sw_quiet)
 	{
 		SynfigToolGeneralOptions::instance()->set_should_be_quiet(true);
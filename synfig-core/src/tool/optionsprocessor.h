@@ -118,6 +118,8 @@ private:
 	double			set_dpi_x;
 	double			set_dpi_y;
 	int				set_repeats;
+	std::string		set_trace_file;
+	int				set_write_queue;
 
 	// Switch group
 	int				sw_verbosity;
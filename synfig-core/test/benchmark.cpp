@@ -24,18 +24,21 @@
 
 /* === H E A D E R S ======================================================= */
 
+#include <cmath>
 #include <cstdio>
 
 #include <synfig/angle.h>
 #include <synfig/bezier.h>
 #include <synfig/clock.h>
 #include <synfig/surface_etl.h>
+#include <synfig/valuenodes/valuenode_animated.h>
 
 /* === M A C R O S ========================================================= */
 
 using namespace synfig;
 
 #define HERMITE_TEST_ITERATIONS		(100000)
+#define ANIMATED_TEST_EVALUATIONS	(200000)
 
 /* === C L A S S E S ======================================================= */
 
@@ -281,6 +284,62 @@ int hermite_angle_test(void)
 	return ret;
 }
 
+int animated_waypoint_count_test(int waypoint_count)
+{
+	int ret=0;
+
+	// one waypoint per frame at 24 fps, like a baked motion capture track
+	const Real fps = 24;
+	ValueNode_Animated::Handle animated = ValueNode_Animated::create(type_real);
+	for(int i = 0; i < waypoint_count; ++i)
+		animated->editable_waypoint_list().push_back(Waypoint(ValueBase(Real(i % 7)), Time(i/fps)));
+	animated->changed();
+
+	const Time duration = Time((waypoint_count - 1)/fps);
+	const Time step = duration/ANIMATED_TEST_EVALUATIONS;
+	synfig::clock timer;
+	Real sum = 0;
+
+	// sequential playback
+	timer.reset();
+	for(int i = 0; i < ANIMATED_TEST_EVALUATIONS; ++i)
+		sum += (*animated)(step*i).get(Real());
+	const double sequential = timer();
+
+	// scrubbing over the whole track
+	unsigned int seed = 1;
+	timer.reset();
+	for(int i = 0; i < ANIMATED_TEST_EVALUATIONS; ++i) {
+		seed = seed*1103515245u + 12345u;
+		sum += (*animated)(step*(int)((seed >> 8) % ANIMATED_TEST_EVALUATIONS)).get(Real());
+	}
+	const double random = timer();
+
+	// waypoints must be hit exactly
+	for(int i = 0; i < waypoint_count; i += 97)
+		if (std::fabs((*animated)(Time(i/fps)).get(Real()) - Real(i % 7)) > 1e-6) {
+			fprintf(stderr,"animated<real>: wrong value at waypoint %d of %d\n", i, waypoint_count);
+			ret++;
+		}
+
+	printf("animated<real>, %5d waypoints: sequential=%f, random=%f microseconds per evaluation (%g)\n",
+		waypoint_count,
+		sequential*1000000/ANIMATED_TEST_EVALUATIONS,
+		random*1000000/ANIMATED_TEST_EVALUATIONS,
+		sum);
+	return ret;
+}
+
+int animated_waypoint_lookup_test()
+{
+	// evaluation time should not grow with the number of waypoints
+	int ret=0;
+	ret+=animated_waypoint_count_test(10);
+	ret+=animated_waypoint_count_test(100);
+	ret+=animated_waypoint_count_test(1000);
+	ret+=animated_waypoint_count_test(10000);
+	return ret;
+}
 
 /* === E N T R Y P O I N T ================================================= */
 
@@ -288,10 +347,13 @@ int main()
 {
 	int error=0;
 
+	Type::subsys_init();
+
 	error+=hermite_float_test();
 	error+=hermite_double_test();
 	error+=hermite_int_test();
 	error+=hermite_angle_test();
+	error+=animated_waypoint_lookup_test();
 
 	return error;
 }
@@ -0,0 +1,196 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file blur_benchmark.cpp
+**	\brief Benchmark of the software blur by radius and image size
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+/*
+ Usage: test_synfig_blur_benchmark [-o <file.json>] [-n <iterations>] [-s <max size>]
+
+ Square surfaces of 256, 1024 and 2048 pixels (not bigger than the max size)
+ are blurred by software::Blur with each blur type and a range of radii.
+ The time of each blur (minimum and median over the iterations) is
+ reported as JSON on stdout or into the given file.
+
+ Fails if the middle of a blurred uniform surface is not the same color,
+ when the blur is smaller than the surface.
+*/
+
+/* === H E A D E R S ======================================================= */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <synfig/clock.h>
+#include <synfig/general.h>
+#include <synfig/main.h>
+#include <synfig/os.h>
+#include <synfig/rendering/software/function/blur.h>
+#include <synfig/surface.h>
+
+/* === M A C R O S ========================================================= */
+
+using namespace synfig;
+
+#define DEFAULT_ITERATIONS	3
+#define DEFAULT_MAX_SIZE	2048
+
+/* === P R O C E D U R E S ================================================= */
+
+static void
+write_stats(std::ostream &out, std::vector<Real> values)
+{
+	std::sort(values.begin(), values.end());
+	const Real min = values.empty() ? 0.0 : values.front();
+	const Real median = values.empty() ? 0.0 : values[values.size()/2];
+	out << "\"min\": " << min << ", \"median\": " << median;
+}
+
+static bool
+is_same_color(const Color &a, const Color &b)
+{
+	const float precision = 1e-3f;
+	return std::fabs(a.get_r() - b.get_r()) < precision
+	    && std::fabs(a.get_g() - b.get_g()) < precision
+	    && std::fabs(a.get_b() - b.get_b()) < precision
+	    && std::fabs(a.get_a() - b.get_a()) < precision;
+}
+
+static bool
+run_blur(std::ostream &out, const char *name, rendering::Blur::Type type, int size, Real radius, int iterations)
+{
+	const Color color(0.25f, 0.5f, 0.75f, 1.f);
+	Surface src(size, size);
+	src.fill(color);
+	Surface dest(size, size);
+
+	std::vector<Real> times;
+	for(int i = 0; i < iterations; ++i) {
+		dest.clear();
+		synfig::clock timer;
+		rendering::software::Blur::blur(rendering::software::Blur::Params(
+			dest,
+			RectInt(0, 0, size, size),
+			src,
+			VectorInt(0, 0),
+			type,
+			Vector(radius, radius),
+			false,
+			Color::BLEND_COMPOSITE,
+			1.f ));
+		times.push_back(timer());
+	}
+
+	out << "    { \"type\": \"" << name << "\", \"size\": " << size << ", \"radius\": " << radius << ", ";
+	write_stats(out, times);
+	out << " }";
+
+	// transparent pixels around the surface are blurred into the middle,
+	// if it's within the blur size
+	const bool check = 2*rendering::software::Blur::get_extra_size(type, Vector(radius, radius))[0] < size;
+	if (check && !is_same_color(color, dest[size/2][size/2])) {
+		std::cerr << name << " blur of " << size << " pixels with radius " << radius
+		          << " changed the uniform color" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/* === E N T R Y P O I N T ================================================= */
+
+int main(int argc, char *argv[])
+{
+	String output_filename;
+	int iterations = DEFAULT_ITERATIONS;
+	int max_size = DEFAULT_MAX_SIZE;
+	for(int i = 1; i < argc; ++i) {
+		if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+			output_filename = argv[++i];
+		} else
+		if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+			iterations = std::max(1, atoi(argv[++i]));
+		} else
+		if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+			max_size = std::max(1, atoi(argv[++i]));
+		} else {
+			std::cerr << "Usage: " << argv[0] << " [-o <file.json>] [-n <iterations>] [-s <max size>]" << std::endl;
+			return 1;
+		}
+	}
+
+	// info messages go to stdout, keep it for JSON
+	synfig_quiet_mode = true;
+
+	// initializes the thread pool and FFT
+	const String root_path = OS::get_binary_path().parent_path().append("../..").cleanup().u8string();
+	Main synfig_main(root_path);
+
+	struct BlurType { const char *name; rendering::Blur::Type type; };
+	const BlurType types[] = {
+		{ "box",          rendering::Blur::BOX },
+		{ "cross",        rendering::Blur::CROSS },
+		{ "fastgaussian", rendering::Blur::FASTGAUSSIAN },
+		{ "gaussian",     rendering::Blur::GAUSSIAN },
+		{ "disc",         rendering::Blur::DISC } };
+	const int sizes[] = { 256, 1024, 2048 };
+	const Real radii[] = { 1.0, 4.0, 16.0, 64.0, 200.0 };
+
+	std::ostringstream out;
+	out.precision(9);
+	out << "{\n"
+	    << "  \"benchmark\": \"blur\",\n"
+	    << "  \"iterations\": " << iterations << ",\n"
+	    << "  \"blurs\": [\n";
+
+	bool success = true;
+	bool first = true;
+	for(const int size : sizes) {
+		if (size > max_size) continue;
+		for(const BlurType &type : types) {
+			for(const Real radius : radii) {
+				if (!first) out << ",\n";
+				first = false;
+				if (!run_blur(out, type.name, type.type, size, radius, iterations))
+					success = false;
+			}
+		}
+	}
+	out << "\n  ]\n}\n";
+
+	if (output_filename.empty()) {
+		std::cout << out.str();
+	} else {
+		std::ofstream file(output_filename.c_str());
+		file << out.str();
+		if (!file) {
+			std::cerr << "Cannot write " << output_filename << std::endl;
+			return 1;
+		}
+	}
+
+	return success ? 0 : 1;
+}
@@ -0,0 +1,189 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file canvas_binary.cpp
+**	\brief Test the binary canvas format
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#include "test_base.h"
+
+#include <sstream>
+
+#include <libxml++/libxml++.h>
+
+#include <synfig/canvasbinary.h>
+
+/* === M A C R O S ========================================================= */
+
+using namespace synfig;
+
+/* === P R O C E D U R E S ================================================= */
+
+static void
+fill_document(xmlpp::Document &document)
+{
+	xmlpp::Element *root = document.create_root_node("canvas");
+	root->set_attribute("version", "1.2");
+	root->set_attribute("width", "480");
+	root->add_child("name")->set_child_text("Sc\xc3\xa8ne <1> & \"2\"");
+
+	xmlpp::Element *defs = root->add_child("defs");
+	xmlpp::Element *animated = defs->add_child("animated");
+	animated->set_attribute("type", "real");
+	animated->set_attribute("id", "value");
+	for(int i = 0; i < 3; ++i) {
+		xmlpp::Element *waypoint = animated->add_child("waypoint");
+		waypoint->set_attribute("time", strprintf("%ds", i));
+		waypoint->set_attribute("before", "clamped");
+		waypoint->add_child("real")->set_attribute("value", strprintf("%d.0000000000", i));
+	}
+
+	xmlpp::Element *layer = root->add_child("layer");
+	layer->set_attribute("type", "polygon");
+	layer->add_child("desc")->set_child_text("");
+	layer->add_child("param")->set_attribute("name", "amount");
+	root->add_child("keyframe")->set_attribute("time", "0s");
+}
+
+static String
+write_binary(xmlpp::Document &document)
+{
+	std::ostringstream stream;
+	ASSERT(CanvasBinary::write(document.get_root_node(), stream));
+	return stream.str();
+}
+
+static void
+test_round_trip()
+{
+	xmlpp::Document document;
+	fill_document(document);
+	const String data = write_binary(document);
+	ASSERT(CanvasBinary::check_magic(data.c_str(), data.size()));
+
+	CanvasBinary::Reader reader;
+	ASSERT(reader.open(data.c_str(), data.size()));
+	ASSERT_EQUAL(String("canvas"), String(reader.get_string(reader.get_node(0).name)));
+	ASSERT_EQUAL((uint32_t)reader.get_header().node_count, reader.get_node(0).end);
+
+	xmlpp::Document result;
+	xmlpp::Element *root = result.create_root_node(reader.get_string(reader.get_node(0).name));
+	reader.copy_attributes(0, root);
+	for(size_t i = 1; i < reader.get_node(0).end; i = reader.get_node(i).end)
+		reader.build(i, root);
+
+	ASSERT_EQUAL(document.write_to_string(), result.write_to_string());
+}
+
+static void
+test_strings_are_shared()
+{
+	xmlpp::Document document;
+	fill_document(document);
+	const String data = write_binary(document);
+
+	CanvasBinary::Reader reader;
+	ASSERT(reader.open(data.c_str(), data.size()));
+	size_t count = 0;
+	for(size_t i = 0; i < reader.get_header().string_count; ++i)
+		if (String(reader.get_string(i)) == "waypoint")
+			++count;
+	ASSERT_EQUAL(1, (int)count);
+}
+
+static void
+test_truncated_data_is_rejected()
+{
+	xmlpp::Document document;
+	fill_document(document);
+	const String data = write_binary(document);
+
+	CanvasBinary::Reader reader;
+	for(size_t size = 0; size < data.size(); ++size) {
+		// the last string loses its terminating zero first
+		ASSERT_FALSE(reader.open(data.c_str(), size));
+		ASSERT_FALSE(reader.get_error().empty());
+	}
+}
+
+static void
+test_corrupted_data_is_checked()
+{
+	xmlpp::Document document;
+	fill_document(document);
+	const String data = write_binary(document);
+
+	// every byte of the tables is changed, the reader either rejects
+	// the data or gives a tree which can be walked safely
+	CanvasBinary::Reader reader;
+	ASSERT(reader.open(data.c_str(), data.size()));
+	const size_t tables_end = reader.get_header().string_data_offset;
+	for(size_t i = 8; i < tables_end; ++i) {
+		String corrupted = data;
+		corrupted[i] ^= 0x5a;
+		if (!reader.open(corrupted.c_str(), corrupted.size()))
+			continue;
+		xmlpp::Document result;
+		xmlpp::Element *root = result.create_root_node("canvas");
+		for(size_t j = 1; j < reader.get_node(0).end; j = reader.get_node(j).end)
+			reader.build(j, root);
+	}
+}
+
+static String
+write_nested(size_t depth)
+{
+	xmlpp::Document document;
+	xmlpp::Element *element = document.create_root_node("canvas");
+	for(size_t i = 1; i < depth; ++i)
+		element = element->add_child("layer");
+	return write_binary(document);
+}
+
+static void
+test_deep_nesting_is_rejected()
+{
+	CanvasBinary::Reader reader;
+	const String data = write_nested(CanvasBinary::max_depth);
+	ASSERT(reader.open(data.c_str(), data.size()));
+
+	// Reader::build() recurses into every level
+	const String deeper_data = write_nested(CanvasBinary::max_depth + 1);
+	ASSERT_FALSE(reader.open(deeper_data.c_str(), deeper_data.size()));
+	ASSERT_FALSE(reader.get_error().empty());
+}
+
+/* === E N T R Y P O I N T ================================================= */
+
+int main()
+{
+	TEST_SUITE_BEGIN()
+		TEST_FUNCTION(test_round_trip);
+		TEST_FUNCTION(test_strings_are_shared);
+		TEST_FUNCTION(test_truncated_data_is_rejected);
+		TEST_FUNCTION(test_corrupted_data_is_checked);
+		TEST_FUNCTION(test_deep_nesting_is_rejected);
+	TEST_SUITE_END()
+
+	return tst_exit_status;
+}
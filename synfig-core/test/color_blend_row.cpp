@@ -0,0 +1,207 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file color_blend_row.cpp
+**	\brief Test row-wise color blending against Color::blend()
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#include "test_base.h"
+
+#include <cstring>
+#include <iomanip>
+
+#include <synfig/color/colorblendrow.h>
+#include <synfig/surface.h>
+
+/* === M A C R O S ========================================================= */
+
+using namespace synfig;
+
+// odd, so the AVX2 kernels go through their single pixel tail too
+static const int row_size = 67;
+
+static const ColorReal amounts[] = { 1.f, 0.5f, 0.3f, 2.f, -0.5f, -1.f, 1e-5f, 1e-7f, 0.f };
+
+/* === P R O C E D U R E S ================================================= */
+
+static std::vector<Color>
+make_row(unsigned int seed)
+{
+	// a few special values first, the rest are pseudo random,
+	// including negative and above one components
+	std::vector<Color> row;
+	row.push_back(Color(0.f, 0.f, 0.f, 0.f));
+	row.push_back(Color(1.f, 1.f, 1.f, 1.f));
+	row.push_back(Color(0.2f, 0.4f, 0.6f, 0.f));
+	row.push_back(Color(0.2f, 0.4f, 0.6f, 1e-7f));
+	row.push_back(Color(0.7f, -0.1f, 1.3f, 0.5f));
+	row.push_back(Color(0.5f, 0.5f, 0.5f, -0.25f));
+	while((int)row.size() < row_size) {
+		ColorReal c[4];
+		for(int i = 0; i < 4; ++i) {
+			seed = seed*1103515245u + 12345u;
+			c[i] = (ColorReal)((seed >> 8) & 0xffff)/65535.f*1.5f - 0.25f;
+		}
+		row.push_back(Color(c[0], c[1], c[2], c[3]));
+	}
+	return row;
+}
+
+static std::string
+to_string(const Color &c)
+{
+	std::ostringstream oss;
+	oss << std::setprecision(9) << '(' << c.get_r() << ',' << c.get_g() << ',' << c.get_b() << ',' << c.get_a() << ')';
+	return oss.str();
+}
+
+static bool
+bitwise_equal(const Color &a, const Color &b)
+	{ return memcmp(&a, &b, sizeof(Color)) == 0; }
+
+static void
+check_row_function(ColorBlendRow::Instructions instructions, bool vectorized_only)
+{
+	if (!ColorBlendRow::is_supported(instructions)) {
+		synfig::info("%s row blending is not supported here, skipped", ColorBlendRow::get_instructions_name(instructions));
+		return;
+	}
+
+	const std::vector<Color> src = make_row(1);
+	const std::vector<Color> dest = make_row(2);
+
+	for(int m = 0; m < Color::BLEND_END; ++m) {
+		const Color::BlendMethod method = (Color::BlendMethod)m;
+		if (vectorized_only && !ColorBlendRow::is_vectorized(method))
+			continue;
+
+		ColorBlendRow::Func func = ColorBlendRow::get_func(method, instructions);
+		ASSERT(func);
+
+		for(const ColorReal amount : amounts) {
+			// swap rows to get both orders of operands
+			for(int swap = 0; swap < 2; ++swap) {
+				const std::vector<Color> &a = swap ? dest : src;
+				const std::vector<Color> &b = swap ? src : dest;
+
+				std::vector<Color> result = b;
+				func(&result.front(), &a.front(), row_size, amount);
+
+				for(int i = 0; i < row_size; ++i) {
+					const Color expected = Color::blend(a[i], b[i], amount, method);
+					if (!bitwise_equal(expected, result[i])) {
+						std::ostringstream oss;
+						oss << "\t - " << ColorBlendRow::get_instructions_name(instructions)
+						    << " method " << m << " amount " << amount << " pixel " << i
+						    << ": expected " << to_string(expected) << ", but got " << to_string(result[i]) << std::endl;
+						throw SynfigTestException{__FUNCTION__, __LINE__, oss.str()};
+					}
+				}
+			}
+		}
+	}
+}
+
+static void
+test_scalar_row_blend_is_bit_exact()
+	{ check_row_function(ColorBlendRow::INSTRUCTIONS_SCALAR, false); }
+
+static void
+test_sse2_row_blend_is_bit_exact()
+	{ check_row_function(ColorBlendRow::INSTRUCTIONS_SSE2, true); }
+
+static void
+test_avx2_row_blend_is_bit_exact()
+	{ check_row_function(ColorBlendRow::INSTRUCTIONS_AVX2, true); }
+
+static void
+test_every_method_has_row_function()
+{
+	for(int m = 0; m < Color::BLEND_END; ++m)
+		ASSERT(ColorBlendRow::get_func((Color::BlendMethod)m));
+}
+
+static void
+test_short_rows_are_blended_completely()
+{
+	const std::vector<Color> src = make_row(3);
+	for(int count = 0; count < 5; ++count) {
+		std::vector<Color> result = make_row(4);
+		const std::vector<Color> dest = result;
+		ColorBlendRow::blend(&result.front(), &src.front(), count, 0.75f, Color::BLEND_COMPOSITE);
+		for(int i = 0; i < row_size; ++i) {
+			const Color expected = i < count
+			                     ? Color::blend(src[i], dest[i], 0.75f, Color::BLEND_COMPOSITE)
+			                     : dest[i];
+			ASSERT(bitwise_equal(expected, result[i]));
+		}
+	}
+}
+
+static void
+test_alpha_pen_blit_matches_color_blend()
+{
+	const int w = row_size, h = 3;
+	Surface src(w, h), dest(w, h);
+	for(int y = 0; y < h; ++y) {
+		const std::vector<Color> a = make_row(10 + y);
+		const std::vector<Color> b = make_row(20 + y);
+		for(int x = 0; x < w; ++x) {
+			src[y][x] = a[x];
+			dest[y][x] = b[x];
+		}
+	}
+
+	const Color::BlendMethod methods[] = { Color::BLEND_COMPOSITE, Color::BLEND_BEHIND, Color::BLEND_HUE };
+	for(const Color::BlendMethod method : methods) {
+		Surface result(dest);
+		Surface::alpha_pen pen(result.get_pen(1, 1));
+		pen.set_blend_method(method);
+		pen.set_alpha(0.6f);
+		src.blit_to(pen, 0, 0, w, h);
+
+		for(int y = 0; y < h; ++y)
+			for(int x = 0; x < w; ++x) {
+				const Color c = x >= 1 && y >= 1
+				              ? Color::blend(src[y-1][x-1], dest[y][x], 0.6f, method)
+				              : dest[y][x];
+				ASSERT(bitwise_equal(c, result[y][x]));
+			}
+	}
+}
+
+/* === E N T R Y P O I N T ================================================= */
+
+int main()
+{
+	TEST_SUITE_BEGIN()
+		TEST_FUNCTION(test_scalar_row_blend_is_bit_exact);
+		TEST_FUNCTION(test_sse2_row_blend_is_bit_exact);
+		TEST_FUNCTION(test_avx2_row_blend_is_bit_exact);
+		TEST_FUNCTION(test_every_method_has_row_function);
+		TEST_FUNCTION(test_short_rows_are_blended_completely);
+		TEST_FUNCTION(test_alpha_pen_blit_matches_color_blend);
+	TEST_SUITE_END()
+
+	return tst_exit_status;
+}
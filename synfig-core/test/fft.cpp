@@ -0,0 +1,182 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file fft.cpp
+**	\brief Test the FFT with cached plans against a direct DFT
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#include "test_base.h"
+
+#include <cmath>
+#include <thread>
+#include <vector>
+
+#include <synfig/rendering/software/function/fft.h>
+
+/* === M A C R O S ========================================================= */
+
+using namespace synfig;
+using namespace rendering;
+using namespace software;
+
+/* === P R O C E D U R E S ================================================= */
+
+static std::vector<Complex>
+make_data(int count, int seed)
+{
+	std::vector<Complex> data(count);
+	for(int i = 0; i < count; ++i)
+		data[i] = Complex(std::sin(0.7*i + seed), std::cos(1.3*i*seed + 0.1));
+	return data;
+}
+
+static std::vector<Complex>
+dft(const std::vector<Complex> &data, int offset, int count, int stride)
+{
+	const Real pi = std::acos(Real(-1));
+	std::vector<Complex> result(count);
+	for(int k = 0; k < count; ++k)
+		for(int i = 0; i < count; ++i)
+			result[k] += data[offset + i*stride]*std::polar(Real(1), -2*pi*k*i/count);
+	return result;
+}
+
+static void
+assert_near(const Complex &expected, const Complex &value)
+{
+	ASSERT(std::abs(expected - value) < 1e-9);
+}
+
+static void
+test_fft_matches_dft()
+{
+	const int count = 12;
+	std::vector<Complex> data = make_data(count, 1);
+	const std::vector<Complex> expected = dft(data, 0, count, 1);
+
+	// twice, the second time with the cached plan
+	for(int pass = 0; pass < 2; ++pass) {
+		std::vector<Complex> x = data;
+		Array<Complex, 1> arr(&x.front());
+		arr.set_dim(count, 1);
+		FFT::fft(arr, false);
+		for(int i = 0; i < count; ++i)
+			assert_near(expected[i], x[i]);
+	}
+}
+
+static void
+test_fft_inverse_restores_data()
+{
+	const int count = 30;
+	const std::vector<Complex> data = make_data(count, 2);
+	std::vector<Complex> x = data;
+	Array<Complex, 1> arr(&x.front());
+	arr.set_dim(count, 1);
+	FFT::fft(arr, false);
+	FFT::fft(arr, true);
+	for(int i = 0; i < count; ++i)
+		assert_near(data[i], x[i]);
+}
+
+static void
+test_fft2d_rows_and_cols()
+{
+	const int rows = 6;
+	const int cols = 8;
+	const std::vector<Complex> data = make_data(rows*cols, 3);
+
+	std::vector<Complex> x = data;
+	Array<Complex, 2> arr(&x.front());
+	arr.set_dim(rows, cols).set_dim(cols, 1);
+
+	FFT::fft2d(arr, false, true, false);
+	for(int r = 0; r < rows; ++r) {
+		const std::vector<Complex> expected = dft(data, r*cols, cols, 1);
+		for(int c = 0; c < cols; ++c)
+			assert_near(expected[c], x[r*cols + c]);
+	}
+
+	// the other direction has the plan of another layout
+	std::vector<Complex> rows_only = x;
+	FFT::fft2d(arr, false, false, true);
+	for(int c = 0; c < cols; ++c) {
+		const std::vector<Complex> expected = dft(rows_only, c, rows, cols);
+		for(int r = 0; r < rows; ++r)
+			assert_near(expected[r], x[r*cols + c]);
+	}
+
+	FFT::fft2d(arr, true);
+	for(int i = 0; i < rows*cols; ++i)
+		assert_near(data[i], x[i]);
+}
+
+static void
+transform_back_and_forth(std::vector<Complex> *x, int rows, int cols)
+{
+	Array<Complex, 2> arr(&x->front());
+	arr.set_dim(rows, cols).set_dim(cols, 1);
+	for(int i = 0; i < 50; ++i) {
+		FFT::fft2d(arr, false);
+		FFT::fft2d(arr, true);
+	}
+}
+
+static void
+test_fft_in_parallel()
+{
+	const int rows = 16;
+	const int cols = 20;
+	std::vector< std::vector<Complex> > data;
+	for(int i = 0; i < 8; ++i)
+		data.push_back(make_data(rows*cols, i));
+	std::vector< std::vector<Complex> > x = data;
+
+	std::vector<std::thread> threads;
+	for(size_t i = 0; i < x.size(); ++i)
+		threads.push_back(std::thread(transform_back_and_forth, &x[i], rows, cols));
+	for(size_t i = 0; i < threads.size(); ++i)
+		threads[i].join();
+
+	for(size_t i = 0; i < x.size(); ++i)
+		for(int j = 0; j < rows*cols; ++j)
+			assert_near(data[i][j], x[i][j]);
+}
+
+/* === E N T R Y P O I N T ================================================= */
+
+int main()
+{
+	FFT::initialize();
+
+	TEST_SUITE_BEGIN()
+		TEST_FUNCTION(test_fft_matches_dft);
+		TEST_FUNCTION(test_fft_inverse_restores_data);
+		TEST_FUNCTION(test_fft2d_rows_and_cols);
+		TEST_FUNCTION(test_fft_in_parallel);
+	TEST_SUITE_END()
+
+	FFT::deinitialize();
+
+	return tst_exit_status;
+}
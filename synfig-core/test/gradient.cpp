@@ -607,6 +607,37 @@ test_BAD_gradient_3_colors_fetches_similar_to_the_LAST_color_for_position_near_t
 	// ASSERT(Color(0, .2, .8, 1.) == g1(0.6));
 }
 
+static void
+check_compiled_gradient_span_average(bool loop, bool zigzag)
+{
+	Gradient g(Color::red(), Color::green(), Color::blue());
+	g.push_back(GradientCPoint(0.7, Color(1, 1, 0, 0.5)));
+	CompiledGradient cg(g, loop, zigzag);
+
+	// forward, backward, across the loop boundary and zero width
+	const Real starts[] = { -0.5, 1.7, 0.9, 0.3 };
+	const Real steps[] = { 0.031, -0.047, 0.013, 0.0 };
+	const Real radius[] = { 0.01, 0.02, 0.0, 0.05 };
+	const int count = 80;
+
+	for (int k = 0; k < 4; ++k) {
+		std::vector<Color> colors(count);
+		cg.average(&colors.front(), count, radius[k], [&](int i) -> Real { return starts[k] + steps[k]*i; });
+		for (int i = 0; i < count; ++i) {
+			const Real x = starts[k] + steps[k]*i;
+			ASSERT(cg.average(x - radius[k], x + radius[k]) == colors[i]);
+		}
+	}
+}
+
+void
+test_compiled_gradient_span_average_equals_per_pixel_average()
+{
+	check_compiled_gradient_span_average(false, false);
+	check_compiled_gradient_span_average(true, false);
+	check_compiled_gradient_span_average(true, true);
+}
+
 /* === E N T R Y P O I N T ================================================= */
 
 int main() {
@@ -655,6 +686,8 @@ int main() {
 	TEST_FUNCTION(test_BAD_gradient_3_colors_fetches_similar_to_the_FIRST_color_for_position_near_to_the_middle_position_from_left)
 	TEST_FUNCTION(test_BAD_gradient_3_colors_fetches_similar_to_the_LAST_color_for_position_near_to_the_middle_position_from_right)
 
+	TEST_FUNCTION(test_compiled_gradient_span_average_equals_per_pixel_average)
+
 	TEST_SUITE_END()
 
 	return tst_exit_status;
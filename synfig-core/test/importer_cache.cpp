@@ -0,0 +1,169 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file importer_cache.cpp
+**	\brief Test the budget and LRU order of ImporterCache
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#include "test_base.h"
+
+#include <vector>
+
+#include <synfig/filesystemnative.h>
+#include <synfig/importercache.h>
+#include <synfig/rendering/software/surfacesw.h>
+#include <synfig/rendering/software/surfaceswpacked.h>
+
+/* === M A C R O S ========================================================= */
+
+using namespace synfig;
+
+static const int side = 10;
+static const size_t surface_bytes = side*side*sizeof(Color);
+
+/* === P R O C E D U R E S ================================================= */
+
+static FileSystem::Identifier
+id(const char *filename)
+	{ return FileSystem::Identifier(FileSystemNative::instance(), filename); }
+
+static rendering::Surface::Handle
+make_surface()
+{
+	std::vector<Color> pixels(side*side, Color(0.5f, 0.25f, 1.f, 1.f));
+	rendering::Surface::Handle surface = new rendering::SurfaceSW();
+	surface->assign(&pixels.front(), side, side);
+	return surface;
+}
+
+static void
+test_least_recently_used_is_evicted()
+{
+	ImporterCache cache(3*surface_bytes);
+	cache.put(id("a.png"), make_surface());
+	cache.put(id("b.png"), make_surface());
+	cache.put(id("c.png"), make_surface());
+	ASSERT(cache.get(id("a.png")));
+
+	cache.put(id("d.png"), make_surface());
+	ASSERT(cache.contains(id("a.png")));
+	ASSERT_FALSE(cache.contains(id("b.png")));
+	ASSERT(cache.contains(id("c.png")));
+	ASSERT(cache.contains(id("d.png")));
+
+	const ImporterCache::Statistics statistics = cache.get_statistics();
+	ASSERT_EQUAL(1, (int)statistics.hits);
+	ASSERT_EQUAL(1, (int)statistics.evictions);
+	ASSERT_EQUAL(3, statistics.entries);
+	ASSERT_EQUAL(3*surface_bytes, statistics.bytes);
+}
+
+static void
+test_miss_is_counted()
+{
+	ImporterCache cache(surface_bytes);
+	ASSERT_FALSE(cache.get(id("a.png")));
+	ASSERT_EQUAL(1, (int)cache.get_statistics().misses);
+	ASSERT_EQUAL(0, (int)cache.get_statistics().hits);
+}
+
+static void
+test_surface_bigger_than_budget_is_not_cached()
+{
+	ImporterCache cache(surface_bytes - 1);
+	cache.put(id("a.png"), make_surface());
+	ASSERT_FALSE(cache.contains(id("a.png")));
+	ASSERT_EQUAL(0u, cache.get_statistics().bytes);
+}
+
+static void
+test_put_replaces_entry()
+{
+	ImporterCache cache(3*surface_bytes);
+	cache.put(id("a.png"), make_surface());
+	rendering::Surface::Handle surface = make_surface();
+	cache.put(id("a.png"), surface);
+	ASSERT(cache.get(id("a.png")) == surface);
+	ASSERT_EQUAL(surface_bytes, cache.get_statistics().bytes);
+	ASSERT_EQUAL(1, cache.get_statistics().entries);
+}
+
+static void
+test_smaller_budget_evicts_oldest()
+{
+	ImporterCache cache(3*surface_bytes);
+	cache.put(id("a.png"), make_surface());
+	cache.put(id("b.png"), make_surface());
+	cache.put(id("c.png"), make_surface());
+
+	cache.set_budget(surface_bytes);
+	ASSERT_FALSE(cache.contains(id("a.png")));
+	ASSERT_FALSE(cache.contains(id("b.png")));
+	ASSERT(cache.contains(id("c.png")));
+	ASSERT_EQUAL(2, (int)cache.get_statistics().evictions);
+}
+
+static void
+test_erase_frees_bytes()
+{
+	ImporterCache cache(3*surface_bytes);
+	cache.put(id("a.png"), make_surface());
+	cache.put(id("b.png"), make_surface());
+	cache.erase(id("a.png"));
+	ASSERT_FALSE(cache.contains(id("a.png")));
+	ASSERT_EQUAL(surface_bytes, cache.get_statistics().bytes);
+	cache.clear();
+	ASSERT_EQUAL(0u, cache.get_statistics().bytes);
+	ASSERT_EQUAL(0, cache.get_statistics().entries);
+}
+
+static void
+test_packed_surface_is_counted_by_packed_size()
+{
+	std::vector<Color> pixels(side*side);
+	for(int i = 0; i < side*side; ++i)
+		pixels[i] = Color((i % 256)/255.f, 0.f, 1.f, 1.f);
+	rendering::Surface::Handle surface = new rendering::SurfaceSWPacked();
+	surface->assign(&pixels.front(), side, side);
+
+	const size_t size = ImporterCache::get_surface_size(surface);
+	ASSERT(size > 0);
+	ASSERT(size < surface_bytes);
+}
+
+/* === E N T R Y P O I N T ================================================= */
+
+int main()
+{
+	TEST_SUITE_BEGIN()
+		TEST_FUNCTION(test_least_recently_used_is_evicted);
+		TEST_FUNCTION(test_miss_is_counted);
+		TEST_FUNCTION(test_surface_bigger_than_budget_is_not_cached);
+		TEST_FUNCTION(test_put_replaces_entry);
+		TEST_FUNCTION(test_smaller_budget_evicts_oldest);
+		TEST_FUNCTION(test_erase_frees_bytes);
+		TEST_FUNCTION(test_packed_surface_is_counted_by_packed_size);
+	TEST_SUITE_END()
+
+	return tst_exit_status;
+}
@@ -0,0 +1,285 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file load_benchmark.cpp
+**	\brief Benchmark of loading .sif, .sifz and .sifb files
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/*
+ Usage: test_synfig_load_benchmark [-o <file.json>] [-n <iterations>] [-l <layers>]
+
+ A canvas with animated and exported values is built from code with core
+ layers only, saved as .sif, .sifz and .sifb into the current directory,
+ then loaded back by CanvasParser. XML files are loaded with the DOM and
+ with the streaming parser.
+ The time of each load (minimum and median over the iterations) is
+ reported as JSON on stdout or into the given file.
+
+ Fails if any load reports errors or if the loaded canvases are not
+ saved back into the same document.
+*/
+
+/* === H E A D E R S ======================================================= */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#include <synfig/canvas.h>
+#include <synfig/clock.h>
+#include <synfig/filesystem_path.h>
+#include <synfig/filesystemnative.h>
+#include <synfig/general.h>
+#include <synfig/layer.h>
+#include <synfig/layers/layer_pastecanvas.h>
+#include <synfig/loadcanvas.h>
+#include <synfig/main.h>
+#include <synfig/os.h>
+#include <synfig/savecanvas.h>
+#include <synfig/valuenodes/valuenode_animated.h>
+
+/* === M A C R O S ========================================================= */
+
+using namespace synfig;
+
+#define DEFAULT_ITERATIONS	5
+#define DEFAULT_LAYERS		2000
+
+/* === P R O C E D U R E S ================================================= */
+
+static void
+set_param(const Layer::Handle &layer, const char *param, const ValueBase &value)
+{
+	if (!layer->set_param(param, value))
+		synfig::warning("load benchmark: cannot set param '%s' of layer '%s'", param, layer->get_name().c_str());
+}
+
+static ValueNode_Animated::Handle
+animate(const ValueBase &from, const ValueBase &to)
+{
+	ValueNode_Animated::Handle animated = ValueNode_Animated::create(from, Time(0));
+	animated->new_waypoint(Time(1), to);
+	animated->new_waypoint(Time(2), from);
+	return animated;
+}
+
+static Canvas::Handle
+build_canvas(int layers)
+{
+	Canvas::Handle canvas = Canvas::create();
+	canvas->rend_desc().set_wh(480, 270);
+	canvas->rend_desc().set_tl(Point(-4, 2.25));
+	canvas->rend_desc().set_br(Point(4, -2.25));
+	canvas->rend_desc().set_time_end(Time(2));
+
+	// a few exported values shared by many layers
+	std::vector<ValueNode::Handle> exported;
+	for(int i = 0; i < 8; ++i) {
+		ValueNode::Handle node = animate(Color(0.1f*i, 0.5f, 1.f - 0.1f*i, 1.f), Color(1.f, 0.1f*i, 0.f, 0.5f));
+		canvas->add_value_node(node, strprintf("color%d", i));
+		exported.push_back(node);
+	}
+
+	Canvas::Handle group_canvas;
+	for(int i = 0; i < layers; ++i) {
+		if (i % 50 == 0) {
+			Layer::Handle group = Layer::create("group");
+			Layer_PasteCanvas *paste = dynamic_cast<Layer_PasteCanvas*>(group.get());
+			if (!paste) return Canvas::Handle();
+			group_canvas = Canvas::create_inline(canvas);
+			paste->set_sub_canvas(group_canvas);
+			group->set_description(strprintf("Group %d", i/50));
+			canvas->push_back(group);
+		}
+
+		Layer::Handle layer;
+		if (i % 5 == 0) {
+			layer = Layer::create("solid_color");
+			if (!layer) return Canvas::Handle();
+			set_param(layer, "amount", 0.1);
+		} else {
+			layer = Layer::create("polygon");
+			if (!layer) return Canvas::Handle();
+			std::vector<ValueBase> points;
+			for(int j = 0; j < 8; ++j) {
+				const Real a = 2*PI*j/8;
+				points.push_back(Point(std::cos(a + i), std::sin(a*i)));
+			}
+			set_param(layer, "vector_list", points);
+			ValueNode::Handle origin = animate(Point(0, 0), Point(0.001*i, -0.001*i));
+			layer->connect_dynamic_param("origin", origin);
+		}
+		layer->connect_dynamic_param("color", exported[i % exported.size()]);
+		layer->set_description(strprintf("Layer %d", i));
+		group_canvas->push_front(layer);
+	}
+	return canvas;
+}
+
+static Canvas::Handle
+load(const String &filename, bool streaming, String &errors)
+{
+	CanvasParser parser;
+	parser.set_streaming(streaming);
+	Canvas::Handle canvas = parser.parse_from_file_as(
+		FileSystemNative::instance()->get_identifier(filename), filename, errors );
+	// the same file is loaded many times, forget it every time
+	if (canvas)
+		get_open_canvas_map().erase(canvas.get());
+	return canvas;
+}
+
+static void
+write_stats(std::ostream &out, const char *name, std::vector<Real> values)
+{
+	std::sort(values.begin(), values.end());
+	const Real min = values.empty() ? 0.0 : values.front();
+	const Real median = values.empty() ? 0.0 : values[values.size()/2];
+	out << "\"" << name << "\": { \"min\": " << min << ", \"median\": " << median << " }";
+}
+
+static bool
+run_file(std::ostream &out, const String &filename, const String &expected, int iterations)
+{
+	std::ifstream file(filename.c_str(), std::ios::binary | std::ios::ate);
+	out << "    { \"file\": \"" << filename << "\", \"size\": " << (long long)file.tellg() << ", ";
+
+	// the binary file has a single parser
+	const bool binary = filesystem::Path(filename).extension().u8string() == ".sifb";
+	const char *modes[] = { "dom", "streaming" };
+	const int mode_count = binary ? 1 : 2;
+
+	bool success = true;
+	for(int mode = 0; mode < mode_count; ++mode) {
+		std::vector<Real> times;
+		for(int i = 0; i < iterations; ++i) {
+			String errors;
+			synfig::clock timer;
+			Canvas::Handle canvas = load(filename, mode == 1, errors);
+			times.push_back(timer());
+
+			if (!canvas || !errors.empty()) {
+				std::cerr << filename << ": " << errors << std::endl;
+				success = false;
+			} else
+			if (i == 0 && canvas_to_string(canvas) != expected) {
+				std::cerr << filename << ": loaded canvas differs from the saved one" << std::endl;
+				success = false;
+			}
+		}
+		write_stats(out, binary ? "binary" : modes[mode], times);
+		out << (mode + 1 < mode_count ? ", " : " }");
+	}
+	return success;
+}
+
+/* === E N T R Y P O I N T ================================================= */
+
+int main(int argc, char *argv[])
+{
+	String output_filename;
+	int iterations = DEFAULT_ITERATIONS;
+	int layers = DEFAULT_LAYERS;
+	for(int i = 1; i < argc; ++i) {
+		if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+			output_filename = argv[++i];
+		} else
+		if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+			iterations = std::max(1, atoi(argv[++i]));
+		} else
+		if (!strcmp(argv[i], "-l") && i + 1 < argc) {
+			layers = std::max(1, atoi(argv[++i]));
+		} else {
+			std::cerr << "Usage: " << argv[0] << " [-o <file.json>] [-n <iterations>] [-l <layers>]" << std::endl;
+			return 1;
+		}
+	}
+
+	// info messages go to stdout, keep it for JSON
+	synfig_quiet_mode = true;
+
+	const String root_path = OS::get_binary_path().parent_path().append("../..").cleanup().u8string();
+	Main synfig_main(root_path);
+
+	Canvas::Handle canvas = build_canvas(layers);
+	if (!canvas) {
+		std::cerr << "Core layers are not available" << std::endl;
+		return 1;
+	}
+
+	const String filenames[] = { "load_benchmark.sif", "load_benchmark.sifz", "load_benchmark.sifb" };
+	for(const String &filename : filenames) {
+		if (!save_canvas(FileSystemNative::instance()->get_identifier(filename), canvas, false)) {
+			std::cerr << "Cannot write " << filename << std::endl;
+			return 1;
+		}
+	}
+
+	// compare the loaded canvases with the one read by the DOM parser,
+	// so the result doesn't depend on how file name and ids are saved
+	String errors;
+	Canvas::Handle reference = load(filenames[0], false, errors);
+	if (!reference) {
+		std::cerr << filenames[0] << ": " << errors << std::endl;
+		return 1;
+	}
+	const String expected = canvas_to_string(reference);
+
+	std::ostringstream out;
+	out.precision(9);
+	out << "{\n"
+	    << "  \"benchmark\": \"load\",\n"
+	    << "  \"layers\": " << layers << ",\n"
+	    << "  \"iterations\": " << iterations << ",\n"
+	    << "  \"files\": [\n";
+
+	bool success = true;
+	bool first = true;
+	for(const String &filename : filenames) {
+		if (!first) out << ",\n";
+		first = false;
+		if (!run_file(out, filename, expected, iterations))
+			success = false;
+	}
+	out << "\n  ]\n}\n";
+
+	for(const String &filename : filenames)
+		std::remove(filename.c_str());
+
+	if (output_filename.empty()) {
+		std::cout << out.str();
+	} else {
+		std::ofstream file(output_filename.c_str());
+		file << out.str();
+		if (!file) {
+			std::cerr << "Cannot write " << output_filename << std::endl;
+			return 1;
+		}
+	}
+
+	return success ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file load_canvas.cpp
+**	\brief Test the streaming and DOM paths of CanvasParser
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#include "test_base.h"
+
+#include <cstdio>
+#include <fstream>
+
+#include <synfig/canvas.h>
+#include <synfig/filesystemnative.h>
+#include <synfig/general.h>
+#include <synfig/layer.h>
+#include <synfig/loadcanvas.h>
+#include <synfig/main.h>
+#include <synfig/os.h>
+#include <synfig/savecanvas.h>
+
+/* === M A C R O S ========================================================= */
+
+using namespace synfig;
+
+static const char *filename = "test_synfig_load_canvas.sif";
+
+/* === P R O C E D U R E S ================================================= */
+
+static String
+make_document()
+{
+	Canvas::Handle canvas = Canvas::create();
+	canvas->rend_desc().set_wh(48, 27);
+	for(int i = 0; i < 3; ++i) {
+		Layer::Handle layer = Layer::create("polygon");
+		ASSERT(layer);
+		layer->set_description(strprintf("Polygon %d", i));
+		canvas->push_back(layer);
+	}
+	return canvas_to_string(canvas);
+}
+
+static void
+write_file(const String &data)
+{
+	std::ofstream file(filename, std::ios::binary);
+	file.write(data.c_str(), data.size());
+	ASSERT(file);
+}
+
+static Canvas::Handle
+load(bool streaming, String &errors)
+{
+	CanvasParser parser;
+	parser.set_streaming(streaming);
+	Canvas::Handle canvas = parser.parse_from_file_as(
+		FileSystemNative::instance()->get_identifier(filename), filename, errors );
+	if (canvas)
+		get_open_canvas_map().erase(canvas.get());
+	return canvas;
+}
+
+static void
+test_whole_file_is_loaded()
+{
+	write_file(make_document());
+	for(int streaming = 0; streaming < 2; ++streaming) {
+		String errors;
+		Canvas::Handle canvas = load(streaming, errors);
+		ASSERT(canvas);
+		ASSERT(errors.empty());
+		ASSERT_EQUAL(3, (int)canvas->size());
+	}
+	remove(filename);
+}
+
+static void
+test_truncated_file_gives_same_error()
+{
+	// cut in the middle of the last layer, the first ones are complete
+	const String document = make_document();
+	const String::size_type pos = document.rfind("<layer");
+	ASSERT(pos != String::npos);
+	write_file(document.substr(0, pos + 10));
+
+	const size_t open_canvases = get_open_canvas_map().size();
+	String dom_errors;
+	ASSERT_FALSE(load(false, dom_errors));
+	String stream_errors;
+	ASSERT_FALSE(load(true, stream_errors));
+
+	ASSERT_FALSE(dom_errors.empty());
+	ASSERT_EQUAL(dom_errors, stream_errors);
+	ASSERT_EQUAL(open_canvases, get_open_canvas_map().size());
+	remove(filename);
+}
+
+/* === E N T R Y P O I N T ================================================= */
+
+int main()
+{
+	synfig_quiet_mode = true;
+
+	// initializes the layers
+	const String root_path = OS::get_binary_path().parent_path().append("../..").cleanup().u8string();
+	Main synfig_main(root_path);
+
+	TEST_SUITE_BEGIN()
+		TEST_FUNCTION(test_whole_file_is_loaded);
+		TEST_FUNCTION(test_truncated_file_gives_same_error);
+	TEST_SUITE_END()
+
+	return tst_exit_status;
+}
@@ -0,0 +1,286 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file mesh.cpp
+**	\brief Test the tiled rasterization of meshes in software::Mesh
+**	and the mesh of Layer_SkeletonDeformation
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#include "test_base.h"
+
+#include <cmath>
+#include <cstring>
+
+#include <synfig/general.h>
+#include <synfig/layers/layer_skeletondeformation.h>
+#include <synfig/main.h>
+#include <synfig/os.h>
+#include <synfig/rendering/software/function/mesh.h>
+#include <synfig/surface.h>
+
+/* === M A C R O S ========================================================= */
+
+using namespace synfig;
+
+static const int size = 512;
+static const int grid_size = 24;
+
+/* === C L A S S E S ======================================================= */
+
+//! Gives access to the mesh built by the layer
+class SkeletonDeformationMesh: public Layer_SkeletonDeformation
+{
+public:
+	typedef etl::handle<SkeletonDeformationMesh> Handle;
+	const rendering::Mesh::Handle& get_mesh() const
+		{ return mesh; }
+};
+
+/* === P R O C E D U R E S ================================================= */
+
+//! Grid over the whole surface with waved vertices, so triangles overlap each other
+static rendering::Mesh::Handle
+make_mesh()
+{
+	rendering::Mesh::Handle mesh(new rendering::Mesh());
+	const Real step = Real(size)/(grid_size - 1);
+	for(int j = 0; j < grid_size; ++j) {
+		for(int i = 0; i < grid_size; ++i) {
+			const Vector p(i*step, j*step);
+			const Vector wave(10.0*std::sin(0.7*j + 0.3*i), 10.0*std::cos(0.5*i - 0.2*j));
+			mesh->vertices.push_back(rendering::Mesh::Vertex(p + wave*(1.0 + (i + j)%3), p));
+		}
+	}
+	for(int j = 1; j < grid_size; ++j) {
+		for(int i = 1; i < grid_size; ++i) {
+			const int v0 = (j-1)*grid_size + i - 1;
+			mesh->triangles.push_back(rendering::Mesh::Triangle(v0, v0 + 1, v0 + grid_size));
+			mesh->triangles.push_back(rendering::Mesh::Triangle(v0 + 1, v0 + grid_size + 1, v0 + grid_size));
+		}
+	}
+	return mesh;
+}
+
+static void
+fill_surface(synfig::Surface &surface)
+{
+	for(int y = 0; y < surface.get_h(); ++y)
+		for(int x = 0; x < surface.get_w(); ++x)
+			surface[y][x] = Color(x/Real(size), y/Real(size), ((x^y)&255)/255.0, 0.25 + 0.5*((x + y)%2));
+}
+
+static void
+assert_surfaces_equal(const synfig::Surface &expected, const synfig::Surface &value)
+{
+	ASSERT_EQUAL(expected.get_w(), value.get_w());
+	ASSERT_EQUAL(expected.get_h(), value.get_h());
+	for(int y = 0; y < expected.get_h(); ++y)
+		ASSERT(!memcmp(expected[y], value[y], sizeof(Color)*expected.get_w()));
+}
+
+static void
+test_polygon_tiles_match_triangles()
+{
+	const rendering::Mesh::Handle mesh = make_mesh();
+	const RectInt rect(3, 5, size - 7, size - 2);
+	const Color color(0.9, 0.4, 0.1, 0.8);
+
+	synfig::Surface expected(size, size);
+	fill_surface(expected);
+	for(std::vector<rendering::Mesh::Triangle>::const_iterator i = mesh->triangles.begin(); i != mesh->triangles.end(); ++i)
+		rendering::software::Mesh::render_triangle(
+			expected, rect,
+			mesh->vertices[i->vertices[0]].position,
+			mesh->vertices[i->vertices[1]].position,
+			mesh->vertices[i->vertices[2]].position,
+			color, 0.7, Color::BLEND_COMPOSITE );
+
+	synfig::Surface value(size, size);
+	fill_surface(value);
+	rendering::software::Mesh::render_polygon(
+		value, rect, *mesh, Matrix(), color, 0.7, Color::BLEND_COMPOSITE );
+
+	assert_surfaces_equal(expected, value);
+}
+
+static void
+test_mesh_tiles_match_triangles()
+{
+	const rendering::Mesh::Handle mesh = make_mesh();
+	const RectInt rect(0, 0, size, size);
+
+	synfig::Surface texture(size/2, size/2);
+	fill_surface(texture);
+	// texture is smaller than the target, so some pixels are outside of it
+	const Rect texture_rect(0.0, 0.0, size/2, size/2);
+	Matrix texture_matrix;
+	texture_matrix.m00 = texture_matrix.m11 = 0.6;
+
+	for(int method = 0; method < 2; ++method) {
+		const Color::BlendMethod blend_method = method ? Color::BLEND_STRAIGHT : Color::BLEND_COMPOSITE;
+
+		synfig::Surface expected(size, size);
+		fill_surface(expected);
+		for(std::vector<rendering::Mesh::Triangle>::const_iterator i = mesh->triangles.begin(); i != mesh->triangles.end(); ++i)
+			rendering::software::Mesh::render_triangle(
+				expected, rect,
+				mesh->vertices[i->vertices[0]].position,
+				texture_matrix.get_transformed(mesh->vertices[i->vertices[0]].tex_coords),
+				mesh->vertices[i->vertices[1]].position,
+				texture_matrix.get_transformed(mesh->vertices[i->vertices[1]].tex_coords),
+				mesh->vertices[i->vertices[2]].position,
+				texture_matrix.get_transformed(mesh->vertices[i->vertices[2]].tex_coords),
+				texture, texture_rect, 0.9, blend_method );
+
+		synfig::Surface value(size, size);
+		fill_surface(value);
+		rendering::software::Mesh::render_mesh(
+			value, rect, *mesh, texture, texture_rect,
+			Matrix(), texture_matrix, 0.9, blend_method );
+
+		assert_surfaces_equal(expected, value);
+	}
+}
+
+static Bone
+make_bone(const Point &origin, Real angle, Real width, Real depth)
+{
+	Bone bone;
+	bone.set_length(2.0);
+	bone.set_width(width);
+	bone.set_tipwidth(0.5*width);
+	bone.set_depth(depth);
+	bone.set_animated_matrix(Matrix(
+		 std::cos(angle), std::sin(angle), 0.0,
+		-std::sin(angle), std::cos(angle), 0.0,
+		 origin[0],       origin[1],       1.0 ));
+	return bone;
+}
+
+//! Two crossed bones, the pose rotates them and may put the second one above the first
+static ValueBase
+make_bones(Real setup_width, Real pose_angle, Real pose_depth)
+{
+	std::vector<Layer_SkeletonDeformation::BonePair> list;
+	list.push_back(Layer_SkeletonDeformation::BonePair(
+		make_bone(Point(-1.0, 0.0), 0.0, setup_width, 0.0),
+		make_bone(Point(-1.0, 0.2), pose_angle, setup_width, 0.0) ));
+	list.push_back(Layer_SkeletonDeformation::BonePair(
+		make_bone(Point(0.0, -1.0), 0.5*PI, setup_width, 0.0),
+		make_bone(Point(0.1, -1.0), 0.5*PI - pose_angle, setup_width, pose_depth) ));
+	ValueBase bones;
+	bones.set_list_of(list);
+	return bones;
+}
+
+static SkeletonDeformationMesh::Handle
+make_layer(const ValueBase &bones, int x_subdivisions, int y_subdivisions)
+{
+	SkeletonDeformationMesh::Handle layer(new SkeletonDeformationMesh());
+	ASSERT(layer->set_param("x_subdivisions", x_subdivisions));
+	ASSERT(layer->set_param("y_subdivisions", y_subdivisions));
+	ASSERT(layer->set_param("bones", bones));
+	return layer;
+}
+
+static bool
+same_vertices(const rendering::Mesh &a, const rendering::Mesh &b)
+{
+	if (a.vertices.size() != b.vertices.size())
+		return false;
+	for(size_t i = 0; i < a.vertices.size(); ++i)
+		if ( memcmp(&a.vertices[i].position, &b.vertices[i].position, sizeof(Vector))
+		  || memcmp(&a.vertices[i].tex_coords, &b.vertices[i].tex_coords, sizeof(Vector)) )
+			return false;
+	return true;
+}
+
+static void
+assert_meshes_equal(const SkeletonDeformationMesh &expected, const SkeletonDeformationMesh &value)
+{
+	ASSERT(expected.get_mesh());
+	ASSERT(value.get_mesh());
+	const rendering::Mesh &a = *expected.get_mesh();
+	const rendering::Mesh &b = *value.get_mesh();
+	ASSERT(same_vertices(a, b));
+	ASSERT_EQUAL(a.triangles.size(), b.triangles.size());
+	for(size_t i = 0; i < a.triangles.size(); ++i)
+		for(int j = 0; j < 3; ++j)
+			ASSERT_EQUAL(a.triangles[i].vertices[j], b.triangles[i].vertices[j]);
+}
+
+static void
+test_cached_weights_give_same_mesh()
+{
+	SkeletonDeformationMesh::Handle cached = make_layer(make_bones(1.5, 0.0, 0.0), 16, 12);
+	ASSERT_FALSE(cached->get_mesh()->triangles.empty());
+
+	// animated pose, the order of triangles is reused in frames 2 and 4
+	// and sorted again when the depth of the second bone changes
+	for(int frame = 1; frame <= 4; ++frame) {
+		const ValueBase bones = make_bones(1.5, 0.2*frame, frame < 3 ? 1.0 : -1.0);
+		ASSERT(cached->set_param("bones", bones));
+		assert_meshes_equal(*make_layer(bones, 16, 12), *cached);
+	}
+}
+
+static void
+test_setup_and_grid_changes_rebuild_cache()
+{
+	SkeletonDeformationMesh::Handle cached = make_layer(make_bones(1.5, 0.3, 0.0), 16, 12);
+	const rendering::Mesh::Handle previous = cached->get_mesh();
+
+	// setup pose bones have other weights
+	const ValueBase bones = make_bones(0.8, 0.3, 0.0);
+	ASSERT(cached->set_param("bones", bones));
+	assert_meshes_equal(*make_layer(bones, 16, 12), *cached);
+	ASSERT_FALSE(same_vertices(*previous, *cached->get_mesh()));
+
+	ASSERT(cached->set_param("x_subdivisions", 10));
+	assert_meshes_equal(*make_layer(bones, 10, 12), *cached);
+
+	ASSERT(cached->set_param("point2", Point(3.0, -5.0)));
+	SkeletonDeformationMesh::Handle fresh = make_layer(bones, 10, 12);
+	ASSERT(fresh->set_param("point2", Point(3.0, -5.0)));
+	assert_meshes_equal(*fresh, *cached);
+}
+
+/* === E N T R Y P O I N T ================================================= */
+
+int main()
+{
+	synfig_quiet_mode = true;
+
+	// initializes the thread pool
+	const String root_path = OS::get_binary_path().parent_path().append("../..").cleanup().u8string();
+	Main synfig_main(root_path);
+
+	TEST_SUITE_BEGIN()
+		TEST_FUNCTION(test_polygon_tiles_match_triangles);
+		TEST_FUNCTION(test_mesh_tiles_match_triangles);
+		TEST_FUNCTION(test_cached_weights_give_same_mesh);
+		TEST_FUNCTION(test_setup_and_grid_changes_rebuild_cache);
+	TEST_SUITE_END()
+
+	return tst_exit_status;
+}
@@ -0,0 +1,116 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file paramid.cpp
+**	\brief Test ParamID class
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#include <synfig/paramid.h>
+
+#include "test_base.h"
+
+using namespace synfig;
+
+/* === P R O C E D U R E S ================================================= */
+
+static void
+test_same_name_gets_same_id()
+{
+	ParamID a("origin"), b(String("orig") + "in");
+	ASSERT(a == b);
+	ASSERT_EQUAL(a.get_id(), b.get_id());
+	ASSERT(&a.get_name() == &b.get_name());
+}
+
+static void
+test_different_names_get_different_ids()
+{
+	ParamID a("origin"), b("amount");
+	ASSERT(a != b);
+	ASSERT_EQUAL(String("origin"), a.get_name());
+	ASSERT_EQUAL(String("amount"), b.get_name());
+}
+
+static void
+test_name_is_matched_by_address_and_by_value()
+{
+	ParamID id("color");
+	ASSERT(id.is_name(id.get_name()));
+	ASSERT(id.is_name(String("color")));
+	ASSERT_FALSE(id.is_name(String("colour")));
+	ASSERT_FALSE(id.is_name(ParamID("amount").get_name()));
+}
+
+static void
+test_member_name_drops_prefix()
+{
+	ASSERT(ParamID::from_member_name("param_origin") == ParamID("origin"));
+	ASSERT(ParamID::from_member_name("halftone.param_size", "halftone.param_") == ParamID("size"));
+}
+
+static void
+test_member_name_without_prefix_is_invalid()
+{
+	ParamID id = ParamID::from_member_name("origin");
+	ASSERT_FALSE(id.is_valid());
+	ASSERT_FALSE(id.is_name(String("origin")));
+	ASSERT_FALSE(id.is_name(String()));
+}
+
+static void
+test_member_macro_interns_once()
+{
+	const int count = ParamID::count();
+	for(int i = 0; i < 3; ++i)
+		ASSERT(SYNFIG_PARAM_ID_OF_MEMBER(param_test_member_macro).is_name(String("test_member_macro")));
+	ASSERT_EQUAL(count + 1, ParamID::count());
+}
+
+static void
+test_find_doesnt_register()
+{
+	const ParamID id("width");
+	ASSERT(ParamID::find("width") == id);
+	ASSERT(&ParamID::find("width").get_name() == &id.get_name());
+
+	const int count = ParamID::count();
+	ASSERT_FALSE(ParamID::find("test_name_from_file").is_valid());
+	ASSERT_EQUAL(count, ParamID::count());
+}
+
+/* === E N T R Y P O I N T ================================================= */
+
+int main()
+{
+	TEST_SUITE_BEGIN()
+		TEST_FUNCTION(test_same_name_gets_same_id);
+		TEST_FUNCTION(test_different_names_get_different_ids);
+		TEST_FUNCTION(test_name_is_matched_by_address_and_by_value);
+		TEST_FUNCTION(test_member_name_drops_prefix);
+		TEST_FUNCTION(test_member_name_without_prefix_is_invalid);
+		TEST_FUNCTION(test_member_macro_interns_once);
+		TEST_FUNCTION(test_find_doesnt_register);
+	TEST_SUITE_END()
+
+	return tst_exit_status;
+}
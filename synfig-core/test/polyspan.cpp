@@ -0,0 +1,139 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file polyspan.cpp
+**	\brief Test cropping of rendering::Polyspan marks against drawing with a window
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#include "test_base.h"
+
+#include <cmath>
+#include <map>
+
+#include <synfig/rendering/primitive/polyspan.h>
+
+/* === M A C R O S ========================================================= */
+
+using namespace synfig;
+using namespace rendering;
+
+typedef std::map<std::pair<int, int>, Real> Coverage;
+
+/* === P R O C E D U R E S ================================================= */
+
+static void
+draw(Polyspan &polyspan)
+{
+	// curves and lines crossing every side of the windows below
+	polyspan.move_to(-30.3, 5.2);
+	polyspan.cubic_to(200.7, 80.1, 50, -100, 300, 200, 0.25);
+	polyspan.line_to(120.5, 150.25, 0.25);
+	polyspan.conic_to(10, 10, -80, 300, 0.25);
+	polyspan.line_to(5.5, 90.1);
+	polyspan.move_to(40, 40);
+	polyspan.line_to(60, 45);
+	polyspan.line_to(50, 70);
+	polyspan.close();
+	polyspan.sort_marks();
+}
+
+//! Accumulates the marks the same way as software::Contour::render_polyspan()
+static Coverage
+get_coverage(const Polyspan &polyspan)
+{
+	std::map<std::pair<int, int>, std::pair<Real, Real> > cells;
+	for(const Polyspan::PenMark &mark : polyspan.get_covers()) {
+		std::pair<Real, Real> &cell = cells[std::make_pair(mark.y, mark.x)];
+		cell.first += mark.cover;
+		cell.second += mark.area;
+	}
+
+	const RectInt &window = polyspan.get_window();
+	Coverage coverage;
+	for(int y = window.miny; y < window.maxy; ++y) {
+		Real cover = 0;
+		for(int x = window.minx; x < window.maxx; ++x) {
+			Real area = 0;
+			std::map<std::pair<int, int>, std::pair<Real, Real> >::const_iterator i = cells.find(std::make_pair(y, x));
+			if (i != cells.end()) {
+				cover += i->second.first;
+				area = i->second.second;
+			}
+			coverage[std::make_pair(y, x)] = cover - area;
+		}
+	}
+	return coverage;
+}
+
+static void
+test_cropped_marks_match_drawing_with_window()
+{
+	Polyspan whole;
+	whole.init(RectInt(-10, -20, 260, 260));
+	draw(whole);
+
+	const RectInt windows[] = {
+		RectInt(0, 0, 100, 50),
+		RectInt(20, 30, 90, 120),
+		RectInt(-10, 100, 260, 180),
+		RectInt(100, 0, 150, 260) };
+	for(const RectInt &window : windows) {
+		Polyspan drawn;
+		drawn.init(window);
+		draw(drawn);
+
+		Polyspan cropped;
+		cropped.crop(whole, window);
+		ASSERT(cropped.get_window() == window);
+
+		const Coverage expected = get_coverage(drawn);
+		const Coverage actual = get_coverage(cropped);
+		ASSERT_EQUAL(expected.size(), actual.size());
+		for(Coverage::const_iterator i = expected.begin(); i != expected.end(); ++i)
+			ASSERT_APPROX_EQUAL_MICRO(i->second, actual.find(i->first)->second);
+	}
+}
+
+static void
+test_crop_outside_marks_is_empty()
+{
+	Polyspan whole;
+	whole.init(RectInt(-10, -20, 260, 260));
+	draw(whole);
+
+	Polyspan cropped;
+	cropped.crop(whole, RectInt(0, 300, 100, 400));
+	ASSERT(cropped.get_covers().empty());
+}
+
+/* === E N T R Y P O I N T ================================================= */
+
+int main()
+{
+	TEST_SUITE_BEGIN()
+		TEST_FUNCTION(test_cropped_marks_match_drawing_with_window);
+		TEST_FUNCTION(test_crop_outside_marks_is_empty);
+	TEST_SUITE_END()
+
+	return tst_exit_status;
+}
@@ -0,0 +1,480 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file render_benchmark.cpp
+**	\brief Rendering benchmark on procedurally generated canvases
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/*
+ Usage: test_synfig_render_benchmark [-o <file.json>] [-n <iterations>]
+
+ Every scene is built from code with a fixed seed, so the numbers are
+ comparable between runs and machines. For each scene the task tree is
+ built, optimized and run separately, and the time of each phase is
+ reported (minimum and median over the iterations) as JSON on stdout
+ or into the given file.
+
+ Scenes which need layers from modules that could not be loaded are
+ reported with "skipped": true, so the benchmark still runs offline
+ and from the build tree.
+*/
+
+/* === H E A D E R S ======================================================= */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#include <synfig/angle.h>
+#include <synfig/blinepoint.h>
+#include <synfig/canvas.h>
+#include <synfig/clock.h>
+#include <synfig/context.h>
+#include <synfig/general.h>
+#include <synfig/gradient.h>
+#include <synfig/layer.h>
+#include <synfig/layers/layer_mime.h>
+#include <synfig/layers/layer_pastecanvas.h>
+#include <synfig/main.h>
+#include <synfig/os.h>
+#include <synfig/rendering/common/task/tasktransformation.h>
+#include <synfig/rendering/renderer.h>
+#include <synfig/rendering/software/surfacesw.h>
+#include <synfig/rendering/subtreecache.h>
+#include <synfig/rendering/surface.h>
+
+/* === M A C R O S ========================================================= */
+
+using namespace synfig;
+
+#define DEFAULT_ITERATIONS	5
+#define FRAME_WIDTH			480
+#define FRAME_HEIGHT		270
+
+/* === C L A S S E S ======================================================= */
+
+namespace {
+
+//! Thrown by scene builders when a layer is not available
+struct MissingLayer
+{
+	String name;
+};
+
+//! Small LCG, so scenes do not depend on the standard library implementation
+class Random
+{
+	unsigned int seed;
+public:
+	explicit Random(unsigned int seed): seed(seed) { }
+	Real operator()(Real min, Real max)
+	{
+		seed = seed*1103515245u + 12345u;
+		return min + (max - min)*(Real)((seed >> 8) & 0xffff)/65535.0;
+	}
+	Color color(Real alpha = 1.0)
+		{ return Color((*this)(0, 1), (*this)(0, 1), (*this)(0, 1), alpha); }
+	Point point()
+		{ return Point((*this)(-4, 4), (*this)(-2.25, 2.25)); }
+};
+
+struct Timings
+{
+	std::vector<Real> build, optimize, run;
+};
+
+struct Scene
+{
+	const char *name;
+	const char *description;
+	std::function<void(Canvas::Handle)> build;
+};
+
+} // END of anonymous namespace
+
+/* === P R O C E D U R E S ================================================= */
+
+static Layer::Handle
+create_layer(const char *name)
+{
+	Layer::Handle layer = Layer::create(name);
+	if (!layer || dynamic_cast<Layer_Mime*>(layer.get()))
+		throw MissingLayer{name};
+	return layer;
+}
+
+static void
+set_param(const Layer::Handle &layer, const char *param, const ValueBase &value)
+{
+	if (!layer->set_param(param, value))
+		synfig::warning("render benchmark: cannot set param '%s' of layer '%s'", param, layer->get_name().c_str());
+}
+
+static Layer::Handle
+add_layer(const Canvas::Handle &canvas, const char *name)
+{
+	Layer::Handle layer = create_layer(name);
+	canvas->push_back(layer);
+	return layer;
+}
+
+static Canvas::Handle
+add_group(const Canvas::Handle &canvas, const Point &origin = Point())
+{
+	Layer::Handle layer = add_layer(canvas, "group");
+	Layer_PasteCanvas *group = dynamic_cast<Layer_PasteCanvas*>(layer.get());
+	if (!group)
+		throw MissingLayer{"group"};
+	Canvas::Handle sub_canvas = Canvas::create_inline(canvas);
+	group->set_sub_canvas(sub_canvas);
+	set_param(layer, "origin", origin);
+	return sub_canvas;
+}
+
+static Layer::Handle
+add_circle(const Canvas::Handle &canvas, const Point &origin, Real radius, const Color &color)
+{
+	Layer::Handle layer = add_layer(canvas, "circle");
+	set_param(layer, "origin", origin);
+	set_param(layer, "radius", radius);
+	set_param(layer, "color", color);
+	return layer;
+}
+
+static Layer::Handle
+add_outline(const Canvas::Handle &canvas, Random &random, int vertices)
+{
+	const Point center = random.point();
+	const Real radius = random(0.2, 1.0);
+
+	std::vector<BLinePoint> points;
+	for(int i = 0; i < vertices; ++i) {
+		const Real a = 2*PI*i/vertices;
+		const Real r = radius*(i % 2 ? 0.5 : 1.0);
+		BLinePoint p;
+		p.set_vertex(center + Vector(r*std::cos(a), r*std::sin(a)));
+		p.set_tangent(Vector(-std::sin(a), std::cos(a))*random(0.0, 2*r));
+		p.set_width(random(0.5, 1.5));
+		points.push_back(p);
+	}
+
+	Layer::Handle layer = add_layer(canvas, "outline");
+	set_param(layer, "bline", ValueBase(points, true));
+	set_param(layer, "width", random(0.02, 0.1));
+	set_param(layer, "color", random.color());
+	return layer;
+}
+
+static void
+build_outlines(Canvas::Handle canvas)
+{
+	Random random(1);
+	for(int i = 0; i < 300; ++i)
+		add_outline(canvas, random, 12);
+}
+
+static void
+build_deep_groups(Canvas::Handle canvas)
+{
+	Random random(2);
+	Canvas::Handle c = canvas;
+	for(int i = 0; i < 64; ++i) {
+		add_circle(c, random.point(), random(0.1, 0.5), random.color(0.8));
+		c = add_group(c, Point(random(-0.05, 0.05), random(-0.05, 0.05)));
+	}
+	add_circle(c, Point(), 1.0, random.color());
+}
+
+static void
+build_big_blurs(Canvas::Handle canvas)
+{
+	Random random(3);
+	for(int i = 0; i < 3; ++i) {
+		Canvas::Handle group = add_group(canvas);
+		Layer::Handle blur = add_layer(group, "blur");
+		set_param(blur, "size", Vector(0.5 + 0.5*i, 0.5 + 0.5*i));
+		set_param(blur, "type", i);
+		for(int j = 0; j < 20; ++j)
+			add_circle(group, random.point(), random(0.2, 1.0), random.color());
+	}
+}
+
+static void
+build_gradients(Canvas::Handle canvas)
+{
+	Random random(4);
+	for(int i = 0; i < 40; ++i) {
+		Layer::Handle layer;
+		if (i % 2) {
+			layer = add_layer(canvas, "linear_gradient");
+			set_param(layer, "p1", random.point());
+			set_param(layer, "p2", random.point());
+		} else {
+			layer = add_layer(canvas, "radial_gradient");
+			set_param(layer, "center", random.point());
+			set_param(layer, "radius", random(0.5, 3.0));
+		}
+		set_param(layer, "gradient", Gradient(random.color(), random.color(0.5), random.color(0.0)));
+		set_param(layer, "amount", 0.5);
+	}
+}
+
+static void
+build_masks(Canvas::Handle canvas)
+{
+	Random random(5);
+	for(int i = 0; i < 40; ++i) {
+		Canvas::Handle group = add_group(canvas);
+		// top layers first: a hole, the content is painted onto the shape below it
+		Layer::Handle hole = add_circle(group, random.point(), random(0.1, 0.3), Color::black());
+		set_param(hole, "blend_method", int(Color::BLEND_ALPHA_OVER));
+		Layer::Handle content = add_layer(group, "radial_gradient");
+		set_param(content, "center", random.point());
+		set_param(content, "gradient", Gradient(random.color(), random.color()));
+		set_param(content, "blend_method", int(Color::BLEND_ONTO));
+		add_circle(group, random.point(), random(0.3, 1.0), Color::white());
+	}
+}
+
+static void
+build_text(Canvas::Handle canvas)
+{
+	Random random(6);
+	for(int i = 0; i < 40; ++i) {
+		Layer::Handle layer = add_layer(canvas, "text");
+		set_param(layer, "text", String("Synfig render benchmark"));
+		set_param(layer, "family", String("Sans Serif"));
+		set_param(layer, "size", Vector(0.25, 0.25)*random(0.5, 2.0));
+		set_param(layer, "origin", random.point());
+		set_param(layer, "color", random.color());
+	}
+}
+
+static void
+build_motion_blur(Canvas::Handle canvas)
+{
+	Random random(7);
+	Layer::Handle blur = add_layer(canvas, "motion_blur");
+	set_param(blur, "subsamples_factor", 2.0);
+	for(int i = 0; i < 20; ++i)
+		add_circle(canvas, random.point(), random(0.2, 1.0), random.color());
+}
+
+static int
+count_tasks(const rendering::Task::Handle &task, std::set<const rendering::Task*> &visited)
+{
+	if (!task || !visited.insert(task.get()).second)
+		return 0;
+	int count = 1;
+	for(const rendering::Task::Handle &sub_task : task->sub_tasks)
+		count += count_tasks(sub_task, visited);
+	return count;
+}
+
+static Real
+checksum(const rendering::SurfaceResource::Handle &surface)
+{
+	rendering::SurfaceResource::LockRead<rendering::SurfaceSW> lock(surface);
+	if (!lock)
+		return 0.0;
+	const Surface &s = lock->get_surface();
+	Real sum = 0.0;
+	for(int y = 0; y < s.get_h(); ++y)
+		for(int x = 0; x < s.get_w(); ++x)
+			sum += s[y][x].get_a();
+	return sum;
+}
+
+static void
+write_stats(std::ostream &out, const char *name, std::vector<Real> values)
+{
+	std::sort(values.begin(), values.end());
+	const Real min = values.empty() ? 0.0 : values.front();
+	const Real median = values.empty() ? 0.0 : values[values.size()/2];
+	out << "\"" << name << "\": { \"min\": " << min << ", \"median\": " << median << " }";
+}
+
+static bool
+run_scene(
+	std::ostream &out,
+	const Scene &scene,
+	const rendering::Renderer::Handle &renderer,
+	int iterations )
+{
+	out << "    { \"name\": \"" << scene.name << "\", \"description\": \"" << scene.description << "\", ";
+
+	Canvas::Handle canvas = Canvas::create();
+	RendDesc &desc = canvas->rend_desc();
+	desc.set_wh(FRAME_WIDTH, FRAME_HEIGHT);
+	desc.set_tl(Point(-4, 2.25));
+	desc.set_br(Point(4, -2.25));
+
+	try {
+		scene.build(canvas);
+	} catch(const MissingLayer &e) {
+		out << "\"skipped\": true, \"reason\": \"layer '" << e.name << "' is not available\" }";
+		return true;
+	}
+
+	canvas->set_time(0);
+	const ContextParams context_params;
+
+	Timings timings;
+	int tasks = 0;
+	Real sum = 0.0;
+	bool success = true;
+	for(int i = 0; i < iterations; ++i) {
+		synfig::clock timer;
+
+		rendering::SurfaceResource::Handle surface = new rendering::SurfaceResource();
+		surface->create(desc.get_w(), desc.get_h());
+		rendering::Task::Handle task = canvas->build_rendering_task(context_params);
+		if (task) {
+			// same as Target_Scanline::build_frame_task(), y axis of the canvas goes up
+			rendering::TaskTransformationAffine::Handle flip = new rendering::TaskTransformationAffine();
+			flip->transformation->matrix.m11 = -1.0;
+			flip->transformation->matrix.m21 = desc.get_tl()[1] + desc.get_br()[1];
+			flip->sub_task() = task;
+			task = flip;
+			task->target_surface = surface;
+			task->target_rect = RectInt(VectorInt(), surface->get_size());
+			task->source_rect = Rect(desc.get_tl()[0], desc.get_br()[1], desc.get_br()[0], desc.get_tl()[1]);
+		}
+		rendering::Task::List list;
+		if (task)
+			list.push_back(task);
+		timings.build.push_back(timer.pop_time());
+
+		renderer->optimize(list);
+		timings.optimize.push_back(timer.pop_time());
+
+		if (!renderer->run(list, true, true))
+			success = false;
+		timings.run.push_back(timer.pop_time());
+
+		if (i == 0) {
+			std::set<const rendering::Task*> visited;
+			for(const rendering::Task::Handle &t : list)
+				tasks += count_tasks(t, visited);
+			sum = checksum(surface);
+		}
+	}
+
+	out << "\"skipped\": false, \"success\": " << (success ? "true" : "false")
+	    << ", \"layers\": " << canvas->size()
+	    << ", \"tasks\": " << tasks
+	    << ", \"alpha_sum\": " << sum << ", ";
+	write_stats(out, "build", timings.build);
+	out << ", ";
+	write_stats(out, "optimize", timings.optimize);
+	out << ", ";
+	write_stats(out, "run", timings.run);
+	out << " }";
+	return success;
+}
+
+/* === E N T R Y P O I N T ================================================= */
+
+int main(int argc, char *argv[])
+{
+	String output_filename;
+	int iterations = DEFAULT_ITERATIONS;
+	for(int i = 1; i < argc; ++i) {
+		if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+			output_filename = argv[++i];
+		} else
+		if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+			iterations = std::max(1, atoi(argv[++i]));
+		} else {
+			std::cerr << "Usage: " << argv[0] << " [-o <file.json>] [-n <iterations>]" << std::endl;
+			return 1;
+		}
+	}
+
+	// info messages go to stdout, keep it for JSON
+	synfig_quiet_mode = true;
+
+	// the test binary is placed in <root>/bin/test, modules are found
+	// through <root>/etc/synfig_modules.cfg like synfig tool does
+	const String root_path = OS::get_binary_path().parent_path().append("../..").cleanup().u8string();
+	Main synfig_main(root_path);
+
+	rendering::Renderer::Handle renderer = rendering::Renderer::get_renderer("software");
+	if (!renderer) {
+		std::cerr << "Renderer 'software' not found" << std::endl;
+		return 1;
+	}
+
+	// every iteration renders the same frame, don't let it come from the cache
+	if (rendering::SubtreeCache *cache = rendering::SubtreeCache::instance())
+		cache->set_budget(0);
+
+	const Scene scenes[] = {
+		{ "outlines", "300 looped outlines with 12 vertices", build_outlines },
+		{ "deep_groups", "64 nested groups with a circle in each", build_deep_groups },
+		{ "big_blurs", "3 groups with blurs of every type over 20 circles", build_big_blurs },
+		{ "gradients", "40 linear and radial gradients blended at half amount", build_gradients },
+		{ "masks", "40 groups with gradients masked by circles", build_masks },
+		{ "text", "40 text layers", build_text },
+		{ "motion_blur", "motion blur with 24 samples over 20 circles", build_motion_blur },
+	};
+
+	std::ostringstream out;
+	out.precision(9);
+	out << "{\n"
+	    << "  \"benchmark\": \"render\",\n"
+	    << "  \"renderer\": \"software\",\n"
+	    << "  \"width\": " << FRAME_WIDTH << ",\n"
+	    << "  \"height\": " << FRAME_HEIGHT << ",\n"
+	    << "  \"iterations\": " << iterations << ",\n"
+	    << "  \"threads\": " << renderer->get_max_simultaneous_threads() << ",\n"
+	    << "  \"scenes\": [\n";
+
+	bool success = true;
+	bool first = true;
+	for(const Scene &scene : scenes) {
+		if (!first) out << ",\n";
+		first = false;
+		if (!run_scene(out, scene, renderer, iterations))
+			success = false;
+	}
+	out << "\n  ]\n}\n";
+
+	if (output_filename.empty()) {
+		std::cout << out.str();
+	} else {
+		std::ofstream file(output_filename.c_str());
+		file << out.str();
+		if (!file) {
+			std::cerr << "Cannot write " << output_filename << std::endl;
+			return 1;
+		}
+	}
+
+	return success ? 0 : 1;
+}
@@ -0,0 +1,232 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file render_queue.cpp
+**	\brief Test the dependency tracking and the cancellation of RenderQueue
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#include "test_base.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <synfig/general.h>
+#include <synfig/main.h>
+#include <synfig/os.h>
+#include <synfig/rendering/renderqueue.h>
+
+/* === M A C R O S ========================================================= */
+
+using namespace synfig;
+using namespace rendering;
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace {
+
+//! holds the first task of the graph until the test opens it
+struct Gate
+{
+	std::mutex mutex;
+	std::condition_variable cond;
+	bool open;
+	bool entered;
+	Gate(): open(), entered() { }
+};
+
+Gate gate;
+std::atomic<int> leaf_runs(0);
+std::atomic<int> other_runs(0);
+
+class TaskTest: public Task
+{
+public:
+	typedef etl::handle<TaskTest> Handle;
+	static Token token;
+	virtual Token::Handle get_token() const { return token.handle(); }
+
+	bool gated;
+	bool leaf;
+
+	TaskTest(): gated(), leaf() { }
+
+	virtual bool run(RunParams &) const
+	{
+		if (gated) {
+			std::unique_lock<std::mutex> lock(gate.mutex);
+			gate.entered = true;
+			gate.cond.notify_all();
+			while(!gate.open)
+				gate.cond.wait(lock);
+		}
+		++(leaf ? leaf_runs : other_runs);
+		return true;
+	}
+};
+
+Task::Token TaskTest::token(
+	DescAbstract<TaskTest>("Test") );
+
+} // end of anonimous namespace
+
+/* === P R O C E D U R E S ================================================= */
+
+static void
+add_dep(const Task::Handle &task, const Task::Handle &dep)
+{
+	task->renderer_data.deps.push_back(dep);
+	++task->renderer_data.deps_count;
+	dep->renderer_data.back_deps.push_back(task);
+}
+
+static TaskTest::Handle
+make_task(bool leaf = false)
+{
+	TaskTest::Handle task(new TaskTest());
+	task->leaf = leaf;
+	return task;
+}
+
+//! gate <- 3 leaves <- parent <- root, like Renderer::enqueue()
+//! the finish event waits for all of them
+static Task::List
+make_graph(const TaskEvent::Handle &event, Task::List &leaves)
+{
+	TaskTest::Handle first = make_task();
+	first->gated = true;
+	TaskTest::Handle parent = make_task();
+	TaskTest::Handle root = make_task();
+
+	Task::List list;
+	list.push_back(first);
+	for(int i = 0; i < 3; ++i) {
+		TaskTest::Handle leaf = make_task(true);
+		add_dep(leaf, first);
+		add_dep(parent, leaf);
+		leaves.push_back(leaf);
+		list.push_back(leaf);
+	}
+	add_dep(root, parent);
+	list.push_back(parent);
+	list.push_back(root);
+
+	for(Task::List::const_iterator i = list.begin(); i != list.end(); ++i)
+		add_dep(event, *i);
+	list.push_back(event);
+	return list;
+}
+
+static void
+reset_gate(bool open)
+{
+	std::lock_guard<std::mutex> lock(gate.mutex);
+	gate.open = open;
+	gate.entered = false;
+	gate.cond.notify_all();
+}
+
+static bool
+wait_gate_entered()
+{
+	std::unique_lock<std::mutex> lock(gate.mutex);
+	return gate.cond.wait_for(lock, std::chrono::seconds(10), [](){ return gate.entered; });
+}
+
+static bool
+wait_all_done(const TaskEvent::Handle &event)
+{
+	// event is finished by cancel() immediately,
+	// so wait until all its deps pass through the queue
+	for(int i = 0; i < 10000; ++i) {
+		if (event->renderer_data.deps_count == 0)
+			return true;
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return false;
+}
+
+static void
+test_graph_runs_all_tasks()
+{
+	RenderQueue queue;
+	reset_gate(true);
+	leaf_runs = other_runs = 0;
+
+	TaskEvent::Handle event(new TaskEvent());
+	Task::List leaves;
+	queue.enqueue(make_graph(event, leaves), Task::RunParams());
+	event->wait();
+
+	ASSERT(event->is_done());
+	ASSERT_EQUAL(3, (int)leaf_runs);
+	ASSERT_EQUAL(3, (int)other_runs);
+}
+
+static void
+test_cancelled_graph_skips_pending_tasks()
+{
+	RenderQueue queue;
+	reset_gate(false);
+	leaf_runs = other_runs = 0;
+
+	TaskEvent::Handle event(new TaskEvent());
+	Task::List leaves;
+	queue.enqueue(make_graph(event, leaves), Task::RunParams());
+	ASSERT(wait_gate_entered());
+
+	// leaves and intermediate tasks are waited only by the cancelled event
+	queue.cancel(event);
+	int cancelled_leaves = 0;
+	for(Task::List::const_iterator i = leaves.begin(); i != leaves.end(); ++i)
+		if ((*i)->renderer_data.cancelled)
+			++cancelled_leaves;
+
+	reset_gate(true);
+	ASSERT(event->is_cancelled());
+	ASSERT_EQUAL(3, cancelled_leaves);
+	ASSERT(wait_all_done(event));
+	ASSERT_EQUAL(0, (int)leaf_runs);
+	// only the gated task which was already running
+	ASSERT_EQUAL(1, (int)other_runs);
+}
+
+/* === E N T R Y P O I N T ================================================= */
+
+int main()
+{
+	synfig_quiet_mode = true;
+
+	// initializes the thread pool used by the queue workers
+	const String root_path = OS::get_binary_path().parent_path().append("../..").cleanup().u8string();
+	Main synfig_main(root_path);
+
+	TEST_SUITE_BEGIN()
+		TEST_FUNCTION(test_graph_runs_all_tasks);
+		TEST_FUNCTION(test_cancelled_graph_skips_pending_tasks);
+	TEST_SUITE_END()
+
+	return tst_exit_status;
+}
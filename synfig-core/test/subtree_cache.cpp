@@ -0,0 +1,300 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file subtree_cache.cpp
+**	\brief Test the task hash and the admission, budget and LRU order of SubtreeCache
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#include "test_base.h"
+
+#include <cstring>
+#include <vector>
+
+#include <synfig/general.h>
+#include <synfig/main.h>
+#include <synfig/os.h>
+#include <synfig/rendering/common/task/taskblend.h>
+#include <synfig/rendering/common/task/taskcontour.h>
+#include <synfig/rendering/renderer.h>
+#include <synfig/rendering/software/surfacesw.h>
+#include <synfig/rendering/software/surfaceswcompact.h>
+#include <synfig/rendering/subtreecache.h>
+
+/* === M A C R O S ========================================================= */
+
+using namespace synfig;
+using namespace rendering;
+
+static const int side = 10;
+static const size_t surface_bytes = side*side*sizeof(Color);
+
+/* === P R O C E D U R E S ================================================= */
+
+static TaskHash
+hash_of(int x)
+	{ TaskHash hash; hash.add(x); return hash; }
+
+static SurfaceResource::Handle
+make_surface()
+{
+	SurfaceResource::Handle surface = new SurfaceResource();
+	surface->create(side, side);
+	return surface;
+}
+
+static TaskContour::Handle
+make_contour_task()
+{
+	TaskContour::Handle task(new TaskContour());
+	task->contour = std::make_shared<Contour>();
+	task->contour->move_to(Vector(0, 0));
+	task->contour->line_to(Vector(1, 0));
+	task->contour->line_to(Vector(1, 1));
+	task->contour->close();
+	task->contour->color = Color(1.f, 0.f, 0.f, 1.f);
+	return task;
+}
+
+static TaskHash
+hash_params_of(const Task &task)
+{
+	TaskHash hash;
+	ASSERT(task.hash_params(hash));
+	return hash;
+}
+
+static void
+test_equal_values_give_equal_hash()
+{
+	TaskHash a, b;
+	a.add(String("Contour")); a.add(Rect(0, 0, 1, 1)); a.add(0.0);
+	b.add(String("Contour")); b.add(Rect(0, 0, 1, 1)); b.add(-0.0);
+	ASSERT(a == b);
+
+	TaskHash c;
+	c.add(String("Contour")); c.add(Rect(0, 0, 1, 2)); c.add(0.0);
+	ASSERT(a != c);
+	ASSERT(a < c || c < a);
+}
+
+static void
+test_contour_hash_follows_parameters()
+{
+	TaskContour::Handle a = make_contour_task();
+	TaskContour::Handle b = make_contour_task();
+	ASSERT(hash_params_of(*a) == hash_params_of(*b));
+
+	b->contour->color = Color(0.f, 1.f, 0.f, 1.f);
+	ASSERT(hash_params_of(*a) != hash_params_of(*b));
+
+	b = make_contour_task();
+	b->transformation->matrix = Matrix().set_translate(1, 0);
+	ASSERT(hash_params_of(*a) != hash_params_of(*b));
+
+	b = make_contour_task();
+	b->contour->line_to(Vector(0, 1));
+	ASSERT(hash_params_of(*a) != hash_params_of(*b));
+}
+
+static void
+test_surface_is_not_hashable()
+{
+	TaskHash hash;
+	ASSERT_FALSE(TaskSurface().hash_params(hash));
+}
+
+static void
+test_hash_is_admitted_when_seen_twice()
+{
+	SubtreeCache cache(3*surface_bytes);
+	ASSERT_FALSE(cache.admit(hash_of(1)));
+	ASSERT_FALSE(cache.admit(hash_of(2)));
+	ASSERT(cache.admit(hash_of(1)));
+	ASSERT(cache.admit(hash_of(1)));
+}
+
+static void
+test_disabled_cache_admits_nothing()
+{
+	SubtreeCache cache(0);
+	ASSERT_FALSE(cache.is_enabled());
+	ASSERT_FALSE(cache.admit(hash_of(1)));
+	ASSERT_FALSE(cache.admit(hash_of(1)));
+}
+
+static void
+test_oldest_seen_hash_is_forgotten()
+{
+	SubtreeCache cache(surface_bytes);
+	for(int i = 0; i <= SubtreeCache::max_seen; ++i)
+		cache.admit(hash_of(i));
+	ASSERT_FALSE(cache.admit(hash_of(0)));
+	ASSERT(cache.admit(hash_of(SubtreeCache::max_seen)));
+}
+
+static void
+test_least_recently_used_is_evicted()
+{
+	SubtreeCache cache(3*surface_bytes);
+	cache.put(hash_of(1), make_surface());
+	cache.put(hash_of(2), make_surface());
+	cache.put(hash_of(3), make_surface());
+	ASSERT(cache.get(hash_of(1)));
+	ASSERT_FALSE(cache.get(hash_of(4)));
+
+	cache.put(hash_of(4), make_surface());
+	ASSERT(cache.contains(hash_of(1)));
+	ASSERT_FALSE(cache.contains(hash_of(2)));
+	ASSERT(cache.contains(hash_of(3)));
+	ASSERT(cache.contains(hash_of(4)));
+
+	const SubtreeCache::Statistics statistics = cache.get_statistics();
+	ASSERT_EQUAL(1, (int)statistics.hits);
+	ASSERT_EQUAL(1, (int)statistics.misses);
+	ASSERT_EQUAL(4, (int)statistics.stores);
+	ASSERT_EQUAL(1, (int)statistics.evictions);
+	ASSERT_EQUAL(3, statistics.entries);
+	ASSERT_EQUAL(3*surface_bytes, statistics.bytes);
+}
+
+static void
+test_surface_bigger_than_budget_is_not_cached()
+{
+	SubtreeCache cache(surface_bytes - 1);
+	cache.put(hash_of(1), make_surface());
+	ASSERT_FALSE(cache.contains(hash_of(1)));
+	ASSERT_EQUAL(0u, cache.get_statistics().bytes);
+}
+
+static void
+test_smaller_budget_evicts_oldest()
+{
+	SubtreeCache cache(3*surface_bytes);
+	cache.put(hash_of(1), make_surface());
+	cache.put(hash_of(2), make_surface());
+	cache.put(hash_of(3), make_surface());
+
+	cache.set_budget(surface_bytes);
+	ASSERT_FALSE(cache.contains(hash_of(1)));
+	ASSERT_FALSE(cache.contains(hash_of(2)));
+	ASSERT(cache.contains(hash_of(3)));
+	ASSERT_EQUAL(2, (int)cache.get_statistics().evictions);
+
+	cache.clear();
+	ASSERT_EQUAL(0u, cache.get_statistics().bytes);
+	ASSERT_EQUAL(0, cache.get_statistics().entries);
+}
+
+//! Static scene with anti-aliased semi-transparent edges,
+//! which are changed by the conversion into SurfaceSWRGBA8
+static std::vector<Color>
+render_scene(const Renderer::Handle &renderer)
+{
+	const int size = 64;
+
+	TaskContour::Handle a = make_contour_task();
+	a->contour->color = Color(0.3f, 0.6f, 0.9f, 0.7f);
+	TaskContour::Handle b(new TaskContour());
+	b->contour = std::make_shared<Contour>();
+	b->contour->move_to(Vector(0.1, 0.9));
+	b->contour->line_to(Vector(0.8, 0.05));
+	b->contour->line_to(Vector(0.95, 0.7));
+	b->contour->close();
+	b->contour->color = Color(0.9f, 0.2f, 0.15f, 0.45f);
+
+	TaskBlend::Handle blend(new TaskBlend());
+	blend->amount = 0.8;
+	blend->sub_task_a() = a;
+	blend->sub_task_b() = b;
+	blend->target_surface = new SurfaceResource();
+	blend->target_surface->create(size, size);
+	blend->target_rect = RectInt(0, 0, size, size);
+	blend->source_rect = Rect(0.0, 0.0, 1.0, 1.0);
+
+	ASSERT(renderer->run(blend, true));
+
+	SurfaceResource::LockRead<SurfaceSW> lock(blend->target_surface);
+	ASSERT(lock);
+	std::vector<Color> pixels(size*size);
+	ASSERT(lock->get_pixels(&pixels.front()));
+	return pixels;
+}
+
+static void
+test_cache_hit_is_bit_exact()
+{
+	Renderer::Handle renderer = Renderer::get_renderer("software");
+	ASSERT(renderer);
+	SubtreeCache *cache = SubtreeCache::instance();
+	ASSERT(cache);
+
+	// intermediate results are stored in the lossy format
+	const rendering::Surface::Token::Handle compact_token = renderer->get_compact_surface_token();
+	renderer->set_compact_surface_token(SurfaceSWRGBA8::token.handle());
+
+	const size_t budget = cache->get_budget();
+	cache->set_budget(64*1024*1024);
+	cache->clear();
+	cache->reset_statistics();
+
+	// the first frame only marks the subtree as seen and renders it as usual,
+	// the second one stores it and the third one takes it from the cache
+	const std::vector<Color> expected = render_scene(renderer);
+	for(int frame = 1; frame < 3; ++frame) {
+		const std::vector<Color> pixels = render_scene(renderer);
+		ASSERT_EQUAL(expected.size(), pixels.size());
+		ASSERT(!memcmp(&expected.front(), &pixels.front(), sizeof(Color)*expected.size()));
+	}
+	ASSERT_EQUAL(1, (int)cache->get_statistics().stores);
+	ASSERT_EQUAL(1, (int)cache->get_statistics().hits);
+
+	cache->clear();
+	cache->set_budget(budget);
+	renderer->set_compact_surface_token(compact_token);
+}
+
+/* === E N T R Y P O I N T ================================================= */
+
+int main()
+{
+	synfig_quiet_mode = true;
+
+	// initializes the renderers and the process-wide cache
+	const String root_path = OS::get_binary_path().parent_path().append("../..").cleanup().u8string();
+	Main synfig_main(root_path);
+
+	TEST_SUITE_BEGIN()
+		TEST_FUNCTION(test_equal_values_give_equal_hash);
+		TEST_FUNCTION(test_contour_hash_follows_parameters);
+		TEST_FUNCTION(test_surface_is_not_hashable);
+		TEST_FUNCTION(test_hash_is_admitted_when_seen_twice);
+		TEST_FUNCTION(test_disabled_cache_admits_nothing);
+		TEST_FUNCTION(test_oldest_seen_hash_is_forgotten);
+		TEST_FUNCTION(test_least_recently_used_is_evicted);
+		TEST_FUNCTION(test_surface_bigger_than_budget_is_not_cached);
+		TEST_FUNCTION(test_smaller_budget_evicts_oldest);
+		TEST_FUNCTION(test_cache_hit_is_bit_exact);
+	TEST_SUITE_END()
+
+	return tst_exit_status;
+}
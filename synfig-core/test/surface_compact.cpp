@@ -0,0 +1,271 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file surface_compact.cpp
+**	\brief Test the 8-bit and half-float surfaces and their conversion in SurfaceResource
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#include "test_base.h"
+
+#include <cmath>
+#include <vector>
+
+#include <synfig/rendering/software/surfacesw.h>
+#include <synfig/rendering/software/surfaceswcompact.h>
+
+/* === M A C R O S ========================================================= */
+
+using namespace synfig;
+using namespace rendering;
+
+static const int width = 4;
+static const int height = 2;
+
+/* === P R O C E D U R E S ================================================= */
+
+static std::vector<Color>
+make_pixels()
+{
+	std::vector<Color> pixels;
+	pixels.push_back(Color(0.f,   0.f,   0.f,  0.f));
+	pixels.push_back(Color(1.f,   0.5f,  0.25f, 1.f));
+	pixels.push_back(Color(0.2f,  0.4f,  0.6f, 0.5f));
+	pixels.push_back(Color(1.f,   1.f,   1.f,  0.1f));
+	pixels.push_back(Color(0.75f, 0.f,   0.3f, 0.9f));
+	pixels.push_back(Color(0.f,   1.f,   0.f,  1.f));
+	pixels.push_back(Color(0.33f, 0.66f, 0.99f, 0.75f));
+	pixels.push_back(Color(0.5f,  0.5f,  0.5f, 0.5f));
+	return pixels;
+}
+
+static SurfaceSW::Handle
+make_surface_sw(const std::vector<Color> &pixels)
+{
+	SurfaceSW::Handle surface = new SurfaceSW();
+	ASSERT(surface->assign(&pixels.front(), width, height));
+	return surface;
+}
+
+static void
+assert_colors_near(const std::vector<Color> &expected, const std::vector<Color> &value, float tolerance)
+{
+	ASSERT_EQUAL(expected.size(), value.size());
+	for(size_t i = 0; i < expected.size(); ++i) {
+		ASSERT(std::fabs(expected[i].get_a() - value[i].get_a()) <= tolerance);
+		// color of transparent pixel has no meaning
+		if (expected[i].get_a() == 0.f)
+			continue;
+		ASSERT(std::fabs(expected[i].get_r() - value[i].get_r()) <= tolerance);
+		ASSERT(std::fabs(expected[i].get_g() - value[i].get_g()) <= tolerance);
+		ASSERT(std::fabs(expected[i].get_b() - value[i].get_b()) <= tolerance);
+	}
+}
+
+static void
+test_half_exact_values()
+{
+	const float values[] = { 0.f, 1.f, -2.f, 0.5f, 0.125f, 1024.f, 65504.f, 1.f/16777216.f };
+	for(size_t i = 0; i < sizeof(values)/sizeof(values[0]); ++i)
+		ASSERT_EQUAL(values[i], SurfaceSWRGBA16F::half_to_float(SurfaceSWRGBA16F::float_to_half(values[i])));
+
+	ASSERT_EQUAL(0x3c00, (int)SurfaceSWRGBA16F::float_to_half(1.f));
+	ASSERT_EQUAL(0xc000, (int)SurfaceSWRGBA16F::float_to_half(-2.f));
+	ASSERT_EQUAL(0x0001, (int)SurfaceSWRGBA16F::float_to_half(1.f/16777216.f));
+}
+
+static void
+test_half_clamps_and_rounds()
+{
+	ASSERT_EQUAL(65504.f, SurfaceSWRGBA16F::half_to_float(SurfaceSWRGBA16F::float_to_half(1e6f)));
+	ASSERT_EQUAL(-65504.f, SurfaceSWRGBA16F::half_to_float(SurfaceSWRGBA16F::float_to_half(-1e6f)));
+	ASSERT_EQUAL(0.f, SurfaceSWRGBA16F::half_to_float(SurfaceSWRGBA16F::float_to_half(NAN)));
+	ASSERT_EQUAL(0.f, SurfaceSWRGBA16F::half_to_float(SurfaceSWRGBA16F::float_to_half(1e-9f)));
+
+	// 1 + 2^-11 is exactly between 1 and the next half, goes to the even one
+	ASSERT_EQUAL(0x3c00, (int)SurfaceSWRGBA16F::float_to_half(1.f + 1.f/2048.f));
+	ASSERT_EQUAL(0x3c01, (int)SurfaceSWRGBA16F::float_to_half(1.f + 1.5f/2048.f));
+
+	for(float x = 1e-4f; x < 60000.f; x *= 1.37f) {
+		const float y = SurfaceSWRGBA16F::half_to_float(SurfaceSWRGBA16F::float_to_half(x));
+		ASSERT(std::fabs(x - y) <= x/2048.f);
+	}
+}
+
+static void
+test_rgba16f_keeps_colors()
+{
+	std::vector<Color> pixels = make_pixels();
+	pixels[2] = Color(2.5f, -0.5f, 0.6f, 0.5f); // out of range values are kept
+
+	SurfaceSWRGBA16F surface;
+	ASSERT(surface.assign(*make_surface_sw(pixels)));
+	ASSERT_EQUAL(width, surface.get_width());
+	ASSERT_EQUAL(height, surface.get_height());
+	ASSERT_EQUAL((size_t)width*height*4, surface.get_data().size());
+
+	std::vector<Color> result(pixels.size());
+	ASSERT(surface.get_pixels(&result.front()));
+	assert_colors_near(pixels, result, 0.005f);
+}
+
+static void
+test_rgba8_keeps_visible_colors()
+{
+	const std::vector<Color> pixels = make_pixels();
+
+	SurfaceSWRGBA8 surface;
+	ASSERT(surface.assign(*make_surface_sw(pixels)));
+	ASSERT_EQUAL((size_t)width*height*4, surface.get_data().size());
+	// premultiplied
+	ASSERT_EQUAL(0, (int)surface.get_data()[0*4 + 3]);
+	ASSERT_EQUAL(255, (int)surface.get_data()[1*4 + 0]);
+	ASSERT_EQUAL(26, (int)surface.get_data()[3*4 + 0]);
+
+	std::vector<Color> result(pixels.size());
+	ASSERT(surface.get_pixels(&result.front()));
+	assert_colors_near(pixels, result, 2.5f/255.f);
+}
+
+static void
+test_rgba8_rejects_out_of_range_colors()
+{
+	std::vector<Color> pixels = make_pixels();
+	pixels[2] = Color(2.5f, 0.4f, 0.6f, 0.5f);
+
+	SurfaceSWRGBA8 surface;
+	ASSERT_FALSE(surface.assign(*make_surface_sw(pixels)));
+	ASSERT_FALSE(SurfaceSWRGBA8::fits(&pixels.front(), pixels.size()));
+
+	// values above 1 fit if they are in range after premultiplication
+	pixels[2] = Color(1.5f, 0.4f, 0.6f, 0.5f);
+	ASSERT(SurfaceSWRGBA8::fits(&pixels.front(), pixels.size()));
+
+	// the resource keeps the float surface
+	pixels[2] = Color(0.2f, -0.5f, 0.6f, 0.5f);
+	SurfaceResource::Handle resource = new SurfaceResource(make_surface_sw(pixels));
+	ASSERT_FALSE(resource->convert(SurfaceSWRGBA8::token.handle()));
+	ASSERT(resource->has_surface<SurfaceSW>());
+	ASSERT_FALSE(resource->has_surface<SurfaceSWRGBA8>());
+}
+
+static void
+test_compact_surfaces_convert_to_each_other()
+{
+	const std::vector<Color> pixels = make_pixels();
+
+	SurfaceSWRGBA16F half;
+	ASSERT(half.assign(*make_surface_sw(pixels)));
+	SurfaceSWRGBA8 bytes;
+	ASSERT(bytes.assign(half));
+	SurfaceSWRGBA16F half_copy;
+	ASSERT(half_copy.assign(half));
+	ASSERT(half.get_data() == half_copy.get_data());
+
+	std::vector<Color> result(pixels.size());
+	ASSERT(bytes.get_pixels(&result.front()));
+	assert_colors_near(pixels, result, 2.5f/255.f);
+}
+
+static void
+test_resource_converts_and_drops_float_surface()
+{
+	const std::vector<Color> pixels = make_pixels();
+	SurfaceResource::Handle resource = new SurfaceResource(make_surface_sw(pixels));
+	ASSERT(resource->has_surface<SurfaceSW>());
+
+	ASSERT(resource->convert(SurfaceSWRGBA16F::token.handle()));
+	ASSERT_FALSE(resource->has_surface<SurfaceSW>());
+	ASSERT(resource->has_surface<SurfaceSWRGBA16F>());
+	ASSERT_FALSE(resource->is_blank());
+
+	{
+		// reading gives a full copy kept until the lock is released
+		SurfaceResource::LockRead<SurfaceSW> lock(resource);
+		ASSERT(lock);
+		std::vector<Color> result(pixels.size());
+		ASSERT(lock->get_pixels(&result.front()));
+		assert_colors_near(pixels, result, 0.005f);
+	}
+	ASSERT_FALSE(resource->has_surface<SurfaceSW>());
+
+	{
+		// writing converts it back
+		SurfaceResource::LockWrite<SurfaceSW> lock(resource);
+		ASSERT(lock);
+	}
+	ASSERT(resource->has_surface<SurfaceSW>());
+	ASSERT_FALSE(resource->has_surface<SurfaceSWRGBA16F>());
+}
+
+static void
+test_resource_shares_decoded_copy_between_readers()
+{
+	const std::vector<Color> pixels = make_pixels();
+	SurfaceResource::Handle resource = new SurfaceResource(make_surface_sw(pixels));
+	ASSERT(resource->convert(SurfaceSWRGBA16F::token.handle()));
+
+	{
+		SurfaceResource::LockRead<SurfaceSW> lock_a(resource);
+		SurfaceResource::LockRead<SurfaceSW> lock_b(resource, RectInt(0, 0, width, 1));
+		ASSERT(lock_a);
+		ASSERT(lock_b);
+		// decoded once for all readers
+		ASSERT(lock_a.get() == lock_b.get());
+		ASSERT(resource->has_surface<SurfaceSW>());
+	}
+	// and dropped after the last of them
+	ASSERT_FALSE(resource->has_surface<SurfaceSW>());
+	ASSERT(resource->has_surface<SurfaceSWRGBA16F>());
+}
+
+static void
+test_resource_keeps_blank_on_convert()
+{
+	SurfaceResource::Handle resource = new SurfaceResource();
+	resource->create(width, height);
+	ASSERT(resource->convert(SurfaceSWRGBA8::token.handle()));
+	ASSERT(resource->is_blank());
+
+	SurfaceResource::LockRead<SurfaceSW> lock(resource);
+	ASSERT(lock);
+	ASSERT(lock->is_blank());
+}
+
+/* === E N T R Y P O I N T ================================================= */
+
+int main()
+{
+	TEST_SUITE_BEGIN()
+		TEST_FUNCTION(test_half_exact_values);
+		TEST_FUNCTION(test_half_clamps_and_rounds);
+		TEST_FUNCTION(test_rgba16f_keeps_colors);
+		TEST_FUNCTION(test_rgba8_keeps_visible_colors);
+		TEST_FUNCTION(test_rgba8_rejects_out_of_range_colors);
+		TEST_FUNCTION(test_compact_surfaces_convert_to_each_other);
+		TEST_FUNCTION(test_resource_converts_and_drops_float_surface);
+		TEST_FUNCTION(test_resource_shares_decoded_copy_between_readers);
+		TEST_FUNCTION(test_resource_keeps_blank_on_convert);
+	TEST_SUITE_END()
+
+	return tst_exit_status;
+}
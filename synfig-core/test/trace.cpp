@@ -0,0 +1,335 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file trace.cpp
+**	\brief Test the JSON output, the summary and the thread buffers of debug::Trace
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#include "test_base.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include <synfig/debug/trace.h>
+
+/* === M A C R O S ========================================================= */
+
+using namespace synfig;
+using namespace debug;
+
+/* === C L A S S E S & S T R U C T S ======================================= */
+
+namespace {
+
+//! just enough of JSON to read back the trace
+struct Json
+{
+	enum Type { NONE, NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT };
+
+	Type type;
+	double number;
+	String string;
+	std::vector<Json> array;
+	std::map<String, Json> object;
+
+	Json(): type(NONE), number() { }
+
+	const Json& operator[](const String &key) const
+	{
+		static const Json none;
+		std::map<String, Json>::const_iterator i = object.find(key);
+		return i == object.end() ? none : i->second;
+	}
+};
+
+class JsonParser
+{
+private:
+	const String &text;
+	size_t pos;
+
+	void skip_spaces()
+		{ while(pos < text.size() && std::isspace((unsigned char)text[pos])) ++pos; }
+
+	bool expect(char c)
+	{
+		skip_spaces();
+		if (pos >= text.size() || text[pos] != c) return false;
+		++pos;
+		return true;
+	}
+
+	bool parse_word(const char *word)
+	{
+		for(const char *c = word; *c; ++c, ++pos)
+			if (pos >= text.size() || text[pos] != *c) return false;
+		return true;
+	}
+
+	bool parse_string(String &result)
+	{
+		if (!expect('"')) return false;
+		while(pos < text.size() && text[pos] != '"') {
+			char c = text[pos++];
+			if ((unsigned char)c < 0x20) return false;
+			if (c == '\\') {
+				if (pos >= text.size()) return false;
+				c = text[pos++];
+				switch(c) {
+				case '"': case '\\': case '/': break;
+				case 'n': c = '\n'; break;
+				case 't': c = '\t'; break;
+				case 'r': c = '\r'; break;
+				case 'b': c = '\b'; break;
+				case 'f': c = '\f'; break;
+				case 'u':
+					// the trace escapes control characters only
+					if (pos + 4 > text.size()) return false;
+					c = (char)std::strtol(text.substr(pos, 4).c_str(), nullptr, 16);
+					pos += 4;
+					break;
+				default: return false;
+				}
+			}
+			result += c;
+		}
+		return expect('"');
+	}
+
+	bool parse_value(Json &value)
+	{
+		skip_spaces();
+		if (pos >= text.size()) return false;
+		const char c = text[pos];
+		if (c == '{') {
+			value.type = Json::OBJECT;
+			++pos;
+			if (expect('}')) return true;
+			do {
+				String key;
+				if (!parse_string(key) || !expect(':') || !parse_value(value.object[key]))
+					return false;
+			} while(expect(','));
+			return expect('}');
+		}
+		if (c == '[') {
+			value.type = Json::ARRAY;
+			++pos;
+			if (expect(']')) return true;
+			do {
+				value.array.push_back(Json());
+				if (!parse_value(value.array.back()))
+					return false;
+			} while(expect(','));
+			return expect(']');
+		}
+		if (c == '"')
+			{ value.type = Json::STRING; return parse_string(value.string); }
+		if (c == 't')
+			{ value.type = Json::BOOL; value.number = 1; return parse_word("true"); }
+		if (c == 'f')
+			{ value.type = Json::BOOL; return parse_word("false"); }
+		if (c == 'n')
+			{ value.type = Json::NUL; return parse_word("null"); }
+
+		const char *begin = text.c_str() + pos;
+		char *end = nullptr;
+		value.type = Json::NUMBER;
+		value.number = std::strtod(begin, &end);
+		if (end == begin) return false;
+		pos += end - begin;
+		return true;
+	}
+
+public:
+	explicit JsonParser(const String &text): text(text), pos() { }
+
+	//! false if the text is not a single valid JSON value
+	bool parse(Json &value)
+	{
+		if (!parse_value(value)) return false;
+		skip_spaces();
+		return pos == text.size();
+	}
+};
+
+} // end of anonimous namespace
+
+/* === P R O C E D U R E S ================================================= */
+
+static void
+record_sample_events()
+{
+	Trace::start();
+	Trace::add("task", "TaskBlend", "circle \"one\"\n", 100, 0, 1000);
+	Trace::add("optimizer", "OptimizerBlendMerge", String(), 0, 1000, 1500);
+	Trace::add("task", "TaskBlend", "circle", 50, 2000, 5000);
+	Trace::stop();
+}
+
+static std::vector<const Json*>
+get_events_by_phase(const Json &root, const String &phase)
+{
+	std::vector<const Json*> events;
+	const Json &list = root["traceEvents"];
+	for(std::vector<Json>::const_iterator i = list.array.begin(); i != list.array.end(); ++i)
+		if (i->type == Json::OBJECT && (*i)["ph"].string == phase)
+			events.push_back(&*i);
+	return events;
+}
+
+static void
+test_write_is_chrome_trace_json()
+{
+	record_sample_events();
+
+	std::ostringstream stream;
+	Trace::write(stream);
+
+	Json root;
+	ASSERT(JsonParser(stream.str()).parse(root));
+	ASSERT(root.type == Json::OBJECT);
+	ASSERT(root["traceEvents"].type == Json::ARRAY);
+
+	const std::vector<const Json*> threads = get_events_by_phase(root, "M");
+	ASSERT_EQUAL(1, (int)threads.size());
+	ASSERT_EQUAL(String("thread_name"), (*threads[0])["name"].string);
+
+	const std::vector<const Json*> events = get_events_by_phase(root, "X");
+	ASSERT_EQUAL(3, (int)events.size());
+
+	const Json &first = *events[0];
+	ASSERT_EQUAL(String("TaskBlend"), first["name"].string);
+	ASSERT_EQUAL(String("task"), first["cat"].string);
+	ASSERT_EQUAL(0.0, first["ts"].number);
+	ASSERT_EQUAL(1000.0, first["dur"].number);
+	ASSERT_EQUAL(String("circle \"one\"\n"), first["args"]["layer"].string);
+	ASSERT_EQUAL(100.0, first["args"]["pixels"].number);
+
+	const Json &second = *events[1];
+	ASSERT_EQUAL(String("OptimizerBlendMerge"), second["name"].string);
+	ASSERT_EQUAL(String("optimizer"), second["cat"].string);
+	ASSERT_EQUAL(1000.0, second["ts"].number);
+	ASSERT_EQUAL(500.0, second["dur"].number);
+
+	const Json &third = *events[2];
+	ASSERT_EQUAL(2000.0, third["ts"].number);
+	ASSERT_EQUAL(3000.0, third["dur"].number);
+	ASSERT_EQUAL((*threads[0])["tid"].number, third["tid"].number);
+}
+
+static void
+test_summary_by_name()
+{
+	record_sample_events();
+
+	const std::vector<Trace::SummaryRow> rows = Trace::get_summary(false);
+	ASSERT_EQUAL(2, (int)rows.size());
+	ASSERT_EQUAL(String("task"), rows[0].category);
+	ASSERT_EQUAL(String("TaskBlend"), rows[0].name);
+	ASSERT_EQUAL(2LL, rows[0].count);
+	ASSERT_EQUAL(150LL, rows[0].pixels);
+	ASSERT_EQUAL(4000LL, rows[0].total);
+	ASSERT_EQUAL(3000LL, rows[0].max);
+	ASSERT_EQUAL(String("OptimizerBlendMerge"), rows[1].name);
+	ASSERT_EQUAL(500LL, rows[1].total);
+}
+
+static void
+test_summary_by_layer()
+{
+	record_sample_events();
+
+	// optimizers are not counted by layer
+	const std::vector<Trace::SummaryRow> rows = Trace::get_summary(true);
+	ASSERT_EQUAL(2, (int)rows.size());
+	ASSERT_EQUAL(String("circle"), rows[0].name);
+	ASSERT_EQUAL(3000LL, rows[0].total);
+	ASSERT_EQUAL(String("circle \"one\"\n"), rows[1].name);
+	ASSERT_EQUAL(1000LL, rows[1].total);
+}
+
+static void
+test_write_summary()
+{
+	record_sample_events();
+
+	std::ostringstream stream;
+	Trace::write_summary(stream);
+	const String text = stream.str();
+	ASSERT(text.find("Rendering trace by task and optimizer:") != String::npos);
+	ASSERT(text.find("Rendering trace by layer:") != String::npos);
+	ASSERT(text.find("OptimizerBlendMerge") != String::npos);
+	ASSERT(text.find("4.000") != String::npos);
+	ASSERT(text.find("dropped") == String::npos);
+}
+
+static void
+test_stopped_trace_records_nothing()
+{
+	Trace::start();
+	Trace::stop();
+	{
+		Trace::Scope scope("task", "TaskBlend");
+		ASSERT_FALSE(scope.is_active());
+	}
+	ASSERT(Trace::get_events().empty());
+}
+
+static void
+test_exited_thread_buffer_is_reused()
+{
+	Trace::start();
+	Trace::add("task", "main", String(), 0, 0, 1);
+	std::thread([](){ Trace::add("task", "first", String(), 0, 1, 2); }).join();
+	std::thread([](){ Trace::add("task", "second", String(), 0, 2, 3); }).join();
+	Trace::stop();
+
+	// events of an exited thread are kept
+	const std::vector<Trace::Event> events = Trace::get_events();
+	ASSERT_EQUAL(3, (int)events.size());
+	ASSERT_EQUAL(String("first"), events[1].name);
+	ASSERT_EQUAL(String("second"), events[2].name);
+	ASSERT_NOT_EQUAL(events[0].thread, events[1].thread);
+	ASSERT_EQUAL(events[1].thread, events[2].thread);
+}
+
+/* === E N T R Y P O I N T ================================================= */
+
+int main()
+{
+	TEST_SUITE_BEGIN()
+		TEST_FUNCTION(test_write_is_chrome_trace_json);
+		TEST_FUNCTION(test_summary_by_name);
+		TEST_FUNCTION(test_summary_by_layer);
+		TEST_FUNCTION(test_write_summary);
+		TEST_FUNCTION(test_stopped_trace_records_nothing);
+		TEST_FUNCTION(test_exited_thread_buffer_is_reused);
+	TEST_SUITE_END()
+
+	return tst_exit_status;
+}
@@ -0,0 +1,256 @@
+/* === S Y N F I G ========================================================= */
+/*!	\file valuenode_constant_interval.cpp
+**	\brief Test ValueNode::get_constant_interval()
+**
+**	\legal
+**	Copyright (c) 2025 Synfig contributors
+**
+**	This file is part of Synfig.
+**
+**	Synfig is free software: you can redistribute it and/or modify
+**	it under the terms of the GNU General Public License as published by
+**	the Free Software Foundation, either version 2 of the License, or
+**	(at your option) any later version.
+**
+**	Synfig is distributed in the hope that it will be useful,
+**	but WITHOUT ANY WARRANTY; without even the implied warranty of
+**	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+**	GNU General Public License for more details.
+**
+**	You should have received a copy of the GNU General Public License
+**	along with Synfig.  If not, see <https://www.gnu.org/licenses/>.
+**	\endlegal
+*/
+/* ========================================================================= */
+
+/* === H E A D E R S ======================================================= */
+
+#include "test_base.h"
+
+#include <synfig/canvas.h>
+#include <synfig/layer.h>
+#include <synfig/valuenodes/valuenode_add.h>
+#include <synfig/valuenodes/valuenode_animated.h>
+#include <synfig/valuenodes/valuenode_bone.h>
+#include <synfig/valuenodes/valuenode_bonelink.h>
+#include <synfig/valuenodes/valuenode_const.h>
+#include <synfig/valuenodes/valuenode_linear.h>
+#include <synfig/valuenodes/valuenode_timeloop.h>
+
+using namespace synfig;
+
+/* === P R O C E D U R E S ================================================= */
+
+static ValueNode_Animated::Handle
+create_animated_real()
+{
+	// waypoints at 1s and 2s
+	ValueNode_Animated::Handle animated = ValueNode_Animated::create(ValueBase(Real(1.0)), Time(1));
+	animated->new_waypoint(Time(2), ValueBase(Real(3.0)));
+	animated->changed();
+	return animated;
+}
+
+static void
+test_const_is_time_invariant()
+{
+	ValueNode::Handle node = ValueNode_Const::create(Real(2.0));
+	ASSERT(node->is_time_invariant());
+}
+
+static void
+test_linkable_of_consts_is_time_invariant()
+{
+	ValueNode_Add::Handle add = ValueNode_Add::create(Real(2.0));
+	ASSERT(add->is_time_invariant());
+}
+
+//! Node which doesn't tell that its value is a pure function of its links
+class ValueNode_Opaque : public LinkableValueNode
+{
+public:
+	ValueNode_Opaque(): LinkableValueNode(type_real) { }
+	virtual String get_name() const override { return "opaque"; }
+	virtual String get_local_name() const override { return "opaque"; }
+	virtual ValueBase operator()(Time) const override { return Real(1.0); }
+
+protected:
+	virtual LinkableValueNode* create_new() const override { return new ValueNode_Opaque(); }
+	virtual bool set_link_vfunc(int, ValueNode::Handle) override { return false; }
+	virtual ValueNode::LooseHandle get_link_vfunc(int) const override { return nullptr; }
+	virtual Vocab get_children_vocab_vfunc() const override { return Vocab(); }
+};
+
+static void
+test_linkable_is_not_constant_by_default()
+{
+	ValueNode::Handle node(new ValueNode_Opaque());
+	Time begin, end;
+	ASSERT_FALSE(node->get_constant_interval(Time(1), begin, end));
+	ASSERT_FALSE(node->is_time_invariant());
+}
+
+static void
+test_linear_is_not_constant()
+{
+	ValueNode::Handle linear = ValueNode_Linear::create(Real(2.0));
+	Time begin, end;
+	ASSERT_FALSE(linear->get_constant_interval(Time(1), begin, end));
+	ASSERT_FALSE(linear->is_time_invariant());
+}
+
+static void
+test_linkable_is_not_constant_if_any_link_is_not()
+{
+	ValueNode_Add::Handle add = ValueNode_Add::create(Real(2.0));
+	add->set_link("rhs", ValueNode_Linear::create(Real(1.0)));
+	Time begin, end;
+	ASSERT_FALSE(add->get_constant_interval(Time(1), begin, end));
+}
+
+static void
+test_animated_with_single_waypoint_is_time_invariant()
+{
+	ValueNode::Handle animated = ValueNode_Animated::create(ValueBase(Real(1.0)), Time(1));
+	ASSERT(animated->is_time_invariant());
+}
+
+static void
+test_animated_is_constant_before_first_waypoint()
+{
+	ValueNode::Handle animated = create_animated_real();
+	Time begin, end;
+	ASSERT(animated->get_constant_interval(Time(0.5), begin, end));
+	ASSERT(begin == Time::begin());
+	ASSERT(end == Time(1));
+}
+
+static void
+test_animated_is_constant_after_last_waypoint()
+{
+	ValueNode::Handle animated = create_animated_real();
+	Time begin, end;
+	ASSERT(animated->get_constant_interval(Time(5), begin, end));
+	ASSERT(begin == Time(2));
+	ASSERT(end == Time::end());
+}
+
+static void
+test_animated_is_not_constant_between_waypoints()
+{
+	ValueNode::Handle animated = create_animated_real();
+	Time begin, end;
+	ASSERT_FALSE(animated->get_constant_interval(Time(1.5), begin, end));
+	ASSERT_FALSE(animated->is_time_invariant());
+}
+
+static void
+test_linkable_intersects_intervals_of_links()
+{
+	ValueNode_Add::Handle add = ValueNode_Add::create(Real(2.0));
+	add->set_link("lhs", create_animated_real());
+	Time begin, end;
+	ASSERT(add->get_constant_interval(Time(3), begin, end));
+	ASSERT(begin == Time(2));
+	ASSERT(end == Time::end());
+}
+
+static void
+test_timeloop_of_animated_is_not_constant()
+{
+	ValueNode::Handle loop = ValueNode_TimeLoop::create(ValueBase(Real(1.0)));
+	ASSERT(loop->is_time_invariant());
+
+	ValueNode_TimeLoop::Handle animated_loop = ValueNode_TimeLoop::create(ValueBase(Real(1.0)));
+	animated_loop->set_link("link", create_animated_real());
+	Time begin, end;
+	ASSERT_FALSE(animated_loop->get_constant_interval(Time(5), begin, end));
+}
+
+static ValueNode_BoneLink::Handle
+create_link_to_child_of_animated_bone()
+{
+	// the parent bone rotates between 1s and 2s, the child bone itself is static
+	ValueNode_Bone::Handle parent = ValueNode_Bone::create(Bone());
+	ValueNode_Animated::Handle angle = ValueNode_Animated::create(ValueBase(Angle::deg(0.0)), Time(1));
+	angle->new_waypoint(Time(2), ValueBase(Angle::deg(90.0)));
+	angle->changed();
+	parent->set_link("angle", angle);
+
+	ValueNode_Bone::Handle child = ValueNode_Bone::create(Bone());
+	child->set_link("parent", ValueNode_Const::create(ValueBase(parent)));
+
+	// bone references are loaded from files as constants
+	ValueNode_BoneLink::Handle link = ValueNode_BoneLink::create(ValueBase(Vector(1.0, 0.0)));
+	link->set_link("bone", ValueNode_Const::create(ValueBase(child)));
+	return link;
+}
+
+static void
+test_const_bone_reference_is_not_constant()
+{
+	ValueNode_Bone::Handle bone = ValueNode_Bone::create(Bone());
+	ValueNode::Handle node = ValueNode_Const::create(ValueBase(bone));
+	Time begin, end;
+	ASSERT_FALSE(node->get_constant_interval(Time(0), begin, end));
+}
+
+static void
+test_bone_link_follows_animated_parent_bone()
+{
+	ValueNode_BoneLink::Handle link = create_link_to_child_of_animated_bone();
+	Time begin, end;
+	ASSERT_FALSE(link->get_constant_interval(Time(1.5), begin, end));
+	ASSERT(link->get_constant_interval(Time(3), begin, end));
+	ASSERT(begin == Time(2));
+	ASSERT(end == Time::end());
+}
+
+static void
+test_layer_param_linked_to_animated_parent_bone_changes()
+{
+	Canvas::Handle canvas = Canvas::create();
+	ValueNode_BoneLink::Handle link = create_link_to_child_of_animated_bone();
+	Layer::Handle layer = Layer::create("polygon");
+	ASSERT(layer);
+	layer->connect_dynamic_param("origin", ValueNode::LooseHandle(link));
+	canvas->push_back(layer);
+
+	std::vector<Vector> origins;
+	const Time times[] = { Time(0.5), Time(1.25), Time(1.5), Time(1.75), Time(3) };
+	for(const Time &time : times) {
+		canvas->set_time(time);
+		const Vector origin = layer->get_param("origin").get(Vector());
+		ASSERT_VECTOR_APPROX_EQUAL_MICRO((*link)(time).get(Vector()), origin);
+		origins.push_back(origin);
+	}
+	for(size_t i = 1; i < origins.size(); ++i)
+		ASSERT((origins[i] - origins[i-1]).mag() > 1e-6);
+}
+
+/* === E N T R Y P O I N T ================================================= */
+
+int main()
+{
+	Type::subsys_init();
+	Layer::subsys_init();
+
+	TEST_SUITE_BEGIN()
+		TEST_FUNCTION(test_const_is_time_invariant);
+		TEST_FUNCTION(test_linkable_of_consts_is_time_invariant);
+		TEST_FUNCTION(test_linkable_is_not_constant_by_default);
+		TEST_FUNCTION(test_linear_is_not_constant);
+		TEST_FUNCTION(test_linkable_is_not_constant_if_any_link_is_not);
+		TEST_FUNCTION(test_animated_with_single_waypoint_is_time_invariant);
+		TEST_FUNCTION(test_animated_is_constant_before_first_waypoint);
+		TEST_FUNCTION(test_animated_is_constant_after_last_waypoint);
+		TEST_FUNCTION(test_animated_is_not_constant_between_waypoints);
+		TEST_FUNCTION(test_linkable_intersects_intervals_of_links);
+		TEST_FUNCTION(test_timeloop_of_animated_is_not_constant);
+		TEST_FUNCTION(test_const_bone_reference_is_not_constant);
+		TEST_FUNCTION(test_bone_link_follows_animated_parent_bone);
+		TEST_FUNCTION(test_layer_param_linked_to_animated_parent_bone_changes);
+	TEST_SUITE_END()
+
+	return tst_exit_status;
+}
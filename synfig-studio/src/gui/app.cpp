@@ -38,6 +38,7 @@
 #	include <config.h>
 #endif
 
+#include <algorithm>
 #include <fstream>
 #include <iostream>
 
@@ -281,6 +282,9 @@ String studio::App::image_editor_path;
 
 String studio::App::sequence_separator(".");
 int    studio::App::number_of_threads = std::thread::hardware_concurrency();
+int    studio::App::frame_cache_memory_size = 512;
+int    studio::App::frame_cache_packed_size = 256;
+int    studio::App::frame_cache_file_size   = 1024;
 String studio::App::navigator_renderer;
 String studio::App::workarea_renderer;
 
@@ -557,6 +561,21 @@ public:
 				value=strprintf("%i",App::number_of_threads);
 				return true;
 			}
+			if(key=="frame_cache_memory_size")
+			{
+				value=strprintf("%i",App::frame_cache_memory_size);
+				return true;
+			}
+			if(key=="frame_cache_packed_size")
+			{
+				value=strprintf("%i",App::frame_cache_packed_size);
+				return true;
+			}
+			if(key=="frame_cache_file_size")
+			{
+				value=strprintf("%i",App::frame_cache_file_size);
+				return true;
+			}
 			if(key=="navigator_renderer")
 			{
 				value=App::navigator_renderer;
@@ -770,6 +789,22 @@ public:
 				App::number_of_threads=atoi(value.c_str());
 				return true;
 			}
+			if(key=="frame_cache_memory_size")
+			{
+				// the same minimum as in the setup dialog, zero would disable the cache
+				App::frame_cache_memory_size=std::max(64, atoi(value.c_str()));
+				return true;
+			}
+			if(key=="frame_cache_packed_size")
+			{
+				App::frame_cache_packed_size=atoi(value.c_str());
+				return true;
+			}
+			if(key=="frame_cache_file_size")
+			{
+				App::frame_cache_file_size=atoi(value.c_str());
+				return true;
+			}
 			if(key=="navigator_renderer")
 			{
 				App::navigator_renderer=value;
@@ -885,6 +920,9 @@ public:
 		ret.push_back("predefined_fps");
 		ret.push_back("sequence_separator");
 		ret.push_back("number_of_threads");
+		ret.push_back("frame_cache_memory_size");
+		ret.push_back("frame_cache_packed_size");
+		ret.push_back("frame_cache_file_size");
 		ret.push_back("navigator_renderer");
 		ret.push_back("workarea_renderer");
 		ret.push_back("default_background_layer_type");
@@ -231,6 +231,9 @@ public:
 	static synfig::String navigator_renderer;
 	static synfig::String workarea_renderer;
 	static int number_of_threads;
+	static int frame_cache_memory_size; //!< in megabytes
+	static int frame_cache_packed_size;
+	static int frame_cache_file_size;
 	static bool enable_mainwin_menubar;
 	static bool enable_mainwin_toolbar;
 	static synfig::String ui_language;
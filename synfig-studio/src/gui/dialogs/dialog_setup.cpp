@@ -96,6 +96,9 @@ Dialog_Setup::Dialog_Setup(Gtk::Window& parent):
 	adj_number_of_threads(Gtk::Adjustment::create(App::number_of_threads,2,std::thread::hardware_concurrency(),1,10,0)),
 	adj_preview_quality(Gtk::Adjustment::create(0.5,0.1,5.0,0.1,0.2,0)),
 	adj_preview_fps(Gtk::Adjustment::create(12,1,120,1,5,0)),
+	adj_frame_cache_memory_size(Gtk::Adjustment::create(512,64,65536,64,256,0)),
+	adj_frame_cache_packed_size(Gtk::Adjustment::create(256,0,65536,64,256,0)),
+	adj_frame_cache_file_size(Gtk::Adjustment::create(1024,0,65536,64,256,0)),
 	pref_modification_flag(false),
 	refreshing(false)
 {
@@ -781,6 +784,26 @@ Dialog_Setup::create_render_page(PageInfo pi)
 	pi.grid->attach(preview_zoom_level_combo, 1, row, 1, 1);
 	preview_zoom_level_combo.set_hexpand(true);
 
+	// Render - Frame cache of the workarea, frames which don't fit in memory
+	// are compressed, and then moved to the scratch file
+	attach_label_section(pi.grid, _("Frame cache"), ++row);
+	attach_label(pi.grid, _("Memory (MB)"), ++row);
+	Gtk::SpinButton *frame_cache_memory_size_spinbutton = Gtk::manage(new Gtk::SpinButton(adj_frame_cache_memory_size, 64, 0));
+	frame_cache_memory_size_spinbutton->set_tooltip_text(_("Memory for the rendered frames"));
+	pi.grid->attach(*frame_cache_memory_size_spinbutton, 1, row, 1, 1);
+	frame_cache_memory_size_spinbutton->set_hexpand(true);
+
+	attach_label(pi.grid, _("Compressed in memory (MB)"), ++row);
+	Gtk::SpinButton *frame_cache_packed_size_spinbutton = Gtk::manage(new Gtk::SpinButton(adj_frame_cache_packed_size, 64, 0));
+	frame_cache_packed_size_spinbutton->set_tooltip_text(_("Memory for the compressed frames which don't fit in the memory above"));
+	pi.grid->attach(*frame_cache_packed_size_spinbutton, 1, row, 1, 1);
+	frame_cache_packed_size_spinbutton->set_hexpand(true);
+
+	attach_label(pi.grid, _("Scratch file (MB)"), ++row);
+	Gtk::SpinButton *frame_cache_file_size_spinbutton = Gtk::manage(new Gtk::SpinButton(adj_frame_cache_file_size, 64, 0));
+	frame_cache_file_size_spinbutton->set_tooltip_text(_("Space in the temporary directory for the compressed frames, zero disables the scratch file"));
+	pi.grid->attach(*frame_cache_file_size_spinbutton, 1, row, 1, 1);
+	frame_cache_file_size_spinbutton->set_hexpand(true);
 }
 
 void
@@ -976,6 +999,9 @@ Dialog_Setup::on_restore_pressed()
 		adj_preview_quality->set_value(0.5);
 		adj_preview_fps->set_value(12);
 		preview_zoom_level_combo.set_active_id("fit");
+		adj_frame_cache_memory_size->set_value(512);
+		adj_frame_cache_packed_size->set_value(256);
+		adj_frame_cache_file_size->set_value(1024);
 		fcbutton_image.unselect_all();
 		
 		toggle_play_sound_on_render_done.set_active(true);
@@ -1143,6 +1169,11 @@ Dialog_Setup::on_apply_pressed()
 	if (App::preview_zoom_level.empty())
 		App::preview_zoom_level = "fit";
 
+	// Set the frame cache limits
+	App::frame_cache_memory_size = int(adj_frame_cache_memory_size->get_value());
+	App::frame_cache_packed_size = int(adj_frame_cache_packed_size->get_value());
+	App::frame_cache_file_size   = int(adj_frame_cache_file_size->get_value());
+
 	// Set ui language
 	if (pref_modification_flag & CHANGE_UI_LANGUAGE)
 		App::ui_language = ui_language_combo.get_active_id().c_str();
@@ -1390,6 +1421,11 @@ Dialog_Setup::refresh()
 		preview_zoom_level_combo.set_active_id("fit");
 	on_enable_preview_defaults_changed();
 
+	// Refresh the frame cache limits
+	adj_frame_cache_memory_size->set_value(App::frame_cache_memory_size);
+	adj_frame_cache_packed_size->set_value(App::frame_cache_packed_size);
+	adj_frame_cache_file_size->set_value(App::frame_cache_file_size);
+
 	// Refresh the status of file toolbar flag
 	toggle_show_file_toolbar.set_active(App::show_file_toolbar);
 
@@ -183,6 +183,9 @@ class Dialog_Setup : public Dialog_Template
 	Gtk::Switch       toggle_play_sound_on_render_done;
 	Glib::RefPtr<Gtk::Adjustment> adj_number_of_threads;
 	Gtk::SpinButton*  number_of_threads_select;	
+	Glib::RefPtr<Gtk::Adjustment> adj_frame_cache_memory_size;
+	Glib::RefPtr<Gtk::Adjustment> adj_frame_cache_packed_size;
+	Glib::RefPtr<Gtk::Adjustment> adj_frame_cache_file_size;
 
 	Gtk::Switch toggle_handle_tooltip_widthpoint;
 	Gtk::Switch toggle_handle_tooltip_radius;
@@ -2162,6 +2162,21 @@ studio::WorkArea::queue_render(bool refresh)
 	}, *this));
 }
 
+void
+studio::WorkArea::queue_render_changes()
+{
+	assert(dirty_trap_count >= 0);
+	if (dirty_trap_count > 0)
+		{ dirty_trap_queued++; return; }
+	dirty_trap_queued = 0;
+	Glib::signal_idle().connect_once(sigc::track_obj([=] () {
+		renderer_canvas->invalidate_changes();
+		Glib::signal_idle().connect_once(
+					sigc::mem_fun(*renderer_canvas, &Renderer_Canvas::enqueue_render),
+					Glib::PRIORITY_DEFAULT );
+	}, *this));
+}
+
 void
 studio::WorkArea::set_cursor(const Glib::RefPtr<Gdk::Cursor> &x)
 {
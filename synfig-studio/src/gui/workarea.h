@@ -454,6 +454,10 @@ public:
 	//! initiate background rendering of canvas
 	void queue_render(bool refresh = true);
 
+	//! initiate background rendering of canvas,
+	//! only tiles touched by changed layers will be rerendered
+	void queue_render_changes();
+
 	void zoom_in();
 	void zoom_out();
 	void zoom_fit();
@@ -35,14 +35,23 @@
 #	include <config.h>
 #endif
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <cstring>
 #include <valarray>
 
 #include <synfig/general.h>
+#include <synfig/clock.h>
 #include <synfig/context.h>
+#include <synfig/filesystemnative.h>
+#include <synfig/filesystemtemporary.h>
 #include <synfig/threadpool.h>
+#include <synfig/layers/layer_filtergroup.h>
+#include <synfig/layers/layer_pastecanvas.h>
 #include <synfig/rendering/renderer.h>
 #include <synfig/rendering/common/task/tasktransformation.h>
+#include <synfig/zstreambuf.h>
 
 #include <gui/app.h>
 #include <gui/canvasview.h>
@@ -67,6 +76,8 @@ using namespace studio;
 
 /* === G L O B A L S ======================================================= */
 
+static const int tile_grid_step = 64;
+
 /* === P R O C E D U R E S ================================================= */
 
 static int
@@ -81,11 +92,65 @@ static long long
 image_rect_size(const RectInt &rect)
 	{ return 4ll*rect.get_width()*rect.get_height(); }
 
+//! fseek() takes long, which is 32-bit on Windows and 32-bit systems,
+//! but the scratch file may be larger than 2 GB
+static bool
+seek_file(FILE *file, long long offset)
+{
+#ifdef _WIN32
+	return !_fseeki64(file, offset, SEEK_SET);
+#else
+	if ((long long)(off_t)offset != offset)
+		return false;
+	return !fseeko(file, (off_t)offset, SEEK_SET);
+#endif
+}
+
+//! converts canvas coordinates to pixels of the frame and snaps result to tile grid
+static RectInt
+canvas_rect_to_frame(const Rect &rect, const RendDesc &rend_desc, int width, int height)
+{
+	const Vector tl = rend_desc.get_tl();
+	const Vector br = rend_desc.get_br();
+	Real x0 = (rect.minx - tl[0])*width/(br[0] - tl[0]);
+	Real x1 = (rect.maxx - tl[0])*width/(br[0] - tl[0]);
+	Real y0 = (rect.miny - tl[1])*height/(br[1] - tl[1]);
+	Real y1 = (rect.maxy - tl[1])*height/(br[1] - tl[1]);
+	if (x1 < x0) std::swap(x0, x1);
+	if (y1 < y0) std::swap(y0, y1);
+
+	// keep one extra pixel for antialiasing, and clamp before conversion to int
+	const Real min = -tile_grid_step, maxx = width + tile_grid_step, maxy = height + tile_grid_step;
+	return RectInt(
+		int_floor((int)std::floor(std::max(min, std::min(maxx, x0))) - 1, tile_grid_step),
+		int_floor((int)std::floor(std::max(min, std::min(maxy, y0))) - 1, tile_grid_step),
+		int_ceil ((int)std::ceil (std::max(min, std::min(maxx, x1))) + 1, tile_grid_step),
+		int_ceil ((int)std::ceil (std::max(min, std::min(maxy, y1))) + 1, tile_grid_step) );
+}
+
+static Cairo::RefPtr<Cairo::ImageSurface>
+copy_surface_part(const Cairo::RefPtr<Cairo::ImageSurface> &surface, const RectInt &rect)
+{
+	Cairo::RefPtr<Cairo::ImageSurface> part =
+		Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, rect.get_width(), rect.get_height());
+	surface->flush();
+	part->flush();
+	const unsigned char *src = surface->get_data() + rect.miny*surface->get_stride() + 4*rect.minx;
+	unsigned char *dst = part->get_data();
+	for(int i = 0; i < rect.get_height(); ++i, src += surface->get_stride(), dst += part->get_stride())
+		memcpy(dst, src, 4*rect.get_width());
+	part->mark_dirty();
+	part->flush();
+	return part;
+}
+
 /* === M E T H O D S ======================================================= */
 
 Renderer_Canvas::Renderer_Canvas():
-	max_tiles_size_soft(512*1024*1024),
-	max_tiles_size_hard(max_tiles_size_soft + 128*1024*1024),
+	max_tiles_size_soft(),
+	max_tiles_size_hard(),
+	max_packed_size(),
+	max_file_size(),
 	weight_future      (   1.0), // high priority
 	weight_past        (   2.0), // low priority
 	weight_future_extra(  16.0),
@@ -95,7 +160,14 @@ Renderer_Canvas::Renderer_Canvas():
 	max_enqueued_tasks (6),
 	enqueued_tasks(),
 	tiles_size(),
-	pixel_format()
+	packed_tiles_size(),
+	file_tiles_size(),
+	packing_size(),
+	packed_source_total(),
+	packed_result_total(),
+	pixel_format(),
+	changes_unknown(),
+	snapshot_valid()
 {
 	// check endianness
     union { int i; char c[4]; } checker = {0x01020304};
@@ -118,10 +190,112 @@ Renderer_Canvas::Renderer_Canvas():
 	alpha_src_surface->flush();
 
 	alpha_context = Cairo::Context::create(alpha_dst_surface);
+
+	update_cache_limits();
 }
 
 Renderer_Canvas::~Renderer_Canvas()
-	{ clear_render(); }
+{
+	if (DEBUG_GETENV("SYNFIG_DEBUG_FRAME_CACHE")) {
+		CacheStatistics s;
+		get_cache_statistics(s);
+		synfig::info(
+			"Renderer_Canvas: frame cache hit rate %.1f%% of %lld frames, "
+			"hits memory/packed/file %lld/%lld/%lld, restore time packed %.2f ms, file %.2f ms",
+			100.0*s.get_hit_rate(), s.get_lookups(),
+			s.hits[CT_Memory], s.hits[CT_Packed], s.hits[CT_File],
+			1000.0*s.get_average_restore_time(CT_Packed),
+			1000.0*s.get_average_restore_time(CT_File) );
+	}
+	canvas_child_changed_connection.disconnect();
+	clear_render();
+}
+
+long long
+Renderer_Canvas::ScratchFile::write(const void *data, long long size)
+{
+	if (!file) {
+		filename = FileSystemTemporary::generate_system_temporary_filename("framecache", ".bin");
+		file = SmartFILE(filename, "w+b");
+		if (!file) {
+			error("Renderer_Canvas: cannot create scratch file %s", filename.u8_str());
+			filename = filesystem::Path();
+			return -1;
+		}
+		end = 0;
+		free_extents.clear();
+	}
+
+	// take the first free extent which is large enough
+	long long offset = end;
+	for(std::map<long long, long long>::iterator i = free_extents.begin(); i != free_extents.end(); ++i)
+		if (i->second >= size) {
+			offset = i->first;
+			if (i->second > size)
+				free_extents[offset + size] = i->second - size;
+			free_extents.erase(i);
+			break;
+		}
+
+	if ( !seek_file(file.get(), offset)
+	  || fwrite(data, 1, (size_t)size, file.get()) != (size_t)size )
+	{
+		error("Renderer_Canvas: cannot write to scratch file %s", filename.u8_str());
+		if (offset < end) release(offset, size);
+		return -1;
+	}
+
+	end = std::max(end, offset + size);
+	return offset;
+}
+
+bool
+Renderer_Canvas::ScratchFile::read(long long offset, void *data, long long size)
+{
+	if ( !file
+	  || !seek_file(file.get(), offset)
+	  || fread(data, 1, (size_t)size, file.get()) != (size_t)size )
+	{
+		error("Renderer_Canvas: cannot read from scratch file %s", filename.u8_str());
+		return false;
+	}
+	return true;
+}
+
+void
+Renderer_Canvas::ScratchFile::release(long long offset, long long size)
+{
+	// merge with the neighbour free extents
+	std::map<long long, long long>::iterator next = free_extents.lower_bound(offset);
+	if (next != free_extents.begin()) {
+		std::map<long long, long long>::iterator prev = next; --prev;
+		if (prev->first + prev->second == offset) {
+			offset = prev->first;
+			size += prev->second;
+			free_extents.erase(prev);
+		}
+	}
+	if (next != free_extents.end() && offset + size == next->first) {
+		size += next->second;
+		free_extents.erase(next);
+	}
+
+	if (offset + size >= end)
+		end = offset;
+	else
+		free_extents[offset] = size;
+}
+
+void
+Renderer_Canvas::ScratchFile::close()
+{
+	if (!file) return;
+	file.reset();
+	FileSystemNative::instance()->file_remove(filename.u8string());
+	filename = filesystem::Path();
+	end = 0;
+	free_extents.clear();
+}
 
 void
 Renderer_Canvas::on_tile_finished_callback(bool success, Renderer_Canvas *obj, Tile::Handle tile)
@@ -142,6 +316,97 @@ Renderer_Canvas::on_post_tile_finished_callback(etl::handle<Renderer_Canvas> obj
 		obj->on_post_tile_finished(tile);
 }
 
+void
+Renderer_Canvas::pack_tile_callback(etl::handle<Renderer_Canvas> obj, Tile::Handle tile)
+{
+	// this function is called by the ThreadPool
+	obj->pack_tile(tile);
+	Glib::signal_idle().connect_once(
+		sigc::bind(sigc::ptr_fun(&on_tile_moved_callback), obj, false) );
+}
+
+void
+Renderer_Canvas::restore_tile_callback(etl::handle<Renderer_Canvas> obj, Tile::Handle tile)
+{
+	// this function is called by the ThreadPool
+	obj->restore_tile(tile);
+	Glib::signal_idle().connect_once(
+		sigc::bind(sigc::ptr_fun(&on_tile_moved_callback), obj, true) );
+}
+
+void
+Renderer_Canvas::on_tile_moved_callback(etl::handle<Renderer_Canvas> obj, bool redraw)
+{
+	// this function should be called in main thread,
+	// so the last Handle of 'obj' is never released by the ThreadPool
+	if (redraw && obj->get_work_area())
+		obj->get_work_area()->queue_draw();
+}
+
+void
+Renderer_Canvas::on_canvas_child_changed(const Node *node)
+{
+	// changes of nested layers come here as changes of their top-level groups
+	if (const Layer *layer = dynamic_cast<const Layer*>(node))
+		changed_layers.insert(layer);
+	else
+		changes_unknown = true;
+}
+
+void
+Renderer_Canvas::track_canvas(const Canvas::Handle &canvas)
+{
+	if (tracked_canvas.get() == canvas.get())
+		return;
+
+	canvas_child_changed_connection.disconnect();
+	reset_changes();
+	tracked_canvas = canvas;
+
+	// canvas signals are emitted from the main thread
+	if (canvas)
+		canvas_child_changed_connection = canvas->signal_child_changed().connect(
+			sigc::mem_fun(*this, &Renderer_Canvas::on_canvas_child_changed) );
+}
+
+void
+Renderer_Canvas::reset_changes()
+{
+	changed_layers.clear();
+	changes_unknown = false;
+	snapshot_valid = false;
+	snapshot.clear();
+}
+
+void
+Renderer_Canvas::get_layers_bounds(const Canvas &canvas, LayerBoundsList &out_list)
+{
+	// canvas time should be already set
+	ContextParams context_params(true);
+	out_list.clear();
+	out_list.reserve(canvas.size());
+	for(Canvas::const_iterator i = canvas.begin(); i != canvas.end(); ++i) {
+		out_list.push_back(LayerBounds());
+		LayerBounds &bounds = out_list.back();
+		bounds.layer = i->get();
+
+		// layer is local if it blends only own pixels onto the context,
+		// filters and distortions change the context itself
+		const Layer_Composite *composite = dynamic_cast<const Layer_Composite*>(bounds.layer);
+		if ( !composite
+		  || !dynamic_cast<const Layer_NoDeform*>(bounds.layer)
+		  || dynamic_cast<const Layer_FilterGroup*>(bounds.layer)
+		  || Color::is_straight(composite->get_blend_method()) )
+			continue;
+
+		const Layer_PasteCanvas *paste_canvas = dynamic_cast<const Layer_PasteCanvas*>(bounds.layer);
+		bounds.rect = paste_canvas
+		            ? paste_canvas->get_bounding_rect_context_dependent(context_params)
+		            : bounds.layer->get_bounding_rect();
+		bounds.local = true;
+	}
+}
+
 Cairo::RefPtr<Cairo::ImageSurface>
 Renderer_Canvas::convert(
 	const rendering::SurfaceResource::Handle &surface,
@@ -296,13 +561,247 @@ Renderer_Canvas::erase_tile(TileList &list, TileList::iterator i, rendering::Tas
 	// this method may be called from other threads
 	// mutex must be already locked
 	if ((*i)->event) events.push_back((*i)->event);
-	tiles_size -= image_rect_size((*i)->rect);
+	release_tile_storage(**i);
 	(*i)->event.reset();
 	(*i)->surface.reset();
 	(*i)->cairo_surface = Cairo::RefPtr<Cairo::ImageSurface>();
 	return list.erase(i);
 }
 
+void
+Renderer_Canvas::release_tile_storage(Tile &tile)
+{
+	// mutex must be already locked
+	switch(tile.tier) {
+	case CT_Memory:
+		tiles_size -= image_rect_size(tile.rect);
+		if (tile.moving)
+			packing_size -= image_rect_size(tile.rect);
+		break;
+	case CT_Packed:
+		packed_tiles_size -= (long long)tile.packed.size();
+		break;
+	case CT_File:
+		scratch_file.release(tile.file_offset, tile.file_size);
+		file_tiles_size -= tile.file_size;
+		break;
+	}
+	std::vector<char>().swap(tile.packed);
+	tile.file_offset = 0;
+	tile.file_size = 0;
+	tile.tier = CT_Memory;
+	tile.moving = false;
+}
+
+void
+Renderer_Canvas::enqueue_pack_tile(const Tile::Handle &tile)
+{
+	// mutex must be already locked
+	assert(tile->tier == CT_Memory && tile->cairo_surface && !tile->event && !tile->moving);
+	tile->moving = true;
+	packing_size += image_rect_size(tile->rect);
+	tile->cairo_surface->flush();
+	ThreadPool::instance().enqueue(
+		sigc::bind(sigc::ptr_fun(&pack_tile_callback), etl::handle<Renderer_Canvas>(this), tile),
+		ThreadPool::PRIORITY_IO );
+}
+
+void
+Renderer_Canvas::pack_tile(const Tile::Handle &tile)
+{
+	// this method may be called from other threads
+	// done surface is not changed anymore, so it is packed without the mutex
+	Cairo::RefPtr<Cairo::ImageSurface> surface;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!tile->moving || tile->tier != CT_Memory)
+			return; // tile is already removed
+		surface = tile->cairo_surface;
+	}
+
+	// fast zlib mode, gzip header is a bit longer than zlib one
+	const size_t size = (size_t)surface->get_stride()*surface->get_height();
+	std::vector<char> packed(compressBound(size) + 64);
+	const size_t packed_size = zstreambuf::pack(&packed.front(), packed.size(), surface->get_data(), size, true);
+	packed.resize(packed_size);
+	packed.shrink_to_fit();
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!tile->moving || tile->tier != CT_Memory || tile->cairo_surface != surface)
+		return; // tile is already removed
+	tile->moving = false;
+	packing_size -= image_rect_size(tile->rect);
+
+	// keep the tile in memory if the frame became visible again
+	if (!packed_size || visible_frames.count(tile->frame_id))
+		return;
+
+	tiles_size -= image_rect_size(tile->rect);
+	packed_tiles_size += (long long)packed_size;
+	packed_source_total += (long long)size;
+	packed_result_total += (long long)packed_size;
+
+	tile->packed.swap(packed);
+	tile->cairo_surface = Cairo::RefPtr<Cairo::ImageSurface>();
+	tile->tier = CT_Packed;
+}
+
+bool
+Renderer_Canvas::spill_tile(Tile &tile)
+{
+	// mutex must be already locked
+	assert(tile.tier == CT_Packed && !tile.packed.empty());
+
+	const long long size = (long long)tile.packed.size();
+	const long long offset = scratch_file.write(&tile.packed.front(), size);
+	if (offset < 0)
+		return false;
+
+	packed_tiles_size -= size;
+	file_tiles_size += size;
+
+	std::vector<char>().swap(tile.packed);
+	tile.file_offset = offset;
+	tile.file_size = size;
+	tile.tier = CT_File;
+	return true;
+}
+
+void
+Renderer_Canvas::restore_tile(const Tile::Handle &tile)
+{
+	// this method may be called from other threads
+	// compressed data is taken under the mutex, but unpacked without it
+	synfig::clock timer;
+	CacheTier tier;
+	std::vector<char> packed;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!tile->moving || tile->tier == CT_Memory)
+			return; // tile is already removed
+		tier = tile->tier;
+		if (tier == CT_Packed) {
+			packed = tile->packed;
+		} else {
+			packed.resize(tile->file_size);
+			if (!scratch_file.read(tile->file_offset, &packed.front(), tile->file_size))
+				packed.clear();
+		}
+	}
+
+	Cairo::RefPtr<Cairo::ImageSurface> surface;
+	if (!packed.empty()) {
+		surface = Cairo::ImageSurface::create(Cairo::FORMAT_ARGB32, tile->rect.get_width(), tile->rect.get_height());
+		surface->flush();
+		const size_t size = (size_t)surface->get_stride()*surface->get_height();
+		if (zstreambuf::unpack(surface->get_data(), size, &packed.front(), packed.size()) == size) {
+			surface->mark_dirty();
+			surface->flush();
+		} else {
+			error("Renderer_Canvas::restore_tile: cannot unpack tile");
+			surface = Cairo::RefPtr<Cairo::ImageSurface>();
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(mutex);
+	if (!tile->moving || tile->tier != tier)
+		return; // tile is already removed
+
+	if (!surface) {
+		// tile will be rendered again
+		TileMap::iterator i = tiles.find(tile->frame_id);
+		if (i != tiles.end()) {
+			TileList::iterator j = std::find(i->second.begin(), i->second.end(), tile);
+			rendering::Task::List events; // stays empty, packed tiles have no events
+			if (j != i->second.end())
+				erase_tile(i->second, j, events);
+		}
+		return;
+	}
+
+	release_tile_storage(*tile);
+	tile->cairo_surface = surface;
+	tiles_size += image_rect_size(tile->rect);
+	statistics.restore_time[tier] += timer();
+}
+
+Renderer_Canvas::CacheTier
+Renderer_Canvas::restore_tiles(const FrameId &id)
+{
+	// mutex must be already locked
+	CacheTier lowest = CT_Memory;
+	TileMap::iterator i = tiles.find(id);
+	if (i == tiles.end())
+		return lowest;
+
+	for(TileList::iterator j = i->second.begin(); j != i->second.end(); ++j) {
+		if (!*j || (*j)->tier == CT_Memory)
+			continue;
+		lowest = std::max(lowest, (*j)->tier);
+		if ((*j)->moving || !shared_object::use_count())
+			continue;
+		(*j)->moving = true;
+		ThreadPool::instance().enqueue(
+			sigc::bind(sigc::ptr_fun(&restore_tile_callback), etl::handle<Renderer_Canvas>(this), *j),
+			ThreadPool::PRIORITY_RENDER );
+	}
+
+	return lowest;
+}
+
+void
+Renderer_Canvas::update_cache_limits()
+{
+	// mutex must be already locked
+	const long long megabyte = 1024*1024;
+	max_tiles_size_soft = std::max(0, App::frame_cache_memory_size)*megabyte;
+	max_tiles_size_hard = max_tiles_size_soft + max_tiles_size_soft/4;
+	max_packed_size     = std::max(0, App::frame_cache_packed_size)*megabyte;
+	max_file_size       = std::max(0, App::frame_cache_file_size)*megabyte;
+}
+
+bool
+Renderer_Canvas::has_cache_space(long long frame_size) const
+{
+	// mutex must be already locked
+	if (tiles_size + frame_size < max_tiles_size_soft)
+		return true;
+
+	// far frames will be packed, estimate their size by the tiles packed before
+	const long long packed_size = packed_source_total > 0
+	                            ? (long long)((Real)frame_size*(Real)packed_result_total/(Real)packed_source_total)
+	                            : frame_size/2;
+	return packed_tiles_size + packed_size < max_packed_size
+	    || file_tiles_size + packed_size < max_file_size;
+}
+
+void
+Renderer_Canvas::erase_tiles_in_rect(TileList &list, const RectInt &rect, rendering::Task::List &events)
+{
+	// mutex must be already locked
+	TileList parts;
+	for(TileList::iterator i = list.begin(); i != list.end(); ) {
+		if (!*i || !((*i)->rect && rect))
+			{ ++i; continue; }
+
+		// cut the rest of done tile into the new tiles, tiles in process will be cancelled
+		const Tile &tile = **i;
+		if (tile.cairo_surface) {
+			std::vector<RectInt> rects(1, tile.rect);
+			rects_subtract(rects, rect);
+			for(std::vector<RectInt>::iterator j = rects.begin(); j != rects.end(); ++j) {
+				Tile::Handle part = new Tile(tile.frame_id, *j);
+				part->cairo_surface = copy_surface_part(tile.cairo_surface, *j - tile.rect.get_min());
+				parts.push_back(part);
+			}
+		}
+		i = erase_tile(list, i, events);
+	}
+
+	for(TileList::const_iterator i = parts.begin(); i != parts.end(); ++i)
+		insert_tile(list, *i);
+}
+
 void
 Renderer_Canvas::remove_extra_tiles(rendering::Task::List &events)
 {
@@ -313,9 +812,13 @@ Renderer_Canvas::remove_extra_tiles(rendering::Task::List &events)
 
 	Real current_zoom = sqrt((Real)(current_frame.width * current_frame.height));
 
+	const bool overflow = tiles_size > max_tiles_size_hard
+	                   || packed_tiles_size > max_packed_size
+	                   || file_tiles_size > max_file_size;
+
 	// calc weight
 	for(TileMap::iterator i = tiles.begin(); i != tiles.end(); ++i) {
-		if (!visible_frames.count(i->first) && tiles_size > max_tiles_size_hard) {
+		if (!visible_frames.count(i->first) && overflow) {
 			Real weight = 0.0;
 			if (frame_duration) {
 				Time dt = i->first.time - current_frame.time;
@@ -331,10 +834,42 @@ Renderer_Canvas::remove_extra_tiles(rendering::Task::List &events)
 		}
 	}
 
-	// remove some extra tiles to free the memory
-	for(WeightMap::reverse_iterator ri = sorted_frames.rbegin(); ri != sorted_frames.rend() && tiles_size > max_tiles_size_hard; ++ri)
-		while(!ri->second->second.empty() && tiles_size > max_tiles_size_hard)
-			erase_tile(ri->second->second, ri->second->second.begin(), events);
+	// move tiles of the far frames to the lower cache tiers to free the memory,
+	// remove tiles when the lower tiers are full too
+	// tiles are packed by the ThreadPool, the memory is freed when they are done
+	const bool can_pack = (max_packed_size > 0 || max_file_size > 0) && shared_object::use_count();
+	for(WeightMap::reverse_iterator ri = sorted_frames.rbegin(); ri != sorted_frames.rend() && tiles_size - packing_size > max_tiles_size_hard; ++ri) {
+		TileList &list = ri->second->second;
+		for(TileList::iterator j = list.begin(); j != list.end() && tiles_size - packing_size > max_tiles_size_hard; )
+			if (!*j || (*j)->tier != CT_Memory || (*j)->moving)
+				++j;
+			else
+			if (can_pack && (*j)->is_done())
+				{ enqueue_pack_tile(*j); ++j; }
+			else
+				j = erase_tile(list, j, events);
+	}
+
+	for(WeightMap::reverse_iterator ri = sorted_frames.rbegin(); ri != sorted_frames.rend() && packed_tiles_size > max_packed_size; ++ri) {
+		TileList &list = ri->second->second;
+		for(TileList::iterator j = list.begin(); j != list.end() && packed_tiles_size > max_packed_size; )
+			if (!*j || (*j)->tier != CT_Packed || (*j)->moving)
+				++j;
+			else
+			if (max_file_size > 0 && spill_tile(**j))
+				++j;
+			else
+				j = erase_tile(list, j, events);
+	}
+
+	for(WeightMap::reverse_iterator ri = sorted_frames.rbegin(); ri != sorted_frames.rend() && file_tiles_size > max_file_size; ++ri) {
+		TileList &list = ri->second->second;
+		for(TileList::iterator j = list.begin(); j != list.end() && file_tiles_size > max_file_size; )
+			if (!*j || (*j)->tier != CT_File)
+				++j;
+			else
+				j = erase_tile(list, j, events);
+	}
 
 	// remove empty entries from tiles map
 	for(TileMap::iterator i = tiles.begin(); i != tiles.end(); )
@@ -469,8 +1004,6 @@ Renderer_Canvas::enqueue_render_frame(
 {
 	// mutex must be already locked
 
-	const int tile_grid_step = 64;
-
 	RendDesc rend_desc = canvas->rend_desc();
 	int      w         = id.width;
 	int      h         = id.height;
@@ -599,6 +1132,24 @@ Renderer_Canvas::enqueue_render()
 		bool			is_bounded = time_model->get_play_bounds_enabled();
 
 		build_onion_frames();
+		update_cache_limits();
+
+		// bring visible frames back to memory and count cache hits,
+		// time of restoring is counted by restore_tile()
+		const bool cached = window_rect.is_valid() && calc_frame_status(current_frame, window_rect) == FS_Done;
+		CacheTier tier = CT_Memory;
+		for(FrameList::const_iterator i = onion_frames.begin(); i != onion_frames.end(); ++i)
+			tier = std::max(tier, restore_tiles(i->id));
+		if (App::animation_thumbnail_preview)
+			restore_tiles(current_thumb);
+		if (counted_frame != current_frame) {
+			counted_frame = current_frame;
+			if (cached) {
+				++statistics.hits[tier];
+			} else {
+				++statistics.misses;
+			}
+		}
 
 		rendering::Renderer::Handle renderer = rendering::Renderer::get_renderer(renderer_name);
 		
@@ -611,6 +1162,19 @@ Renderer_Canvas::enqueue_render()
 				Time orig_time = canvas->get_time();
 				int enqueued = 0;
 
+				// remember bounds of layers before the next changes
+				track_canvas(canvas);
+				if ( !is_playing
+				  && !changes_unknown
+				  && changed_layers.empty()
+				  && (!snapshot_valid || snapshot_time != current_frame.time) )
+				{
+					canvas->set_time(current_frame.time);
+					get_layers_bounds(*canvas, snapshot);
+					snapshot_time = current_frame.time;
+					snapshot_valid = true;
+				}
+
 				// generate rendering task for thumbnail
 				// do it first to be sure that thumbnails will always fully covered by the single tile
 				if (App::animation_thumbnail_preview)
@@ -631,7 +1195,7 @@ Renderer_Canvas::enqueue_render()
 				bool time_in_repeat_range = time_model->get_time() >= time_model->get_play_bounds_lower()
 						                 && time_model->get_time() <= time_model->get_play_bounds_upper();
 				
-				while(bg_rendering && enqueued_tasks < max_tasks && tiles_size + frame_size < max_tiles_size_soft)
+				while(bg_rendering && enqueued_tasks < max_tasks && has_cache_space(frame_size))
 				{
 					Time future_time = current_frame.time + frame_duration*future;
 					bool future_exists = future_time >= time_model->get_lower()
@@ -739,11 +1303,84 @@ Renderer_Canvas::clear_render()
 		tiles.clear();
 		rendering_error_msg_map.clear();
 	}
+	reset_changes();
 	rendering::Renderer::cancel(events);
 	if (cleared && get_work_area())
 		get_work_area()->signal_rendering()();
 }
 
+void
+Renderer_Canvas::invalidate_changes()
+{
+	assert(get_work_area());
+	Canvas::Handle canvas = get_work_area()->get_canvas();
+
+	bool found = canvas
+	          && canvas.get() == tracked_canvas.get()
+	          && snapshot_valid
+	          && !changes_unknown
+	          && !changed_layers.empty()
+	          && canvas->get_time() == snapshot_time;
+
+	// collect bounds of the changed layers before and after the changes,
+	// all layers above them should be local because they are blended onto changed area
+	LayerBoundsList layers;
+	Rect rect = Rect::zero();
+	if (found) {
+		canvas->set_time(snapshot_time); // apply changed values of animated params
+		get_layers_bounds(*canvas, layers);
+		found = layers.size() == snapshot.size();
+		for(size_t i = 0; found && i < layers.size(); ++i)
+			found = layers[i].layer == snapshot[i].layer;
+	}
+	if (found) {
+		size_t count = 0;
+		for(size_t i = 0; found && i < layers.size() && count < changed_layers.size(); ++i) {
+			found = layers[i].local && snapshot[i].local;
+			if (changed_layers.count(layers[i].layer)) {
+				rect |= snapshot[i].rect;
+				rect |= layers[i].rect;
+				++count;
+			}
+		}
+		found = found
+		     && count == changed_layers.size()
+		     && std::isfinite(rect.minx) && std::isfinite(rect.maxx)
+		     && std::isfinite(rect.miny) && std::isfinite(rect.maxy);
+	}
+
+	if (!found) {
+		clear_render();
+		return;
+	}
+
+	rendering::Task::List events;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		const RendDesc &rend_desc = canvas->rend_desc();
+		for(TileMap::iterator i = tiles.begin(); i != tiles.end(); ) {
+			if (i->first.time == snapshot_time) {
+				RectInt frame_rect = canvas_rect_to_frame(rect, rend_desc, i->first.width, i->first.height);
+				erase_tiles_in_rect(i->second, frame_rect & i->first.rect(), events);
+				++i;
+			} else {
+				// other frames may depend on the changed layers in any way
+				while(!i->second.empty()) {
+					TileList::iterator j = i->second.end(); --j;
+					erase_tile(i->second, j, events);
+				}
+				tiles.erase(i++);
+			}
+		}
+		rendering_error_msg_map.clear();
+	}
+	rendering::Renderer::cancel(events);
+
+	snapshot.swap(layers);
+	changed_layers.clear();
+	get_work_area()->signal_rendering()();
+}
+
 Renderer_Canvas::FrameStatus
 Renderer_Canvas::merge_status(FrameStatus a, FrameStatus b) {
 	static const FrameStatus map[FS_Count][FS_Count] = {
@@ -776,7 +1413,7 @@ Renderer_Canvas::calc_frame_status(const FrameId &id, const RectInt &window_rect
 		if (*j) {
 			if ((*j)->event)
 				return FS_InProcess;
-			if ((*j)->cairo_surface)
+			if ((*j)->is_done())
 				rects_subtract(rects, (*j)->rect);
 		}
 	rects_merge(rects);
@@ -788,6 +1425,16 @@ Renderer_Canvas::calc_frame_status(const FrameId &id, const RectInt &window_rect
 	return FS_PartiallyDone;
 }
 
+void
+Renderer_Canvas::get_cache_statistics(CacheStatistics &out_statistics)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	out_statistics = statistics;
+	out_statistics.size[CT_Memory] = tiles_size;
+	out_statistics.size[CT_Packed] = packed_tiles_size;
+	out_statistics.size[CT_File]   = file_tiles_size;
+}
+
 void
 Renderer_Canvas::get_render_status(StatusMap &out_map)
 {
@@ -1016,9 +1663,19 @@ Renderer_Canvas::render_vfunc(
 Cairo::RefPtr<Cairo::ImageSurface>
 Renderer_Canvas::get_thumb(const Time &time)
 {
+	// thumbnail is covered by a single tile, it is restored right here
+	Tile::Handle tile;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		TileMap::const_iterator i = tiles.find( current_thumb.with_time(time) );
+		if (i == tiles.end() || i->second.empty() || !*(i->second.begin()))
+			return Cairo::RefPtr<Cairo::ImageSurface>();
+		tile = *(i->second.begin());
+		if (tile->tier == CT_Memory || tile->moving)
+			return tile->cairo_surface;
+		tile->moving = true;
+	}
+	restore_tile(tile);
 	std::lock_guard<std::mutex> lock(mutex);
-	TileMap::const_iterator i = tiles.find( current_thumb.with_time(time) );
-	return i == tiles.end() || i->second.empty() || !*(i->second.begin())
-		 ? Cairo::RefPtr<Cairo::ImageSurface>()
-		 : (*(i->second.begin()))->cairo_surface;
+	return tile->cairo_surface;
 }
@@ -33,8 +33,11 @@
 
 #include <vector>
 #include <map>
+#include <set>
 
 #include <synfig/canvas.h>
+#include <synfig/filesystem_path.h>
+#include <synfig/smartfile.h>
 #include <synfig/rendering/task.h>
 #include <synfig/rendering/renderer.h>
 #include <synfig/time.h>
@@ -113,6 +116,14 @@ public:
 				id(time, width, height), alpha(alpha) { }
 	};
 
+	//! where the pixels of the done tile are stored
+	enum CacheTier {
+		CT_Memory,  //!< in cairo_surface, also for tiles in process
+		CT_Packed,  //!< compressed in memory
+		CT_File     //!< compressed in the scratch file
+	};
+	enum { CT_Count = CT_File + 1 };
+
 	class Tile: public etl::shared_object {
 	public:
 		typedef etl::handle<Tile> Handle;
@@ -124,9 +135,60 @@ public:
 		synfig::rendering::SurfaceResource::Handle surface;
 		Cairo::RefPtr<Cairo::ImageSurface> cairo_surface;
 
-		Tile() { }
+		CacheTier tier;
+		std::vector<char> packed;
+		long long file_offset;
+		long long file_size;
+		//! tile is being packed or restored by the ThreadPool
+		bool moving;
+
+		Tile(): tier(CT_Memory), file_offset(), file_size(), moving() { }
 		Tile(const FrameId &frame_id, synfig::RectInt &rect):
-			frame_id(frame_id), rect(rect) { }
+			frame_id(frame_id), rect(rect), tier(CT_Memory), file_offset(), file_size(), moving() { }
+
+		bool is_done() const
+			{ return !event && (cairo_surface || tier != CT_Memory); }
+	};
+
+	//! hits are counted once for each frame shown in the work area
+	class CacheStatistics {
+	public:
+		long long hits[CT_Count];
+		long long misses;
+		synfig::Real restore_time[CT_Count]; //!< total time of restoring in seconds
+		long long size[CT_Count];            //!< bytes used by the tier
+
+		CacheStatistics(): misses()
+		{
+			for(int i = 0; i < CT_Count; ++i)
+				{ hits[i] = 0; restore_time[i] = 0.0; size[i] = 0; }
+		}
+
+		long long get_lookups() const
+			{ return hits[CT_Memory] + hits[CT_Packed] + hits[CT_File] + misses; }
+		synfig::Real get_hit_rate() const
+			{ return get_lookups() ? (synfig::Real)(get_lookups() - misses)/(synfig::Real)get_lookups() : 0.0; }
+		synfig::Real get_average_restore_time(CacheTier tier) const
+			{ return hits[tier] ? restore_time[tier]/(synfig::Real)hits[tier] : 0.0; }
+	};
+
+	//! scratch file for the compressed tiles, space of removed tiles is reused
+	class ScratchFile {
+	private:
+		synfig::filesystem::Path filename;
+		synfig::SmartFILE file;
+		long long end;
+		std::map<long long, long long> free_extents; //!< offset -> size
+
+	public:
+		ScratchFile(): end() { }
+		~ScratchFile() { close(); }
+
+		//! returns offset of written data or negative value on error
+		long long write(const void *data, long long size);
+		bool read(long long offset, void *data, long long size);
+		void release(long long offset, long long size);
+		void close();
 	};
 
 	typedef std::map<synfig::Time, FrameStatus> StatusMap;
@@ -135,10 +197,24 @@ public:
 	typedef std::vector<Tile::Handle> TileList;
 	typedef std::map<FrameId, TileList> TileMap;
 
+	//! bounds of the top-level layer, used to find the area changed by the layer
+	class LayerBounds {
+	public:
+		const synfig::Layer *layer;
+		synfig::Rect rect;
+		//! layer affects only pixels inside the 'rect'
+		bool local;
+		LayerBounds(): layer(), local() { }
+	};
+
+	typedef std::vector<LayerBounds> LayerBoundsList;
+
 private:
 	// cache options
-	const long long max_tiles_size_soft; //!< threshold for creation of new tiles
-	const long long max_tiles_size_hard; //!< threshold for removing already created tiles
+	long long max_tiles_size_soft; //!< threshold for creation of new tiles
+	long long max_tiles_size_hard; //!< threshold for packing of already created tiles
+	long long max_packed_size;     //!< threshold for moving packed tiles to the scratch file
+	long long max_file_size;       //!< threshold for removing tiles from the scratch file
 	const synfig::Real weight_future;    //!< will multiply to frames count
 	const synfig::Real weight_past;
 	const synfig::Real weight_future_extra;
@@ -164,6 +240,19 @@ private:
 
 	//! increment of this field makes all tiles outdated
 	long long tiles_size;
+	long long packed_tiles_size;
+	long long file_tiles_size;
+	//! memory tiles which are being packed, they are still counted in tiles_size
+	long long packing_size;
+
+	//! sizes of tiles before and after packing, used to estimate free space of the cache
+	long long packed_source_total;
+	long long packed_result_total;
+
+	ScratchFile scratch_file;
+
+	CacheStatistics statistics;
+	FrameId counted_frame;
 
 	synfig::PixelFormat pixel_format;
 
@@ -176,10 +265,25 @@ private:
 	synfig::Vector previous_br;
 	Cairo::RefPtr<Cairo::ImageSurface> previous_surface;
 
+	//! changes of the canvas since the last invalidation of tiles,
+	//! these fields are accessed from the main thread only
+	synfig::Canvas::LooseHandle tracked_canvas;
+	sigc::connection canvas_child_changed_connection;
+	std::set<const synfig::Layer*> changed_layers;
+	bool changes_unknown;
+
+	//! bounds of the top-level layers before the changes
+	bool snapshot_valid;
+	synfig::Time snapshot_time;
+	LayerBoundsList snapshot;
+
 	// don't try to pass arguments to callbacks by reference, it cannot be properly saved in signal
 	// Renderer_Canvas is non-thread-safe sigc::trackable, so use static callback methods in signals
 	static void on_tile_finished_callback(bool success, Renderer_Canvas *obj, Tile::Handle tile);
 	static void on_post_tile_finished_callback(etl::handle<Renderer_Canvas> obj, Tile::Handle tile);
+	static void pack_tile_callback(etl::handle<Renderer_Canvas> obj, Tile::Handle tile);
+	static void restore_tile_callback(etl::handle<Renderer_Canvas> obj, Tile::Handle tile);
+	static void on_tile_moved_callback(etl::handle<Renderer_Canvas> obj, bool redraw);
 
 	//! this method may be called from the other threads
 	void on_tile_finished(bool success, const Tile::Handle &tile);
@@ -187,6 +291,17 @@ private:
 	//! this method may be called from the main thread only
 	void on_post_tile_finished(const Tile::Handle &tile);
 
+	//! this method may be called from the main thread only
+	void on_canvas_child_changed(const synfig::Node *node);
+
+	//! this method may be called from the main thread only
+	void track_canvas(const synfig::Canvas::Handle &canvas);
+
+	//! this method may be called from the main thread only
+	void reset_changes();
+
+	static void get_layers_bounds(const synfig::Canvas &canvas, LayerBoundsList &out_list);
+
 	//! this method may be called from the other threads
 	Cairo::RefPtr<Cairo::ImageSurface> convert(
 		const synfig::rendering::SurfaceResource::Handle &surface,
@@ -198,6 +313,39 @@ private:
 	//! mutex must be locked before call
 	TileList::iterator erase_tile(TileList &list, TileList::iterator i, synfig::rendering::Task::List &events);
 
+	//! mutex must be locked before call
+	//! parts of the done tiles outside of the 'rect' are kept as new tiles
+	void erase_tiles_in_rect(TileList &list, const synfig::RectInt &rect, synfig::rendering::Task::List &events);
+
+	//! mutex must be locked before call
+	//! frees memory or file space used by the tile
+	void release_tile_storage(Tile &tile);
+
+	//! mutex must be locked before call
+	//! enqueues pack_tile() into the ThreadPool
+	void enqueue_pack_tile(const Tile::Handle &tile);
+
+	//! this method may be called from the other threads, mutex must not be locked
+	//! moves tile to the lower cache tier, compresses it without the mutex
+	void pack_tile(const Tile::Handle &tile);
+
+	//! mutex must be locked before call
+	bool spill_tile(Tile &tile);
+
+	//! this method may be called from the other threads, mutex must not be locked
+	//! brings tile back to memory, decompresses it without the mutex
+	void restore_tile(const Tile::Handle &tile);
+
+	//! mutex must be locked before call
+	//! enqueues restore_tile() for the tiles of the frame, returns the lowest tier they were found in
+	CacheTier restore_tiles(const FrameId &id);
+
+	//! mutex must be locked before call
+	void update_cache_limits();
+
+	//! mutex must be locked before call
+	bool has_cache_space(long long frame_size) const;
+
 	//! mutex must be locked before call
 	void remove_extra_tiles(synfig::rendering::Task::List &events);
 
@@ -228,8 +376,14 @@ public:
 	void wait_render();
 	void clear_render();
 
+	//! removes the tiles touched by the layers changed since the previous call,
+	//! falls back to clear_render() when the changed area cannot be found
+	void invalidate_changes();
+
 	void get_render_status(StatusMap &out_map);
 
+	void get_cache_statistics(CacheStatistics &out_statistics);
+
 	void get_rendering_error_messages(std::vector<std::string>& messages);
 	void get_rendering_error_messages_for_time(const synfig::Time& time, std::set<std::string>& message_set);
 